@@ -4,8 +4,12 @@
 #include <android/log.h>
 #include <sstream>
 
+#include "Log.h"
+
 /*!
- * Use this to log strings out to logcat. Note that you should use std::endl to commit the line
+ * Use this to log strings out to logcat. Note that you should use std::endl to commit the line.
+ * Committed lines go through the asynchronous @a Log, but the formatting still happens on the
+ * calling thread, so prefer the LOG_* macros on hot paths.
  *
  * ex:
  *  aout << "Hello World" << std::endl;
@@ -22,17 +26,18 @@ public:
      * Creates a new output stream for logcat
      * @param kLogTag the log tag to output
      */
-    inline AndroidOut(const char* kLogTag) : logTag_(kLogTag){}
+    inline AndroidOut(const char* kLogTag) : site_{ANDROID_LOG_DEBUG, kLogTag, "%s"} {}
 
 protected:
     virtual int sync() override {
-        __android_log_print(ANDROID_LOG_DEBUG, logTag_, "%s", str().c_str());
+        Log::write(site_, str().c_str());
         str("");
         return 0;
     }
 
 private:
-    const char* logTag_;
+    // Every line is written as a single string argument
+    const LogSite site_;
 };
 
 #endif //ANDROIDGLINVESTIGATIONS_ANDROIDOUT_H
\ No newline at end of file
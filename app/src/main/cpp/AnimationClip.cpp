@@ -0,0 +1,315 @@
+#include "AnimationClip.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "AndroidOut.h"
+
+static constexpr float kSqrt2 = 1.41421356f;
+static constexpr float kQuantizeSteps = 32767.f;
+
+static inline float dot(const Quaternion &a, const Quaternion &b) {
+    return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+}
+
+/*!
+ * Normalized linear interpolation along the shorter arc. Cheaper than slerp and close enough
+ * between neighbouring keys, and the key reduction measures its error against this.
+ */
+static inline Quaternion nlerp(const Quaternion &a, const Quaternion &b, float t) {
+    float sign = dot(a, b) < 0.f ? -1.f : 1.f;
+    float s = 1.f - t;
+    float bt = t * sign;
+    Quaternion q = {a.x * s + b.x * bt, a.y * s + b.y * bt, a.z * s + b.z * bt, a.w * s + b.w * bt};
+    float length = sqrtf(dot(q, q));
+    float invLength = length > 0.f ? 1.f / length : 0.f;
+    return {q.x * invLength, q.y * invLength, q.z * invLength, q.w * invLength};
+}
+
+static inline Vector3 lerp(const Vector3 &a, const Vector3 &b, float t) {
+    return {a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t};
+}
+
+/*!
+ * The angle between two rotations, from the chord between them on the shorter arc. An acos of
+ * their dot turns the ~1e-7 a float unit quaternion is off by into a milliradian, as much as
+ * the tolerances this is checked against.
+ */
+static inline float rotationError(const Quaternion &a, const Quaternion &b) {
+    float sign = dot(a, b) < 0.f ? -1.f : 1.f;
+    float dx = a.x - b.x * sign, dy = a.y - b.y * sign;
+    float dz = a.z - b.z * sign, dw = a.w - b.w * sign;
+    float chord = sqrtf(dx * dx + dy * dy + dz * dz + dw * dw);
+    return 4.f * asinf(std::min(1.f, chord * 0.5f));
+}
+
+static inline float vectorError(const Vector3 &a, const Vector3 &b) {
+    return std::max(fabsf(a.x - b.x), std::max(fabsf(a.y - b.y), fabsf(a.z - b.z)));
+}
+
+/*!
+ * Greedily keeps the fewest keys from @a values that interpolate every frame of @a targets within
+ * @a tolerance. The two differ when the keys are stored quantized, measuring against the source
+ * keeps the quantization inside the tolerance too. A track that never moves keeps a single key.
+ */
+template<typename T, typename Interpolate, typename Error>
+static void reduceKeys(const std::vector<T> &values, const std::vector<T> &targets,
+                       float tolerance, Interpolate interpolate, Error error,
+                       std::vector<uint16_t> &outFrames, std::vector<T> &outKeys) {
+    size_t last = values.size() - 1;
+    bool constant = true;
+    for (size_t frame = 0; frame <= last && constant; frame++) {
+        constant = error(values[0], targets[frame]) <= tolerance;
+    }
+    outFrames.push_back(0);
+    outKeys.push_back(values[0]);
+    if (constant) {
+        return;
+    }
+
+    size_t start = 0;
+    while (start < last) {
+        // Stretch the segment for as long as it still reproduces every frame it skips
+        size_t end = start + 1;
+        for (size_t candidate = end + 1; candidate <= last; candidate++) {
+            bool fits = true;
+            for (size_t frame = start + 1; frame < candidate && fits; frame++) {
+                float t = float(frame - start) / float(candidate - start);
+                fits = error(interpolate(values[start], values[candidate], t), targets[frame])
+                       <= tolerance;
+            }
+            if (!fits) {
+                break;
+            }
+            end = candidate;
+        }
+        outFrames.push_back(static_cast<uint16_t>(end));
+        outKeys.push_back(values[end]);
+        start = end;
+    }
+}
+
+AnimationClip::PackedQuaternion AnimationClip::packQuaternion(const Quaternion &q) {
+    float c[4] = {q.x, q.y, q.z, q.w};
+    float length = sqrtf(dot(q, q));
+    int largest = 0;
+    for (int i = 0; i < 4; i++) {
+        c[i] /= length;
+        if (fabsf(c[i]) > fabsf(c[largest])) {
+            largest = i;
+        }
+    }
+
+    // q and -q are the same rotation, so flip it to make the dropped component positive. The
+    // other three are then within +-1/sqrt(2).
+    float sign = c[largest] < 0.f ? -1.f : 1.f;
+    uint16_t v[3];
+    int n = 0;
+    for (int i = 0; i < 4; i++) {
+        if (i == largest) {
+            continue;
+        }
+        float s = std::clamp(c[i] * sign * kSqrt2, -1.f, 1.f);
+        v[n++] = static_cast<uint16_t>(lroundf((s * 0.5f + 0.5f) * kQuantizeSteps));
+    }
+
+    return {static_cast<uint16_t>(v[0] | ((largest >> 1) << 15)),
+            static_cast<uint16_t>(v[1] | ((largest & 1) << 15)),
+            v[2]};
+}
+
+Quaternion AnimationClip::unpackQuaternion(const PackedQuaternion &packed) {
+    int largest = ((packed.a >> 15) << 1) | (packed.b >> 15);
+    uint16_t v[3] = {uint16_t(packed.a & 0x7FFF), uint16_t(packed.b & 0x7FFF), packed.c};
+
+    float c[4];
+    float sum = 0.f;
+    int n = 0;
+    for (int i = 0; i < 4; i++) {
+        if (i == largest) {
+            continue;
+        }
+        c[i] = (v[n++] / kQuantizeSteps * 2.f - 1.f) / kSqrt2;
+        sum += c[i] * c[i];
+    }
+    c[largest] = sqrtf(std::max(0.f, 1.f - sum));
+    return {c[0], c[1], c[2], c[3]};
+}
+
+std::shared_ptr<AnimationClip> AnimationClip::compress(
+        const std::string &name,
+        size_t jointCount,
+        float sampleRate,
+        const std::vector<JointTransform> &frames,
+        const Tolerance &tolerance) {
+    size_t frameCount = jointCount ? frames.size() / jointCount : 0;
+    if (jointCount == 0 || sampleRate <= 0.f || frames.size() != frameCount * jointCount
+        || frameCount < 2 || frameCount > 65536) {
+        aout << "AnimationClip: can't compress " << name << ", " << frames.size()
+             << " transforms for " << jointCount << " joints" << std::endl;
+        return nullptr;
+    }
+
+    std::shared_ptr<AnimationClip> spClip(new AnimationClip());
+    spClip->name_ = name;
+    spClip->sampleRate_ = sampleRate;
+    spClip->frameCount_ = uint32_t(frameCount);
+    spClip->tracks_.resize(jointCount);
+
+    std::vector<PackedQuaternion> packed(frameCount);
+    std::vector<Quaternion> sourceRotations(frameCount);
+    std::vector<Quaternion> rotations(frameCount);
+    std::vector<Vector3> translations(frameCount);
+    std::vector<Vector3> scales(frameCount);
+    std::vector<uint16_t> keptFrames;
+    std::vector<Quaternion> keptRotations;
+
+    for (size_t joint = 0; joint < jointCount; joint++) {
+        for (size_t frame = 0; frame < frameCount; frame++) {
+            const JointTransform &transform = frames[frame * jointCount + joint];
+            // Keys are fitted from the quantized rotations and measured against the source, so
+            // the tolerance covers both errors
+            const Quaternion &q = transform.rotation;
+            float invLength = 1.f / sqrtf(dot(q, q));
+            sourceRotations[frame] = {q.x * invLength, q.y * invLength, q.z * invLength,
+                                      q.w * invLength};
+            packed[frame] = packQuaternion(q);
+            rotations[frame] = unpackQuaternion(packed[frame]);
+            translations[frame] = transform.translation;
+            scales[frame] = transform.scale;
+        }
+
+        Track &track = spClip->tracks_[joint];
+
+        keptFrames.clear();
+        keptRotations.clear();
+        reduceKeys(rotations, sourceRotations, tolerance.rotation, nlerp, rotationError,
+                   keptFrames, keptRotations);
+        track.rotationOffset = uint32_t(spClip->rotationKeys_.size());
+        track.rotationCount = uint32_t(keptFrames.size());
+        for (uint16_t frame: keptFrames) {
+            spClip->rotationFrames_.push_back(frame);
+            spClip->rotationKeys_.push_back(packed[frame]);
+        }
+
+        track.translationOffset = uint32_t(spClip->translationKeys_.size());
+        reduceKeys(translations, translations, tolerance.translation, lerp, vectorError,
+                   spClip->translationFrames_, spClip->translationKeys_);
+        track.translationCount = uint32_t(spClip->translationKeys_.size()) - track.translationOffset;
+
+        track.scaleOffset = uint32_t(spClip->scaleKeys_.size());
+        reduceKeys(scales, scales, tolerance.scale, lerp, vectorError,
+                   spClip->scaleFrames_, spClip->scaleKeys_);
+        track.scaleCount = uint32_t(spClip->scaleKeys_.size()) - track.scaleOffset;
+    }
+
+    aout << "AnimationClip: " << name << " kept " << spClip->getKeyCount() << " of "
+         << frameCount * jointCount * 3 << " keys, " << spClip->getByteSize() << " bytes"
+         << std::endl;
+    return spClip;
+}
+
+std::shared_ptr<AnimationClip> AnimationClip::compress(
+        const std::string &name,
+        size_t jointCount,
+        float sampleRate,
+        const std::vector<JointTransform> &frames) {
+    return compress(name, jointCount, sampleRate, frames, Tolerance());
+}
+
+size_t AnimationClip::getKeyCount() const {
+    return rotationKeys_.size() + translationKeys_.size() + scaleKeys_.size();
+}
+
+size_t AnimationClip::getByteSize() const {
+    return tracks_.size() * sizeof(Track)
+           + rotationFrames_.size() * (sizeof(uint16_t) + sizeof(PackedQuaternion))
+           + translationFrames_.size() * (sizeof(uint16_t) + sizeof(Vector3))
+           + scaleFrames_.size() * (sizeof(uint16_t) + sizeof(Vector3));
+}
+
+AnimationSampler::AnimationSampler(std::shared_ptr<const AnimationClip> spClip)
+        : spClip_(std::move(spClip)),
+          cursors_(spClip_->getJointCount()) {}
+
+/*!
+ * Moves a track's cursor to the key at or before @a frame. Playing forward this is at most a
+ * step or two, looping back or jumping backwards restarts from the first key.
+ */
+static inline uint32_t seek(const uint16_t *frames, uint32_t count, uint32_t cursor, float frame) {
+    if (cursor >= count || frames[cursor] > frame) {
+        cursor = 0;
+    }
+    while (cursor + 1 < count && frames[cursor + 1] <= frame) {
+        cursor++;
+    }
+    return cursor;
+}
+
+/*!
+ * @return how far @a frame is from the key at @a cursor to the next one
+ */
+static inline float segmentFraction(const uint16_t *frames, uint32_t cursor, float frame) {
+    float start = frames[cursor];
+    return std::min(1.f, (frame - start) / (float(frames[cursor + 1]) - start));
+}
+
+void AnimationSampler::sample(float time, bool loop, JointTransform *outPose) {
+    const AnimationClip &clip = *spClip_;
+    float duration = clip.getDuration();
+    if (loop) {
+        time = fmodf(time, duration);
+        if (time < 0.f) {
+            time += duration;
+        }
+    } else {
+        time = std::clamp(time, 0.f, duration);
+    }
+    float frame = time * clip.sampleRate_;
+
+    for (size_t joint = 0; joint < clip.tracks_.size(); joint++) {
+        const AnimationClip::Track &track = clip.tracks_[joint];
+        Cursor &cursor = cursors_[joint];
+        JointTransform &out = outPose[joint];
+
+        const uint16_t *frames = &clip.rotationFrames_[track.rotationOffset];
+        const AnimationClip::PackedQuaternion *rotations = &clip.rotationKeys_[track.rotationOffset];
+        cursor.rotation = seek(frames, track.rotationCount, cursor.rotation, frame);
+        out.rotation = AnimationClip::unpackQuaternion(rotations[cursor.rotation]);
+        if (cursor.rotation + 1 < track.rotationCount) {
+            out.rotation = nlerp(out.rotation,
+                                 AnimationClip::unpackQuaternion(rotations[cursor.rotation + 1]),
+                                 segmentFraction(frames, cursor.rotation, frame));
+        }
+
+        frames = &clip.translationFrames_[track.translationOffset];
+        const Vector3 *translations = &clip.translationKeys_[track.translationOffset];
+        cursor.translation = seek(frames, track.translationCount, cursor.translation, frame);
+        out.translation = translations[cursor.translation];
+        if (cursor.translation + 1 < track.translationCount) {
+            out.translation = lerp(out.translation, translations[cursor.translation + 1],
+                                   segmentFraction(frames, cursor.translation, frame));
+        }
+
+        frames = &clip.scaleFrames_[track.scaleOffset];
+        const Vector3 *scales = &clip.scaleKeys_[track.scaleOffset];
+        cursor.scale = seek(frames, track.scaleCount, cursor.scale, frame);
+        out.scale = scales[cursor.scale];
+        if (cursor.scale + 1 < track.scaleCount) {
+            out.scale = lerp(out.scale, scales[cursor.scale + 1],
+                             segmentFraction(frames, cursor.scale, frame));
+        }
+    }
+}
+
+void AnimationSampler::blend(const JointTransform *poseA, const JointTransform *poseB,
+                             float weight, size_t jointCount, JointTransform *outPose) {
+    for (size_t joint = 0; joint < jointCount; joint++) {
+        const JointTransform &a = poseA[joint];
+        const JointTransform &b = poseB[joint];
+        JointTransform &out = outPose[joint];
+        out.rotation = nlerp(a.rotation, b.rotation, weight);
+        out.translation = lerp(a.translation, b.translation, weight);
+        out.scale = lerp(a.scale, b.scale, weight);
+    }
+}
@@ -0,0 +1,145 @@
+#ifndef HOLOPERSONA_ANIMATIONCLIP_H
+#define HOLOPERSONA_ANIMATIONCLIP_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Skeleton.h"
+
+/*!
+ * A compressed skeletal animation. Every joint has a rotation, translation and scale track, each
+ * keeping only the keys that can't be rebuilt by interpolating their neighbours within a
+ * tolerance. Rotations are stored as 48 bit "smallest three" quaternions: the largest component
+ * is dropped and rebuilt from the other three, which are quantized to 15 bits each.
+ *
+ * Clips are immutable once compressed and can be shared by any number of @a AnimationSampler.
+ */
+class AnimationClip {
+public:
+    /*!
+     * How far the compressed clip may stray from the source samples
+     */
+    struct Tolerance {
+        float rotation = 0.002f;    // radians
+        float translation = 0.001f; // model units
+        float scale = 0.001f;
+    };
+
+    /*!
+     * Compresses a clip sampled at a fixed rate
+     * @param name a name for the clip
+     * @param jointCount the number of joints in each frame
+     * @param sampleRate the frames per second of @a frames
+     * @param frames jointCount local transforms per frame, at least two frames and at most 65536.
+     *     A looping clip should end on a copy of its first frame.
+     * @param tolerance the error allowed when dropping keys
+     * @return the compressed clip, or null if the frames don't fit the description
+     */
+    static std::shared_ptr<AnimationClip> compress(
+            const std::string &name,
+            size_t jointCount,
+            float sampleRate,
+            const std::vector<JointTransform> &frames,
+            const Tolerance &tolerance);
+
+    /*!
+     * Compresses a clip with the default tolerance
+     */
+    static std::shared_ptr<AnimationClip> compress(
+            const std::string &name,
+            size_t jointCount,
+            float sampleRate,
+            const std::vector<JointTransform> &frames);
+
+    inline const std::string &getName() const { return name_; }
+
+    inline size_t getJointCount() const { return tracks_.size(); }
+
+    //! @return the length of the clip in seconds
+    inline float getDuration() const { return float(frameCount_ - 1) / sampleRate_; }
+
+    //! @return the number of keys kept across every track
+    size_t getKeyCount() const;
+
+    //! @return the memory the compressed tracks take
+    size_t getByteSize() const;
+
+private:
+    friend class AnimationSampler;
+
+    //! A smallest three quaternion. The top bits of a and b hold the index of the dropped component.
+    struct PackedQuaternion {
+        uint16_t a, b, c;
+    };
+
+    //! Where each of a joint's tracks lives in the key arrays
+    struct Track {
+        uint32_t rotationOffset, rotationCount;
+        uint32_t translationOffset, translationCount;
+        uint32_t scaleOffset, scaleCount;
+    };
+
+    static PackedQuaternion packQuaternion(const Quaternion &q);
+
+    static Quaternion unpackQuaternion(const PackedQuaternion &packed);
+
+    AnimationClip() = default;
+
+    std::string name_;
+    float sampleRate_ = 30.f;
+    uint32_t frameCount_ = 0;
+    std::vector<Track> tracks_;
+
+    // The frame number of every key, then the key values, each track contiguous
+    std::vector<uint16_t> rotationFrames_;
+    std::vector<PackedQuaternion> rotationKeys_;
+    std::vector<uint16_t> translationFrames_;
+    std::vector<Vector3> translationKeys_;
+    std::vector<uint16_t> scaleFrames_;
+    std::vector<Vector3> scaleKeys_;
+};
+
+/*!
+ * Plays an @a AnimationClip. Every track keeps a cursor to the key it last used, so sampling a
+ * clip that moves forward a frame at a time never searches and walks the key arrays in order.
+ * Each character playing a clip needs its own sampler.
+ */
+class AnimationSampler {
+public:
+    explicit AnimationSampler(std::shared_ptr<const AnimationClip> spClip);
+
+    inline const AnimationClip &getClip() const { return *spClip_; }
+
+    /*!
+     * Evaluates every joint of the clip in a single pass
+     * @param time the time in seconds
+     * @param loop wraps @a time into the clip if true, otherwise clamps it
+     * @param outPose receives one local transform per joint
+     */
+    void sample(float time, bool loop, JointTransform *outPose);
+
+    /*!
+     * Blends two poses, interpolating rotations along the shorter arc
+     * @param poseA the pose at a weight of 0
+     * @param poseB the pose at a weight of 1
+     * @param weight how much of @a poseB to use
+     * @param jointCount the number of joints in each pose
+     * @param outPose receives the blend, may be either input
+     */
+    static void blend(const JointTransform *poseA, const JointTransform *poseB, float weight,
+                      size_t jointCount, JointTransform *outPose);
+
+private:
+    struct Cursor {
+        uint32_t rotation = 0;
+        uint32_t translation = 0;
+        uint32_t scale = 0;
+    };
+
+    std::shared_ptr<const AnimationClip> spClip_;
+    std::vector<Cursor> cursors_;
+};
+
+#endif //HOLOPERSONA_ANIMATIONCLIP_H
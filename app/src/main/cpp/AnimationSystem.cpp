@@ -0,0 +1,95 @@
+#include "AnimationSystem.h"
+
+#include <algorithm>
+#include <cmath>
+
+AnimatedCharacter::AnimatedCharacter(std::shared_ptr<const Skeleton> spSkeleton,
+                                     std::shared_ptr<const AnimationClip> spIdle,
+                                     std::shared_ptr<const AnimationClip> spWalk,
+                                     float startTime)
+        : spSkeleton_(std::move(spSkeleton)),
+          time_(std::fmod(startTime, kBlendPeriod)) {
+    size_t jointCount = spSkeleton_->getJointCount();
+    if (spIdle && spWalk
+        && spIdle->getJointCount() == jointCount && spWalk->getJointCount() == jointCount) {
+        idleSampler_ = std::make_unique<AnimationSampler>(std::move(spIdle));
+        walkSampler_ = std::make_unique<AnimationSampler>(std::move(spWalk));
+        idlePose_.resize(jointCount);
+        walkPose_.resize(jointCount);
+    }
+
+    // Both buffers start in the rest pose so there's something to draw before the first update
+    pose_ = spSkeleton_->getBindPose();
+    modelMatrices_.resize(jointCount * 16);
+    spSkeleton_->computeModelMatrices(pose_.data(), modelMatrices_.data());
+    for (auto &skinMatrices: skinMatrices_) {
+        skinMatrices.resize(jointCount * 16);
+        spSkeleton_->computeSkinMatrices(modelMatrices_.data(), skinMatrices.data());
+    }
+}
+
+void AnimatedCharacter::update(float frameTime) {
+    time_ = std::fmod(time_ + frameTime, kBlendPeriod);
+    if (idleSampler_ && walkSampler_) {
+        idleSampler_->sample(time_, true, idlePose_.data());
+        walkSampler_->sample(time_, true, walkPose_.data());
+        float walkWeight = 0.5f - 0.5f * std::cos(2.0f * float(M_PI) * time_ / kBlendPeriod);
+        AnimationSampler::blend(idlePose_.data(), walkPose_.data(), walkWeight, pose_.size(),
+                                pose_.data());
+    }
+
+    spSkeleton_->computeModelMatrices(pose_.data(), modelMatrices_.data());
+    spSkeleton_->computeSkinMatrices(modelMatrices_.data(), skinMatrices_[front_ ^ 1].data());
+}
+
+AnimationSystem::AnimationSystem(JobSystem &jobSystem) : jobSystem_(jobSystem) {}
+
+AnimationSystem::~AnimationSystem() {
+    if (updating_) {
+        jobSystem_.wait(counter_);
+    }
+}
+
+size_t AnimationSystem::addCharacter(std::unique_ptr<AnimatedCharacter> character) {
+    characters_.push_back(std::move(character));
+    return characters_.size() - 1;
+}
+
+void AnimationSystem::clear() {
+    if (updating_) {
+        jobSystem_.wait(counter_);
+        updating_ = false;
+    }
+    characters_.clear();
+}
+
+void AnimationSystem::beginUpdate(float frameTime) {
+    finishUpdate();
+
+    updating_ = true;
+    for (size_t begin = 0; begin < characters_.size(); begin += kCharactersPerJob) {
+        size_t end = std::min(begin + kCharactersPerJob, characters_.size());
+        jobSystem_.run(counter_, [this, begin, end, frameTime]() {
+            for (size_t i = begin; i < end; i++) {
+                characters_[i]->update(frameTime);
+            }
+        }, CoreHint::BIG);
+    }
+}
+
+void AnimationSystem::finishUpdate() {
+    if (!updating_) {
+        return;
+    }
+    jobSystem_.wait(counter_);
+    updating_ = false;
+
+    for (auto &character: characters_) {
+        character->swapBuffers();
+    }
+}
+
+void AnimationSystem::update(float frameTime) {
+    beginUpdate(frameTime);
+    finishUpdate();
+}
@@ -0,0 +1,130 @@
+#ifndef HOLOPERSONA_ANIMATIONSYSTEM_H
+#define HOLOPERSONA_ANIMATIONSYSTEM_H
+
+#include <memory>
+#include <vector>
+
+#include "AnimationClip.h"
+#include "JobSystem.h"
+#include "Skeleton.h"
+
+/*!
+ * One animated persona: a skeleton playing an idle and a walk clip that it fades between. Each
+ * update samples both clips, blends them, propagates the pose down the hierarchy and computes the
+ * skin matrices.
+ *
+ * The skin matrices are double buffered. An update writes the back buffer while the renderer
+ * draws from the front one, and @a swapBuffers publishes the new pose.
+ */
+class AnimatedCharacter {
+public:
+    /*!
+     * @param spSkeleton the skeleton to pose
+     * @param spIdle the clip played at a blend weight of 0, may be null to hold the rest pose
+     * @param spWalk the clip played at a blend weight of 1, may be null to hold the rest pose
+     * @param startTime where in the blend cycle to start, so a crowd doesn't move in lockstep
+     */
+    AnimatedCharacter(std::shared_ptr<const Skeleton> spSkeleton,
+                      std::shared_ptr<const AnimationClip> spIdle,
+                      std::shared_ptr<const AnimationClip> spWalk,
+                      float startTime = 0.f);
+
+    inline const Skeleton &getSkeleton() const { return *spSkeleton_; }
+
+    //! @return the skin matrices of the last published pose, sixteen floats per joint
+    inline const float *getSkinMatrices() const { return skinMatrices_[front_].data(); }
+
+    /*!
+     * Advances the clips and poses the back buffer. Touches nothing but this character, so
+     * characters can be updated on any threads at once.
+     * @param frameTime the seconds since the last update
+     */
+    void update(float frameTime);
+
+    //! Makes the pose written by the last update the one @a getSkinMatrices returns
+    inline void swapBuffers() { front_ ^= 1; }
+
+private:
+    // Seconds for an idle, walk, idle cycle
+    static constexpr float kBlendPeriod = 8.0f;
+
+    std::shared_ptr<const Skeleton> spSkeleton_;
+    std::unique_ptr<AnimationSampler> idleSampler_;
+    std::unique_ptr<AnimationSampler> walkSampler_;
+    float time_;
+
+    std::vector<JointTransform> idlePose_;
+    std::vector<JointTransform> walkPose_;
+    std::vector<JointTransform> pose_;
+    std::vector<float> modelMatrices_;
+    std::vector<float> skinMatrices_[2];
+    int front_ = 0;
+};
+
+/*!
+ * Updates every character on a @a JobSystem. An update is started with @a beginUpdate and runs
+ * in the background while the renderer submits the previous frame from the front buffers, then
+ * @a finishUpdate waits for it and publishes the new poses. Characters are handed out in batches
+ * so the pool can balance a crowd across its workers, hinted onto the big cores since a frame is
+ * waiting on them.
+ */
+class AnimationSystem {
+public:
+    /*!
+     * @param jobSystem the pool to run updates on, must outlive the system
+     */
+    explicit AnimationSystem(JobSystem &jobSystem);
+
+    /*!
+     * Waits for an update that's still running
+     */
+    ~AnimationSystem();
+
+    /*!
+     * Adds a character. Must not be called while an update is running.
+     * @return the index of the character
+     */
+    size_t addCharacter(std::unique_ptr<AnimatedCharacter> character);
+
+    inline size_t getCharacterCount() const { return characters_.size(); }
+
+    /*!
+     * @return a character, whose front buffer may be read while an update is running
+     */
+    inline const AnimatedCharacter &getCharacter(size_t index) const { return *characters_[index]; }
+
+    /*!
+     * Waits for any running update and removes every character
+     */
+    void clear();
+
+    /*!
+     * Starts updating every character in the background. Finishes a previous update first if
+     * @a finishUpdate wasn't called.
+     * @param frameTime the seconds to advance the characters by
+     */
+    void beginUpdate(float frameTime);
+
+    /*!
+     * Waits for the update started by @a beginUpdate, helping with it on the calling thread, and
+     * publishes the new poses. Does nothing if there's no update running.
+     */
+    void finishUpdate();
+
+    /*!
+     * Updates and publishes every character before returning
+     */
+    void update(float frameTime);
+
+private:
+    // Characters per job. A character takes a few microseconds, fewer per job and the queueing
+    // costs more than it saves.
+    static constexpr size_t kCharactersPerJob = 8;
+
+    JobSystem &jobSystem_;
+    std::vector<std::unique_ptr<AnimatedCharacter>> characters_;
+    JobCounter counter_;
+    bool updating_ = false;
+};
+
+#endif //HOLOPERSONA_ANIMATIONSYSTEM_H
@@ -0,0 +1,121 @@
+#include "Bounds.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Simd.h"
+
+void Bounds::transformPoints(const float *matrix,
+                             const float *xs, const float *ys, const float *zs,
+                             float *outXs, float *outYs, float *outZs,
+                             size_t count) {
+    const float *m = matrix;
+    size_t i = 0;
+
+#if defined(HOLOPERSONA_SIMD)
+    // Four points per batch, one per lane, so the matrix elements are splatted once for all
+    Float4 m0 = splat4(m[0]), m1 = splat4(m[1]), m2 = splat4(m[2]);
+    Float4 m4 = splat4(m[4]), m5 = splat4(m[5]), m6 = splat4(m[6]);
+    Float4 m8 = splat4(m[8]), m9 = splat4(m[9]), m10 = splat4(m[10]);
+    Float4 m12 = splat4(m[12]), m13 = splat4(m[13]), m14 = splat4(m[14]);
+    for (; i + 4 <= count; i += 4) {
+        Float4 x = load4(xs + i), y = load4(ys + i), z = load4(zs + i);
+        store4(outXs + i, madd4(madd4(madd4(m12, m0, x), m4, y), m8, z));
+        store4(outYs + i, madd4(madd4(madd4(m13, m1, x), m5, y), m9, z));
+        store4(outZs + i, madd4(madd4(madd4(m14, m2, x), m6, y), m10, z));
+    }
+#endif
+
+    for (; i < count; i++) {
+        float x = xs[i], y = ys[i], z = zs[i];
+        outXs[i] = ((m[12] + m[0] * x) + m[4] * y) + m[8] * z;
+        outYs[i] = ((m[13] + m[1] * x) + m[5] * y) + m[9] * z;
+        outZs[i] = ((m[14] + m[2] * x) + m[6] * y) + m[10] * z;
+    }
+}
+
+void Bounds::transformBoundingBoxes(const float *matrix,
+                                    const BoundingBox *boxes,
+                                    BoundingBox *outBoxes,
+                                    size_t count) {
+    // Each output extent is the translation plus, for every input axis, whichever end of the
+    // input range pushes furthest along the matrix column for that axis
+#if defined(HOLOPERSONA_SIMD)
+    Float4 columns[3] = {load4(matrix), load4(matrix + 4), load4(matrix + 8)};
+    Float4 translation = load4(matrix + 12);
+    for (size_t i = 0; i < count; i++) {
+        const BoundingBox box = boxes[i];
+        Float4 low = translation, high = translation;
+        for (int axis = 0; axis < 3; axis++) {
+            Float4 a = mul4(columns[axis], splat4(box.min.idx[axis]));
+            Float4 b = mul4(columns[axis], splat4(box.max.idx[axis]));
+            low = add4(low, min4(a, b));
+            high = add4(high, max4(a, b));
+        }
+
+        // The fourth lane is the unused bottom row
+        float lows[4], highs[4];
+        store4(lows, low);
+        store4(highs, high);
+        outBoxes[i] = {{lows[0], lows[1], lows[2]}, {highs[0], highs[1], highs[2]}};
+    }
+#else
+    const float *m = matrix;
+    for (size_t i = 0; i < count; i++) {
+        const BoundingBox box = boxes[i];
+        BoundingBox result = {{m[12], m[13], m[14]}, {m[12], m[13], m[14]}};
+        for (int axis = 0; axis < 3; axis++) {
+            const float *column = m + axis * 4;
+            for (int row = 0; row < 3; row++) {
+                float a = column[row] * box.min.idx[axis];
+                float b = column[row] * box.max.idx[axis];
+                result.min.idx[row] += std::min(a, b);
+                result.max.idx[row] += std::max(a, b);
+            }
+        }
+        outBoxes[i] = result;
+    }
+#endif
+}
+
+BoundingBox Bounds::computeBoundingBox(const float *matrix,
+                                       const Vertex *vertices,
+                                       size_t count) {
+    if (count == 0) {
+        return {{0.f, 0.f, 0.f}, {0.f, 0.f, 0.f}};
+    }
+
+    static const float kIdentity[16] = {1.f, 0.f, 0.f, 0.f,
+                                        0.f, 1.f, 0.f, 0.f,
+                                        0.f, 0.f, 1.f, 0.f,
+                                        0.f, 0.f, 0.f, 1.f};
+    const float *m = matrix ? matrix : kIdentity;
+
+#if defined(HOLOPERSONA_SIMD)
+    // One vertex per vector, the bounds kept as running minimum and maximum vectors
+    Float4 c0 = load4(m), c1 = load4(m + 4), c2 = load4(m + 8), c3 = load4(m + 12);
+    Float4 low = splat4(INFINITY), high = splat4(-INFINITY);
+    for (size_t i = 0; i < count; i++) {
+        const Vector3 &p = vertices[i].position;
+        Float4 world = madd4(madd4(madd4(c3, c0, splat4(p.x)), c1, splat4(p.y)), c2, splat4(p.z));
+        low = min4(low, world);
+        high = max4(high, world);
+    }
+
+    float lows[4], highs[4];
+    store4(lows, low);
+    store4(highs, high);
+    return {{lows[0], lows[1], lows[2]}, {highs[0], highs[1], highs[2]}};
+#else
+    BoundingBox bounds = {{INFINITY, INFINITY, INFINITY}, {-INFINITY, -INFINITY, -INFINITY}};
+    for (size_t i = 0; i < count; i++) {
+        const Vector3 &p = vertices[i].position;
+        for (int row = 0; row < 3; row++) {
+            float world = ((m[12 + row] + m[row] * p.x) + m[4 + row] * p.y) + m[8 + row] * p.z;
+            bounds.min.idx[row] = std::min(bounds.min.idx[row], world);
+            bounds.max.idx[row] = std::max(bounds.max.idx[row], world);
+        }
+    }
+    return bounds;
+#endif
+}
@@ -0,0 +1,49 @@
+#ifndef HOLOPERSONA_BOUNDS_H
+#define HOLOPERSONA_BOUNDS_H
+
+#include <cstddef>
+
+#include "Model.h"
+#include "VectorMath.h"
+
+/*!
+ * Transforms points and bounding boxes for culling and picking. Nothing here touches GL, so it
+ * builds and is tested on the host along with VectorMath.
+ *
+ * Matrices are column major and affine, their last row 0, 0, 0, 1.
+ */
+class Bounds {
+public:
+    /*!
+     * Transforms points stored as separate x, y and z arrays, four at a time with NEON or SSE2.
+     * The outputs may be the inputs.
+     * @param count the number of points in each array
+     */
+    static void transformPoints(const float *matrix,
+                                const float *xs, const float *ys, const float *zs,
+                                float *outXs, float *outYs, float *outZs,
+                                size_t count);
+
+    /*!
+     * Transforms bounding boxes with Arvo's method, giving the smallest boxes that hold the
+     * transformed corners without transforming all eight of them. The output may be the input.
+     * @param count the number of boxes
+     */
+    static void transformBoundingBoxes(const float *matrix,
+                                       const BoundingBox *boxes,
+                                       BoundingBox *outBoxes,
+                                       size_t count);
+
+    /*!
+     * Computes the bounds of a mesh after transforming it. Tighter than transforming its local
+     * bounds, at the cost of a pass over every vertex.
+     * @param matrix the transform, or null for the local bounds
+     * @param count the number of vertices
+     * @return the bounds, all zero for an empty mesh
+     */
+    static BoundingBox computeBoundingBox(const float *matrix,
+                                          const Vertex *vertices,
+                                          size_t count);
+};
+
+#endif //HOLOPERSONA_BOUNDS_H
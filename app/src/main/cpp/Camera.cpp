@@ -0,0 +1,38 @@
+#include "Camera.h"
+
+#include <cmath>
+
+Camera::Camera(float focalLength, float near, float far, float distance, float height)
+        : focalLength_(focalLength),
+          near_(near),
+          far_(far),
+          distance_(distance),
+          height_(height),
+          projection_(perspective(focalLength, 1.f, near, far)) {
+    updateView();
+}
+
+bool Camera::setAspectRatio(float aspect) {
+    if (aspect == aspect_) {
+        return false;
+    }
+    aspect_ = aspect;
+    projection_ = perspective(focalLength_, aspect_, near_, far_);
+    viewProjection_ = VectorMath::multiply(projection_, view_);
+    return true;
+}
+
+bool Camera::setYaw(float yaw) {
+    if (yaw == yaw_) {
+        return false;
+    }
+    yaw_ = yaw;
+    updateView();
+    return true;
+}
+
+void Camera::updateView() {
+    Vector3 eye = {distance_ * std::sin(yaw_), height_, distance_ * std::cos(yaw_)};
+    VectorMath::lookAt(view_.m, eye, {0.f, 0.f, 0.f}, {0.f, 1.f, 0.f});
+    viewProjection_ = VectorMath::multiply(projection_, view_);
+}
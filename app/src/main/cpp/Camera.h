@@ -0,0 +1,101 @@
+#ifndef HOLOPERSONA_CAMERA_H
+#define HOLOPERSONA_CAMERA_H
+
+#include "VectorMath.h"
+
+/*!
+ * A camera orbiting the origin. The projection, view and their product are cached and only
+ * rebuilt when the aspect ratio or the orbit actually changes, so a frame where neither does
+ * costs no matrix math beyond the model matrix.
+ *
+ * The projection builders are constexpr, so anything known at compile time, such as the focal
+ * length of a constant field of view, is folded by the compiler instead of calling tan.
+ */
+class Camera {
+public:
+    /*!
+     * @param fovY the vertical field of view in radians, less than pi
+     * @return the focal length, 1 / tan(fovY / 2), the scale the projection applies to y
+     */
+    static constexpr float focalLength(float fovY) {
+        return float(1.0 / tangent(double(fovY) * 0.5));
+    }
+
+    /*!
+     * Builds a right handed perspective projection, the same one as
+     * Utility::buildPerspectiveMatrix but taking the focal length instead of the field of view
+     */
+    static constexpr Mat4 perspective(float focalLength, float aspect, float near, float far) {
+        return {{
+                focalLength / aspect, 0.f, 0.f, 0.f,
+                0.f, focalLength, 0.f, 0.f,
+                0.f, 0.f, (far + near) / (near - far), -1.f,
+                0.f, 0.f, (2.f * far * near) / (near - far), 0.f}};
+    }
+
+    /*!
+     * Starts at an aspect ratio of 1, looking down -z from @a distance along +z
+     * @param focalLength see @a focalLength
+     * @param near the distance of the near plane
+     * @param far the distance of the far plane
+     * @param distance the orbit radius
+     * @param height the height of the camera above the point it looks at
+     */
+    Camera(float focalLength, float near, float far, float distance, float height);
+
+    /*!
+     * Sets the width over the height of the viewport, rebuilding the projection if it changed
+     * @return true if it changed
+     */
+    bool setAspectRatio(float aspect);
+
+    /*!
+     * Moves the camera around the origin, rebuilding the view if it moved
+     * @param yaw the angle around the y axis in radians, 0 puts the camera on +z
+     * @return true if the camera moved
+     */
+    bool setYaw(float yaw);
+
+    inline float getFocalLength() const { return focalLength_; }
+
+    inline float getDistance() const { return distance_; }
+
+    inline const Mat4 &getProjection() const { return projection_; }
+
+    inline const Mat4 &getView() const { return view_; }
+
+    //! @return the projection times the view
+    inline const Mat4 &getViewProjection() const { return viewProjection_; }
+
+private:
+    /*!
+     * tan for |x| < pi / 2, from the Taylor series of sin and cos so it can run at compile time
+     */
+    static constexpr double tangent(double x) {
+        double sine = x, cosine = 1.0;
+        double sineTerm = x, cosineTerm = 1.0;
+        for (int n = 1; n < 12; n++) {
+            sineTerm *= -x * x / double((2 * n) * (2 * n + 1));
+            cosineTerm *= -x * x / double((2 * n - 1) * (2 * n));
+            sine += sineTerm;
+            cosine += cosineTerm;
+        }
+        return sine / cosine;
+    }
+
+    void updateView();
+
+    float focalLength_;
+    float near_;
+    float far_;
+    float distance_;
+    float height_;
+    float aspect_ = 1.f;
+    float yaw_ = 0.f;
+
+    Mat4 projection_;
+    Mat4 view_;
+    Mat4 viewProjection_;
+};
+
+#endif //HOLOPERSONA_CAMERA_H
@@ -0,0 +1,135 @@
+#include "CpuSkinning.h"
+
+#include <algorithm>
+
+#include "Simd.h"
+
+static constexpr float kWeightScale = 1.f / 255.f;
+
+void SkinPalette::setMatrices(const float *skinMatrices, size_t jointCount) {
+    jointCount_ = jointCount;
+    elements_.resize(kElements * jointCount);
+    for (size_t joint = 0; joint < jointCount; joint++) {
+        const float *m = skinMatrices + joint * 16;
+        for (int row = 0; row < 3; row++) {
+            for (int column = 0; column < 4; column++) {
+                elements_[(row * 4 + column) * jointCount + joint] = m[column * 4 + row];
+            }
+        }
+    }
+}
+
+/*!
+ * Blends and applies the skin matrices of one vertex. Adds in the same order as the vector path
+ * so the two agree to the last bit where the compiler doesn't fuse the multiply-adds.
+ */
+static inline void skinVertex(const Vertex &src, Vertex &dst, const SkinPalette &palette) {
+    float blended[SkinPalette::kElements] = {};
+    for (int k = 0; k < Vertex::kMaxInfluences; k++) {
+        if (src.weights[k] == 0) {
+            continue;
+        }
+        float weight = src.weights[k] * kWeightScale;
+        for (int e = 0; e < SkinPalette::kElements; e++) {
+            blended[e] += palette.getElement(e)[src.joints[k]] * weight;
+        }
+    }
+
+    const Vector3 &p = src.position;
+    dst = src;
+    for (int row = 0; row < 3; row++) {
+        const float *m = blended + row * 4;
+        dst.position.idx[row] = ((m[3] + m[0] * p.x) + m[1] * p.y) + m[2] * p.z;
+    }
+}
+
+void CpuSkinning::skin(const Vertex *src, Vertex *dst, size_t count, const SkinPalette &palette) {
+    size_t i = 0;
+
+#if defined(HOLOPERSONA_SIMD)
+    // Four vertices per batch, one per lane. The joint lookups are gathers either way, the win is
+    // in blending twelve matrix elements and transforming the positions four at a time.
+    for (; i + 4 <= count; i += 4) {
+        const Vertex *v = src + i;
+        Float4 blended[SkinPalette::kElements];
+        for (auto &element: blended) {
+            element = splat4(0.f);
+        }
+
+        for (int k = 0; k < Vertex::kMaxInfluences; k++) {
+            if ((v[0].weights[k] | v[1].weights[k] | v[2].weights[k] | v[3].weights[k]) == 0) {
+                continue;
+            }
+            Float4 weight = mul4(set4(v[0].weights[k], v[1].weights[k],
+                                      v[2].weights[k], v[3].weights[k]),
+                                 splat4(kWeightScale));
+            uint8_t j0 = v[0].joints[k], j1 = v[1].joints[k];
+            uint8_t j2 = v[2].joints[k], j3 = v[3].joints[k];
+            if (j0 == j1 && j0 == j2 && j0 == j3) {
+                // Neighbouring vertices usually share joints, which saves the gather
+                for (int e = 0; e < SkinPalette::kElements; e++) {
+                    Float4 m = splat4(palette.getElement(e)[j0]);
+                    blended[e] = madd4(blended[e], m, weight);
+                }
+                continue;
+            }
+            for (int e = 0; e < SkinPalette::kElements; e++) {
+                const float *element = palette.getElement(e);
+                Float4 m = set4(element[j0], element[j1], element[j2], element[j3]);
+                blended[e] = madd4(blended[e], m, weight);
+            }
+        }
+
+        Float4 x = set4(v[0].position.x, v[1].position.x, v[2].position.x, v[3].position.x);
+        Float4 y = set4(v[0].position.y, v[1].position.y, v[2].position.y, v[3].position.y);
+        Float4 z = set4(v[0].position.z, v[1].position.z, v[2].position.z, v[3].position.z);
+
+        float out[3][4];
+        for (int row = 0; row < 3; row++) {
+            const Float4 *m = blended + row * 4;
+            Float4 p = madd4(madd4(madd4(m[3], m[0], x), m[1], y), m[2], z);
+            store4(out[row], p);
+        }
+
+        for (int lane = 0; lane < 4; lane++) {
+            dst[i + lane] = v[lane];
+            dst[i + lane].position = {out[0][lane], out[1][lane], out[2][lane]};
+        }
+    }
+#endif
+
+    for (; i < count; i++) {
+        skinVertex(src[i], dst[i], palette);
+    }
+}
+
+void CpuSkinning::skinParallel(const Vertex *src, Vertex *dst, size_t count,
+                               const SkinPalette &palette, JobSystem &jobSystem) {
+    // Split by whole batches of four so only the last range has a scalar tail
+    size_t batches = (count + 3) / 4;
+    jobSystem.parallelFor(batches, kMinVerticesPerJob / 4, [=, &palette](size_t begin, size_t end) {
+        size_t first = begin * 4;
+        skin(src + first, dst + first, std::min(end * 4, count) - first, palette);
+    }, CoreHint::BIG);
+}
+
+void CpuSkinning::skinReference(const Vertex *src, Vertex *dst, size_t count,
+                                const float *skinMatrices) {
+    for (size_t i = 0; i < count; i++) {
+        float blended[16] = {};
+        for (int k = 0; k < Vertex::kMaxInfluences; k++) {
+            float weight = src[i].weights[k] * kWeightScale;
+            const float *m = skinMatrices + src[i].joints[k] * 16;
+            for (int e = 0; e < 16; e++) {
+                blended[e] += m[e] * weight;
+            }
+        }
+
+        const Vector3 &p = src[i].position;
+        dst[i] = src[i];
+        dst[i].position = {
+                blended[0] * p.x + blended[4] * p.y + blended[8] * p.z + blended[12],
+                blended[1] * p.x + blended[5] * p.y + blended[9] * p.z + blended[13],
+                blended[2] * p.x + blended[6] * p.y + blended[10] * p.z + blended[14]};
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef HOLOPERSONA_CPUSKINNING_H
+#define HOLOPERSONA_CPUSKINNING_H
+
+#include <cstddef>
+#include <vector>
+
+#include "JobSystem.h"
+#include "Model.h"
+
+/*!
+ * Skin matrices rearranged for vector skinning. Only the top three rows of each matrix matter
+ * for an affine transform, so the palette keeps twelve arrays, one per matrix element, each
+ * holding that element for every joint.
+ */
+class SkinPalette {
+public:
+    static constexpr int kElements = 12;
+
+    /*!
+     * @param skinMatrices sixteen floats per joint, column major, as computed by
+     *     Skeleton::computeSkinMatrices
+     * @param jointCount the number of joints
+     */
+    void setMatrices(const float *skinMatrices, size_t jointCount);
+
+    inline size_t getJointCount() const { return jointCount_; }
+
+    /*!
+     * @param element the row major index into the top 3x4 of the matrix, row * 4 + column
+     * @return that element for every joint
+     */
+    inline const float *getElement(int element) const { return &elements_[element * jointCount_]; }
+
+private:
+    size_t jointCount_ = 0;
+    std::vector<float> elements_;
+};
+
+/*!
+ * Linear blend skinning on the CPU, for devices or debug paths without the skinned shader and
+ * for checking the GPU result on a host. Vertices are skinned four at a time with NEON or SSE2
+ * (see Simd.h), and large meshes are split across a @a JobSystem by vertex range.
+ *
+ * Skinning copies every vertex from the source to the destination with only the position
+ * changed, so the destination can be a mapped vertex buffer that's drawn as is.
+ */
+class CpuSkinning {
+public:
+    /*!
+     * Skins vertices with the vector path when there is one
+     * @param src the vertices in their rest pose
+     * @param dst receives @a count skinned vertices, must not overlap @a src
+     * @param count the number of vertices
+     * @param palette the skin matrices of the pose
+     */
+    static void skin(const Vertex *src, Vertex *dst, size_t count, const SkinPalette &palette);
+
+    /*!
+     * Like @a skin, with the vertices split into ranges that are skinned as jobs. The calling
+     * thread skins ranges too and returns once every range is done. Small meshes aren't split.
+     */
+    static void skinParallel(const Vertex *src, Vertex *dst, size_t count,
+                             const SkinPalette &palette, JobSystem &jobSystem);
+
+    /*!
+     * The scalar reference the vector path is validated against. Blends the column major matrices
+     * directly, one vertex at a time.
+     */
+    static void skinReference(const Vertex *src, Vertex *dst, size_t count,
+                              const float *skinMatrices);
+
+private:
+    // Fewer vertices than this per job cost more to hand off than they save
+    static constexpr size_t kMinVerticesPerJob = 2048;
+};
+
+#endif //HOLOPERSONA_CPUSKINNING_H
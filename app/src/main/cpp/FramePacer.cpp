@@ -0,0 +1,216 @@
+#include "FramePacer.h"
+
+#include <android/choreographer.h>
+#include <android/looper.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+#include "AndroidOut.h"
+
+FramePacer::~FramePacer() {
+    // The view reference is left to the process exit, there's no VM to release it with here
+    stopThread();
+}
+
+bool FramePacer::start(JNIEnv *env, jobject view) {
+    stop(env);
+
+    if (env->GetJavaVM(&vm_) != JNI_OK) {
+        aout << "ERROR: FramePacer couldn't get the VM" << std::endl;
+        return false;
+    }
+    jclass viewClass = env->GetObjectClass(view);
+    requestRender_ = env->GetMethodID(viewClass, "requestRender", "()V");
+    if (!requestRender_) {
+        aout << "ERROR: FramePacer needs a GLSurfaceView" << std::endl;
+        return false;
+    }
+    view_ = env->NewGlobalRef(view);
+
+    // The thread reports back once it knows whether it has a choreographer
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        startFinished_ = false;
+    }
+    running_ = true;
+    thread_ = std::thread(&FramePacer::run, this);
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        started_.wait(lock, [this]() { return startFinished_; });
+    }
+
+    bool paced;
+    {
+        std::lock_guard<std::mutex> lock(looperMutex_);
+        paced = looper_ != nullptr;
+    }
+    if (!paced) {
+        aout << "WARNING: No AChoreographer, falling back to continuous rendering" << std::endl;
+        stop(env);
+        return false;
+    }
+    return true;
+}
+
+void FramePacer::stop(JNIEnv *env) {
+    stopThread();
+    if (view_) {
+        env->DeleteGlobalRef(view_);
+        view_ = nullptr;
+    }
+}
+
+void FramePacer::requestFrame() {
+    int64_t noRequest = 0;
+    requestNanos_.compare_exchange_strong(noRequest, nowNanos(), std::memory_order_relaxed);
+
+    if (!frameRequested_.exchange(true, std::memory_order_acq_rel)) {
+        wakeLooper();
+    }
+}
+
+FrameTiming FramePacer::beginFrame() {
+    int64_t now = nowNanos();
+    int64_t period = vsyncPeriodNanos_.load(std::memory_order_relaxed);
+
+    // A frame asked for at R should start by the vsync after next, R + 2 periods. Every period
+    // it starts later than that is a vsync the display showed an old frame for.
+    int64_t requested = requestNanos_.exchange(0, std::memory_order_relaxed);
+    if (requested) {
+        int64_t late = now - (requested + 2 * period);
+        if (late > 0) {
+            missedFrames_.fetch_add(uint32_t(1 + late / period), std::memory_order_relaxed);
+        }
+    }
+
+    // Start from the vsync that woke the frame. A frame the view drew for some other reason,
+    // such as input or a resize, has no fresh vsync and starts now.
+    int64_t vsync = latestVsyncNanos_.load(std::memory_order_acquire);
+    int64_t start = vsync > lastFrameStartNanos_ && now - vsync < 2 * period ? vsync : now;
+    start = std::max(start, lastFrameStartNanos_);
+
+    FrameTiming timing = {};
+    timing.frameTime = lastFrameStartNanos_ ? float(start - lastFrameStartNanos_) * 1e-9f : 0.f;
+    timing.frameStartNanos = start;
+    timing.displayTimeNanos = start + kDisplayLatencyFrames * period;
+    lastFrameStartNanos_ = start;
+    return timing;
+}
+
+void FramePacer::run() {
+    vm_->AttachCurrentThread(&env_, nullptr);
+    ALooper *looper = ALooper_prepare(0);
+    choreographer_ = AChoreographer_getInstance();
+    if (choreographer_) {
+        // The reference keeps the looper alive for anyone waking it after this thread is gone,
+        // stopThread releases it
+        ALooper_acquire(looper);
+        std::lock_guard<std::mutex> looperLock(looperMutex_);
+        looper_ = looper;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        startFinished_ = true;
+    }
+    started_.notify_all();
+
+    // Sleep until a frame is requested, then post a callback for the next vsync. A request made
+    // while a callback is pending is picked up once it has run.
+    while (choreographer_ && running_) {
+        if (!callbackPosted_ && frameRequested_.exchange(false, std::memory_order_acq_rel)) {
+            callbackPosted_ = true;
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+            // The 64 bit variant needs API 29, see frameCallback for 32 bit devices
+            AChoreographer_postFrameCallback(choreographer_, frameCallback, this);
+#pragma clang diagnostic pop
+        }
+        ALooper_pollOnce(-1, nullptr, nullptr, nullptr);
+    }
+
+    choreographer_ = nullptr;
+    callbackPosted_ = false;
+    vm_->DetachCurrentThread();
+    env_ = nullptr;
+}
+
+void FramePacer::stopThread() {
+    if (!thread_.joinable()) {
+        return;
+    }
+    running_ = false;
+    wakeLooper();
+    thread_.join();
+
+    std::lock_guard<std::mutex> lock(looperMutex_);
+    if (looper_) {
+        ALooper_release(looper_);
+        looper_ = nullptr;
+    }
+}
+
+void FramePacer::wakeLooper() {
+    std::lock_guard<std::mutex> lock(looperMutex_);
+    if (looper_) {
+        ALooper_wake(looper_);
+    }
+}
+
+void FramePacer::onVsync(int64_t frameTimeNanos) {
+    callbackPosted_ = false;
+
+    // Measure the vsync period from callbacks on consecutive vsyncs. A much shorter gap means the
+    // display switched to a higher refresh rate. A longer one is usually a vsync the callback
+    // wasn't posted for, so a lower rate is only taken once several gaps in a row agree on it.
+    int64_t period = vsyncPeriodNanos_.load(std::memory_order_relaxed);
+    int64_t gap = frameTimeNanos - previousVsyncNanos_;
+    if (previousVsyncNanos_ && gap > 0) {
+        if (gap < period * 3 / 4) {
+            period = gap;
+            longerGapCount_ = 0;
+        } else if (gap < period * 3 / 2) {
+            period += (gap - period) / 8;
+            longerGapCount_ = 0;
+        } else if (gap < period * kMaxPeriodChange) {
+            int64_t difference = gap - longerPeriodNanos_;
+            if (longerGapCount_ && std::abs(difference) < longerPeriodNanos_ / 32) {
+                longerPeriodNanos_ += difference / int64_t(longerGapCount_ + 1);
+                longerGapCount_++;
+            } else {
+                longerPeriodNanos_ = gap;
+                longerGapCount_ = 1;
+            }
+            if (longerGapCount_ == kLongerPeriodGaps) {
+                period = longerPeriodNanos_;
+                longerGapCount_ = 0;
+            }
+        } else {
+            longerGapCount_ = 0;
+        }
+        vsyncPeriodNanos_.store(period, std::memory_order_relaxed);
+    }
+    previousVsyncNanos_ = frameTimeNanos;
+
+    latestVsyncNanos_.store(frameTimeNanos, std::memory_order_release);
+    if (running_ && view_) {
+        env_->CallVoidMethod(view_, requestRender_);
+    }
+}
+
+void FramePacer::frameCallback(long frameTimeNanos, void *data) {
+    int64_t vsync = frameTimeNanos;
+    if (sizeof(long) < sizeof(int64_t)) {
+        // A 32 bit long only holds the low bits. The vsync was moments ago, so put back the high
+        // bits of the current time.
+        int64_t now = nowNanos();
+        vsync = now - int64_t(uint32_t(uint32_t(now) - uint32_t(frameTimeNanos)));
+    }
+    static_cast<FramePacer *>(data)->onVsync(vsync);
+}
+
+int64_t FramePacer::nowNanos() {
+    // Bionic's steady_clock is CLOCK_MONOTONIC, the clock Choreographer and MotionEvent use
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,152 @@
+#ifndef HOLOPERSONA_FRAMEPACER_H
+#define HOLOPERSONA_FRAMEPACER_H
+
+#include <jni.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+struct AChoreographer;
+struct ALooper;
+
+/*!
+ * When a frame is drawn and how far it advances the scene
+ */
+struct FrameTiming {
+    //! Seconds since the last frame, 0 for the first one
+    float frameTime;
+    //! The vsync the frame was started for, nanoseconds on the monotonic clock
+    int64_t frameStartNanos;
+    //! When the frame is expected to reach the display, on the same clock
+    int64_t displayTimeNanos;
+};
+
+/*!
+ * Paces a GLSurfaceView in RENDERMODE_WHEN_DIRTY to the display's vsync. Anything that wants a
+ * frame calls @a requestFrame, and the pacer asks the view to render on the next vsync. A scene
+ * with nothing changing draws nothing at all.
+ *
+ * AChoreographer only delivers vsync to the thread it was created on, and that thread needs a
+ * looper, so the pacer runs a small thread of its own. It sleeps in the looper until a frame is
+ * requested, posts a vsync callback, and calls requestRender from it.
+ *
+ * Frame times come from the vsync timestamps rather than the time the render thread got to the
+ * frame, so motion stays even when the render thread is scheduled late.
+ */
+class FramePacer {
+public:
+    FramePacer() = default;
+
+    ~FramePacer();
+
+    FramePacer(const FramePacer &) = delete;
+
+    FramePacer &operator=(const FramePacer &) = delete;
+
+    /*!
+     * Starts pacing a view. Call from a thread attached to the VM.
+     * @param view the GLSurfaceView to request renders from
+     * @return false if vsync isn't available, in which case the view should render continuously
+     */
+    bool start(JNIEnv *env, jobject view);
+
+    /*!
+     * Stops pacing and releases the view. Call from a thread attached to the VM.
+     */
+    void stop(JNIEnv *env);
+
+    /*!
+     * Asks for a frame on the next vsync. Safe to call from any thread, any number of times per
+     * frame.
+     */
+    void requestFrame();
+
+    /*!
+     * Starts a frame. Render thread only.
+     */
+    FrameTiming beginFrame();
+
+    /*!
+     * @return how many vsyncs a requested frame started too late for, in total. A frame is due
+     *     within a vsync of the one after it was requested.
+     */
+    inline uint32_t getMissedFrames() const { return missedFrames_.load(std::memory_order_relaxed); }
+
+    //! @return the time between vsyncs, measured from the callbacks
+    inline int64_t getVsyncPeriodNanos() const {
+        return vsyncPeriodNanos_.load(std::memory_order_relaxed);
+    }
+
+private:
+    // Until the callbacks have measured it
+    static constexpr int64_t kDefaultVsyncPeriodNanos = 16'666'667;
+
+    // How many gaps in a row have to agree on a longer period before it's taken
+    static constexpr uint32_t kLongerPeriodGaps = 6;
+
+    // Refresh rates a display may switch between, 24 to 144 Hz, are at most this many times apart
+    static constexpr int64_t kMaxPeriodChange = 6;
+
+    // GLSurfaceView queues a frame behind the one being displayed, so what's drawn after a vsync
+    // shows up about two vsyncs later
+    static constexpr int64_t kDisplayLatencyFrames = 2;
+
+    void run();
+
+    /*!
+     * Stops the pacer thread and lets go of its looper
+     */
+    void stopThread();
+
+    /*!
+     * Wakes the pacer thread, if it has a looper
+     */
+    void wakeLooper();
+
+    void onVsync(int64_t frameTimeNanos);
+
+    static void frameCallback(long frameTimeNanos, void *data);
+
+    static int64_t nowNanos();
+
+    JavaVM *vm_ = nullptr;
+    jobject view_ = nullptr;
+    jmethodID requestRender_ = nullptr;
+
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable started_;
+    bool startFinished_ = false;
+
+    // The pacer thread's looper, referenced so it can be woken from any thread until stopThread
+    // releases it. Guarded by looperMutex_, which is only held to wake it.
+    std::mutex looperMutex_;
+    ALooper *looper_ = nullptr;
+    std::atomic<bool> running_{false};
+
+    // Pacer thread only
+    JNIEnv *env_ = nullptr;
+    AChoreographer *choreographer_ = nullptr;
+    bool callbackPosted_ = false;
+    int64_t previousVsyncNanos_ = 0;
+    // A longer period the latest gaps agree on, and how many of them in a row
+    int64_t longerPeriodNanos_ = 0;
+    uint32_t longerGapCount_ = 0;
+
+    // Set by requestFrame, taken by the pacer thread when it posts the next callback
+    std::atomic<bool> frameRequested_{false};
+
+    // When the first request since the last frame was made, 0 if there was none
+    std::atomic<int64_t> requestNanos_{0};
+
+    std::atomic<int64_t> latestVsyncNanos_{0};
+    std::atomic<int64_t> vsyncPeriodNanos_{kDefaultVsyncPeriodNanos};
+    std::atomic<uint32_t> missedFrames_{0};
+
+    // Render thread only
+    int64_t lastFrameStartNanos_ = 0;
+};
+
+#endif //HOLOPERSONA_FRAMEPACER_H
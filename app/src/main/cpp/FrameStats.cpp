@@ -0,0 +1,59 @@
+#include "FrameStats.h"
+
+#include <algorithm>
+
+void FrameStats::addFrame(const FrameSample &sample) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    frames_[frameCount_ % kWindowSize] = sample;
+    frameCount_++;
+}
+
+void FrameStats::addGpuTime(float gpuMs) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    gpuTimes_[gpuTimeCount_ % kWindowSize] = gpuMs;
+    gpuTimeCount_++;
+}
+
+void FrameStats::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    frameCount_ = 0;
+    gpuTimeCount_ = 0;
+}
+
+FrameStatsSnapshot FrameStats::getSnapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    FrameStatsSnapshot snapshot = {};
+    snapshot.gpuMs = -1.0f;
+
+    size_t frames = std::min(frameCount_, kWindowSize);
+    if (frames > 0) {
+        for (size_t i = 0; i < frames; i++) {
+            snapshot.cpuMs += frames_[i].cpuMs;
+            snapshot.draws += float(frames_[i].draws);
+            snapshot.triangles += float(frames_[i].triangles);
+            snapshot.stateChanges += float(frames_[i].stateChanges);
+            snapshot.inputMs += frames_[i].inputMs;
+            snapshot.waitMs += frames_[i].waitMs;
+            snapshot.simulationMs += frames_[i].simulationMs;
+            snapshot.renderMs += frames_[i].renderMs;
+        }
+        snapshot.cpuMs /= float(frames);
+        snapshot.draws /= float(frames);
+        snapshot.triangles /= float(frames);
+        snapshot.stateChanges /= float(frames);
+        snapshot.inputMs /= float(frames);
+        snapshot.waitMs /= float(frames);
+        snapshot.simulationMs /= float(frames);
+        snapshot.renderMs /= float(frames);
+    }
+
+    size_t gpuTimes = std::min(gpuTimeCount_, kWindowSize);
+    if (gpuTimes > 0) {
+        float total = 0.0f;
+        for (size_t i = 0; i < gpuTimes; i++) {
+            total += gpuTimes_[i];
+        }
+        snapshot.gpuMs = total / float(gpuTimes);
+    }
+    return snapshot;
+}
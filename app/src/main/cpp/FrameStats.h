@@ -0,0 +1,76 @@
+#ifndef HOLOPERSONA_FRAMESTATS_H
+#define HOLOPERSONA_FRAMESTATS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+/*!
+ * What the render thread spent on one frame
+ */
+struct FrameSample {
+    float cpuMs;            // From the start of nativeOnDrawFrame to the last draw submitted
+    uint32_t draws;
+    uint32_t triangles;
+    uint32_t stateChanges;  // Program, texture and joint palette changes between draws
+
+    // The stages of cpuMs, except simulationMs
+    float inputMs;          // Commands, touches and any model recreation
+    float waitMs;           // Waiting on the simulation, only when there was no state to draw
+    float simulationMs;     // The step that produced the state drawn, on the simulation thread
+    float renderMs;         // Submitting the draw calls
+};
+
+/*!
+ * Recent frames averaged. The layout, one float per field, is what nativeGetFrameStats copies
+ * out to Kotlin, so it must match FrameStats in FrameStats.kt.
+ */
+struct FrameStatsSnapshot {
+    float cpuMs;
+    float gpuMs;            // Negative when the GPU can't be timed or no result has come back yet
+    float draws;
+    float triangles;
+    float stateChanges;
+    float inputMs;
+    float waitMs;
+    float simulationMs;
+    float renderMs;
+
+    static constexpr size_t kFieldCount = 9;
+};
+
+/*!
+ * Collects what frames cost and averages the last few for display. Nothing here touches GL, the
+ * GPU times come from a GpuTimer, which only has them a few frames after the frame they timed.
+ *
+ * The render thread adds to it, any thread can take a snapshot.
+ */
+class FrameStats {
+public:
+    // How many frames, and GPU times, are averaged, half a second at 60 fps
+    static constexpr size_t kWindowSize = 30;
+
+    void addFrame(const FrameSample &sample);
+
+    /*!
+     * Adds the GPU time of a frame once it's been read back, which may be several frames after
+     * the frame itself was added
+     */
+    void addGpuTime(float gpuMs);
+
+    /*!
+     * Forgets every frame so far, for when what's drawn changes completely
+     */
+    void clear();
+
+    FrameStatsSnapshot getSnapshot() const;
+
+private:
+    mutable std::mutex mutex_;
+    FrameSample frames_[kWindowSize] = {};
+    size_t frameCount_ = 0;     // Added so far, the newest kWindowSize are kept
+    float gpuTimes_[kWindowSize] = {};
+    size_t gpuTimeCount_ = 0;
+};
+
+#endif //HOLOPERSONA_FRAMESTATS_H
@@ -1,7 +1,10 @@
 #include <jni.h>
 #include <memory>
 #include <GLES3/gl3.h>
+#include <chrono>
 #include <cmath>
+#include <cstdint>
+#include <mutex>
 #include <android/asset_manager.h>
 #include <android/asset_manager_jni.h>
 
@@ -10,32 +13,168 @@
 #include "Shader.h"
 #include "Utility.h"
 #include "TextureAsset.h"
+#include "TextureAtlas.h"
+#include "TextureCache.h"
+#include "AnimationSystem.h"
+#include "Camera.h"
+#include "CpuSkinning.h"
+#include "FramePacer.h"
+#include "FrameStats.h"
+#include "GlQueryBackend.h"
+#include "GpuTimer.h"
+#include "JobSystem.h"
+#include "Log.h"
+#include "MorphTarget.h"
+#include "Profiler.h"
+#include "Skeleton.h"
+#include "SimulationThread.h"
 #include "SkeletonAsset.h"
+#include "SpscQueue.h"
+#include "TouchInput.h"
+#include "TripleBuffer.h"
 #include "ObjLoader.h"
 
 // Global variables to manage the renderer
 static std::unique_ptr<Shader> gShader;
+static std::unique_ptr<Shader> gSkinnedShader;
 static std::vector<Model> gModels;
+static TextureCache gTextureCache;
 static AAssetManager* gAssetManager = nullptr;
 static int gWidth = 0;
 static int gHeight = 0;
 static int gCurrentSkeletonType = 1; // Default to DETAILED_HUMANOID
-static int gRequestedSkeletonType = 1; // Thread-safe skeleton type switching
 static bool gSkeletonTypeChanged = false; // Flag to indicate model recreation needed
 static bool gUseObjLoader = false; // Flag to switch between OBJ and box-based skeletons
-static float gCharacterRotationY = 0.0f;
-static float gCameraRotationY = 0.0f;
-static bool gTouchActive = false;
-static float gLastTouchX = 0.0f;
-static float gLastTouchY = 0.0f;
+static float gBodyShape = 0.0f; // -1 slim, 0 the base build, 1 athletic
+static bool gBodyShapeChanged = false;
+static bool gAnimating = true; // Whether the characters play their clips and turn
+
+/*!
+ * Input and settings from the UI thread. Everything above is owned by the render thread, which
+ * applies the commands at the top of each frame.
+ */
+struct RenderCommand {
+    enum Type : uint8_t {
+        SET_SKELETON_TYPE,
+        SET_USE_OBJ_LOADER,
+        SET_BODY_SHAPE,
+        SET_ANIMATING
+    };
+
+    RenderCommand() = default;
+
+    /*!
+     * A command of @a type with its value zeroed, for the caller to fill in
+     */
+    explicit RenderCommand(Type type) : type(type), skeletonType(0) {}
+
+    Type type;
+    union {
+        int skeletonType;
+        bool useObjLoader;
+        float bodyShape;
+        bool animating;
+    };
+};
+
+// Room for Compose re-sending every setting on each change for several frames
+static SpscQueue<RenderCommand, 256> gCommands;
+
+// Touch samples are batched by the view into two direct buffers, one filled on the UI thread while
+// the render thread reads the other, and handed over once per frame with nativeOnDrawFrame
+static TouchSample *gTouchBuffers[2] = {nullptr, nullptr};
+static size_t gTouchBufferCapacity = 0;
+static constexpr float kRadiansPerPixel = 0.005f;
+
+// Asks the view for frames on vsync while the scene is moving. The view renders on demand, so a
+// still scene draws nothing until the next input or setting.
+static FramePacer gFramePacer;
+
+// Every skinned model is an animated character, posed by the simulation thread with the job
+// system's help. gModelCharacters holds the character of each model in gModels.
+static constexpr size_t kNoCharacter = SIZE_MAX;
+static AnimationSystem gAnimation(JobSystem::shared());
+static std::vector<size_t> gModelCharacters;
+
+// Body shape morph targets of the persona model, the first in gModels. Empty for skeleton types
+// that can't be reshaped.
+static MorphTargetSet gBodyShapes;
+
+// CPU skinning, used when the skinned shader isn't available. The skinned vertices are written
+// straight into a dynamic vertex buffer.
+static constexpr bool kForceCpuSkinning = false;  // Set to check the CPU path on any device
+static SkinPalette gSkinPalette;
+static GLuint gCpuSkinnedBuffer = 0;
+static size_t gCpuSkinnedBufferVertices = 0;
 
 // 3D rendering constants
 static constexpr float kCameraDistance = 20.0f;     // Closer for MakeHuman models
 static constexpr float kCameraHeight = 0.0f;
 static constexpr float kFieldOfView = 60.0f * M_PI / 180.0f;  // Wider field of view
+static constexpr float kFocalLength = Camera::focalLength(kFieldOfView);
 static constexpr float kNearPlane = 0.1f;
 static constexpr float kFarPlane = 100.0f;
 static constexpr float kCharacterScale = 0.5f;     // Scale down MakeHuman models
+static constexpr float kCharacterTurnSpeed = 0.6f;   // Radians per second
+static constexpr float kMaxFrameTime = 0.1f;         // Longer frames don't fast forward the clips
+
+/*!
+ * Everything that moves in a frame, worked out by the simulation thread for the render thread to
+ * draw. The simulation fills one of these for frame N + 1 while the render thread submits frame N.
+ */
+struct FrameState {
+    // Where a character's skin matrices are in skinMatrices
+    struct Palette {
+        size_t offset;
+        size_t jointCount;
+    };
+    
+    uint64_t step = 0;                  // 0 until the simulation has run
+    uint32_t generation = 0;            // The set of models the palettes were posed for
+    float mvpMatrix[16] = {0};
+    std::vector<float> skinMatrices;    // Every character's palette back to back
+    std::vector<Palette> palettes;      // One per character in gAnimation
+    float simulationMs = 0.0f;
+};
+
+/*!
+ * What the render thread hands the simulation for its next step
+ */
+struct SimulationInput {
+    float frameTime = 0.0f;             // Added up over frames the simulation didn't keep up with
+    int64_t displayTimeNanos = 0;       // When the state being simulated should reach the display
+    float aspectRatio = 1.0f;
+    bool animating = true;
+    uint32_t generation = 0;
+    std::vector<TouchSample> touches;
+};
+
+// The render thread adds to the pending input each frame and the simulation takes it at the start
+// of a step. The states go back through a mailbox, so neither thread waits for the other.
+static std::mutex gSimulationInputMutex;
+static SimulationInput gSimulationInput;
+static TripleBuffer<FrameState> gFrameStates;
+static uint32_t gModelGeneration = 0; // Bumped by createModels
+
+// Owned by the simulation thread, and by the render thread only while the simulation is idle
+static SimulationInput gStepInput;
+static TouchInput gTouchInput;
+static float gCameraRotationY = 0.0f;
+static float gCharacterRotationY = 0.0f;
+static bool gWasAnimating = false;
+static uint64_t gStepCount = 0;
+
+// Orbits the character as the user drags. Its matrices only change on a resize or a drag.
+static Camera gCamera(kFocalLength, kNearPlane, kFarPlane, kCameraDistance, kCameraHeight);
+
+// What recent frames cost, polled by the stats overlay
+static GlQueryBackend gGpuQueries;
+static GpuTimer gGpuTimer(gGpuQueries);
+static FrameStats gFrameStats;
+
+static float millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
 
 // Simple test triangle for debugging
 void createTestTriangle(std::vector<Vertex>& vertices, std::vector<Index>& indices) {
@@ -69,6 +208,31 @@ void main() {
 }
 )vertex";
 
+// Skinned vertex shader, blends up to 4 joint matrices from the palette per vertex
+static const char *skinnedVertex = R"vertex(#version 300 es
+in vec3 inPosition;
+in vec2 inUV;
+in uvec4 inJoints;
+in vec4 inWeights;
+
+out vec2 fragUV;
+
+uniform mat4 uMVP;
+
+layout(std140) uniform JointMatrices {
+    mat4 uJoints[64];
+};
+
+void main() {
+    mat4 skin = uJoints[inJoints.x] * inWeights.x
+              + uJoints[inJoints.y] * inWeights.y
+              + uJoints[inJoints.z] * inWeights.z
+              + uJoints[inJoints.w] * inWeights.w;
+    fragUV = inUV;
+    gl_Position = uMVP * skin * vec4(inPosition, 1.0);
+}
+)vertex";
+
 // Fragment shader (same as original)
 static const char *fragment = R"fragment(#version 300 es
 precision mediump float;
@@ -84,13 +248,282 @@ void main() {
 }
 )fragment";
 
+/*!
+ * Skins a model into gCpuSkinnedBuffer
+ * @return true if the buffer holds the skinned vertices
+ */
+static bool skinOnCpu(const Model &model, const float *skinMatrices, size_t jointCount) {
+    gSkinPalette.setMatrices(skinMatrices, jointCount);
+    
+    size_t bufferSize = model.getVertexCount() * sizeof(Vertex);
+    if (!gCpuSkinnedBuffer) {
+        glGenBuffers(1, &gCpuSkinnedBuffer);
+        gCpuSkinnedBufferVertices = 0;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, gCpuSkinnedBuffer);
+    if (gCpuSkinnedBufferVertices != model.getVertexCount()) {
+        glBufferData(GL_ARRAY_BUFFER, bufferSize, nullptr, GL_DYNAMIC_DRAW);
+        gCpuSkinnedBufferVertices = model.getVertexCount();
+    }
+    
+    // Invalidating lets the driver hand out fresh memory instead of waiting on last frame's draw
+    auto *pSkinned = static_cast<Vertex *>(glMapBufferRange(
+            GL_ARRAY_BUFFER, 0, bufferSize, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    bool skinned = false;
+    if (pSkinned) {
+        CpuSkinning::skinParallel(model.getVertexData(), pSkinned, model.getVertexCount(),
+                                  gSkinPalette, JobSystem::shared());
+        skinned = glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE;
+    } else {
+        LOG_ERROR("ERROR: Failed to map the CPU skinning buffer");
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return skinned;
+}
+
+/*!
+ * Morphs the persona model to gBodyShape. Only the vertices of targets whose weight changed move.
+ */
+static void applyBodyShape(Model &model) {
+    if (gBodyShapes.getTargetCount() != SkeletonAsset::BODY_SHAPE_COUNT) {
+        return;
+    }
+    Vertex *vertices = model.getMutableVertexData();
+    gBodyShapes.setWeight(SkeletonAsset::ATHLETIC_SHAPE, std::max(0.0f, gBodyShape), vertices);
+    gBodyShapes.setWeight(SkeletonAsset::SLIM_SHAPE, std::max(0.0f, -gBodyShape), vertices);
+    model.updateBoundingRadius();
+}
+
+/*!
+ * Queues a command for the render thread. UI thread only.
+ */
+static void sendCommand(const RenderCommand &command) {
+    if (!gCommands.push(command)) {
+        LOG_WARN("WARNING: Render command queue full, dropped command %d", int(command.type));
+        return;
+    }
+    gFramePacer.requestFrame();
+}
+
+/*!
+ * Applies every command the UI thread sent since the last frame. Settings only flag the work
+ * they need, so a burst of them recreates or reshapes the models once.
+ */
+static void applyCommands() {
+    RenderCommand command;
+    while (gCommands.pop(command)) {
+        switch (command.type) {
+            case RenderCommand::SET_SKELETON_TYPE:
+                if (command.skeletonType != gCurrentSkeletonType) {
+                    LOG_INFO("GLSurfaceView: Changing skeleton type to %d", command.skeletonType);
+                    gCurrentSkeletonType = command.skeletonType;
+                    gSkeletonTypeChanged = true;
+                }
+                break;
+            
+            case RenderCommand::SET_USE_OBJ_LOADER:
+                if (command.useObjLoader != gUseObjLoader) {
+                    LOG_INFO("GLSurfaceView: Setting OBJ loader usage to %s", command.useObjLoader ? "true" : "false");
+                    gUseObjLoader = command.useObjLoader;
+                    gSkeletonTypeChanged = true;
+                }
+                break;
+            
+            case RenderCommand::SET_BODY_SHAPE:
+                if (command.bodyShape != gBodyShape) {
+                    gBodyShape = command.bodyShape;
+                    gBodyShapeChanged = true;
+                }
+                break;
+            
+            case RenderCommand::SET_ANIMATING:
+                gAnimating = command.animating;
+                break;
+        }
+    }
+}
+
+/*!
+ * Passes a frame's batch of touch samples on to the simulation. They're copied since the view
+ * refills the buffer after the next frame.
+ * @param buffer which of the two touch buffers the view filled
+ * @param count the number of samples in it
+ */
+static void queueTouches(int buffer, int count) {
+    if (buffer < 0 || buffer > 1 || !gTouchBuffers[buffer] || count <= 0) {
+        return;
+    }
+    size_t sampleCount = std::min(size_t(count), gTouchBufferCapacity);
+    
+    std::lock_guard<std::mutex> lock(gSimulationInputMutex);
+    gSimulationInput.touches.insert(gSimulationInput.touches.end(), gTouchBuffers[buffer],
+                                    gTouchBuffers[buffer] + sampleCount);
+}
+
+/*!
+ * One step of the simulation: applies the input, moves the camera and the characters, and
+ * publishes the result as a FrameState. Runs on the simulation thread.
+ */
+static void simulate() {
+    PROFILE_ZONE("simulate");
+    auto start = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(gSimulationInputMutex);
+        gStepInput.frameTime = gSimulationInput.frameTime;
+        gStepInput.displayTimeNanos = gSimulationInput.displayTimeNanos;
+        gStepInput.aspectRatio = gSimulationInput.aspectRatio;
+        gStepInput.animating = gSimulationInput.animating;
+        gStepInput.generation = gSimulationInput.generation;
+        gStepInput.touches.swap(gSimulationInput.touches);
+        gSimulationInput.frameTime = 0.0f;
+        gSimulationInput.touches.clear();
+    }
+    const SimulationInput &input = gStepInput;
+    
+    // Update camera rotation based on horizontal movement
+    gCameraRotationY += gTouchInput.consume(input.touches.data(), input.touches.size())
+                        * kRadiansPerPixel;
+    
+    // Clamp rotation to prevent overflow
+    if (gCameraRotationY > 2.0f * M_PI) {
+        gCameraRotationY -= 2.0f * M_PI;
+    } else if (gCameraRotationY < -2.0f * M_PI) {
+        gCameraRotationY += 2.0f * M_PI;
+    }
+    
+    // Aim the camera where the drag will be once this state is on screen. The camera only
+    // rebuilds its matrices when they changed.
+    bool cameraMoved = gCamera.setAspectRatio(input.aspectRatio);
+    cameraMoved |= gCamera.setYaw(
+            gCameraRotationY + gTouchInput.predictDeltaX(input.displayTimeNanos) * kRadiansPerPixel);
+    
+    // A resumed animation picks up where it stopped rather than jumping ahead by the pause
+    float frameTime = gWasAnimating ? std::min(input.frameTime, kMaxFrameTime) : 0.0f;
+    gWasAnimating = input.animating;
+    if (input.animating) {
+        // Enable rotation for skeleton model
+        gCharacterRotationY += kCharacterTurnSpeed * frameTime;
+        if (gCharacterRotationY > 2.0f * M_PI) {
+            gCharacterRotationY -= 2.0f * M_PI;
+        }
+        gAnimation.update(frameTime);
+    }
+    
+    FrameState &state = gFrameStates.getWriteBuffer();
+    state.step = ++gStepCount;
+    state.generation = input.generation;
+    
+    // Build model matrix (with scaling and rotation for skeleton), then combine matrices:
+    // MVP = Projection * View * Model, the first product cached by the camera
+    float modelMatrix[16] = {0};
+    Utility::buildModelMatrix(modelMatrix, gCharacterRotationY, 0.0f, 0.0f, 0.0f, kCharacterScale);
+    Utility::multiplyMatrices(state.mvpMatrix, gCamera.getViewProjection().data(), modelMatrix);
+    
+    // Copy out the poses, the characters move on in the next step while this state is drawn
+    state.skinMatrices.clear();
+    state.palettes.clear();
+    for (size_t i = 0; i < gAnimation.getCharacterCount(); i++) {
+        const AnimatedCharacter &character = gAnimation.getCharacter(i);
+        size_t jointCount = character.getSkeleton().getJointCount();
+        state.palettes.push_back({state.skinMatrices.size(), jointCount});
+        state.skinMatrices.insert(state.skinMatrices.end(), character.getSkinMatrices(),
+                                  character.getSkinMatrices() + jointCount * 16);
+    }
+    
+    state.simulationMs = millisecondsSince(start);
+    gFrameStates.publish();
+    
+    // A state that moved anything needs a frame to show it
+    if (cameraMoved || input.animating) {
+        gFramePacer.requestFrame();
+    }
+}
+
+// Declared after everything simulate touches, so it's stopped before any of it is destroyed
+static SimulationThread gSimulation(simulate);
+
+// The materials a box character is dressed in, packed into one atlas so it draws with a single
+// texture binding
+enum Material {
+    MATERIAL_SKIN,
+    MATERIAL_EYES,
+    MATERIAL_HAIR,
+    MATERIAL_SUIT,
+    MATERIAL_COUNT
+};
+static const char *const kMaterialAssets[MATERIAL_COUNT] = {
+        "textures/skin.png",
+        "textures/eyes.png",
+        "textures/hair.png",
+        "textures/suit.png"
+};
+static TextureAtlas::Region gMaterialRegions[MATERIAL_COUNT]; // Set when the atlas is packed
+
+/*!
+ * Packs the materials into an atlas, recording where each one went in gMaterialRegions
+ */
+static std::shared_ptr<TextureAsset> createMaterialAtlas() {
+    TextureAtlas atlas;
+    int images[MATERIAL_COUNT];
+    for (int material = 0; material < MATERIAL_COUNT; material++) {
+        images[material] = atlas.addAsset(gAssetManager, kMaterialAssets[material]);
+        if (images[material] < 0) {
+            return nullptr;
+        }
+    }
+    if (!atlas.pack()) {
+        aout << "ERROR: The character materials don't fit in one atlas" << std::endl;
+        return nullptr;
+    }
+    for (int material = 0; material < MATERIAL_COUNT; material++) {
+        gMaterialRegions[material] = atlas.getRegion(images[material]);
+    }
+    return atlas.createTexture(true);
+}
+
+/*!
+ * Maps each face of a box character onto its material's region of the atlas. The face looking
+ * forward on the head gets the eyes, its top and back the hair, the neck and hands are bare skin
+ * and everything else is the suit.
+ */
+static void applyMaterials(std::vector<Vertex> &vertices) {
+    for (size_t box = 0; box + SkeletonAsset::kBoxVertexCount <= vertices.size();
+         box += SkeletonAsset::kBoxVertexCount) {
+        int joint = vertices[box].joints[0];
+        for (int face = 0; face < SkeletonAsset::BOX_FACE_COUNT; face++) {
+            Material material = MATERIAL_SUIT;
+            if (joint == SkeletonAsset::HEAD) {
+                material = face == SkeletonAsset::BOX_FRONT ? MATERIAL_EYES
+                         : face == SkeletonAsset::BOX_TOP || face == SkeletonAsset::BOX_BACK
+                           ? MATERIAL_HAIR
+                         : MATERIAL_SKIN;
+            } else if (joint == SkeletonAsset::NECK || joint == SkeletonAsset::LEFT_HAND
+                       || joint == SkeletonAsset::RIGHT_HAND) {
+                material = MATERIAL_SKIN;
+            }
+            TextureAtlas::remapUVs(&vertices[box + face * SkeletonAsset::kBoxFaceVertexCount],
+                                   SkeletonAsset::kBoxFaceVertexCount,
+                                   gMaterialRegions[material]);
+        }
+    }
+}
+
 void createModels() {
+    PROFILE_ZONE("createModels");
+    // The simulation poses the characters, so it has to be out of the way while they're replaced
+    gSimulation.waitIdle();
+    gModelGeneration++;
+    
     gModels.clear();
+    gAnimation.clear();
+    gModelCharacters.clear();
+    gBodyShapes = MorphTargetSet();
     
     try {
         // Create vertex and index arrays
         std::vector<Vertex> vertices;
         std::vector<Index> indices;
+        std::shared_ptr<Skeleton> spSkeleton;
         
         if (gUseObjLoader && gAssetManager) {
             // Try to load OBJ file first, fall back to box-based if it fails
@@ -107,13 +540,15 @@ void createModels() {
             if (!objLoaded) {
                 // Fall back to box-based skeleton
                 SkeletonAsset::SkeletonType skeletonType = static_cast<SkeletonAsset::SkeletonType>(gCurrentSkeletonType);
-                SkeletonAsset::createSkeleton(skeletonType, vertices, indices);
+                spSkeleton = std::make_shared<Skeleton>();
+                SkeletonAsset::createSkeleton(skeletonType, vertices, indices, *spSkeleton);
                 aout << "DEBUG: Created fallback skeleton with " << vertices.size() << " vertices, " << indices.size() << " indices" << std::endl;
             }
         } else {
             // Use the box-based skeleton model 
             SkeletonAsset::SkeletonType skeletonType = static_cast<SkeletonAsset::SkeletonType>(gCurrentSkeletonType);
-            SkeletonAsset::createSkeleton(skeletonType, vertices, indices);
+            spSkeleton = std::make_shared<Skeleton>();
+            SkeletonAsset::createSkeleton(skeletonType, vertices, indices, *spSkeleton);
             aout << "DEBUG: Created box-based skeleton with " << vertices.size() << " vertices, " << indices.size() << " indices" << std::endl;
         }
         
@@ -130,16 +565,57 @@ void createModels() {
         }
     }
     
-    // Create texture asset using a simple colored texture
-    auto spTexture = TextureAsset::createSimpleTexture();
+    // The MakeHuman model is UV mapped for a skin texture, the best compressed variant the device
+    // can sample. Box characters wear the material atlas. Both stream their finer mips in as the
+    // character grows on screen. Anything that won't load falls back to a simple colored texture.
+    // The cache hands back the same texture on every skeleton switch so only the first call does
+    // any GL work.
+    std::shared_ptr<TextureAsset> spTexture;
+    if (!spSkeleton) {
+        spTexture = gTextureCache.getOrCreate("textures/skin", []() {
+            return TextureAsset::loadCompressedAsset(gAssetManager, "textures/skin", true);
+        });
+    } else {
+        spTexture = gTextureCache.getOrCreate("atlas:materials", createMaterialAtlas);
+        if (spTexture) {
+            applyMaterials(vertices);
+        }
+    }
+    if (!spTexture) {
+        spTexture = gTextureCache.getOrCreate("builtin:checkerboard",
+                                              TextureAsset::createSimpleTexture);
+    }
     
     if (!spTexture) {
         aout << "ERROR: Failed to create texture!" << std::endl;
         return;
     }
     
+        // Start the skinned model off in its rest pose
+        if (spSkeleton) {
+            SkeletonAsset::createBodyShapes(
+                    static_cast<SkeletonAsset::SkeletonType>(gCurrentSkeletonType), vertices,
+                    gBodyShapes);
+
+            if (spSkeleton->getJointCount() > Shader::kMaxJoints) {
+                aout << "WARNING: Skeleton has " << spSkeleton->getJointCount()
+                     << " joints, only " << Shader::kMaxJoints << " will be skinned" << std::endl;
+            }
+            auto spIdle = SkeletonAsset::createClip(SkeletonAsset::ClipType::IDLE, *spSkeleton);
+            auto spWalk = SkeletonAsset::createClip(SkeletonAsset::ClipType::WALK, *spSkeleton);
+            if (!spIdle || !spWalk) {
+                aout << "WARNING: Failed to create animation clips, holding the rest pose" << std::endl;
+            }
+            gModelCharacters.push_back(gAnimation.addCharacter(std::make_unique<AnimatedCharacter>(
+                    spSkeleton, std::move(spIdle), std::move(spWalk))));
+        } else {
+            gModelCharacters.push_back(kNoCharacter);
+        }
+    
             // Create model
-        gModels.emplace_back(std::move(vertices), std::move(indices), std::move(spTexture));
+        gModels.emplace_back(std::move(vertices), std::move(indices), std::move(spTexture),
+                             std::move(spSkeleton));
+        applyBodyShape(gModels.back());
         aout << "DEBUG: Model created successfully" << std::endl;
         
     } catch (const std::exception& e) {
@@ -159,6 +635,20 @@ Java_org_lightscout_holopersona_HoloPersonaGLSurfaceView_00024HoloPersonaRendere
     
     aout << "GLSurfaceView: Surface created" << std::endl;
     
+    // A new surface means a new GL context, so every texture we knew about is gone. The old
+    // objects are let go before anything is created, since the new context reuses their names
+    // and deleting them now is a no-op rather than deleting something new.
+    gSimulation.waitIdle();
+    gShader.reset();
+    gSkinnedShader.reset();
+    gModels.clear();
+    gAnimation.clear();
+    gModelCharacters.clear();
+    gTextureCache.clear();
+    gCpuSkinnedBuffer = 0;
+    gGpuTimer.init();
+    gFrameStats.clear();
+    
     // Initialize OpenGL state
     glEnable(GL_DEPTH_TEST);
     glDepthFunc(GL_LEQUAL);
@@ -183,16 +673,29 @@ Java_org_lightscout_holopersona_HoloPersonaGLSurfaceView_00024HoloPersonaRendere
     }
     aout << "GLSurfaceView: Shader created successfully" << std::endl;
     
+    // Skinned models fall back to the static shader in their rest pose if this fails
+    gSkinnedShader = std::unique_ptr<Shader>(Shader::loadSkinnedShader(
+            skinnedVertex, fragment, "inPosition", "inUV", "inJoints", "inWeights", "uMVP",
+            "JointMatrices"));
+    if (!gSkinnedShader) {
+        aout << "ERROR: Failed to create skinned shader!" << std::endl;
+    }
+    
     // Set the texture sampler uniform to use texture unit 0
-    gShader->activate();
-    GLint textureUniform = glGetUniformLocation(gShader->getProgram(), "uTexture");
-    if (textureUniform != -1) {
-        glUniform1i(textureUniform, 0);  // Use texture unit 0
-        aout << "DEBUG: Set texture uniform to texture unit 0" << std::endl;
-    } else {
-        aout << "ERROR: Could not find uTexture uniform!" << std::endl;
+    for (const Shader *shader : {gShader.get(), gSkinnedShader.get()}) {
+        if (!shader) {
+            continue;
+        }
+        shader->activate();
+        GLint textureUniform = glGetUniformLocation(shader->getProgram(), "uTexture");
+        if (textureUniform != -1) {
+            glUniform1i(textureUniform, 0);  // Use texture unit 0
+            aout << "DEBUG: Set texture uniform to texture unit 0" << std::endl;
+        } else {
+            aout << "ERROR: Could not find uTexture uniform!" << std::endl;
+        }
+        shader->deactivate();
     }
-    gShader->deactivate();
     
     // Create initial models
     createModels();
@@ -207,6 +710,7 @@ Java_org_lightscout_holopersona_HoloPersonaGLSurfaceView_00024HoloPersonaRendere
     
     aout << "GLSurfaceView: Surface changed to " << width << "x" << height << std::endl;
     
+    // The simulation picks up the new aspect ratio with the next frame
     gWidth = width;
     gHeight = height;
     
@@ -215,182 +719,255 @@ Java_org_lightscout_holopersona_HoloPersonaGLSurfaceView_00024HoloPersonaRendere
 
 JNIEXPORT void JNICALL
 Java_org_lightscout_holopersona_HoloPersonaGLSurfaceView_00024HoloPersonaRenderer_nativeOnDrawFrame(
-        JNIEnv *env, jobject thiz) {
+        JNIEnv *env, jobject thiz, jint touchBuffer, jint touchCount) {
+    PROFILE_ZONE("nativeOnDrawFrame");
     
-    // Check if skeleton type needs to be changed (thread-safe)
+    auto frameStart = std::chrono::steady_clock::now();
+    FrameSample sample = {};
+    
+    // Catch up with the UI thread, then recreate the models if a setting calls for it
+    applyCommands();
     if (gSkeletonTypeChanged) {
-        gCurrentSkeletonType = gRequestedSkeletonType;
         gSkeletonTypeChanged = false;
         if (gShader) {
-            aout << "DEBUG: Recreating models for skeleton type " << gCurrentSkeletonType << std::endl;
+            LOG_DEBUG("DEBUG: Recreating models for skeleton type %d", gCurrentSkeletonType);
             createModels();
         }
     }
     
     if (!gShader || gModels.empty() || gWidth == 0 || gHeight == 0) {
-        // Debug output to see why rendering is skipped
+        // Debug output to see why rendering is skipped, which can go on for a while
+        if (!LOG_EVERY(ANDROID_LOG_DEBUG, 2000)) {
+            return;
+        }
         if (!gShader) {
-            aout << "DEBUG: Skipping render - no shader" << std::endl;
+            LOG_DEBUG("DEBUG: Skipping render - no shader");
         }
         if (gModels.empty()) {
-            aout << "DEBUG: Skipping render - no models" << std::endl;
+            LOG_DEBUG("DEBUG: Skipping render - no models");
         }
         if (gWidth == 0 || gHeight == 0) {
-            aout << "DEBUG: Skipping render - invalid size: " << gWidth << "x" << gHeight << std::endl;
+            LOG_DEBUG("DEBUG: Skipping render - invalid size: %dx%d", gWidth, gHeight);
         }
         return;
     }
     
-    // Debug output (only print occasionally to avoid spam)
-    static int frameCount = 0;
-    if (frameCount % 120 == 0) {  // Print every 2 seconds at 60fps
-        aout << "DEBUG: Rendering frame " << frameCount << ", models: " << gModels.size() << std::endl;
-        aout << "DEBUG: Camera distance: " << kCameraDistance << ", Character scale: " << kCharacterScale << std::endl;
+    if (gBodyShapeChanged) {
+        gBodyShapeChanged = false;
+        applyBodyShape(gModels.front());
     }
-    frameCount++;
     
-    // Enable rotation for skeleton model
-    gCharacterRotationY += 0.01f;
-    if (gCharacterRotationY > 2.0f * M_PI) {
-        gCharacterRotationY -= 2.0f * M_PI;
+    // Debug output for one frame every couple of seconds. Compiled out with the debug logs, along
+    // with the GL queries made for it.
+    static uint64_t frameCount = 0;
+    const bool logFrame = LOG_EVERY(ANDROID_LOG_DEBUG, 2000);
+    if (logFrame) {
+        LOG_DEBUG("DEBUG: Rendering frame %llu, models: %zu", (unsigned long long) frameCount,
+                  gModels.size());
+        LOG_DEBUG("DEBUG: Camera distance: %g, Character scale: %g", kCameraDistance, kCharacterScale);
     }
+    frameCount++;
     
-    // Build perspective projection matrix
-    float projectionMatrix[16] = {0};
-    Utility::buildPerspectiveMatrix(
-            projectionMatrix,
-            kFieldOfView,
-            float(gWidth) / float(gHeight),
-            kNearPlane,
-            kFarPlane);
-    
-    // Build view matrix (camera looking at triangle)
-    float viewMatrix[16] = {0};
-    
-    // Simple fixed camera position for testing
-    float cameraX = 0.0f;                      // Centered
-    float cameraY = 0.0f;                      // At same height
-    float cameraZ = kCameraDistance;           // In front of triangle
-    
-    // Debug camera position occasionally
-    if (frameCount % 120 == 0) {
-        aout << "DEBUG: Camera position: (" << cameraX << ", " << cameraY << ", " << cameraZ << ")" << std::endl;
+    // Advance by the time between vsyncs so the animation runs at the same speed at any frame
+    // rate, however late in the vsync the render thread got to the frame. What's simulated now is
+    // drawn next frame, so it's aimed a vsync further on.
+    FrameTiming timing = gFramePacer.beginFrame();
+    queueTouches(touchBuffer, touchCount);
+    {
+        std::lock_guard<std::mutex> lock(gSimulationInputMutex);
+        gSimulationInput.frameTime += timing.frameTime;
+        gSimulationInput.displayTimeNanos =
+                timing.displayTimeNanos + gFramePacer.getVsyncPeriodNanos();
+        gSimulationInput.aspectRatio = float(gWidth) / float(gHeight);
+        gSimulationInput.animating = gAnimating;
+        gSimulationInput.generation = gModelGeneration;
     }
+    sample.inputMs = millisecondsSince(frameStart);
     
-    Utility::buildViewMatrix(
-            viewMatrix,
-            cameraX, cameraY, cameraZ,          // Camera position
-            0.0f, 0.0f, 0.0f,                   // Look at origin (triangle position)
-            0.0f, 1.0f, 0.0f);                  // Up vector
-    
-    // Build model matrix (with scaling and rotation for skeleton)
-    float modelMatrix[16] = {0};
-    Utility::buildModelMatrix(modelMatrix, gCharacterRotationY, 0.0f, 0.0f, 0.0f, kCharacterScale);
+    // Draw the newest state the simulation has finished and let it work on the next one
+    // meanwhile. Only the first frame for a new set of models has to wait for its state.
+    gFrameStates.acquire();
+    if (gFrameStates.getReadBuffer().step == 0
+        || gFrameStates.getReadBuffer().generation != gModelGeneration) {
+        PROFILE_ZONE("waitForSimulation");
+        auto waitStart = std::chrono::steady_clock::now();
+        gSimulation.kick();
+        gSimulation.waitIdle();
+        gFrameStates.acquire();
+        sample.waitMs = millisecondsSince(waitStart);
+        // Start on the next state now, as a frame that didn't wait would, rather than leave the
+        // simulation idle until the frame after this one
+        gSimulation.kick();
+    } else {
+        gSimulation.kick();
+    }
+    const FrameState &state = gFrameStates.getReadBuffer();
+    const float *mvpMatrix = state.mvpMatrix;
+    sample.simulationMs = state.simulationMs;
+    auto renderStart = std::chrono::steady_clock::now();
     
-    // Combine matrices: MVP = Projection * View * Model
-    float viewProjectionMatrix[16] = {0};
-    float mvpMatrix[16] = {0};
+    // Debug frame timing occasionally
+    if (logFrame) {
+        LOG_DEBUG("DEBUG: Missed frames: %u, stages (ms): input %g, wait %g, simulation %g",
+                  gFramePacer.getMissedFrames(), sample.inputMs, sample.waitMs,
+                  sample.simulationMs);
+    }
     
-    Utility::multiplyMatrices(viewProjectionMatrix, projectionMatrix, viewMatrix);
-    Utility::multiplyMatrices(mvpMatrix, viewProjectionMatrix, modelMatrix);
+    // Collect the GPU times of earlier frames that have finished, then time this one's clear and
+    // each of its draws
+    float gpuMs = gGpuTimer.beginFrame();
+    if (gpuMs >= 0.0f) {
+        gFrameStats.addGpuTime(gpuMs);
+    }
+    const Shader *lastShader = nullptr;
+    GLuint lastTexture = 0;
     
     // Clear the color and depth buffers
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    {
+        GpuScope scope(gGpuTimer);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
     
     // Check for OpenGL errors before rendering
     GLenum error = glGetError();
     if (error != GL_NO_ERROR) {
-        aout << "OpenGL error before rendering: " << error << std::endl;
-    }
-    
-    // Activate the shader program
-    gShader->activate();
-    
-    // Check if shader program is active
-    GLint currentProgram;
-    glGetIntegerv(GL_CURRENT_PROGRAM, &currentProgram);
-    if (frameCount % 120 == 0) {
-        aout << "DEBUG: Current shader program: " << currentProgram << std::endl;
+        LOG_ERROR("OpenGL error before rendering: %u", error);
     }
     
-    // Set the combined MVP matrix
-    gShader->setMVPMatrix(mvpMatrix);
-    
     // Debug: Print matrix values occasionally
-    if (frameCount % 120 == 0) {
-        aout << "DEBUG: MVP Matrix:" << std::endl;
+    if (logFrame) {
+        LOG_DEBUG("DEBUG: MVP Matrix:");
         for (int i = 0; i < 4; i++) {
-            aout << "  [" << mvpMatrix[i*4] << ", " << mvpMatrix[i*4+1] << ", " << mvpMatrix[i*4+2] << ", " << mvpMatrix[i*4+3] << "]" << std::endl;
+            LOG_DEBUG("  [%g, %g, %g, %g]", mvpMatrix[i*4], mvpMatrix[i*4+1], mvpMatrix[i*4+2], mvpMatrix[i*4+3]);
         }
     }
     
     // Render all the models
-    for (const auto &model : gModels) {
-        if (frameCount % 120 == 0) {
-            aout << "DEBUG: Drawing model with " << model.getIndexCount() << " indices" << std::endl;
+    for (size_t i = 0; i < gModels.size(); i++) {
+        const Model &model = gModels[i];
+        if (logFrame) {
+            LOG_DEBUG("DEBUG: Drawing model with %zu indices", model.getIndexCount());
+        }
+        
+        // Skinned models are posed on the GPU, so all a new pose costs is the palette upload.
+        // Without the skinned shader they're skinned on the CPU and drawn with the static one.
+        const FrameState::Palette *palette = i < gModelCharacters.size()
+                                             && gModelCharacters[i] < state.palettes.size()
+                                             ? &state.palettes[gModelCharacters[i]]
+                                             : nullptr;
+        const float *skinMatrices = palette ? state.skinMatrices.data() + palette->offset : nullptr;
+        bool gpuSkinned = palette && gSkinnedShader && !kForceCpuSkinning;
+        bool cpuSkinned = palette && !gpuSkinned
+                          && skinOnCpu(model, skinMatrices, palette->jointCount);
+        
+        const Shader &shader = gpuSkinned ? *gSkinnedShader : *gShader;
+        shader.activate();
+        shader.setMVPMatrix(mvpMatrix);
+        if (gpuSkinned) {
+            shader.setJointMatrices(skinMatrices, palette->jointCount);
+        }
+        
+        // Check if shader program is active
+        if (logFrame) {
+            GLint currentProgram;
+            glGetIntegerv(GL_CURRENT_PROGRAM, &currentProgram);
+            LOG_DEBUG("DEBUG: Current shader program: %d", currentProgram);
         }
-        gShader->drawModel(model);
+        
+        {
+            GpuScope scope(gGpuTimer);
+            if (cpuSkinned) {
+                shader.drawModel(model, gCpuSkinnedBuffer);
+            } else {
+                shader.drawModel(model);
+            }
+        }
+        
+        GLuint texture = model.getTexture().getTextureID();
+        sample.draws++;
+        sample.triangles += uint32_t(model.getIndexCount() / 3);
+        sample.stateChanges += (&shader != lastShader) + (texture != lastTexture) + gpuSkinned;
+        lastShader = &shader;
+        lastTexture = texture;
+        
+        // Let a streaming texture know how large the model is on screen so it can bring in the
+        // mip levels it needs. The projected height is the bounding diameter scaled by the
+        // projection's focal length over the camera distance, in pixels.
+        float screenSize = model.getBoundingRadius() * kCharacterScale * kFocalLength
+                           / kCameraDistance * float(gHeight);
+        model.getSharedTexture()->requestScreenSize(screenSize);
         
         // Check for OpenGL errors after drawing
         error = glGetError();
         if (error != GL_NO_ERROR) {
-            aout << "OpenGL error after drawing model: " << error << std::endl;
+            LOG_ERROR("OpenGL error after drawing model: %u", error);
         }
     }
     
     // Deactivate the shader program
-    gShader->deactivate();
+    glUseProgram(0);
+    gGpuTimer.endFrame();
+    
+    // Upload at most one newly requested mip level per frame
+    bool texturesChanged = gTextureCache.updateResidency();
+    
+    sample.renderMs = millisecondsSince(renderStart);
+    sample.cpuMs = millisecondsSince(frameStart);
+    gFrameStats.addFrame(sample);
+    
+    // Only ask for another frame while something is still changing. The simulation asks for one
+    // whenever a step moves the camera or the characters, which leaves the textures to check here.
+    if (texturesChanged) {
+        gFramePacer.requestFrame();
+    }
 }
 
-JNIEXPORT void JNICALL
-Java_org_lightscout_holopersona_HoloPersonaGLSurfaceView_00024HoloPersonaRenderer_nativeOnTouchDown(
-        JNIEnv *env, jobject thiz, jfloat x, jfloat y) {
+JNIEXPORT jboolean JNICALL
+Java_org_lightscout_holopersona_HoloPersonaGLSurfaceView_00024HoloPersonaRenderer_nativeStartFramePacing(
+        JNIEnv *env, jobject thiz, jobject view) {
     
-    gTouchActive = true;
-    gLastTouchX = x;
-    gLastTouchY = y;
+    if (!gFramePacer.start(env, view)) {
+        return JNI_FALSE;
+    }
+    // Get the first frame going
+    gFramePacer.requestFrame();
+    return JNI_TRUE;
 }
 
 JNIEXPORT void JNICALL
-Java_org_lightscout_holopersona_HoloPersonaGLSurfaceView_00024HoloPersonaRenderer_nativeOnTouchMove(
-        JNIEnv *env, jobject thiz, jfloat x, jfloat y) {
+Java_org_lightscout_holopersona_HoloPersonaGLSurfaceView_00024HoloPersonaRenderer_nativeStopFramePacing(
+        JNIEnv *env, jobject thiz) {
     
-    if (gTouchActive) {
-        // Calculate touch delta
-        float deltaX = x - gLastTouchX;
-        float deltaY = y - gLastTouchY;
-        
-        // Update camera rotation based on horizontal movement
-        gCameraRotationY += deltaX * 0.005f;
-        
-        // Clamp rotation to prevent overflow
-        if (gCameraRotationY > 2.0f * M_PI) {
-            gCameraRotationY -= 2.0f * M_PI;
-        } else if (gCameraRotationY < -2.0f * M_PI) {
-            gCameraRotationY += 2.0f * M_PI;
-        }
-        
-        gLastTouchX = x;
-        gLastTouchY = y;
-    }
+    gFramePacer.stop(env);
 }
 
 JNIEXPORT void JNICALL
-Java_org_lightscout_holopersona_HoloPersonaGLSurfaceView_00024HoloPersonaRenderer_nativeOnTouchUp(
-        JNIEnv *env, jobject thiz) {
+Java_org_lightscout_holopersona_HoloPersonaGLSurfaceView_00024HoloPersonaRenderer_nativeSetTouchBuffers(
+        JNIEnv *env, jobject thiz, jobject first, jobject second) {
     
-    gTouchActive = false;
+    // The view keeps both buffers for as long as it lives, so their addresses stay valid
+    gTouchBuffers[0] = static_cast<TouchSample *>(env->GetDirectBufferAddress(first));
+    gTouchBuffers[1] = static_cast<TouchSample *>(env->GetDirectBufferAddress(second));
+    jlong capacity = std::min(env->GetDirectBufferCapacity(first),
+                              env->GetDirectBufferCapacity(second));
+    if (!gTouchBuffers[0] || !gTouchBuffers[1] || capacity < jlong(sizeof(TouchSample))) {
+        aout << "ERROR: Touch buffers must be direct" << std::endl;
+        gTouchBuffers[0] = gTouchBuffers[1] = nullptr;
+        gTouchBufferCapacity = 0;
+        return;
+    }
+    gTouchBufferCapacity = size_t(capacity) / sizeof(TouchSample);
 }
 
 JNIEXPORT void JNICALL
 Java_org_lightscout_holopersona_HoloPersonaGLSurfaceView_00024HoloPersonaRenderer_nativeSetSkeletonType(
         JNIEnv *env, jobject thiz, jint skeletonType) {
     
-    aout << "GLSurfaceView: Requesting skeleton type change to " << skeletonType << std::endl;
-    
-    // Thread-safe skeleton type switching - defer model creation to render thread
-    gRequestedSkeletonType = skeletonType;
-    gSkeletonTypeChanged = true;
+    // Model creation is deferred to the render thread, which ignores repeats of the current
+    // type since Compose re-sends every setting whenever any of them changes
+    RenderCommand command{RenderCommand::SET_SKELETON_TYPE};
+    command.skeletonType = skeletonType;
+    sendCommand(command);
 }
 
 JNIEXPORT void JNICALL
@@ -406,15 +983,64 @@ Java_org_lightscout_holopersona_HoloPersonaGLSurfaceView_00024HoloPersonaRendere
     }
 }
 
+JNIEXPORT void JNICALL
+Java_org_lightscout_holopersona_HoloPersonaGLSurfaceView_00024HoloPersonaRenderer_nativeOnTrimMemory(
+        JNIEnv *env, jobject thiz, jint level) {
+    
+    // Queued onto the GL thread by the view, so it's safe to touch textures here
+    gTextureCache.onTrimMemory(level);
+}
+
 JNIEXPORT void JNICALL
 Java_org_lightscout_holopersona_HoloPersonaGLSurfaceView_00024HoloPersonaRenderer_nativeSetUseObjLoader(
         JNIEnv *env, jobject thiz, jboolean useObjLoader) {
     
-    aout << "GLSurfaceView: Setting OBJ loader usage to " << (useObjLoader ? "true" : "false") << std::endl;
+    RenderCommand command{RenderCommand::SET_USE_OBJ_LOADER};
+    command.useObjLoader = useObjLoader;
+    sendCommand(command);
+}
+
+JNIEXPORT void JNICALL
+Java_org_lightscout_holopersona_HoloPersonaGLSurfaceView_00024HoloPersonaRenderer_nativeSetBodyShape(
+        JNIEnv *env, jobject thiz, jfloat bodyShape) {
+    
+    // Applied on the render thread, which owns the vertices
+    RenderCommand command{RenderCommand::SET_BODY_SHAPE};
+    command.bodyShape = std::min(1.0f, std::max(-1.0f, float(bodyShape)));
+    sendCommand(command);
+}
+
+JNIEXPORT void JNICALL
+Java_org_lightscout_holopersona_HoloPersonaGLSurfaceView_00024HoloPersonaRenderer_nativeSetAnimating(
+        JNIEnv *env, jobject thiz, jboolean animating) {
+    
+    RenderCommand command{RenderCommand::SET_ANIMATING};
+    command.animating = animating;
+    sendCommand(command);
+}
+
+JNIEXPORT jboolean JNICALL
+Java_org_lightscout_holopersona_HoloPersonaGLSurfaceView_00024HoloPersonaRenderer_nativeWriteTrace(
+        JNIEnv *env, jobject thiz, jstring path) {
+    
+    // Called from a background thread, the profiler reads every thread's zones without stopping them
+    const char *pathChars = env->GetStringUTFChars(path, nullptr);
+    bool written = Profiler::writeChromeTrace(pathChars);
+    env->ReleaseStringUTFChars(path, pathChars);
+    return written ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL
+Java_org_lightscout_holopersona_HoloPersonaGLSurfaceView_00024HoloPersonaRenderer_nativeGetFrameStats(
+        JNIEnv *env, jobject thiz, jfloatArray stats) {
     
-    gUseObjLoader = useObjLoader;
-    // Trigger model recreation
-    gSkeletonTypeChanged = true;
+    // Polled from the UI thread, into an array it keeps so a poll allocates nothing
+    FrameStatsSnapshot snapshot = gFrameStats.getSnapshot();
+    const jfloat fields[FrameStatsSnapshot::kFieldCount] = {
+            snapshot.cpuMs, snapshot.gpuMs, snapshot.draws, snapshot.triangles,
+            snapshot.stateChanges, snapshot.inputMs, snapshot.waitMs, snapshot.simulationMs,
+            snapshot.renderMs};
+    env->SetFloatArrayRegion(stats, 0, FrameStatsSnapshot::kFieldCount, fields);
 }
 
 } 
\ No newline at end of file
@@ -0,0 +1,49 @@
+#include "GlQueryBackend.h"
+
+#include <GLES3/gl3.h>
+#include <GLES2/gl2ext.h>
+#include <cstring>
+
+bool GlQueryBackend::isSupported() {
+    GLint extensionCount = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+    for (GLint i = 0; i < extensionCount; i++) {
+        auto extension = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, i));
+        if (extension && strcmp(extension, "GL_EXT_disjoint_timer_query") == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void GlQueryBackend::createQueries(uint32_t *outQueries, size_t count) {
+    static_assert(sizeof(GLuint) == sizeof(uint32_t), "query names are passed as GLuint");
+    glGenQueries(GLsizei(count), reinterpret_cast<GLuint *>(outQueries));
+}
+
+bool GlQueryBackend::checkDisjoint() {
+    // Reading the flag clears it
+    GLint disjoint = 0;
+    glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+    return disjoint != 0;
+}
+
+void GlQueryBackend::beginQuery(uint32_t query) {
+    glBeginQuery(GL_TIME_ELAPSED_EXT, query);
+}
+
+void GlQueryBackend::endQuery() {
+    glEndQuery(GL_TIME_ELAPSED_EXT);
+}
+
+bool GlQueryBackend::isResultAvailable(uint32_t query) {
+    GLuint available = GL_FALSE;
+    glGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+    return available != GL_FALSE;
+}
+
+uint32_t GlQueryBackend::getResultNanos(uint32_t query) {
+    GLuint nanos = 0;
+    glGetQueryObjectuiv(query, GL_QUERY_RESULT, &nanos);
+    return nanos;
+}
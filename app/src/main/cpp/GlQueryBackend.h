@@ -0,0 +1,28 @@
+#ifndef HOLOPERSONA_GLQUERYBACKEND_H
+#define HOLOPERSONA_GLQUERYBACKEND_H
+
+#include "GpuTimer.h"
+
+/*!
+ * Times with GL_EXT_disjoint_timer_query. ES 3 has the query objects, the extension adds the
+ * target that times and the disjoint flag, so nothing needs loading through eglGetProcAddress.
+ * Results are read as 32 bit nanoseconds, a little over 4 seconds a query.
+ */
+class GlQueryBackend : public GpuQueryBackend {
+public:
+    bool isSupported() override;
+
+    void createQueries(uint32_t *outQueries, size_t count) override;
+
+    bool checkDisjoint() override;
+
+    void beginQuery(uint32_t query) override;
+
+    void endQuery() override;
+
+    bool isResultAvailable(uint32_t query) override;
+
+    uint32_t getResultNanos(uint32_t query) override;
+};
+
+#endif //HOLOPERSONA_GLQUERYBACKEND_H
@@ -0,0 +1,107 @@
+#include "GpuTimer.h"
+
+#include "AndroidOut.h"
+
+namespace {
+
+GpuQueryBackend gNullBackend;
+
+} // namespace
+
+GpuTimer::GpuTimer() : backend_(gNullBackend) {}
+
+GpuTimer::GpuTimer(GpuQueryBackend &backend) : backend_(backend) {}
+
+bool GpuTimer::init() {
+    supported_ = backend_.isSupported();
+
+    // The queries of an earlier context went with it, so there's nothing to delete
+    for (auto &frame: frames_) {
+        frame = {};
+    }
+    current_ = 0;
+    recording_ = false;
+    scopeDepth_ = 0;
+    queryOpen_ = false;
+
+    if (!supported_) {
+        aout << "GpuTimer: the GPU can't be timed, GPU times are off" << std::endl;
+        return false;
+    }
+
+    for (auto &frame: frames_) {
+        backend_.createQueries(frame.queries, kMaxScopes);
+    }
+    return true;
+}
+
+float GpuTimer::beginFrame() {
+    if (!supported_) {
+        return -1.0f;
+    }
+
+    // Something like a frequency change invalidated the results in flight
+    if (backend_.checkDisjoint()) {
+        for (auto &frame: frames_) {
+            frame.pending = false;
+        }
+    }
+
+    // Frames finish in order, so collect from the oldest until one isn't ready
+    float newestMs = -1.0f;
+    for (size_t i = 0; i < kFramesInFlight; i++) {
+        Frame &frame = frames_[(current_ + i) % kFramesInFlight];
+        if (!frame.pending) {
+            continue;
+        }
+        if (!backend_.isResultAvailable(frame.queries[frame.scopeCount - 1])) {
+            break;
+        }
+
+        double totalNanos = 0.0;
+        for (size_t scope = 0; scope < frame.scopeCount; scope++) {
+            totalNanos += backend_.getResultNanos(frame.queries[scope]);
+        }
+        frame.pending = false;
+        newestMs = float(totalNanos / 1000000.0);
+    }
+
+    // If the GPU is so far behind that this frame's queries are still in use, skip timing it
+    recording_ = !frames_[current_].pending;
+    if (recording_) {
+        frames_[current_].scopeCount = 0;
+    }
+    return newestMs;
+}
+
+void GpuTimer::beginScope() {
+    if (scopeDepth_++ > 0 || !recording_) {
+        return;
+    }
+    Frame &frame = frames_[current_];
+    if (frame.scopeCount < kMaxScopes) {
+        backend_.beginQuery(frame.queries[frame.scopeCount]);
+        queryOpen_ = true;
+    }
+}
+
+void GpuTimer::endScope() {
+    if (scopeDepth_ == 0 || --scopeDepth_ > 0 || !queryOpen_) {
+        return;
+    }
+    backend_.endQuery();
+    frames_[current_].scopeCount++;
+    queryOpen_ = false;
+}
+
+void GpuTimer::endFrame() {
+    if (!recording_) {
+        return;
+    }
+    Frame &frame = frames_[current_];
+    if (frame.scopeCount > 0) {
+        frame.pending = true;
+        current_ = (current_ + 1) % kFramesInFlight;
+    }
+    recording_ = false;
+}
@@ -0,0 +1,148 @@
+#ifndef HOLOPERSONA_GPUTIMER_H
+#define HOLOPERSONA_GPUTIMER_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*!
+ * The GPU queries a @a GpuTimer times with, kept behind an interface so the timer's bookkeeping
+ * runs without GL. @a GlQueryBackend is the real one, the base class is a null backend that
+ * can't time anything.
+ *
+ * Queries are named by integers as GL names them. Every call is made on the GL thread.
+ */
+class GpuQueryBackend {
+public:
+    virtual ~GpuQueryBackend() = default;
+
+    /*!
+     * @return true if the GPU can be timed on the current context
+     */
+    virtual bool isSupported() { return false; }
+
+    /*!
+     * Creates @a count queries, writing their names to @a outQueries
+     */
+    virtual void createQueries(uint32_t *outQueries, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            outQueries[i] = 0;
+        }
+    }
+
+    /*!
+     * @return true if something, such as a frequency change, invalidated the results in flight
+     *     since the last call
+     */
+    virtual bool checkDisjoint() { return false; }
+
+    //! Starts timing the GPU work issued from now on into @a query
+    virtual void beginQuery(uint32_t /* query */) {}
+
+    //! Stops the query that's timing
+    virtual void endQuery() {}
+
+    /*!
+     * @return true once the GPU has got to the end of @a query, without waiting for it
+     */
+    virtual bool isResultAvailable(uint32_t /* query */) { return false; }
+
+    /*!
+     * @return the nanoseconds @a query timed, once its result is available
+     */
+    virtual uint32_t getResultNanos(uint32_t /* query */) { return 0; }
+};
+
+/*!
+ * Times the GPU's work for a frame with the queries of a @a GpuQueryBackend, on the device
+ * GL_EXT_disjoint_timer_query through @a GlQueryBackend. A frame is timed as a run of scopes, one
+ * query each, and the frame's time is their total. Results are read back a few frames later, once
+ * the GPU has got to them, and never waited on, so timing doesn't stall the pipeline.
+ *
+ * Without the extension the timer does nothing and never has a result. Queries can't nest, so a
+ * scope opened inside another is timed as part of it.
+ *
+ * ex:
+ *  float gpuMs = timer.beginFrame();
+ *  {
+ *      GpuScope scope(timer);
+ *      glClear(GL_COLOR_BUFFER_BIT);
+ *  }
+ *  timer.endFrame();
+ */
+class GpuTimer {
+public:
+    // Frames that can be waiting on their results. A frame that would need another is left untimed.
+    static constexpr size_t kFramesInFlight = 4;
+    // Scopes timed per frame, any more in a frame go untimed
+    static constexpr size_t kMaxScopes = 16;
+
+    /*!
+     * A timer that never has a result
+     */
+    GpuTimer();
+
+    /*!
+     * @param backend the queries to time with, must outlive the timer
+     */
+    explicit GpuTimer(GpuQueryBackend &backend);
+
+    /*!
+     * Asks the backend whether it can time and creates the queries. Call on the GL thread each
+     * time a context is created, the queries made for an earlier one are gone with it.
+     * @return true if the GPU can be timed
+     */
+    bool init();
+
+    constexpr bool isSupported() const { return supported_; }
+
+    /*!
+     * Starts a frame, first collecting every earlier frame the GPU has finished
+     * @return the GPU time of the newest frame collected in milliseconds, or a negative value if
+     *     none were
+     */
+    float beginFrame();
+
+    void beginScope();
+
+    void endScope();
+
+    void endFrame();
+
+private:
+    struct Frame {
+        uint32_t queries[kMaxScopes];
+        size_t scopeCount;
+        bool pending;       // Ended with scopes whose results haven't been read
+    };
+
+    GpuQueryBackend &backend_;
+    bool supported_ = false;
+    Frame frames_[kFramesInFlight] = {};
+    size_t current_ = 0;    // The frame being recorded, or next to be
+    bool recording_ = false;
+    size_t scopeDepth_ = 0; // Scopes opened inside another are part of it
+    bool queryOpen_ = false;
+};
+
+/*!
+ * Times the GPU work issued during its lifetime as a scope of the current frame
+ */
+class GpuScope {
+public:
+    explicit inline GpuScope(GpuTimer &timer) : timer_(timer) {
+        timer_.beginScope();
+    }
+
+    inline ~GpuScope() {
+        timer_.endScope();
+    }
+
+    GpuScope(const GpuScope &) = delete;
+
+    GpuScope &operator=(const GpuScope &) = delete;
+
+private:
+    GpuTimer &timer_;
+};
+
+#endif //HOLOPERSONA_GPUTIMER_H
@@ -0,0 +1,591 @@
+#include "ImageKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "Simd.h"
+
+#if defined(HOLOPERSONA_SIMD)
+bool ImageKernels::simdEnabled_ = true;
+#else
+bool ImageKernels::simdEnabled_ = false;
+#endif
+
+bool ImageKernels::isSimdAvailable() {
+#if defined(HOLOPERSONA_SIMD)
+    return true;
+#else
+    return false;
+#endif
+}
+
+void ImageKernels::setSimdEnabled(bool enabled) {
+    simdEnabled_ = enabled && isSimdAvailable();
+}
+
+/*!
+ * round(c * a / 255) without a divide, exact for every pair of bytes
+ */
+static inline uint8_t multiplyDiv255(uint32_t c, uint32_t a) {
+    uint32_t t = c * a;
+    return static_cast<uint8_t>((t + ((t + 128) >> 8) + 128) >> 8);
+}
+
+void ImageKernels::premultiplyAlpha(uint8_t *rgba, size_t pixelCount) {
+    size_t i = 0;
+
+#if defined(HOLOPERSONA_SIMD_NEON)
+    if (simdEnabled_) {
+        // Same rounding as multiplyDiv255: t + ((t + 128) >> 8), then + 128 and >> 8 on narrowing
+        auto premultiply = [](uint8x16_t c, uint8x16_t a) {
+            uint16x8_t lo = vmull_u8(vget_low_u8(c), vget_low_u8(a));
+            uint16x8_t hi = vmull_u8(vget_high_u8(c), vget_high_u8(a));
+            lo = vrsraq_n_u16(lo, lo, 8);
+            hi = vrsraq_n_u16(hi, hi, 8);
+            return vcombine_u8(vrshrn_n_u16(lo, 8), vrshrn_n_u16(hi, 8));
+        };
+        for (; i + 16 <= pixelCount; i += 16) {
+            uint8x16x4_t px = vld4q_u8(rgba + i * 4);
+            px.val[0] = premultiply(px.val[0], px.val[3]);
+            px.val[1] = premultiply(px.val[1], px.val[3]);
+            px.val[2] = premultiply(px.val[2], px.val[3]);
+            vst4q_u8(rgba + i * 4, px);
+        }
+    }
+#elif defined(HOLOPERSONA_SIMD_SSE2)
+    if (simdEnabled_) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i round = _mm_set1_epi16(128);
+        // Multiply the alpha lanes by 255 instead, which leaves alpha unchanged
+        const __m128i alphaLanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+        const __m128i opaque = _mm_and_si128(alphaLanes, _mm_set1_epi16(255));
+
+        auto premultiply = [&](__m128i px) {
+            __m128i alpha = _mm_shufflelo_epi16(px, _MM_SHUFFLE(3, 3, 3, 3));
+            alpha = _mm_shufflehi_epi16(alpha, _MM_SHUFFLE(3, 3, 3, 3));
+            alpha = _mm_or_si128(_mm_andnot_si128(alphaLanes, alpha), opaque);
+            __m128i t = _mm_add_epi16(_mm_mullo_epi16(px, alpha), round);
+            t = _mm_add_epi16(t, _mm_srli_epi16(t, 8));
+            return _mm_srli_epi16(t, 8);
+        };
+        for (; i + 4 <= pixelCount; i += 4) {
+            auto *p = reinterpret_cast<__m128i *>(rgba + i * 4);
+            __m128i px = _mm_loadu_si128(p);
+            __m128i lo = premultiply(_mm_unpacklo_epi8(px, zero));
+            __m128i hi = premultiply(_mm_unpackhi_epi8(px, zero));
+            _mm_storeu_si128(p, _mm_packus_epi16(lo, hi));
+        }
+    }
+#endif
+
+    for (; i < pixelCount; i++) {
+        uint8_t *px = rgba + i * 4;
+        px[0] = multiplyDiv255(px[0], px[3]);
+        px[1] = multiplyDiv255(px[1], px[3]);
+        px[2] = multiplyDiv255(px[2], px[3]);
+    }
+}
+
+#if defined(HOLOPERSONA_SIMD_SSE2)
+/*!
+ * Packs the low 16 bits of eight 32 bit lanes. SSE2 only has a signed saturating pack, so the
+ * values are biased into the signed range and back.
+ */
+static inline __m128i packLow16(__m128i a, __m128i b) {
+    const __m128i bias = _mm_set1_epi32(0x8000);
+    __m128i packed = _mm_packs_epi32(_mm_sub_epi32(a, bias), _mm_sub_epi32(b, bias));
+    return _mm_xor_si128(packed, _mm_set1_epi16(static_cast<short>(0x8000)));
+}
+#endif
+
+void ImageKernels::convertRGBA8ToRGB565(const uint8_t *src, uint16_t *dst, size_t pixelCount) {
+    size_t i = 0;
+
+#if defined(HOLOPERSONA_SIMD_NEON)
+    if (simdEnabled_) {
+        // Widen each channel into the top byte, then shift-insert the next channel below it
+        auto pack = [](uint8x8_t r, uint8x8_t g, uint8x8_t b) {
+            uint16x8_t out = vsriq_n_u16(vshll_n_u8(r, 8), vshll_n_u8(g, 8), 5);
+            return vsriq_n_u16(out, vshll_n_u8(b, 8), 11);
+        };
+        for (; i + 16 <= pixelCount; i += 16) {
+            uint8x16x4_t px = vld4q_u8(src + i * 4);
+            vst1q_u16(dst + i, pack(vget_low_u8(px.val[0]), vget_low_u8(px.val[1]),
+                                    vget_low_u8(px.val[2])));
+            vst1q_u16(dst + i + 8, pack(vget_high_u8(px.val[0]), vget_high_u8(px.val[1]),
+                                        vget_high_u8(px.val[2])));
+        }
+    }
+#elif defined(HOLOPERSONA_SIMD_SSE2)
+    if (simdEnabled_) {
+        const __m128i mask5 = _mm_set1_epi32(0xF8);
+        const __m128i mask6 = _mm_set1_epi32(0xFC);
+        auto pack = [&](__m128i px) {
+            __m128i r = _mm_and_si128(px, mask5);
+            __m128i g = _mm_and_si128(_mm_srli_epi32(px, 8), mask6);
+            __m128i b = _mm_and_si128(_mm_srli_epi32(px, 16), mask5);
+            return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(r, 8), _mm_slli_epi32(g, 3)),
+                                _mm_srli_epi32(b, 3));
+        };
+        for (; i + 8 <= pixelCount; i += 8) {
+            auto *p = reinterpret_cast<const __m128i *>(src + i * 4);
+            __m128i packed = packLow16(pack(_mm_loadu_si128(p)), pack(_mm_loadu_si128(p + 1)));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), packed);
+        }
+    }
+#endif
+
+    for (; i < pixelCount; i++) {
+        const uint8_t *px = src + i * 4;
+        dst[i] = static_cast<uint16_t>(((px[0] >> 3) << 11) | ((px[1] >> 2) << 5) | (px[2] >> 3));
+    }
+}
+
+void ImageKernels::convertRGB565ToRGBA8(const uint16_t *src, uint8_t *dst, size_t pixelCount) {
+    size_t i = 0;
+
+#if defined(HOLOPERSONA_SIMD_NEON)
+    if (simdEnabled_) {
+        for (; i + 8 <= pixelCount; i += 8) {
+            uint16x8_t v = vld1q_u16(src + i);
+            uint8x8_t r = vmovn_u16(vshrq_n_u16(v, 11));
+            uint8x8_t g = vmovn_u16(vandq_u16(vshrq_n_u16(v, 5), vdupq_n_u16(0x3F)));
+            uint8x8_t b = vmovn_u16(vandq_u16(v, vdupq_n_u16(0x1F)));
+            uint8x8x4_t px;
+            px.val[0] = vorr_u8(vshl_n_u8(r, 3), vshr_n_u8(r, 2));
+            px.val[1] = vorr_u8(vshl_n_u8(g, 2), vshr_n_u8(g, 4));
+            px.val[2] = vorr_u8(vshl_n_u8(b, 3), vshr_n_u8(b, 2));
+            px.val[3] = vdup_n_u8(0xFF);
+            vst4_u8(dst + i * 4, px);
+        }
+    }
+#elif defined(HOLOPERSONA_SIMD_SSE2)
+    if (simdEnabled_) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i opaque = _mm_set1_epi32(static_cast<int>(0xFF000000));
+        auto expand = [&](__m128i v) {
+            __m128i r = _mm_srli_epi32(v, 11);
+            __m128i g = _mm_and_si128(_mm_srli_epi32(v, 5), _mm_set1_epi32(0x3F));
+            __m128i b = _mm_and_si128(v, _mm_set1_epi32(0x1F));
+            r = _mm_or_si128(_mm_slli_epi32(r, 3), _mm_srli_epi32(r, 2));
+            g = _mm_or_si128(_mm_slli_epi32(g, 2), _mm_srli_epi32(g, 4));
+            b = _mm_or_si128(_mm_slli_epi32(b, 3), _mm_srli_epi32(b, 2));
+            return _mm_or_si128(_mm_or_si128(r, _mm_slli_epi32(g, 8)),
+                                _mm_or_si128(_mm_slli_epi32(b, 16), opaque));
+        };
+        for (; i + 8 <= pixelCount; i += 8) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+            auto *p = reinterpret_cast<__m128i *>(dst + i * 4);
+            _mm_storeu_si128(p, expand(_mm_unpacklo_epi16(v, zero)));
+            _mm_storeu_si128(p + 1, expand(_mm_unpackhi_epi16(v, zero)));
+        }
+    }
+#endif
+
+    for (; i < pixelCount; i++) {
+        uint32_t r = src[i] >> 11;
+        uint32_t g = (src[i] >> 5) & 0x3F;
+        uint32_t b = src[i] & 0x1F;
+        uint8_t *px = dst + i * 4;
+        px[0] = static_cast<uint8_t>((r << 3) | (r >> 2));
+        px[1] = static_cast<uint8_t>((g << 2) | (g >> 4));
+        px[2] = static_cast<uint8_t>((b << 3) | (b >> 2));
+        px[3] = 0xFF;
+    }
+}
+
+void ImageKernels::convertRGBA8ToRGBA4444(const uint8_t *src, uint16_t *dst, size_t pixelCount) {
+    size_t i = 0;
+
+#if defined(HOLOPERSONA_SIMD_NEON)
+    if (simdEnabled_) {
+        auto pack = [](uint8x8_t r, uint8x8_t g, uint8x8_t b, uint8x8_t a) {
+            uint16x8_t out = vsriq_n_u16(vshll_n_u8(r, 8), vshll_n_u8(g, 8), 4);
+            out = vsriq_n_u16(out, vshll_n_u8(b, 8), 8);
+            return vsriq_n_u16(out, vshll_n_u8(a, 8), 12);
+        };
+        for (; i + 16 <= pixelCount; i += 16) {
+            uint8x16x4_t px = vld4q_u8(src + i * 4);
+            vst1q_u16(dst + i, pack(vget_low_u8(px.val[0]), vget_low_u8(px.val[1]),
+                                    vget_low_u8(px.val[2]), vget_low_u8(px.val[3])));
+            vst1q_u16(dst + i + 8, pack(vget_high_u8(px.val[0]), vget_high_u8(px.val[1]),
+                                        vget_high_u8(px.val[2]), vget_high_u8(px.val[3])));
+        }
+    }
+#elif defined(HOLOPERSONA_SIMD_SSE2)
+    if (simdEnabled_) {
+        const __m128i mask4 = _mm_set1_epi32(0xF0);
+        auto pack = [&](__m128i px) {
+            __m128i r = _mm_slli_epi32(_mm_and_si128(px, mask4), 8);
+            __m128i g = _mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(px, 8), mask4), 4);
+            __m128i b = _mm_and_si128(_mm_srli_epi32(px, 16), mask4);
+            __m128i a = _mm_srli_epi32(px, 28);
+            return _mm_or_si128(_mm_or_si128(r, g), _mm_or_si128(b, a));
+        };
+        for (; i + 8 <= pixelCount; i += 8) {
+            auto *p = reinterpret_cast<const __m128i *>(src + i * 4);
+            __m128i packed = packLow16(pack(_mm_loadu_si128(p)), pack(_mm_loadu_si128(p + 1)));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), packed);
+        }
+    }
+#endif
+
+    for (; i < pixelCount; i++) {
+        const uint8_t *px = src + i * 4;
+        dst[i] = static_cast<uint16_t>(((px[0] >> 4) << 12) | ((px[1] >> 4) << 8)
+                                       | ((px[2] >> 4) << 4) | (px[3] >> 4));
+    }
+}
+
+void ImageKernels::convertRGBA4444ToRGBA8(const uint16_t *src, uint8_t *dst, size_t pixelCount) {
+    size_t i = 0;
+
+#if defined(HOLOPERSONA_SIMD_NEON)
+    if (simdEnabled_) {
+        auto expand = [](uint8x8_t nibble) { return vorr_u8(vshl_n_u8(nibble, 4), nibble); };
+        const uint16x8_t mask = vdupq_n_u16(0x0F);
+        for (; i + 8 <= pixelCount; i += 8) {
+            uint16x8_t v = vld1q_u16(src + i);
+            uint8x8x4_t px;
+            px.val[0] = expand(vmovn_u16(vshrq_n_u16(v, 12)));
+            px.val[1] = expand(vmovn_u16(vandq_u16(vshrq_n_u16(v, 8), mask)));
+            px.val[2] = expand(vmovn_u16(vandq_u16(vshrq_n_u16(v, 4), mask)));
+            px.val[3] = expand(vmovn_u16(vandq_u16(v, mask)));
+            vst4_u8(dst + i * 4, px);
+        }
+    }
+#elif defined(HOLOPERSONA_SIMD_SSE2)
+    if (simdEnabled_) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i mask = _mm_set1_epi32(0x0F);
+        auto expand = [&](__m128i v) {
+            __m128i r = _mm_srli_epi32(v, 12);
+            __m128i g = _mm_and_si128(_mm_srli_epi32(v, 8), mask);
+            __m128i b = _mm_and_si128(_mm_srli_epi32(v, 4), mask);
+            __m128i a = _mm_and_si128(v, mask);
+            __m128i packed = _mm_or_si128(_mm_or_si128(r, _mm_slli_epi32(g, 8)),
+                                          _mm_or_si128(_mm_slli_epi32(b, 16),
+                                                       _mm_slli_epi32(a, 24)));
+            // Every byte now holds a nibble, replicate it into the high half
+            return _mm_or_si128(packed, _mm_slli_epi32(packed, 4));
+        };
+        for (; i + 8 <= pixelCount; i += 8) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+            auto *p = reinterpret_cast<__m128i *>(dst + i * 4);
+            _mm_storeu_si128(p, expand(_mm_unpacklo_epi16(v, zero)));
+            _mm_storeu_si128(p + 1, expand(_mm_unpackhi_epi16(v, zero)));
+        }
+    }
+#endif
+
+    for (; i < pixelCount; i++) {
+        uint8_t *px = dst + i * 4;
+        px[0] = static_cast<uint8_t>(((src[i] >> 12) & 0x0F) * 17);
+        px[1] = static_cast<uint8_t>(((src[i] >> 8) & 0x0F) * 17);
+        px[2] = static_cast<uint8_t>(((src[i] >> 4) & 0x0F) * 17);
+        px[3] = static_cast<uint8_t>((src[i] & 0x0F) * 17);
+    }
+}
+
+void ImageKernels::downsample(const uint8_t *src, uint32_t width, uint32_t height, uint8_t *dst,
+                              MipFilter filter) {
+    switch (filter) {
+        case MipFilter::BOX:
+            downsampleBox(src, width, height, dst);
+            break;
+        case MipFilter::BOX_SRGB:
+            downsampleBoxSrgb(src, width, height, dst);
+            break;
+        case MipFilter::KAISER:
+            downsampleKaiser(src, width, height, dst);
+            break;
+    }
+}
+
+std::vector<std::vector<uint8_t>> ImageKernels::buildMipChain(const uint8_t *src,
+                                                              uint32_t width,
+                                                              uint32_t height,
+                                                              MipFilter filter) {
+    std::vector<std::vector<uint8_t>> levels;
+    levels.emplace_back(src, src + size_t(width) * height * 4);
+
+    while (width > 1 || height > 1) {
+        uint32_t mipWidth = mipDimension(width);
+        uint32_t mipHeight = mipDimension(height);
+        std::vector<uint8_t> mip(size_t(mipWidth) * mipHeight * 4);
+        downsample(levels.back().data(), width, height, mip.data(), filter);
+        levels.push_back(std::move(mip));
+        width = mipWidth;
+        height = mipHeight;
+    }
+    return levels;
+}
+
+void ImageKernels::downsampleBox(const uint8_t *src, uint32_t width, uint32_t height,
+                                 uint8_t *dst) {
+    const uint32_t dstWidth = mipDimension(width);
+    const uint32_t dstHeight = mipDimension(height);
+    const size_t rowBytes = size_t(width) * 4;
+
+    for (uint32_t y = 0; y < dstHeight; y++) {
+        // Odd sizes round down, so only a 1 pixel tall source reads the same row twice
+        const uint8_t *row0 = src + std::min(y * 2, height - 1) * rowBytes;
+        const uint8_t *row1 = src + std::min(y * 2 + 1, height - 1) * rowBytes;
+        uint8_t *out = dst + size_t(y) * dstWidth * 4;
+        uint32_t x = 0;
+
+        // The vector paths only handle full 2x2 blocks, a 1 pixel wide source is left to the
+        // scalar loop
+        if (width > 1) {
+#if defined(HOLOPERSONA_SIMD_NEON)
+            if (simdEnabled_) {
+                for (; x + 8 <= dstWidth; x += 8) {
+                    uint8x16x4_t top = vld4q_u8(row0 + x * 8);
+                    uint8x16x4_t bottom = vld4q_u8(row1 + x * 8);
+                    uint8x8x4_t px;
+                    for (int c = 0; c < 4; c++) {
+                        uint16x8_t sum = vpadalq_u8(vpaddlq_u8(top.val[c]), bottom.val[c]);
+                        px.val[c] = vrshrn_n_u16(sum, 2);
+                    }
+                    vst4_u8(out + x * 4, px);
+                }
+            }
+#elif defined(HOLOPERSONA_SIMD_SSE2)
+            if (simdEnabled_) {
+                const __m128i zero = _mm_setzero_si128();
+                const __m128i round = _mm_set1_epi16(2);
+                for (; x + 2 <= dstWidth; x += 2) {
+                    __m128i top = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row0 + x * 8));
+                    __m128i bottom = _mm_loadu_si128(
+                            reinterpret_cast<const __m128i *>(row1 + x * 8));
+
+                    // Columns summed, then the two source pixels of each output pixel
+                    __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(top, zero),
+                                               _mm_unpacklo_epi8(bottom, zero));
+                    __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(top, zero),
+                                               _mm_unpackhi_epi8(bottom, zero));
+                    lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+                    hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+
+                    __m128i sum = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(lo, hi), round), 2);
+                    _mm_storel_epi64(reinterpret_cast<__m128i *>(out + x * 4),
+                                     _mm_packus_epi16(sum, sum));
+                }
+            }
+#endif
+        }
+
+        for (; x < dstWidth; x++) {
+            uint32_t x0 = std::min(x * 2, width - 1) * 4;
+            uint32_t x1 = std::min(x * 2 + 1, width - 1) * 4;
+            for (int c = 0; c < 4; c++) {
+                uint32_t sum = row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c];
+                out[x * 4 + c] = static_cast<uint8_t>((sum + 2) >> 2);
+            }
+        }
+    }
+}
+
+namespace {
+/*!
+ * Lookup tables between 8 bit sRGB and linear light. Linear values are stored with 12 bits, which
+ * is enough to round trip every sRGB byte.
+ */
+struct SrgbTables {
+    static constexpr int kLinearSteps = 4096;
+
+    uint16_t toLinear[256];
+    uint8_t toSrgb[kLinearSteps];
+
+    SrgbTables() {
+        for (int i = 0; i < 256; i++) {
+            float c = i / 255.f;
+            float linear = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            toLinear[i] = static_cast<uint16_t>(std::lround(linear * (kLinearSteps - 1)));
+        }
+        for (int i = 0; i < kLinearSteps; i++) {
+            float linear = float(i) / (kLinearSteps - 1);
+            float c = linear <= 0.0031308f
+                      ? linear * 12.92f
+                      : 1.055f * std::pow(linear, 1.f / 2.4f) - 0.055f;
+            toSrgb[i] = static_cast<uint8_t>(std::lround(std::clamp(c, 0.f, 1.f) * 255.f));
+        }
+    }
+
+    static const SrgbTables &get() {
+        static const SrgbTables tables;
+        return tables;
+    }
+};
+}
+
+void ImageKernels::downsampleBoxSrgb(const uint8_t *src, uint32_t width, uint32_t height,
+                                     uint8_t *dst) {
+    // The table lookups are gathers, which neither NEON nor SSE2 can do, so this stays scalar
+    const auto &tables = SrgbTables::get();
+    const uint32_t dstWidth = mipDimension(width);
+    const uint32_t dstHeight = mipDimension(height);
+    const size_t rowBytes = size_t(width) * 4;
+
+    for (uint32_t y = 0; y < dstHeight; y++) {
+        const uint8_t *row0 = src + std::min(y * 2, height - 1) * rowBytes;
+        const uint8_t *row1 = src + std::min(y * 2 + 1, height - 1) * rowBytes;
+        uint8_t *out = dst + size_t(y) * dstWidth * 4;
+
+        for (uint32_t x = 0; x < dstWidth; x++) {
+            uint32_t x0 = std::min(x * 2, width - 1) * 4;
+            uint32_t x1 = std::min(x * 2 + 1, width - 1) * 4;
+            for (int c = 0; c < 3; c++) {
+                uint32_t sum = tables.toLinear[row0[x0 + c]] + tables.toLinear[row0[x1 + c]]
+                               + tables.toLinear[row1[x0 + c]] + tables.toLinear[row1[x1 + c]];
+                out[x * 4 + c] = tables.toSrgb[(sum + 2) >> 2];
+            }
+
+            // Alpha is already linear
+            uint32_t alpha = row0[x0 + 3] + row0[x1 + 3] + row1[x0 + 3] + row1[x1 + 3];
+            out[x * 4 + 3] = static_cast<uint8_t>((alpha + 2) >> 2);
+        }
+    }
+}
+
+namespace {
+/*!
+ * Weights of an 8 tap Kaiser windowed sinc for halving an image. The taps sit at -3.5 .. 3.5
+ * source pixels from the centre of each output pixel.
+ */
+struct KaiserWeights {
+    static constexpr int kTaps = 8;
+    static constexpr float kBeta = 4.f;
+
+    float weights[kTaps];
+
+    static float besselI0(float x) {
+        float sum = 1.f;
+        float term = 1.f;
+        for (int k = 1; k < 16; k++) {
+            term *= (x / (2.f * k)) * (x / (2.f * k));
+            sum += term;
+        }
+        return sum;
+    }
+
+    KaiserWeights() {
+        const float pi = 3.14159265358979f;
+        float total = 0.f;
+        for (int i = 0; i < kTaps; i++) {
+            // Distance in output pixels, the sinc cuts off at half the source rate
+            float distance = (i - (kTaps - 1) * 0.5f) * 0.5f;
+            float sinc = std::sin(pi * distance) / (pi * distance);
+            float t = distance / (kTaps * 0.5f * 0.5f);
+            float window = besselI0(kBeta * std::sqrt(std::max(0.f, 1.f - t * t))) / besselI0(kBeta);
+            weights[i] = sinc * window;
+            total += weights[i];
+        }
+        for (float &weight: weights) {
+            weight /= total;
+        }
+    }
+
+    static const KaiserWeights &get() {
+        static const KaiserWeights kaiser;
+        return kaiser;
+    }
+};
+
+inline uint8_t toByte(float value) {
+    return static_cast<uint8_t>(std::min(std::max(value, 0.f), 255.f) + 0.5f);
+}
+}
+
+void ImageKernels::downsampleKaiser(const uint8_t *src, uint32_t width, uint32_t height,
+                                    uint8_t *dst) {
+    constexpr int kTaps = KaiserWeights::kTaps;
+    constexpr int kHalfTaps = kTaps / 2;
+    const float *weights = KaiserWeights::get().weights;
+    const uint32_t dstWidth = mipDimension(width);
+    const uint32_t dstHeight = mipDimension(height);
+
+    // A one pixel wide or tall axis isn't filtered, the other one still is
+    const bool filterX = width > 1;
+    const bool filterY = height > 1;
+
+    // Horizontal pass into float rows of dstWidth pixels, one per source row. Every pixel is one
+    // 4 float vector so both passes vectorise across the channels.
+    std::vector<float> sourceRow(size_t(width) * 4);
+    std::vector<float> rows(size_t(dstWidth) * height * 4);
+    for (uint32_t y = 0; y < height; y++) {
+        const uint8_t *in = src + size_t(y) * width * 4;
+        for (size_t i = 0; i < sourceRow.size(); i++) {
+            sourceRow[i] = in[i];
+        }
+
+        float *out = rows.data() + size_t(y) * dstWidth * 4;
+        for (uint32_t x = 0; x < dstWidth; x++) {
+            if (!filterX) {
+                memcpy(out, sourceRow.data(), sizeof(float) * 4);
+                continue;
+            }
+
+            int first = int(x * 2) - (kHalfTaps - 1);
+#if defined(HOLOPERSONA_SIMD)
+            if (simdEnabled_) {
+                Float4 acc = splat4(0.f);
+                for (int k = 0; k < kTaps; k++) {
+                    int sx = std::clamp(first + k, 0, int(width) - 1);
+                    acc = madd4(acc, load4(&sourceRow[sx * 4]), splat4(weights[k]));
+                }
+                store4(out + x * 4, acc);
+                continue;
+            }
+#endif
+            for (int c = 0; c < 4; c++) {
+                float acc = 0.f;
+                for (int k = 0; k < kTaps; k++) {
+                    int sx = std::clamp(first + k, 0, int(width) - 1);
+                    acc += sourceRow[sx * 4 + c] * weights[k];
+                }
+                out[x * 4 + c] = acc;
+            }
+        }
+    }
+
+    // Vertical pass straight into the destination
+    const size_t rowFloats = size_t(dstWidth) * 4;
+    for (uint32_t y = 0; y < dstHeight; y++) {
+        uint8_t *out = dst + size_t(y) * dstWidth * 4;
+        int first = int(y * 2) - (kHalfTaps - 1);
+
+        for (uint32_t x = 0; x < dstWidth; x++) {
+            float pixel[4];
+            if (!filterY) {
+                memcpy(pixel, &rows[x * 4], sizeof(pixel));
+            } else {
+#if defined(HOLOPERSONA_SIMD)
+                if (simdEnabled_) {
+                    Float4 acc = splat4(0.f);
+                    for (int k = 0; k < kTaps; k++) {
+                        int sy = std::clamp(first + k, 0, int(height) - 1);
+                        acc = madd4(acc, load4(&rows[sy * rowFloats + x * 4]), splat4(weights[k]));
+                    }
+                    store4(pixel, acc);
+                } else
+#endif
+                {
+                    for (int c = 0; c < 4; c++) {
+                        float acc = 0.f;
+                        for (int k = 0; k < kTaps; k++) {
+                            int sy = std::clamp(first + k, 0, int(height) - 1);
+                            acc += rows[sy * rowFloats + x * 4 + c] * weights[k];
+                        }
+                        pixel[c] = acc;
+                    }
+                }
+            }
+
+            for (int c = 0; c < 4; c++) {
+                out[x * 4 + c] = toByte(pixel[c]);
+            }
+        }
+    }
+}
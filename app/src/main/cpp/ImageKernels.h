@@ -0,0 +1,99 @@
+#ifndef HOLOPERSONA_IMAGEKERNELS_H
+#define HOLOPERSONA_IMAGEKERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*!
+ * CPU image processing for decoded RGBA8 images: premultiplied alpha, 16 bit format conversion
+ * and mip downsampling. Used by the texture pipeline after stb_image decodes an asset and by
+ * anything that needs pixels without going through GL, such as thumbnails.
+ *
+ * Every kernel has a NEON and an SSE2 path behind a portable scalar reference (see Simd.h). The
+ * integer kernels produce bit-identical results on every path, the Kaiser filter can differ by
+ * float rounding. @a setSimdEnabled lets a host-side check or benchmark compare the two. Nothing
+ * here touches GL or Android.
+ *
+ * RGBA8 images are tightly packed, 4 bytes per pixel in R, G, B, A order. 16 bit formats hold
+ * one pixel per uint16_t in the bit layout GL_UNSIGNED_SHORT_5_6_5 and
+ * GL_UNSIGNED_SHORT_4_4_4_4 expect.
+ */
+class ImageKernels {
+public:
+    enum class MipFilter {
+        BOX,        // 2x2 average of the stored values, fastest
+        BOX_SRGB,   // 2x2 average in linear light, for sRGB color textures
+        KAISER      // 8 tap Kaiser windowed sinc, sharper lower mips
+    };
+
+    /*!
+     * Multiplies the color channels by alpha in place, rounding to nearest
+     */
+    static void premultiplyAlpha(uint8_t *rgba, size_t pixelCount);
+
+    static void convertRGBA8ToRGB565(const uint8_t *src, uint16_t *dst, size_t pixelCount);
+
+    /*!
+     * Expands by bit replication, alpha is set to 255
+     */
+    static void convertRGB565ToRGBA8(const uint16_t *src, uint8_t *dst, size_t pixelCount);
+
+    static void convertRGBA8ToRGBA4444(const uint8_t *src, uint16_t *dst, size_t pixelCount);
+
+    /*!
+     * Expands by bit replication
+     */
+    static void convertRGBA4444ToRGBA8(const uint16_t *src, uint8_t *dst, size_t pixelCount);
+
+    /*!
+     * Halves an image, rounding odd sizes down as GL does for mip levels, so the last column of
+     * an odd width and the last row of an odd height are dropped by the box filters. A side of 1
+     * pixel stays 1 pixel.
+     * @param src the source image
+     * @param width the width of the source image
+     * @param height the height of the source image
+     * @param dst receives mipDimension(width) x mipDimension(height) pixels
+     * @param filter how to weigh the source pixels
+     */
+    static void downsample(const uint8_t *src, uint32_t width, uint32_t height, uint8_t *dst,
+                           MipFilter filter = MipFilter::BOX);
+
+    /*!
+     * Builds a full mip chain down to 1x1, level 0 being a copy of @a src
+     * @return the levels, each tightly packed RGBA8
+     */
+    static std::vector<std::vector<uint8_t>> buildMipChain(const uint8_t *src,
+                                                           uint32_t width,
+                                                           uint32_t height,
+                                                           MipFilter filter = MipFilter::BOX);
+
+    /*!
+     * @return the size of the next mip level along one axis
+     */
+    static constexpr uint32_t mipDimension(uint32_t size) { return size > 1 ? size / 2 : 1; }
+
+    /*!
+     * @return true if this build has a NEON or SSE2 path
+     */
+    static bool isSimdAvailable();
+
+    /*!
+     * Switches between the vector paths and the scalar reference, to validate or benchmark them.
+     * Enabled by default when available.
+     */
+    static void setSimdEnabled(bool enabled);
+
+private:
+    static void downsampleBox(const uint8_t *src, uint32_t width, uint32_t height, uint8_t *dst);
+
+    static void downsampleBoxSrgb(const uint8_t *src, uint32_t width, uint32_t height,
+                                  uint8_t *dst);
+
+    static void downsampleKaiser(const uint8_t *src, uint32_t width, uint32_t height,
+                                 uint8_t *dst);
+
+    static bool simdEnabled_;
+};
+
+#endif //HOLOPERSONA_IMAGEKERNELS_H
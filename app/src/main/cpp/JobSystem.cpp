@@ -0,0 +1,296 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// The pool and queue the current thread works from. Threads outside every pool use the shared
+// queue of whichever pool they queue into.
+static thread_local const JobSystem *tCurrentPool = nullptr;
+static thread_local size_t tCurrentQueue = 0;
+
+namespace {
+
+/*!
+ * The cores of each kind, told apart by the top frequency cpufreq reports for them. Every core
+ * faster than the slowest counts as big, so the prime core of a three cluster SoC is big too.
+ * With one kind of core, or no cpufreq to read, every core is big and little is empty.
+ */
+struct CoreTopology {
+    std::vector<int> big;
+    std::vector<int> little;
+};
+
+const CoreTopology &getCoreTopology() {
+    static const CoreTopology kTopology = []() {
+        CoreTopology topology;
+        int coreCount = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        std::vector<long> maxFrequencies(coreCount, 0);
+        for (int core = 0; core < coreCount; core++) {
+            char path[96];
+            snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/cpuinfo_max_freq",
+                     core);
+            if (FILE *file = fopen(path, "r")) {
+                if (fscanf(file, "%ld", &maxFrequencies[core]) != 1) {
+                    maxFrequencies[core] = 0;
+                }
+                fclose(file);
+            }
+        }
+
+        long slowest = *std::min_element(maxFrequencies.begin(), maxFrequencies.end());
+        long fastest = *std::max_element(maxFrequencies.begin(), maxFrequencies.end());
+        for (int core = 0; core < coreCount; core++) {
+            if (slowest > 0 && slowest < fastest && maxFrequencies[core] == slowest) {
+                topology.little.push_back(core);
+            } else {
+                topology.big.push_back(core);
+            }
+        }
+        return topology;
+    }();
+    return kTopology;
+}
+
+/*!
+ * Keeps the calling thread to the cores of one kind. Only a hint, if it fails the scheduler is
+ * left to place the thread.
+ */
+void setCoreAffinity(const std::vector<int> &cores) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int core: cores) {
+        CPU_SET(core, &set);
+    }
+    sched_setaffinity(0, sizeof(set), &set);
+#endif
+}
+
+} // namespace
+
+JobSystem::JobSystem(size_t workerCount) {
+    const CoreTopology &topology = getCoreTopology();
+    if (workerCount == 0) {
+        workerCount = std::max(1u, std::thread::hardware_concurrency()) - 1;
+        workerCount = std::max<size_t>(workerCount, 1);
+    }
+    workerCount_ = workerCount;
+
+    // A worker for every LITTLE core, leaving at least one on the big cores for the frame work.
+    // The calling thread is usually on a big core already, which is why it's one fewer.
+    size_t littleWorkers = workerCount > 1 ? std::min(topology.little.size(), workerCount - 1) : 0;
+    workerCores_.assign(workerCount, CoreHint::BIG);
+    std::fill(workerCores_.end() - littleWorkers, workerCores_.end(), CoreHint::LITTLE);
+
+    for (size_t i = 0; i < workerCount + 3; i++) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    workers_.reserve(workerCount);
+    for (size_t i = 0; i < workerCount; i++) {
+        workers_.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto &worker: workers_) {
+        worker.join();
+    }
+}
+
+JobSystem &JobSystem::shared() {
+    static JobSystem pool;
+    return pool;
+}
+
+void JobSystem::run(JobCounter &counter, Job job, CoreHint hint) {
+    counter.pending_.fetch_add(1, std::memory_order_relaxed);
+    enqueue({std::move(job), &counter}, hint);
+}
+
+void JobSystem::runAfter(JobCounter &dependency, JobCounter &counter, Job job, CoreHint hint) {
+    counter.pending_.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(dependency.mutex_);
+        if (!dependency.isDone()) {
+            dependency.continuations_.push_back({std::move(job), &counter, hint});
+            return;
+        }
+    }
+    enqueue({std::move(job), &counter}, hint);
+}
+
+void JobSystem::wait(JobCounter &counter) {
+    while (!counter.isDone()) {
+        if (!tryRunJob()) {
+            // The last jobs are running on other threads
+            std::this_thread::yield();
+        }
+    }
+
+    // The job that finished the group may still be releasing its continuations, so let it get
+    // out of the counter before the caller is free to destroy it
+    std::lock_guard<std::mutex> lock(counter.mutex_);
+}
+
+void JobSystem::parallelFor(size_t count, size_t minBatchSize,
+                            const std::function<void(size_t, size_t)> &body, CoreHint hint) {
+    if (count == 0) {
+        return;
+    }
+
+    // A few batches per thread so a slow one can be balanced by stealing the rest
+    size_t threads = workerCount_ + 1;
+    size_t batchSize = std::max<size_t>({minBatchSize, count / (threads * 4), 1});
+    if (batchSize >= count) {
+        body(0, count);
+        return;
+    }
+
+    JobCounter counter;
+    for (size_t begin = batchSize; begin < count; begin += batchSize) {
+        size_t end = std::min(begin + batchSize, count);
+        run(counter, [&body, begin, end]() { body(begin, end); }, hint);
+    }
+
+    // The calling thread takes the first batch instead of waiting idle
+    body(0, batchSize);
+    wait(counter);
+}
+
+void JobSystem::enqueue(QueuedJob job, CoreHint hint) {
+    // Workers keep the jobs they queue without a hint, everything else goes to a shared queue
+    size_t home = tCurrentPool == this && hint == CoreHint::ANY ? tCurrentQueue
+                                                                : getSharedQueue(hint);
+    {
+        std::lock_guard<std::mutex> lock(queues_[home]->mutex);
+        queues_[home]->jobs.push_back(std::move(job));
+    }
+
+    // Taking the sleep lock orders the count with a worker that's about to sleep
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        queuedJobs_.fetch_add(1, std::memory_order_release);
+    }
+    wake_.notify_one();
+}
+
+void JobSystem::finish(JobCounter &counter) {
+    // Only the last job of the group needs the lock
+    int pending = counter.pending_.load(std::memory_order_relaxed);
+    while (pending > 1) {
+        if (counter.pending_.compare_exchange_weak(pending, pending - 1,
+                                                   std::memory_order_acq_rel)) {
+            return;
+        }
+    }
+
+    std::vector<JobCounter::Continuation> continuations;
+    {
+        std::lock_guard<std::mutex> lock(counter.mutex_);
+        if (counter.pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            continuations.swap(counter.continuations_);
+        }
+    }
+    for (auto &continuation: continuations) {
+        enqueue({std::move(continuation.job), continuation.counter}, continuation.hint);
+    }
+}
+
+void JobSystem::workerLoop(size_t index) {
+    tCurrentPool = this;
+    tCurrentQueue = index;
+
+#ifdef __linux__
+    // Named so the worker can be told apart in traces
+    char name[16];
+    snprintf(name, sizeof(name), "JobWorker %zu", index);
+    pthread_setname_np(pthread_self(), name);
+#endif
+
+    // Nothing to choose between with one kind of core
+    const CoreTopology &topology = getCoreTopology();
+    if (!topology.little.empty()) {
+        setCoreAffinity(workerCores_[index] == CoreHint::LITTLE ? topology.little : topology.big);
+    }
+
+    while (true) {
+        if (tryRunJob()) {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        wake_.wait(lock, [this]() {
+            return stopping_ || queuedJobs_.load(std::memory_order_acquire) > 0;
+        });
+        if (stopping_ && queuedJobs_.load(std::memory_order_acquire) == 0) {
+            return;
+        }
+    }
+}
+
+bool JobSystem::tryTakeJob(size_t home, QueuedJob &out) {
+    if (queuedJobs_.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+
+    auto take = [this, &out](size_t index, bool newest) {
+        Queue &queue = *queues_[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.jobs.empty()) {
+            return false;
+        }
+        if (newest) {
+            out = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+        } else {
+            out = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+        }
+        queuedJobs_.fetch_sub(1, std::memory_order_acq_rel);
+        return true;
+    };
+
+    // A worker's own jobs first, then the ones meant for its kind of core
+    bool isWorker = home < workerCount_;
+    CoreHint cores = isWorker ? workerCores_[home] : CoreHint::BIG;
+    if (isWorker && take(home, true)) {
+        return true;
+    }
+    if (take(getSharedQueue(cores), false) || take(getSharedQueue(CoreHint::ANY), false)) {
+        return true;
+    }
+    // Steal starting from the next worker along so thieves spread out over their victims
+    for (size_t step = 1; step <= workerCount_; step++) {
+        size_t victim = (home + step) % workerCount_;
+        if (victim != home && take(victim, false)) {
+            return true;
+        }
+    }
+    // Rather than sit idle a worker takes jobs meant for the other kind of core
+    if (isWorker) {
+        CoreHint others = cores == CoreHint::LITTLE ? CoreHint::BIG : CoreHint::LITTLE;
+        return take(getSharedQueue(others), false);
+    }
+    return false;
+}
+
+bool JobSystem::tryRunJob() {
+    size_t home = tCurrentPool == this ? tCurrentQueue : getSharedQueue(CoreHint::ANY);
+    QueuedJob job;
+    if (!tryTakeJob(home, job)) {
+        return false;
+    }
+    job.job();
+    finish(*job.counter);
+    return true;
+}
@@ -0,0 +1,185 @@
+#ifndef HOLOPERSONA_JOBSYSTEM_H
+#define HOLOPERSONA_JOBSYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*!
+ * Which cores a job would rather run on. Frame work that something is waiting on wants the big
+ * cores, background work such as loading should leave them to it and take the LITTLE ones. Only
+ * a preference: any worker runs any job rather than sit idle, except that threads outside the
+ * pool never pick up LITTLE jobs while they wait, since one could hold up a frame.
+ */
+enum class CoreHint : uint8_t {
+    ANY,
+    BIG,
+    LITTLE
+};
+
+/*!
+ * Counts the jobs in a group that haven't finished yet. Pass the same counter to every
+ * @a JobSystem::run call in the group, then wait on it with @a JobSystem::wait, or have more jobs
+ * follow it with @a JobSystem::runAfter. A counter must outlive its jobs and anything waiting on
+ * it, and can be reused once they're done.
+ */
+class JobCounter {
+public:
+    inline bool isDone() const { return pending_.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+
+    // A job queued by JobSystem::runAfter, held here until this counter is done
+    struct Continuation {
+        std::function<void()> job;
+        JobCounter *counter;
+        CoreHint hint;
+    };
+
+    std::atomic<int> pending_{0};
+    // Guards continuations_ and the last decrement of pending_, so a continuation is either
+    // queued straight away or released by the job that finishes the group
+    std::mutex mutex_;
+    std::vector<Continuation> continuations_;
+};
+
+/*!
+ * A pool of worker threads that run small jobs. Every worker has its own queue: it takes the
+ * newest job from its own queue, which is still warm in its cache, and when that runs dry steals
+ * the oldest job from another worker's. Jobs queued from outside the pool, such as the GL thread,
+ * go into a shared queue every worker takes from.
+ *
+ * Waiting on a counter runs queued jobs instead of blocking, so a job can queue more jobs and
+ * wait for them without tying up its worker.
+ *
+ * On a big.LITTLE device every worker is kept to one kind of core and prefers jobs hinted for it
+ * (see @a CoreHint). There's one LITTLE worker per LITTLE core, the rest run on the big cores.
+ */
+class JobSystem {
+public:
+    using Job = std::function<void()>;
+
+    /*!
+     * @param workerCount the number of threads to start, 0 for one less than the number of cores
+     *     so the calling thread has a core of its own
+     */
+    explicit JobSystem(size_t workerCount = 0);
+
+    /*!
+     * Finishes the jobs that are already queued and stops the workers
+     */
+    ~JobSystem();
+
+    JobSystem(const JobSystem &) = delete;
+
+    JobSystem &operator=(const JobSystem &) = delete;
+
+    /*!
+     * @return the pool the renderer and loaders share, started on first use
+     */
+    static JobSystem &shared();
+
+    inline size_t getWorkerCount() const { return workerCount_; }
+
+    /*!
+     * Queues a job
+     * @param counter counts the job until it has run
+     * @param job the work to do, must not throw
+     * @param hint the cores the job would rather run on
+     */
+    void run(JobCounter &counter, Job job, CoreHint hint = CoreHint::ANY);
+
+    /*!
+     * Queues a job once every job counted by @a dependency has finished, straight away if they
+     * already have. The job can itself queue more jobs on @a counter, so a whole graph can be
+     * waited on through its last counter.
+     * @param dependency the group to wait for, whose jobs must be run on this pool
+     * @param counter counts the job from now until it has run
+     * @param job the work to do, must not throw
+     * @param hint the cores the job would rather run on
+     */
+    void runAfter(JobCounter &dependency, JobCounter &counter, Job job,
+                  CoreHint hint = CoreHint::ANY);
+
+    /*!
+     * Runs queued jobs on the calling thread until every job counted by @a counter has finished
+     */
+    void wait(JobCounter &counter);
+
+    /*!
+     * Splits [0, count) into batches and runs @a body on each one in parallel, returning once they
+     * have all finished
+     * @param count the number of items
+     * @param minBatchSize the fewest items worth handing to another thread
+     * @param body called with the [begin, end) range of each batch
+     * @param hint the cores the batches would rather run on
+     */
+    void parallelFor(size_t count, size_t minBatchSize,
+                     const std::function<void(size_t begin, size_t end)> &body,
+                     CoreHint hint = CoreHint::ANY);
+
+private:
+    struct QueuedJob {
+        Job job;
+        JobCounter *counter;
+    };
+
+    /*!
+     * Puts a job that's already been counted on the queue for @a hint
+     */
+    void enqueue(QueuedJob job, CoreHint hint);
+
+    /*!
+     * Counts a job as done, queueing whatever was waiting on its group if it was the last one
+     */
+    void finish(JobCounter &counter);
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<QueuedJob> jobs;
+    };
+
+    void workerLoop(size_t index);
+
+    /*!
+     * Takes a job for the thread owning queue @a home, from the back of its own queue, then the
+     * shared queues its cores prefer, then the front of the other workers' queues, then whatever
+     * is left in the shared queues. Threads outside the pool never take LITTLE jobs.
+     * @return false if every queue was empty
+     */
+    bool tryTakeJob(size_t home, QueuedJob &out);
+
+    inline size_t getSharedQueue(CoreHint hint) const {
+        return workerCount_ + static_cast<size_t>(hint);
+    }
+
+    /*!
+     * Runs one queued job on the calling thread
+     * @return false if there was nothing to run
+     */
+    bool tryRunJob();
+
+    // Set before the first worker starts, unlike workers_.size()
+    size_t workerCount_;
+    // One queue per worker, then a shared queue for each CoreHint that jobs queued from other
+    // threads or with a hint go into
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+    // The kind of core each worker runs on, BIG for every worker on a device with one kind
+    std::vector<CoreHint> workerCores_;
+
+    std::atomic<size_t> queuedJobs_{0};
+    std::atomic<bool> stopping_{false};
+    std::mutex sleepMutex_;
+    std::condition_variable wake_;
+};
+
+#endif //HOLOPERSONA_JOBSYSTEM_H
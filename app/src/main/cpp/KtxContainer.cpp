@@ -0,0 +1,319 @@
+#include "KtxContainer.h"
+
+#include <cstring>
+
+// The GL enums are spelled out here rather than pulled from the GLES headers so the parser can be
+// built on hosts that have no GL headers at all.
+static constexpr uint32_t kGlUnsignedByte = 0x1401;
+static constexpr uint32_t kGlRgba = 0x1908;
+static constexpr uint32_t kGlRgba8 = 0x8058;
+static constexpr uint32_t kGlSrgb8Alpha8 = 0x8C43;
+static constexpr uint32_t kGlCompressedR11Eac = 0x9270;
+static constexpr uint32_t kGlCompressedSignedRg11Eac = 0x9273;
+static constexpr uint32_t kGlCompressedRgb8Etc2 = 0x9274;
+static constexpr uint32_t kGlCompressedSrgb8Alpha8Etc2Eac = 0x9279;
+static constexpr uint32_t kGlCompressedRgbaAstc4x4 = 0x93B0;
+static constexpr uint32_t kGlCompressedSrgb8Alpha8Astc4x4 = 0x93D0;
+
+// Vulkan formats used by KTX 2.0 for the payloads we can upload
+static constexpr uint32_t kVkFormatR8G8B8A8Unorm = 37;
+static constexpr uint32_t kVkFormatR8G8B8A8Srgb = 43;
+static constexpr uint32_t kVkFormatEtc2R8G8B8Unorm = 147;
+static constexpr uint32_t kVkFormatEacR11G11SnormBlock = 156;
+static constexpr uint32_t kVkFormatAstc4x4Unorm = 157;
+static constexpr uint32_t kVkFormatAstc12x12Srgb = 184;
+
+// ASTC footprints in the order both the GL and Vulkan enums list them
+static constexpr uint32_t kAstcFootprints[][2] = {
+        {4, 4}, {5, 4}, {5, 5}, {6, 5}, {6, 6}, {8, 5}, {8, 6},
+        {8, 8}, {10, 5}, {10, 6}, {10, 8}, {10, 10}, {12, 10}, {12, 12}
+};
+static constexpr uint32_t kAstcFootprintCount = sizeof(kAstcFootprints) / sizeof(kAstcFootprints[0]);
+
+static constexpr uint8_t kKtx1Identifier[12] = {
+        0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+};
+static constexpr uint8_t kKtx2Identifier[12] = {
+        0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+};
+static constexpr uint32_t kKtx1Endianness = 0x04030201;
+static constexpr size_t kKtx1HeaderSize = 64;
+static constexpr size_t kKtx2HeaderSize = 80;
+static constexpr size_t kKtx2LevelIndexEntrySize = 24;
+
+static inline uint32_t readU32(const uint8_t *p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static inline uint64_t readU64(const uint8_t *p) {
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static inline uint32_t mipDimension(uint32_t base, size_t level) {
+    uint32_t dimension = base >> level;
+    return dimension ? dimension : 1;
+}
+
+bool KtxContainer::isKtx(const void *data, size_t size) {
+    if (!data || size < sizeof(kKtx1Identifier)) {
+        return false;
+    }
+    return memcmp(data, kKtx1Identifier, sizeof(kKtx1Identifier)) == 0
+           || memcmp(data, kKtx2Identifier, sizeof(kKtx2Identifier)) == 0;
+}
+
+bool KtxContainer::parse(const void *data,
+                         size_t size,
+                         KtxContainer &outContainer,
+                         std::string *outError) {
+    outContainer = KtxContainer();
+
+    std::string error;
+    bool parsed = false;
+    auto *bytes = static_cast<const uint8_t *>(data);
+    if (!bytes || size < sizeof(kKtx1Identifier)) {
+        error = "file is too small to be a KTX container";
+    } else if (memcmp(bytes, kKtx1Identifier, sizeof(kKtx1Identifier)) == 0) {
+        parsed = parseKtx1(bytes, size, outContainer, error);
+    } else if (memcmp(bytes, kKtx2Identifier, sizeof(kKtx2Identifier)) == 0) {
+        parsed = parseKtx2(bytes, size, outContainer, error);
+    } else {
+        error = "missing KTX identifier";
+    }
+
+    if (!parsed) {
+        outContainer = KtxContainer();
+        if (outError) {
+            *outError = error;
+        }
+    }
+    return parsed;
+}
+
+bool KtxContainer::isAstc() const {
+    return (glInternalFormat_ >= kGlCompressedRgbaAstc4x4
+            && glInternalFormat_ < kGlCompressedRgbaAstc4x4 + kAstcFootprintCount)
+           || (glInternalFormat_ >= kGlCompressedSrgb8Alpha8Astc4x4
+               && glInternalFormat_ < kGlCompressedSrgb8Alpha8Astc4x4 + kAstcFootprintCount);
+}
+
+size_t KtxContainer::getTotalSize() const {
+    size_t total = 0;
+    for (const auto &level: levels_) {
+        total += level.size;
+    }
+    return total;
+}
+
+bool KtxContainer::findGlFormat(uint32_t glInternalFormat, FormatInfo &outInfo) {
+    outInfo = {glInternalFormat, 0, 0, 4, 4, 0};
+
+    if (glInternalFormat == kGlRgba8 || glInternalFormat == kGlSrgb8Alpha8) {
+        outInfo = {glInternalFormat, kGlRgba, kGlUnsignedByte, 1, 1, 4};
+        return true;
+    }
+
+    // ETC2/EAC: R11, signed R11, RGB8, SRGB8 and both punchthrough variants use 8 byte blocks, the
+    // formats carrying a separate alpha or second channel use 16 byte blocks.
+    if (glInternalFormat >= kGlCompressedR11Eac
+        && glInternalFormat <= kGlCompressedSrgb8Alpha8Etc2Eac) {
+        switch (glInternalFormat - kGlCompressedR11Eac) {
+            case 2: // GL_COMPRESSED_RG11_EAC
+            case 3: // GL_COMPRESSED_SIGNED_RG11_EAC
+            case 8: // GL_COMPRESSED_RGBA8_ETC2_EAC
+            case 9: // GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC
+                outInfo.bytesPerBlock = 16;
+                break;
+            default:
+                outInfo.bytesPerBlock = 8;
+                break;
+        }
+        return true;
+    }
+
+    for (uint32_t i = 0; i < kAstcFootprintCount; i++) {
+        if (glInternalFormat == kGlCompressedRgbaAstc4x4 + i
+            || glInternalFormat == kGlCompressedSrgb8Alpha8Astc4x4 + i) {
+            outInfo.blockWidth = kAstcFootprints[i][0];
+            outInfo.blockHeight = kAstcFootprints[i][1];
+            outInfo.bytesPerBlock = 16;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool KtxContainer::findVkFormat(uint32_t vkFormat, FormatInfo &outInfo) {
+    if (vkFormat == kVkFormatR8G8B8A8Unorm) {
+        return findGlFormat(kGlRgba8, outInfo);
+    }
+    if (vkFormat == kVkFormatR8G8B8A8Srgb) {
+        return findGlFormat(kGlSrgb8Alpha8, outInfo);
+    }
+
+    // Vulkan lists ETC2 before EAC, GL lists EAC first
+    if (vkFormat >= kVkFormatEtc2R8G8B8Unorm && vkFormat <= kVkFormatEacR11G11SnormBlock) {
+        uint32_t offset = vkFormat - kVkFormatEtc2R8G8B8Unorm;
+        uint32_t glInternalFormat = offset < 6
+                                    ? kGlCompressedRgb8Etc2 + offset
+                                    : kGlCompressedR11Eac + (offset - 6);
+        return findGlFormat(glInternalFormat, outInfo);
+    }
+
+    // Vulkan interleaves UNORM and SRGB for each ASTC footprint
+    if (vkFormat >= kVkFormatAstc4x4Unorm && vkFormat <= kVkFormatAstc12x12Srgb) {
+        uint32_t offset = vkFormat - kVkFormatAstc4x4Unorm;
+        uint32_t glInternalFormat = (offset % 2 == 0)
+                                    ? kGlCompressedRgbaAstc4x4 + offset / 2
+                                    : kGlCompressedSrgb8Alpha8Astc4x4 + offset / 2;
+        return findGlFormat(glInternalFormat, outInfo);
+    }
+    return false;
+}
+
+size_t KtxContainer::expectedLevelSize(const FormatInfo &info, uint32_t width, uint32_t height) {
+    size_t blocksX = (width + info.blockWidth - 1) / info.blockWidth;
+    size_t blocksY = (height + info.blockHeight - 1) / info.blockHeight;
+    return blocksX * blocksY * info.bytesPerBlock;
+}
+
+bool KtxContainer::parseKtx1(const uint8_t *data, size_t size, KtxContainer &out,
+                             std::string &error) {
+    if (size < kKtx1HeaderSize) {
+        error = "truncated KTX header";
+        return false;
+    }
+
+    const uint8_t *header = data + sizeof(kKtx1Identifier);
+    uint32_t endianness = readU32(header + 0);
+    uint32_t glType = readU32(header + 4);
+    uint32_t glFormat = readU32(header + 12);
+    uint32_t glInternalFormat = readU32(header + 16);
+    uint32_t pixelWidth = readU32(header + 24);
+    uint32_t pixelHeight = readU32(header + 28);
+    uint32_t pixelDepth = readU32(header + 32);
+    uint32_t arrayElements = readU32(header + 36);
+    uint32_t faces = readU32(header + 40);
+    uint32_t levelCount = readU32(header + 44);
+    uint32_t keyValueBytes = readU32(header + 48);
+
+    if (endianness != kKtx1Endianness) {
+        error = "big endian KTX files are not supported";
+        return false;
+    }
+    if (pixelWidth == 0 || pixelHeight == 0 || pixelDepth > 1 || arrayElements != 0
+        || faces != 1) {
+        error = "only single 2D images are supported";
+        return false;
+    }
+
+    FormatInfo info;
+    if (!findGlFormat(glInternalFormat, info)
+        || (glType != 0 && (glType != info.glType || glFormat != info.glFormat))) {
+        error = "unsupported GL internal format " + std::to_string(glInternalFormat);
+        return false;
+    }
+
+    if (levelCount == 0) {
+        levelCount = 1;
+    }
+    if (levelCount > 32) {
+        error = "invalid mip level count";
+        return false;
+    }
+
+    size_t offset = kKtx1HeaderSize + keyValueBytes;
+    for (size_t level = 0; level < levelCount; level++) {
+        if (offset + sizeof(uint32_t) > size) {
+            error = "truncated mip level " + std::to_string(level);
+            return false;
+        }
+        uint32_t imageSize = readU32(data + offset);
+        offset += sizeof(uint32_t);
+
+        uint32_t width = mipDimension(pixelWidth, level);
+        uint32_t height = mipDimension(pixelHeight, level);
+        if (imageSize != expectedLevelSize(info, width, height) || offset + imageSize > size) {
+            error = "bad size for mip level " + std::to_string(level);
+            return false;
+        }
+
+        out.levels_.push_back({width, height, data + offset, imageSize});
+
+        // Each level is padded to a multiple of 4 bytes
+        offset += (imageSize + 3) & ~size_t(3);
+    }
+
+    out.glInternalFormat_ = info.glInternalFormat;
+    out.glFormat_ = info.glFormat;
+    out.glType_ = info.glType;
+    return true;
+}
+
+bool KtxContainer::parseKtx2(const uint8_t *data, size_t size, KtxContainer &out,
+                             std::string &error) {
+    if (size < kKtx2HeaderSize) {
+        error = "truncated KTX2 header";
+        return false;
+    }
+
+    const uint8_t *header = data + sizeof(kKtx2Identifier);
+    uint32_t vkFormat = readU32(header + 0);
+    uint32_t pixelWidth = readU32(header + 8);
+    uint32_t pixelHeight = readU32(header + 12);
+    uint32_t pixelDepth = readU32(header + 16);
+    uint32_t layerCount = readU32(header + 20);
+    uint32_t faceCount = readU32(header + 24);
+    uint32_t levelCount = readU32(header + 28);
+    uint32_t supercompression = readU32(header + 32);
+
+    if (supercompression != 0) {
+        error = "supercompressed KTX2 files are not supported";
+        return false;
+    }
+    if (pixelWidth == 0 || pixelHeight == 0 || pixelDepth != 0 || layerCount != 0
+        || faceCount != 1) {
+        error = "only single 2D images are supported";
+        return false;
+    }
+
+    FormatInfo info;
+    if (!findVkFormat(vkFormat, info)) {
+        error = "unsupported Vulkan format " + std::to_string(vkFormat);
+        return false;
+    }
+
+    if (levelCount == 0) {
+        levelCount = 1;
+    }
+    if (levelCount > 32 || kKtx2HeaderSize + levelCount * kKtx2LevelIndexEntrySize > size) {
+        error = "invalid mip level index";
+        return false;
+    }
+
+    const uint8_t *levelIndex = data + kKtx2HeaderSize;
+    for (size_t level = 0; level < levelCount; level++) {
+        const uint8_t *entry = levelIndex + level * kKtx2LevelIndexEntrySize;
+        uint64_t byteOffset = readU64(entry);
+        uint64_t byteLength = readU64(entry + 8);
+
+        uint32_t width = mipDimension(pixelWidth, level);
+        uint32_t height = mipDimension(pixelHeight, level);
+        if (byteLength != expectedLevelSize(info, width, height)
+            || byteOffset > size || byteLength > size - byteOffset) {
+            error = "bad size for mip level " + std::to_string(level);
+            return false;
+        }
+
+        out.levels_.push_back({width, height, data + byteOffset, size_t(byteLength)});
+    }
+
+    out.glInternalFormat_ = info.glInternalFormat;
+    out.glFormat_ = info.glFormat;
+    out.glType_ = info.glType;
+    return true;
+}
@@ -0,0 +1,116 @@
+#ifndef HOLOPERSONA_KTXCONTAINER_H
+#define HOLOPERSONA_KTXCONTAINER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*!
+ * A parsed KTX 1.1 or KTX 2.0 texture container holding a single 2D image with an optional
+ * pre-built mip chain.
+ *
+ * Only the container is interpreted here. The level payloads are pointers into the caller's
+ * buffer and are handed to the GPU untouched, so the buffer must outlive the container. This
+ * class has no GL or Android dependencies, which lets the parsing be exercised on a desktop host
+ * without a GPU; @a TextureAsset does the actual upload.
+ */
+class KtxContainer {
+public:
+    /*!
+     * A single mip level. Level 0 is the full resolution image.
+     */
+    struct Level {
+        uint32_t width;
+        uint32_t height;
+        const uint8_t *data;
+        size_t size;
+    };
+
+    /*!
+     * @param data the start of the file contents
+     * @param size the size of the file contents in bytes
+     * @return true if the buffer starts with a KTX 1.1 or KTX 2.0 identifier
+     */
+    static bool isKtx(const void *data, size_t size);
+
+    /*!
+     * Parses a KTX 1.1 or KTX 2.0 file. Cube maps, arrays, 3D textures and supercompressed KTX 2.0
+     * files are rejected, as are files whose level sizes don't match their format.
+     *
+     * @param data the start of the file contents, must outlive @a outContainer
+     * @param size the size of the file contents in bytes
+     * @param outContainer the container to fill in
+     * @param outError if not null, receives a description of why parsing failed
+     * @return true if successful, false otherwise
+     */
+    static bool parse(const void *data,
+                      size_t size,
+                      KtxContainer &outContainer,
+                      std::string *outError = nullptr);
+
+    /*!
+     * @return the sized GL internal format, eg GL_COMPRESSED_RGBA8_ETC2_EAC or GL_RGBA8
+     */
+    inline uint32_t getGlInternalFormat() const { return glInternalFormat_; }
+
+    /*!
+     * @return the GL pixel format for uncompressed data, 0 for compressed formats
+     */
+    inline uint32_t getGlFormat() const { return glFormat_; }
+
+    /*!
+     * @return the GL pixel type for uncompressed data, 0 for compressed formats
+     */
+    inline uint32_t getGlType() const { return glType_; }
+
+    inline bool isCompressed() const { return glType_ == 0; }
+
+    /*!
+     * @return true if the payload needs GL_KHR_texture_compression_astc_ldr to be uploaded
+     */
+    bool isAstc() const;
+
+    inline uint32_t getWidth() const { return levels_.empty() ? 0 : levels_[0].width; }
+
+    inline uint32_t getHeight() const { return levels_.empty() ? 0 : levels_[0].height; }
+
+    inline size_t getLevelCount() const { return levels_.size(); }
+
+    inline const Level &getLevel(size_t level) const { return levels_[level]; }
+
+    /*!
+     * @return the total number of payload bytes across all levels, ie the VRAM the texture needs
+     */
+    size_t getTotalSize() const;
+
+private:
+    /*!
+     * Describes how a format is laid out in memory so level sizes can be validated
+     */
+    struct FormatInfo {
+        uint32_t glInternalFormat;
+        uint32_t glFormat;
+        uint32_t glType;
+        uint32_t blockWidth;
+        uint32_t blockHeight;
+        uint32_t bytesPerBlock;
+    };
+
+    static bool findGlFormat(uint32_t glInternalFormat, FormatInfo &outInfo);
+
+    static bool findVkFormat(uint32_t vkFormat, FormatInfo &outInfo);
+
+    static size_t expectedLevelSize(const FormatInfo &info, uint32_t width, uint32_t height);
+
+    static bool parseKtx1(const uint8_t *data, size_t size, KtxContainer &out, std::string &error);
+
+    static bool parseKtx2(const uint8_t *data, size_t size, KtxContainer &out, std::string &error);
+
+    uint32_t glInternalFormat_ = 0;
+    uint32_t glFormat_ = 0;
+    uint32_t glType_ = 0;
+    std::vector<Level> levels_;
+};
+
+#endif //HOLOPERSONA_KTXCONTAINER_H
@@ -0,0 +1,247 @@
+#include "Log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+// Records on the ring, and the size of each. Whatever a record's arguments leave over holds the
+// strings it copied.
+constexpr size_t kRecordCount = 256;
+constexpr size_t kRecordSize = 512;
+// The longest line written to logcat
+constexpr size_t kMaxLineLength = 1024;
+
+struct Record {
+    std::atomic<uint64_t> sequence;
+    int64_t timeNanos;
+    const LogSite *site;
+    size_t argCount;
+    LogArg args[Log::kMaxArgs];
+    char text[kRecordSize - sizeof(std::atomic<uint64_t>) - sizeof(int64_t) - sizeof(LogSite *)
+              - sizeof(size_t) - sizeof(LogArg) * Log::kMaxArgs];
+};
+static_assert(sizeof(Record) == kRecordSize, "Records should pack into kRecordSize");
+
+int64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*!
+ * Formats a record printf style into @a out. Integers were widened to 64 bits when they were
+ * captured, so each conversion's length modifier is swapped for the one that matches.
+ * @param text the strings the record copied, null if its string arguments still point at the
+ *     caller's
+ * @return the length of the line, at most @a outSize - 1
+ */
+size_t formatRecord(const LogSite &site, int64_t timeNanos, const LogArg *args, size_t argCount,
+                    const char *text, char *out, size_t outSize) {
+    size_t length = 0;
+    auto append = [&](int written) {
+        if (written > 0) {
+            length = std::min(length + size_t(written), outSize - 1);
+        }
+    };
+
+    append(snprintf(out, outSize, "[%lld.%06lld] ", (long long) (timeNanos / 1000000000),
+                    (long long) (timeNanos / 1000 % 1000000)));
+
+    size_t argIndex = 0;
+    for (const char *c = site.format; *c && length < outSize - 1; c++) {
+        if (*c != '%') {
+            out[length++] = *c;
+            continue;
+        }
+        if (c[1] == '%') {
+            out[length++] = '%';
+            c++;
+            continue;
+        }
+
+        // Keep the flags, width and precision, drop the length modifier
+        char spec[32] = "%";
+        size_t specLength = 1;
+        for (c++; *c && strchr("-+ #0123456789.", *c) && specLength < sizeof(spec) - 4; c++) {
+            spec[specLength++] = *c;
+        }
+        while (*c && strchr("hlLqjzt", *c)) {
+            c++;
+        }
+        if (!*c) {
+            break;
+        }
+        char conversion = *c;
+        if (argIndex >= argCount) {
+            append(snprintf(out + length, outSize - length, "<missing>"));
+            continue;
+        }
+        const LogArg &arg = args[argIndex++];
+        char *end = out + length;
+        size_t space = outSize - length;
+
+        if (strchr("di", conversion)) {
+            strcpy(spec + specLength, "lld");
+            append(snprintf(end, space, spec, (long long) arg.i));
+        } else if (strchr("uoxX", conversion)) {
+            spec[specLength] = 'l';
+            spec[specLength + 1] = 'l';
+            spec[specLength + 2] = conversion;
+            spec[specLength + 3] = '\0';
+            append(snprintf(end, space, spec, (unsigned long long) arg.u));
+        } else if (conversion == 'c') {
+            strcpy(spec + specLength, "c");
+            append(snprintf(end, space, spec, int(arg.i)));
+        } else if (strchr("fFeEgGaA", conversion)) {
+            spec[specLength] = conversion;
+            spec[specLength + 1] = '\0';
+            append(snprintf(end, space, spec, arg.d));
+        } else if (conversion == 's') {
+            strcpy(spec + specLength, "s");
+            const char *string = arg.kind != LogArg::STRING ? "?" : text ? text + arg.u : arg.s;
+            append(snprintf(end, space, spec, string ? string : "(null)"));
+        } else if (conversion == 'p') {
+            strcpy(spec + specLength, "p");
+            append(snprintf(end, space, spec, arg.p));
+        }
+    }
+    out[length] = '\0';
+    return length;
+}
+
+/*!
+ * The ring and the thread that drains it. A bounded queue for many producers and one consumer:
+ * each record has a sequence number that tells producers when it's free and the consumer when
+ * it's been written, so a producer only ever contends on claiming its position.
+ */
+class Logger {
+public:
+    Logger() {
+        for (size_t i = 0; i < kRecordCount; i++) {
+            records_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        thread_ = std::thread(&Logger::run, this);
+    }
+
+    void write(const LogSite &site, const LogArg *args, size_t argCount) {
+        int64_t timeNanos = nowNanos();
+
+        size_t textSize = 0;
+        for (size_t i = 0; i < argCount; i++) {
+            if (args[i].kind == LogArg::STRING) {
+                textSize += strlen(args[i].s ? args[i].s : "(null)") + 1;
+            }
+        }
+        if (textSize > sizeof(Record::text)) {
+            // Too long for a record, so it's written straight away and may land out of order
+            writeNow(site, timeNanos, args, argCount);
+            return;
+        }
+
+        uint64_t position = enqueuePosition_.load(std::memory_order_relaxed);
+        Record *record;
+        while (true) {
+            record = &records_[position % kRecordCount];
+            uint64_t sequence = record->sequence.load(std::memory_order_acquire);
+            if (sequence == position) {
+                if (enqueuePosition_.compare_exchange_weak(position, position + 1,
+                                                           std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (sequence < position) {
+                // The consumer hasn't freed this record yet, so the ring is full
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            } else {
+                position = enqueuePosition_.load(std::memory_order_relaxed);
+            }
+        }
+
+        record->timeNanos = timeNanos;
+        record->site = &site;
+        record->argCount = argCount;
+        size_t textOffset = 0;
+        for (size_t i = 0; i < argCount; i++) {
+            record->args[i] = args[i];
+            if (args[i].kind == LogArg::STRING) {
+                const char *string = args[i].s ? args[i].s : "(null)";
+                size_t length = strlen(string) + 1;
+                memcpy(record->text + textOffset, string, length);
+                record->args[i].u = textOffset;
+                textOffset += length;
+            }
+        }
+        record->sequence.store(position + 1, std::memory_order_seq_cst);
+
+        // Wake the thread if it went to sleep on an empty ring. Taking the lock means it's either
+        // still to check the ring, and will see this record, or already waiting for the notify.
+        if (sleeping_.load(std::memory_order_seq_cst)) {
+            { std::lock_guard<std::mutex> lock(mutex_); }
+            wake_.notify_one();
+        }
+    }
+
+private:
+    void writeNow(const LogSite &site, int64_t timeNanos, const LogArg *args, size_t argCount) {
+        char line[kMaxLineLength];
+        formatRecord(site, timeNanos, args, argCount, nullptr, line, sizeof(line));
+        __android_log_write(site.priority, site.tag, line);
+    }
+
+    void run() {
+        uint64_t position = 0;
+        char line[kMaxLineLength];
+        while (true) {
+            Record &record = records_[position % kRecordCount];
+            if (record.sequence.load(std::memory_order_acquire) == position + 1) {
+                formatRecord(*record.site, record.timeNanos, record.args, record.argCount,
+                             record.text, line, sizeof(line));
+                __android_log_write(record.site->priority, record.site->tag, line);
+                record.sequence.store(position + kRecordCount, std::memory_order_release);
+                position++;
+                continue;
+            }
+
+            size_t dropped = dropped_.exchange(0, std::memory_order_relaxed);
+            if (dropped) {
+                __android_log_print(ANDROID_LOG_WARN, Log::kTag,
+                                    "Dropped %zu log messages, the ring was full", dropped);
+            }
+
+            // Sleep until a producer finds us asleep. The timeout only covers a producer that
+            // was mid write when we looked.
+            std::unique_lock<std::mutex> lock(mutex_);
+            sleeping_.store(true, std::memory_order_seq_cst);
+            if (record.sequence.load(std::memory_order_seq_cst) != position + 1) {
+                wake_.wait_for(lock, std::chrono::milliseconds(100));
+            }
+            sleeping_.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    alignas(64) std::atomic<uint64_t> enqueuePosition_{0};
+    alignas(64) std::atomic<size_t> dropped_{0};
+    std::atomic<bool> sleeping_{false};
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    Record records_[kRecordCount];
+    std::thread thread_;
+};
+
+Logger &getLogger() {
+    // Never destroyed, so static destructors can still log
+    static Logger *logger = new Logger();
+    return *logger;
+}
+
+} // namespace
+
+void Log::writeArgs(const LogSite &site, const LogArg *args, size_t count) {
+    getLogger().write(site, args, count);
+}
@@ -0,0 +1,188 @@
+#ifndef HOLOPERSONA_LOG_H
+#define HOLOPERSONA_LOG_H
+
+#include <android/log.h>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// The lowest priority that's compiled in, one of the ANDROID_LOG_* priorities. Calls below it
+// are discarded at compile time along with their arguments. Set by CMake from the build type or
+// the HOLOPERSONA_LOG_LEVEL cache variable, this is the fallback for other builds.
+#ifndef HOLOPERSONA_LOG_LEVEL
+#ifdef NDEBUG
+#define HOLOPERSONA_LOG_LEVEL ANDROID_LOG_INFO
+#else
+#define HOLOPERSONA_LOG_LEVEL ANDROID_LOG_DEBUG
+#endif
+#endif
+
+/*!
+ * A log call in the source. Every call site has its own, made at compile time, and records carry
+ * a pointer to it in place of the format string, which is only read when the record is formatted.
+ */
+struct LogSite {
+    int priority;
+    const char *tag;
+    const char *format;
+};
+
+/*!
+ * One argument of a log call, kept as its raw bits until the record is formatted
+ */
+struct LogArg {
+    enum Kind : uint8_t {
+        INT,
+        UINT,
+        DOUBLE,
+        STRING,     // Copied when the record is written, so temporaries are safe to log
+        POINTER
+    };
+
+    Kind kind;
+    union {
+        int64_t i;
+        uint64_t u;
+        double d;
+        const char *s;
+        const void *p;
+    };
+};
+
+/*!
+ * A logger that's cheap to call from a frame. A call copies its arguments into a record on a
+ * lock-free ring and returns, and a background thread formats the records printf style and
+ * writes them to logcat, each prefixed with the monotonic time it was logged at. If the ring is
+ * full the record is dropped and counted rather than making the caller wait.
+ *
+ * Use it through the LOG_* macros, which check the format against the arguments at compile time
+ * and compile out anything below HOLOPERSONA_LOG_LEVEL:
+ *
+ * ex:
+ *  LOG_DEBUG("Loaded %s with %zu vertices", path.c_str(), vertices.size());
+ *
+ * Logging from every frame should be throttled with LOG_EVERY or LOG_ONCE, which also guard any
+ * work done only for the log:
+ *
+ * ex:
+ *  if (LOG_EVERY(ANDROID_LOG_DEBUG, 2000)) {
+ *      LOG_DEBUG("Drawing %zu models", models.size());
+ *  }
+ */
+class Log {
+public:
+    // The tag every message is written under
+    static constexpr const char *kTag = "AO";
+    // The most arguments a call can take
+    static constexpr size_t kMaxArgs = 8;
+
+    /*!
+     * Queues a record for @a site, use the LOG_* macros rather than calling this directly
+     */
+    template<typename... Args>
+    static void write(const LogSite &site, Args... args) {
+        static_assert(sizeof...(Args) <= kMaxArgs, "Too many arguments to log");
+        const LogArg packed[sizeof...(Args) + 1] = {makeArg(args)..., {}};
+        writeArgs(site, packed, sizeof...(Args));
+    }
+
+    /*!
+     * Never called, only there so the compiler checks a format against its arguments
+     */
+    __attribute__((format(printf, 1, 2)))
+    static inline void checkFormat(const char *, ...) {}
+
+private:
+    static void writeArgs(const LogSite &site, const LogArg *args, size_t count);
+
+    template<typename T>
+    static LogArg makeArg(T value) {
+        LogArg arg;
+        if constexpr (std::is_enum_v<T>) {
+            arg.kind = LogArg::INT;
+            arg.i = static_cast<int64_t>(value);
+        } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            arg.kind = LogArg::INT;
+            arg.i = value;
+        } else if constexpr (std::is_integral_v<T>) {
+            arg.kind = LogArg::UINT;
+            arg.u = value;
+        } else if constexpr (std::is_floating_point_v<T>) {
+            arg.kind = LogArg::DOUBLE;
+            arg.d = value;
+        } else if constexpr (std::is_convertible_v<T, const char *>) {
+            arg.kind = LogArg::STRING;
+            arg.s = value;
+        } else {
+            static_assert(std::is_pointer_v<T>, "Log arguments are numbers, strings or pointers");
+            arg.kind = LogArg::POINTER;
+            arg.p = value;
+        }
+        return arg;
+    }
+};
+
+/*!
+ * Lets one call site through at most once per interval, from any number of threads
+ */
+class LogRateLimit {
+public:
+    explicit constexpr LogRateLimit(int64_t intervalMillis)
+            : intervalNanos_(intervalMillis * 1000000) {}
+
+    /*!
+     * @return true if the interval has passed since the last time this returned true
+     */
+    bool tryAcquire() {
+        int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        int64_t next = next_.load(std::memory_order_relaxed);
+        return now >= next
+               && next_.compare_exchange_strong(next, now + intervalNanos_, std::memory_order_relaxed);
+    }
+
+private:
+    int64_t intervalNanos_;
+    std::atomic<int64_t> next_{0};
+};
+
+/*!
+ * True at most once every @a intervalMillis for this call site, and always false when
+ * @a priority is compiled out
+ */
+#define LOG_EVERY(priority, intervalMillis) \
+    ((priority) >= HOLOPERSONA_LOG_LEVEL && []() { \
+        static LogRateLimit limit(intervalMillis); \
+        return limit.tryAcquire(); \
+    }())
+
+/*!
+ * True the first time this call site is reached, and always false when @a priority is compiled
+ * out
+ */
+#define LOG_ONCE(priority) \
+    ((priority) >= HOLOPERSONA_LOG_LEVEL && []() { \
+        static std::atomic<bool> done{false}; \
+        return !done.exchange(true, std::memory_order_relaxed); \
+    }())
+
+#define HOLOPERSONA_LOG(priority, format, ...) \
+    do { \
+        if constexpr ((priority) >= HOLOPERSONA_LOG_LEVEL) { \
+            static constexpr LogSite kLogSite = {(priority), Log::kTag, format}; \
+            if (false) { \
+                Log::checkFormat(format, ##__VA_ARGS__); \
+            } \
+            Log::write(kLogSite, ##__VA_ARGS__); \
+        } \
+    } while (false)
+
+#define LOG_VERBOSE(...) HOLOPERSONA_LOG(ANDROID_LOG_VERBOSE, __VA_ARGS__)
+#define LOG_DEBUG(...) HOLOPERSONA_LOG(ANDROID_LOG_DEBUG, __VA_ARGS__)
+#define LOG_INFO(...) HOLOPERSONA_LOG(ANDROID_LOG_INFO, __VA_ARGS__)
+#define LOG_WARN(...) HOLOPERSONA_LOG(ANDROID_LOG_WARN, __VA_ARGS__)
+#define LOG_ERROR(...) HOLOPERSONA_LOG(ANDROID_LOG_ERROR, __VA_ARGS__)
+
+#endif //HOLOPERSONA_LOG_H
@@ -1,6 +1,8 @@
 #ifndef ANDROIDGLINVESTIGATIONS_MODEL_H
 #define ANDROIDGLINVESTIGATIONS_MODEL_H
 
+#include <algorithm>
+#include <cmath>
 #include <vector>
 #include "TextureAsset.h"
 
@@ -21,30 +23,65 @@ union Vector2 {
     float idx[2];
 };
 
+/*!
+ * A vertex can be skinned to up to 4 joints. Weights are stored as bytes that sum to 255, and
+ * unused influences have a weight of 0. A vertex that isn't skinned is fully bound to joint 0.
+ */
 struct Vertex {
+    static constexpr int kMaxInfluences = 4;
+
     constexpr Vertex(const Vector3 &inPosition, const Vector2 &inUV) : position(inPosition),
                                                                        uv(inUV) {}
 
+    /*!
+     * Creates a vertex rigidly bound to a single joint
+     */
+    constexpr Vertex(const Vector3 &inPosition, const Vector2 &inUV, uint8_t joint)
+            : position(inPosition),
+              uv(inUV),
+              joints{joint, 0, 0, 0} {}
+
     Vector3 position;
     Vector2 uv;
+    uint8_t joints[kMaxInfluences] = {0, 0, 0, 0};
+    uint8_t weights[kMaxInfluences] = {255, 0, 0, 0};
 };
 
 typedef uint16_t Index;
 
+class Skeleton;
+
 class Model {
 public:
+    /*!
+     * @param spSkeleton the joints the vertices are skinned to, or null for a model that isn't
+     *     skinned
+     */
     inline Model(
             std::vector<Vertex> vertices,
             std::vector<Index> indices,
-            std::shared_ptr<TextureAsset> spTexture)
+            std::shared_ptr<TextureAsset> spTexture,
+            std::shared_ptr<const Skeleton> spSkeleton = nullptr)
             : vertices_(std::move(vertices)),
               indices_(std::move(indices)),
-              spTexture_(std::move(spTexture)) {}
+              spTexture_(std::move(spTexture)),
+              spSkeleton_(std::move(spSkeleton)),
+              boundingRadius_(0.f) {
+        updateBoundingRadius();
+    }
 
     inline const Vertex *getVertexData() const {
         return vertices_.data();
     }
 
+    /*!
+     * @return the vertices, for systems that reshape the rest pose in place such as morph
+     *     targets. Call @a updateBoundingRadius once they're done.
+     */
+    inline Vertex *getMutableVertexData() {
+        return vertices_.data();
+    }
+
     inline const size_t getVertexCount() const {
         return vertices_.size();
     }
@@ -61,10 +98,45 @@ public:
         return *spTexture_;
     }
 
+    /*!
+     * @return the texture as a shared pointer, for systems that update it such as mip streaming
+     */
+    inline const std::shared_ptr<TextureAsset> &getSharedTexture() const {
+        return spTexture_;
+    }
+
+    /*!
+     * @return the skeleton the model is skinned to, or null if it isn't skinned
+     */
+    inline const std::shared_ptr<const Skeleton> &getSkeleton() const {
+        return spSkeleton_;
+    }
+
+    /*!
+     * @return the radius of a sphere around the model's origin that contains every vertex in the
+     *     rest pose
+     */
+    inline float getBoundingRadius() const {
+        return boundingRadius_;
+    }
+
+    /*!
+     * Recomputes the bounding radius after the vertices moved
+     */
+    inline void updateBoundingRadius() {
+        boundingRadius_ = 0.f;
+        for (const auto &vertex: vertices_) {
+            const auto &p = vertex.position;
+            boundingRadius_ = std::max(boundingRadius_, std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z));
+        }
+    }
+
 private:
     std::vector<Vertex> vertices_;
     std::vector<Index> indices_;
     std::shared_ptr<TextureAsset> spTexture_;
+    std::shared_ptr<const Skeleton> spSkeleton_;
+    float boundingRadius_;
 };
 
 #endif //ANDROIDGLINVESTIGATIONS_MODEL_H
\ No newline at end of file
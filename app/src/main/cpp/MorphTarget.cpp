@@ -0,0 +1,110 @@
+#include "MorphTarget.h"
+
+#include <cmath>
+
+#include "AndroidOut.h"
+#include "Simd.h"
+
+MorphTarget MorphTarget::fromShapes(const std::string &name,
+                                    const std::vector<Vertex> &base,
+                                    const std::vector<Vertex> &shape) {
+    MorphTarget target;
+    target.name_ = name;
+    if (base.size() != shape.size()) {
+        aout << "MorphTarget: " << name << " has " << shape.size() << " vertices, the base has "
+             << base.size() << std::endl;
+        return target;
+    }
+
+    for (size_t i = 0; i < base.size(); i++) {
+        float dx = shape[i].position.x - base[i].position.x;
+        float dy = shape[i].position.y - base[i].position.y;
+        float dz = shape[i].position.z - base[i].position.z;
+        if (std::fabs(dx) < kMinDelta && std::fabs(dy) < kMinDelta && std::fabs(dz) < kMinDelta) {
+            continue;
+        }
+        target.indices_.push_back(static_cast<uint32_t>(i));
+        target.deltas_.insert(target.deltas_.end(), {dx, dy, dz, 0.f});
+    }
+    return target;
+}
+
+size_t MorphTargetSet::addTarget(MorphTarget target, const std::vector<Vertex> &base) {
+    // Merge the target's vertices into the sorted set of touched ones
+    std::vector<uint32_t> indices;
+    std::vector<Vector3> positions;
+    indices.reserve(baseIndices_.size() + target.indices_.size());
+    positions.reserve(indices.capacity());
+    size_t a = 0, b = 0;
+    while (a < baseIndices_.size() || b < target.indices_.size()) {
+        bool takeOld = b == target.indices_.size()
+                       || (a < baseIndices_.size() && baseIndices_[a] <= target.indices_[b]);
+        if (takeOld) {
+            if (b < target.indices_.size() && baseIndices_[a] == target.indices_[b]) {
+                b++;
+            }
+            indices.push_back(baseIndices_[a]);
+            positions.push_back(basePositions_[a]);
+            a++;
+        } else {
+            indices.push_back(target.indices_[b]);
+            positions.push_back(base[target.indices_[b]].position);
+            b++;
+        }
+    }
+    baseIndices_ = std::move(indices);
+    basePositions_ = std::move(positions);
+
+    targets_.push_back({std::move(target), 0.f});
+    return targets_.size() - 1;
+}
+
+void MorphTargetSet::setWeight(size_t index, float weight, Vertex *vertices) {
+    Entry &entry = targets_[index];
+    float change = weight - entry.weight;
+    if (change == 0.f) {
+        return;
+    }
+    entry.weight = weight;
+
+    if (++updatesSinceRebuild_ >= kUpdatesPerRebuild) {
+        rebuild(vertices);
+    } else {
+        applyDeltas(entry.target, change, vertices);
+    }
+}
+
+void MorphTargetSet::rebuild(Vertex *vertices) {
+    for (size_t i = 0; i < baseIndices_.size(); i++) {
+        vertices[baseIndices_[i]].position = basePositions_[i];
+    }
+    for (const auto &entry: targets_) {
+        if (entry.weight != 0.f) {
+            applyDeltas(entry.target, entry.weight, vertices);
+        }
+    }
+    updatesSinceRebuild_ = 0;
+}
+
+void MorphTargetSet::applyDeltas(const MorphTarget &target, float weight, Vertex *vertices) {
+    const uint32_t *indices = target.indices_.data();
+    const float *deltas = target.deltas_.data();
+    size_t count = target.indices_.size();
+
+#if defined(HOLOPERSONA_SIMD)
+    // One vertex per vector. The load picks up the u coordinate after the position as its fourth
+    // lane, which gets a delta of zero and is stored back unchanged.
+    Float4 w = splat4(weight);
+    for (size_t i = 0; i < count; i++) {
+        float *position = reinterpret_cast<float *>(&vertices[indices[i]]);
+        store4(position, madd4(load4(position), load4(deltas + i * 4), w));
+    }
+#else
+    for (size_t i = 0; i < count; i++) {
+        Vector3 &position = vertices[indices[i]].position;
+        position.x += deltas[i * 4] * weight;
+        position.y += deltas[i * 4 + 1] * weight;
+        position.z += deltas[i * 4 + 2] * weight;
+    }
+#endif
+}
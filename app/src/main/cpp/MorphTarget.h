@@ -0,0 +1,110 @@
+#ifndef HOLOPERSONA_MORPHTARGET_H
+#define HOLOPERSONA_MORPHTARGET_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Model.h"
+
+/*!
+ * A blend shape: how far each vertex of a base mesh moves at a weight of 1. Only the vertices
+ * that actually move are stored, so a target that reshapes an arm costs nothing for the rest of
+ * the body.
+ */
+class MorphTarget {
+public:
+    /*!
+     * Builds a target from two versions of the same mesh
+     * @param name a name for the target
+     * @param base the mesh the target is applied to
+     * @param shape the same vertices, in the same order, moved into the target shape
+     * @return the target, empty if the meshes have different vertex counts
+     */
+    static MorphTarget fromShapes(const std::string &name,
+                                  const std::vector<Vertex> &base,
+                                  const std::vector<Vertex> &shape);
+
+    inline const std::string &getName() const { return name_; }
+
+    //! @return the number of vertices the target moves
+    inline size_t getDeltaCount() const { return indices_.size(); }
+
+    //! @return the memory the deltas take
+    inline size_t getByteSize() const {
+        return indices_.size() * sizeof(uint32_t) + deltas_.size() * sizeof(float);
+    }
+
+private:
+    friend class MorphTargetSet;
+
+    // Moves smaller than this are treated as no move at all
+    static constexpr float kMinDelta = 1e-5f;
+
+    std::string name_;
+    std::vector<uint32_t> indices_;
+
+    // Four floats per index, x y z and a zero, so a delta is one vector load
+    std::vector<float> deltas_;
+};
+
+/*!
+ * The morph targets of a mesh and their weights. Changing a weight moves the vertices by the
+ * change in weight times the target's deltas, so only the vertices of targets whose weight
+ * changed are touched. The positions a target touches are remembered so rounding errors from
+ * many small changes can be cleared out.
+ */
+class MorphTargetSet {
+public:
+    /*!
+     * Adds a target at a weight of 0
+     * @param base the vertices the target was built against, used for @a rebuild
+     * @return the index of the target
+     */
+    size_t addTarget(MorphTarget target, const std::vector<Vertex> &base);
+
+    inline size_t getTargetCount() const { return targets_.size(); }
+
+    inline const MorphTarget &getTarget(size_t index) const { return targets_[index].target; }
+
+    inline float getWeight(size_t index) const { return targets_[index].weight; }
+
+    /*!
+     * Moves the vertices from the target's current weight to a new one
+     * @param index the target
+     * @param weight the new weight, usually between 0 and 1
+     * @param vertices the mesh the targets were built against, with the set's current weights
+     *     applied
+     */
+    void setWeight(size_t index, float weight, Vertex *vertices);
+
+    /*!
+     * Sets every vertex a target touches back to its base position and reapplies the weights,
+     * clearing the rounding error of incremental updates
+     */
+    void rebuild(Vertex *vertices);
+
+private:
+    // Incremental updates between rebuilds, each adds at most one rounding error per vertex
+    static constexpr uint32_t kUpdatesPerRebuild = 256;
+
+    struct Entry {
+        MorphTarget target;
+        float weight;
+    };
+
+    /*!
+     * Adds @a weight times a target's deltas to the vertices
+     */
+    static void applyDeltas(const MorphTarget &target, float weight, Vertex *vertices);
+
+    std::vector<Entry> targets_;
+
+    // Base positions of every vertex a target touches, sorted by index
+    std::vector<uint32_t> baseIndices_;
+    std::vector<Vector3> basePositions_;
+
+    uint32_t updatesSinceRebuild_ = 0;
+};
+
+#endif //HOLOPERSONA_MORPHTARGET_H
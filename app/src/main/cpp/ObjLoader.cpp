@@ -1,5 +1,7 @@
 #include "ObjLoader.h"
 #include "AndroidOut.h"
+#include "JobSystem.h"
+#include "Profiler.h"
 #include <sstream>
 #include <algorithm>
 
@@ -41,17 +43,110 @@ bool ObjLoader::loadFromAssets(AAssetManager* assetManager,
 bool ObjLoader::loadFromString(const std::string& objData,
                               std::vector<Vertex>& vertices,
                               std::vector<Index>& indices) {
+    PROFILE_ZONE("ObjLoader::loadFromString");
     vertices.clear();
     indices.clear();
     
+    // Split the file into chunks of whole lines, a few per thread
+    JobSystem &jobSystem = JobSystem::shared();
+    size_t chunkSize = std::max(kMinChunkSize,
+                                objData.size() / ((jobSystem.getWorkerCount() + 1) * 4) + 1);
+    std::vector<Chunk> chunks;
+    for (size_t begin = 0; begin < objData.size();) {
+        size_t end = objData.find('\n', std::min(begin + chunkSize, objData.size()) - 1);
+        end = end == std::string::npos ? objData.size() : end + 1;
+        chunks.emplace_back(begin, end);
+        begin = end;
+    }
+    
+    // Relative indices count back from the line they're on, so every chunk needs to know how many
+    // vertices came before it. Each chunk is counted first, then once they all have been the
+    // chunks are parsed knowing their starting counts.
+    JobCounter counted;
+    JobCounter parsed;
+    for (auto& chunk : chunks) {
+        jobSystem.run(counted, [&objData, &chunk]() { countChunk(objData, chunk); });
+    }
+    jobSystem.runAfter(counted, parsed, [&jobSystem, &objData, &chunks, &parsed]() {
+        size_t lineBase = 0, vertexBase = 0, texCoordBase = 0;
+        for (auto& chunk : chunks) {
+            chunk.lineBase = lineBase;
+            chunk.vertexBase = vertexBase;
+            chunk.texCoordBase = texCoordBase;
+            lineBase += chunk.lineCount;
+            vertexBase += chunk.vertexCount;
+            texCoordBase += chunk.texCoordCount;
+        }
+        for (auto& chunk : chunks) {
+            jobSystem.run(parsed, [&objData, &chunk]() { parseChunk(objData, chunk); });
+        }
+    });
+    jobSystem.wait(parsed);
+    
     std::vector<ObjVertex> objVertices;
     std::vector<ObjTexCoord> objTexCoords;
     std::vector<ObjFace> objFaces;
+    for (auto& chunk : chunks) {
+        if (chunk.errorLine) {
+            aout << "ERROR: Failed to parse line " << chunk.errorLine << std::endl;
+            aout << "Exception: " << chunk.error << std::endl;
+            return false;
+        }
+        objVertices.insert(objVertices.end(), chunk.objVertices.begin(), chunk.objVertices.end());
+        objTexCoords.insert(objTexCoords.end(), chunk.objTexCoords.begin(), chunk.objTexCoords.end());
+        objFaces.insert(objFaces.end(), chunk.objFaces.begin(), chunk.objFaces.end());
+    }
+    
+    aout << "DEBUG: Parsed " << objVertices.size() << " vertices, " 
+         << objTexCoords.size() << " texture coords, " 
+         << objFaces.size() << " faces in " << chunks.size() << " chunks" << std::endl;
+    
+    if (objVertices.empty() || objFaces.empty()) {
+        aout << "ERROR: OBJ file contains no geometry" << std::endl;
+        return false;
+    }
+    
+    // Convert to our format
+    convertToModel(objVertices, objTexCoords, objFaces, vertices, indices);
+    
+    aout << "DEBUG: Converted to " << vertices.size() << " vertices, " 
+         << indices.size() << " indices" << std::endl;
+    
+    return true;
+}
+
+void ObjLoader::countChunk(const std::string& objData, Chunk& chunk) {
+    PROFILE_ZONE("ObjLoader::countChunk");
+    // Counts the lines the way parseLine reads them, by their first word
+    size_t position = chunk.begin;
+    while (position < chunk.end) {
+        size_t lineEnd = objData.find('\n', position);
+        lineEnd = lineEnd == std::string::npos || lineEnd > chunk.end ? chunk.end : lineEnd;
+        chunk.lineCount++;
+        
+        size_t wordBegin = objData.find_first_not_of(" \t\r", position);
+        if (wordBegin < lineEnd) {
+            size_t wordEnd = std::min(objData.find_first_of(" \t\r\n", wordBegin), lineEnd);
+            size_t wordLength = wordEnd - wordBegin;
+            if (wordLength == 1 && objData[wordBegin] == 'v') {
+                chunk.vertexCount++;
+            } else if (wordLength == 2 && objData.compare(wordBegin, 2, "vt") == 0) {
+                chunk.texCoordCount++;
+            }
+        }
+        position = lineEnd + 1;
+    }
+}
+
+void ObjLoader::parseChunk(const std::string& objData, Chunk& chunk) {
+    PROFILE_ZONE("ObjLoader::parseChunk");
+    chunk.objVertices.reserve(chunk.vertexCount);
+    chunk.objTexCoords.reserve(chunk.texCoordCount);
     
     // Parse line by line
-    std::istringstream stream(objData);
+    std::istringstream stream(objData.substr(chunk.begin, chunk.end - chunk.begin));
     std::string line;
-    int lineNumber = 0;
+    size_t lineNumber = chunk.lineBase;
     
     while (std::getline(stream, line)) {
         lineNumber++;
@@ -65,34 +160,21 @@ bool ObjLoader::loadFromString(const std::string& objData,
             continue;
         }
         
+        // Jobs mustn't throw, so the error is kept for the loader to report
         try {
-            parseLine(line, objVertices, objTexCoords, objFaces);
+            parseLine(line, chunk.vertexBase, chunk.texCoordBase,
+                      chunk.objVertices, chunk.objTexCoords, chunk.objFaces);
         } catch (const std::exception& e) {
-            aout << "ERROR: Failed to parse line " << lineNumber << ": " << line << std::endl;
-            aout << "Exception: " << e.what() << std::endl;
-            return false;
+            chunk.errorLine = lineNumber;
+            chunk.error = line + ": " + e.what();
+            return;
         }
     }
-    
-    aout << "DEBUG: Parsed " << objVertices.size() << " vertices, " 
-         << objTexCoords.size() << " texture coords, " 
-         << objFaces.size() << " faces" << std::endl;
-    
-    if (objVertices.empty() || objFaces.empty()) {
-        aout << "ERROR: OBJ file contains no geometry" << std::endl;
-        return false;
-    }
-    
-    // Convert to our format
-    convertToModel(objVertices, objTexCoords, objFaces, vertices, indices);
-    
-    aout << "DEBUG: Converted to " << vertices.size() << " vertices, " 
-         << indices.size() << " indices" << std::endl;
-    
-    return true;
 }
 
 void ObjLoader::parseLine(const std::string& line,
+                         size_t vertexBase,
+                         size_t texCoordBase,
                          std::vector<ObjVertex>& objVertices,
                          std::vector<ObjTexCoord>& objTexCoords,
                          std::vector<ObjFace>& objFaces) {
@@ -141,7 +223,8 @@ void ObjLoader::parseLine(const std::string& line,
             if (std::getline(vertexStream, indexStr, '/')) {
                 int vertexIndex = std::stoi(indexStr);
                 // OBJ indices are 1-based, convert to 0-based
-                vertexIndex = (vertexIndex > 0) ? vertexIndex - 1 : vertexIndex + objVertices.size();
+                vertexIndex = (vertexIndex > 0) ? vertexIndex - 1
+                                                : vertexIndex + vertexBase + objVertices.size();
                 
                 if (i == 0) face.v1 = vertexIndex;
                 else if (i == 1) face.v2 = vertexIndex;
@@ -152,7 +235,8 @@ void ObjLoader::parseLine(const std::string& line,
             if (std::getline(vertexStream, indexStr, '/') && !indexStr.empty()) {
                 int texIndex = std::stoi(indexStr);
                 // OBJ indices are 1-based, convert to 0-based
-                texIndex = (texIndex > 0) ? texIndex - 1 : texIndex + objTexCoords.size();
+                texIndex = (texIndex > 0) ? texIndex - 1
+                                           : texIndex + texCoordBase + objTexCoords.size();
                 
                 if (i == 0) face.vt1 = texIndex;
                 else if (i == 1) face.vt2 = texIndex;
@@ -175,38 +259,43 @@ void ObjLoader::convertToModel(const std::vector<ObjVertex>& objVertices,
                               const std::vector<ObjFace>& objFaces,
                               std::vector<Vertex>& vertices,
                               std::vector<Index>& indices) {
-    vertices.clear();
-    indices.clear();
+    // Every face becomes three vertices of its own, so each one's place in the output is known
+    // up front and the faces can be converted in parallel
+    vertices.assign(objFaces.size() * 3, Vertex({0.0f, 0.0f, 0.0f}, {0.0f, 0.0f}));
+    indices.resize(objFaces.size() * 3);
     
-    // For each face, create vertices
-    for (const auto& face : objFaces) {
-        // Get vertex positions
-        const ObjVertex& v1 = objVertices[face.v1];
-        const ObjVertex& v2 = objVertices[face.v2];
-        const ObjVertex& v3 = objVertices[face.v3];
-        
-        // Get texture coordinates (or use defaults)
-        Vector2 uv1{0.0f, 0.0f}, uv2{0.5f, 1.0f}, uv3{1.0f, 0.0f};
-        
-        if (face.vt1 >= 0 && face.vt1 < objTexCoords.size()) {
-            uv1 = {objTexCoords[face.vt1].u, objTexCoords[face.vt1].v};
-        }
-        if (face.vt2 >= 0 && face.vt2 < objTexCoords.size()) {
-            uv2 = {objTexCoords[face.vt2].u, objTexCoords[face.vt2].v};
-        }
-        if (face.vt3 >= 0 && face.vt3 < objTexCoords.size()) {
-            uv3 = {objTexCoords[face.vt3].u, objTexCoords[face.vt3].v};
+    JobSystem::shared().parallelFor(objFaces.size(), 4096, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const ObjFace& face = objFaces[i];
+            
+            // Get vertex positions
+            const ObjVertex& v1 = objVertices[face.v1];
+            const ObjVertex& v2 = objVertices[face.v2];
+            const ObjVertex& v3 = objVertices[face.v3];
+            
+            // Get texture coordinates (or use defaults)
+            Vector2 uv1{0.0f, 0.0f}, uv2{0.5f, 1.0f}, uv3{1.0f, 0.0f};
+            
+            if (face.vt1 >= 0 && face.vt1 < objTexCoords.size()) {
+                uv1 = {objTexCoords[face.vt1].u, objTexCoords[face.vt1].v};
+            }
+            if (face.vt2 >= 0 && face.vt2 < objTexCoords.size()) {
+                uv2 = {objTexCoords[face.vt2].u, objTexCoords[face.vt2].v};
+            }
+            if (face.vt3 >= 0 && face.vt3 < objTexCoords.size()) {
+                uv3 = {objTexCoords[face.vt3].u, objTexCoords[face.vt3].v};
+            }
+            
+            // Create vertices
+            size_t baseIndex = i * 3;
+            vertices[baseIndex + 0] = Vertex(Vector3{v1.x, v1.y, v1.z}, uv1);
+            vertices[baseIndex + 1] = Vertex(Vector3{v2.x, v2.y, v2.z}, uv2);
+            vertices[baseIndex + 2] = Vertex(Vector3{v3.x, v3.y, v3.z}, uv3);
+            
+            // Create indices for triangle
+            indices[baseIndex + 0] = Index(baseIndex + 0);
+            indices[baseIndex + 1] = Index(baseIndex + 1);
+            indices[baseIndex + 2] = Index(baseIndex + 2);
         }
-        
-        // Create vertices
-        Index baseIndex = vertices.size();
-        vertices.emplace_back(Vector3{v1.x, v1.y, v1.z}, uv1);
-        vertices.emplace_back(Vector3{v2.x, v2.y, v2.z}, uv2);
-        vertices.emplace_back(Vector3{v3.x, v3.y, v3.z}, uv3);
-        
-        // Create indices for triangle
-        indices.push_back(baseIndex + 0);
-        indices.push_back(baseIndex + 1);
-        indices.push_back(baseIndex + 2);
-    }
-} 
\ No newline at end of file
+    });
+}
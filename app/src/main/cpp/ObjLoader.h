@@ -9,6 +9,8 @@
 /*!
  * A class for loading 3D models from OBJ files.
  * Supports basic OBJ format with vertices, texture coordinates, and faces.
+ * Large files are split into chunks of lines that are parsed in parallel on the shared
+ * JobSystem.
  */
 class ObjLoader {
 public:
@@ -50,10 +52,50 @@ private:
         int vt1, vt2, vt3;   // Texture coordinate indices
     };
     
+    /*!
+     * A run of whole lines parsed by one job
+     */
+    struct Chunk {
+        Chunk(size_t inBegin, size_t inEnd) : begin(inBegin), end(inEnd) {}
+
+        size_t begin;               // Byte range in the file
+        size_t end;
+        size_t lineCount = 0;
+        size_t vertexCount = 0;
+        size_t texCoordCount = 0;
+        // How many of each there are in the chunks before this one
+        size_t lineBase = 0;
+        size_t vertexBase = 0;
+        size_t texCoordBase = 0;
+        std::vector<ObjVertex> objVertices;
+        std::vector<ObjTexCoord> objTexCoords;
+        std::vector<ObjFace> objFaces;
+        // The line that failed to parse, 0 if they all parsed
+        size_t errorLine = 0;
+        std::string error;
+    };
+    
+    // Fewer bytes than this aren't worth handing to another thread
+    static constexpr size_t kMinChunkSize = 64 * 1024;
+    
+    /*!
+     * Counts the lines, vertices and texture coordinates in a chunk
+     */
+    static void countChunk(const std::string& objData, Chunk& chunk);
+    
+    /*!
+     * Parses every line of a chunk into its own vectors, stopping at the first bad line
+     */
+    static void parseChunk(const std::string& objData, Chunk& chunk);
+    
     /*!
      * Parses a single line from an OBJ file
+     * @param vertexBase the vertices before this chunk, which relative indices count back over
+     * @param texCoordBase the texture coordinates before this chunk
      */
     static void parseLine(const std::string& line,
+                         size_t vertexBase,
+                         size_t texCoordBase,
                          std::vector<ObjVertex>& objVertices,
                          std::vector<ObjTexCoord>& objTexCoords,
                          std::vector<ObjFace>& objFaces);
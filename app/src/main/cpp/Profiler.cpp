@@ -0,0 +1,191 @@
+#include "Profiler.h"
+
+#include <android/trace.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+#include "AndroidOut.h"
+
+namespace {
+
+struct Event {
+    const char *name;
+    int64_t beginNanos;
+    int64_t endNanos;
+};
+
+/*!
+ * An event on the ring. A dump reads it while its thread may be overwriting it, so the fields are
+ * atomics, stored with release so that seeing any of them new means seeing the count that was
+ * stored before it.
+ */
+struct Slot {
+    std::atomic<const char *> name;
+    std::atomic<int64_t> beginNanos;
+    std::atomic<int64_t> endNanos;
+};
+
+/*!
+ * The events of one thread. Only its thread writes to it, a dump reads it alongside, and a
+ * thread that exits hands it on to the next new thread rather than have every short-lived thread
+ * keep one.
+ */
+struct ThreadBuffer {
+    // Guarded by gBuffersMutex
+    int threadId = 0;
+    char threadName[16] = {};
+    bool inUse = false;
+    // The first event written by the current thread, earlier ones belonged to a thread that's gone
+    uint64_t firstEvent = 0;
+
+    // Events written so far, the newest kEventsPerThread of which are still in the ring
+    std::atomic<uint64_t> written{0};
+    Slot slots[Profiler::kEventsPerThread];
+};
+
+std::mutex gBuffersMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> gBuffers;
+
+/*!
+ * Gives a thread's buffer back when the thread exits
+ */
+struct ThreadBufferOwner {
+    ThreadBuffer *buffer = nullptr;
+
+    ~ThreadBufferOwner() {
+        if (buffer) {
+            std::lock_guard<std::mutex> lock(gBuffersMutex);
+            buffer->inUse = false;
+        }
+    }
+};
+
+thread_local ThreadBufferOwner tOwner;
+
+ThreadBuffer &getThreadBuffer() {
+    if (tOwner.buffer) {
+        return *tOwner.buffer;
+    }
+
+    std::lock_guard<std::mutex> lock(gBuffersMutex);
+    auto it = std::find_if(gBuffers.begin(), gBuffers.end(),
+                           [](const auto &buffer) { return !buffer->inUse; });
+    if (it == gBuffers.end()) {
+        gBuffers.push_back(std::make_unique<ThreadBuffer>());
+        it = gBuffers.end() - 1;
+    }
+    ThreadBuffer &buffer = **it;
+    buffer.inUse = true;
+    buffer.threadId = static_cast<int>(syscall(SYS_gettid));
+    prctl(PR_GET_NAME, buffer.threadName, 0, 0, 0);
+    buffer.threadName[sizeof(buffer.threadName) - 1] = '\0';
+    buffer.firstEvent = buffer.written.load(std::memory_order_relaxed);
+    tOwner.buffer = &buffer;
+    return buffer;
+}
+
+/*!
+ * Writes a string for JSON, names are identifiers in practice but thread names are up to the OS
+ */
+void writeJsonString(FILE *file, const char *string) {
+    fputc('"', file);
+    for (const char *c = string; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            fputc('\\', file);
+            fputc(*c, file);
+        } else if (static_cast<unsigned char>(*c) < 0x20) {
+            fprintf(file, "\\u%04x", *c);
+        } else {
+            fputc(*c, file);
+        }
+    }
+    fputc('"', file);
+}
+
+} // namespace
+
+void Profiler::record(const char *name, int64_t beginNanos, int64_t endNanos) {
+    ThreadBuffer &buffer = getThreadBuffer();
+    uint64_t index = buffer.written.load(std::memory_order_relaxed);
+    Slot &slot = buffer.slots[index % kEventsPerThread];
+    slot.name.store(name, std::memory_order_release);
+    slot.beginNanos.store(beginNanos, std::memory_order_release);
+    slot.endNanos.store(endNanos, std::memory_order_release);
+    buffer.written.store(index + 1, std::memory_order_release);
+}
+
+bool Profiler::beginSection(const char *name) {
+    if (!ATrace_isEnabled()) {
+        return false;
+    }
+    ATrace_beginSection(name);
+    return true;
+}
+
+void Profiler::endSection() {
+    ATrace_endSection();
+}
+
+bool Profiler::writeChromeTrace(const char *path) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        aout << "Profiler: couldn't open " << path << " to write the trace" << std::endl;
+        return false;
+    }
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    int processId = static_cast<int>(getpid());
+    size_t eventCount = 0;
+    std::vector<Event> events;
+
+    std::lock_guard<std::mutex> lock(gBuffersMutex);
+    for (const auto &buffer: gBuffers) {
+        // Copy out what's in the ring, then drop anything the thread may have overwritten while
+        // we were copying. Having read part of event i + kEventsPerThread means the count read
+        // after is at least that, and the event that count is up to may be half written, so
+        // everything below count + 1 - kEventsPerThread is suspect.
+        uint64_t end = buffer->written.load(std::memory_order_acquire);
+        uint64_t begin = std::max(buffer->firstEvent,
+                                  end > kEventsPerThread ? end - kEventsPerThread : 0);
+        events.clear();
+        for (uint64_t i = begin; i < end; i++) {
+            const Slot &slot = buffer->slots[i % kEventsPerThread];
+            events.push_back({slot.name.load(std::memory_order_acquire),
+                              slot.beginNanos.load(std::memory_order_acquire),
+                              slot.endNanos.load(std::memory_order_acquire)});
+        }
+        uint64_t written = buffer->written.load(std::memory_order_acquire);
+        size_t overwritten = written + 1 > kEventsPerThread + begin
+                             ? std::min<size_t>(written + 1 - kEventsPerThread - begin,
+                                                events.size())
+                             : 0;
+
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,"
+                      "\"args\":{\"name\":", eventCount ? "," : "", processId, buffer->threadId);
+        writeJsonString(file, buffer->threadName);
+        fprintf(file, "}}");
+        eventCount++;
+
+        for (size_t i = overwritten; i < events.size(); i++) {
+            const Event &event = events[i];
+            fprintf(file, ",\n{\"name\":");
+            writeJsonString(file, event.name);
+            fprintf(file, ",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    processId, buffer->threadId, double(event.beginNanos) / 1000.0,
+                    double(event.endNanos - event.beginNanos) / 1000.0);
+            eventCount++;
+        }
+    }
+    fprintf(file, "]}\n");
+
+    bool written = fclose(file) == 0;
+    aout << "Profiler: wrote " << eventCount << " events to " << path << std::endl;
+    return written;
+}
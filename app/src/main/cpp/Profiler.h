@@ -0,0 +1,100 @@
+#ifndef HOLOPERSONA_PROFILER_H
+#define HOLOPERSONA_PROFILER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Whether the PROFILE_* zones are built in. Set by CMake, this is the fallback for other builds.
+#ifndef HOLOPERSONA_PROFILING
+#define HOLOPERSONA_PROFILING 1
+#endif
+
+/*!
+ * A CPU profiler made of named zones. A zone takes the time as it's entered and left and writes
+ * one event to a ring owned by the calling thread, so recording takes no locks and costs little
+ * more than reading the clock twice. The newest events of every thread can be written out as a
+ * Chrome Trace Event file at any time, which Perfetto (ui.perfetto.dev) and chrome://tracing open.
+ *
+ * While a system trace is capturing the app, zones are also passed on to ATrace, so they show up
+ * next to the framework's own sections.
+ *
+ * ex:
+ *  void loadEverything() {
+ *      PROFILE_ZONE("loadEverything");
+ *      ...
+ *  }
+ */
+class Profiler {
+public:
+    // Events kept per thread, older ones are overwritten. About two seconds of a busy render
+    // thread.
+    static constexpr size_t kEventsPerThread = 8192;
+
+    static inline int64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /*!
+     * Records a finished zone for the calling thread
+     * @param name must outlive the profiler, a string literal in practice
+     */
+    static void record(const char *name, int64_t beginNanos, int64_t endNanos);
+
+    /*!
+     * Starts an ATrace section if a system trace is capturing the app
+     * @return true if a section was started and @a endSection has to be called
+     */
+    static bool beginSection(const char *name);
+
+    static void endSection();
+
+    /*!
+     * Writes every thread's recorded events as Chrome Trace Event JSON. Safe to call from any
+     * thread while others are recording.
+     * @param path the file to write, replaced if it exists
+     * @return true if the file was written
+     */
+    static bool writeChromeTrace(const char *path);
+};
+
+/*!
+ * Records the time from its construction to its destruction as a zone. Use it through
+ * PROFILE_ZONE.
+ */
+class ProfileZone {
+public:
+    explicit inline ProfileZone(const char *name)
+            : name_(name),
+              traced_(Profiler::beginSection(name)),
+              beginNanos_(Profiler::now()) {}
+
+    inline ~ProfileZone() {
+        Profiler::record(name_, beginNanos_, Profiler::now());
+        if (traced_) {
+            Profiler::endSection();
+        }
+    }
+
+    ProfileZone(const ProfileZone &) = delete;
+
+    ProfileZone &operator=(const ProfileZone &) = delete;
+
+private:
+    const char *name_;
+    bool traced_;
+    int64_t beginNanos_;
+};
+
+#define HOLOPERSONA_PROFILE_CONCAT_(a, b) a##b
+#define HOLOPERSONA_PROFILE_CONCAT(a, b) HOLOPERSONA_PROFILE_CONCAT_(a, b)
+
+#if HOLOPERSONA_PROFILING
+// Profiles the rest of the enclosing scope under a name, which must be a string literal
+#define PROFILE_ZONE(name) ProfileZone HOLOPERSONA_PROFILE_CONCAT(profileZone, __LINE__)(name)
+#else
+#define PROFILE_ZONE(name) do {} while (false)
+#endif
+
+#endif //HOLOPERSONA_PROFILER_H
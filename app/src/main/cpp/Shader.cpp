@@ -1,7 +1,12 @@
 #include "Shader.h"
 
+#include <algorithm>
+#include <cstddef>
+
 #include "AndroidOut.h"
+#include "Log.h"
 #include "Model.h"
+#include "Profiler.h"
 #include "Utility.h"
 
 Shader *Shader::loadShader(
@@ -78,6 +83,51 @@ Shader *Shader::loadShader(
     return shader;
 }
 
+Shader *Shader::loadSkinnedShader(
+        const std::string &vertexSource,
+        const std::string &fragmentSource,
+        const std::string &positionAttributeName,
+        const std::string &uvAttributeName,
+        const std::string &jointsAttributeName,
+        const std::string &weightsAttributeName,
+        const std::string &mvpMatrixUniformName,
+        const std::string &jointBlockName) {
+    Shader *shader = loadShader(
+            vertexSource,
+            fragmentSource,
+            positionAttributeName,
+            uvAttributeName,
+            mvpMatrixUniformName);
+    if (!shader) {
+        return nullptr;
+    }
+
+    GLint jointsAttribute = glGetAttribLocation(shader->program_, jointsAttributeName.c_str());
+    GLint weightsAttribute = glGetAttribLocation(shader->program_, weightsAttributeName.c_str());
+    GLuint jointBlock = glGetUniformBlockIndex(shader->program_, jointBlockName.c_str());
+    if (jointsAttribute == -1 || weightsAttribute == -1 || jointBlock == GL_INVALID_INDEX) {
+        aout << "Failed to find skinning attributes/uniforms:" << std::endl;
+        aout << "  Joints: " << jointsAttribute << std::endl;
+        aout << "  Weights: " << weightsAttribute << std::endl;
+        aout << "  Joint block: " << (jointBlock == GL_INVALID_INDEX ? -1 : GLint(jointBlock))
+             << std::endl;
+        delete shader;
+        return nullptr;
+    }
+
+    shader->joints_ = jointsAttribute;
+    shader->weights_ = weightsAttribute;
+    glUniformBlockBinding(shader->program_, jointBlock, kJointBlockBinding);
+
+    // std140 lays a mat4 array out tightly, so the palette is the matrices back to back
+    glGenBuffers(1, &shader->jointBuffer_);
+    glBindBuffer(GL_UNIFORM_BUFFER, shader->jointBuffer_);
+    glBufferData(GL_UNIFORM_BUFFER, kMaxJoints * 16 * sizeof(float), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    return shader;
+}
+
 GLuint Shader::loadShader(GLenum shaderType, const std::string &shaderSource) {
     Utility::assertGlError();
     GLuint shader = glCreateShader(shaderType);
@@ -118,20 +168,30 @@ void Shader::deactivate() const {
 }
 
 void Shader::drawModel(const Model &model) const {
+    drawVertices(model, reinterpret_cast<const uint8_t *>(model.getVertexData()));
+}
+
+void Shader::drawModel(const Model &model, GLuint vertexBuffer) const {
+    // With a buffer bound the attribute pointers are offsets into it
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    drawVertices(model, nullptr);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Shader::drawVertices(const Model &model, const uint8_t *vertexData) const {
+    PROFILE_ZONE("Shader::drawModel");
     // Debug: Check if we have valid data
     if (model.getVertexData() == nullptr || model.getIndexData() == nullptr) {
-        aout << "ERROR: Model has null vertex or index data!" << std::endl;
+        LOG_ERROR("ERROR: Model has null vertex or index data!");
         return;
     }
     
     // Debug: Check attribute locations
-    static bool attributesLogged = false;
-    if (!attributesLogged) {
-        aout << "DEBUG: Shader attributes - position: " << position_ << ", uv: " << uv_ << std::endl;
-        aout << "DEBUG: Vertex data pointer: " << model.getVertexData() << std::endl;
-        aout << "DEBUG: Index data pointer: " << model.getIndexData() << std::endl;
-        aout << "DEBUG: Vertex count: " << model.getVertexCount() << ", Index count: " << model.getIndexCount() << std::endl;
-        attributesLogged = true;
+    if (LOG_ONCE(ANDROID_LOG_DEBUG)) {
+        LOG_DEBUG("DEBUG: Shader attributes - position: %d, uv: %d", position_, uv_);
+        LOG_DEBUG("DEBUG: Vertex data pointer: %p", model.getVertexData());
+        LOG_DEBUG("DEBUG: Index data pointer: %p", model.getIndexData());
+        LOG_DEBUG("DEBUG: Vertex count: %zu, Index count: %zu", model.getVertexCount(), model.getIndexCount());
     }
     
     // The position attribute is 3 floats
@@ -141,7 +201,7 @@ void Shader::drawModel(const Model &model) const {
             GL_FLOAT, // of type float
             GL_FALSE, // don't normalize
             sizeof(Vertex), // stride is Vertex bytes
-            model.getVertexData() // pull from the start of the vertex data
+            vertexData // pull from the start of the vertex data
     );
     glEnableVertexAttribArray(position_);
 
@@ -152,30 +212,66 @@ void Shader::drawModel(const Model &model) const {
             GL_FLOAT, // of type float
             GL_FALSE, // don't normalize
             sizeof(Vertex), // stride is Vertex bytes
-            ((uint8_t *) model.getVertexData()) + sizeof(Vector3) // offset Vector3 from the start
+            vertexData + sizeof(Vector3) // offset Vector3 from the start
     );
     glEnableVertexAttribArray(uv_);
 
+    if (isSkinned()) {
+        // Joint indices stay integers, weights are normalized from bytes to 0..1
+        glVertexAttribIPointer(
+                joints_,
+                Vertex::kMaxInfluences,
+                GL_UNSIGNED_BYTE,
+                sizeof(Vertex),
+                vertexData + offsetof(Vertex, joints)
+        );
+        glEnableVertexAttribArray(joints_);
+
+        glVertexAttribPointer(
+                weights_,
+                Vertex::kMaxInfluences,
+                GL_UNSIGNED_BYTE,
+                GL_TRUE,
+                sizeof(Vertex),
+                vertexData + offsetof(Vertex, weights)
+        );
+        glEnableVertexAttribArray(weights_);
+    }
+
     // Setup the texture
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, model.getTexture().getTextureID());
     
-    // Debug: Check texture binding
-    GLint currentTexture;
-    glGetIntegerv(GL_TEXTURE_BINDING_2D, &currentTexture);
-    static bool textureLogged = false;
-    if (!textureLogged) {
-        aout << "DEBUG: Texture ID: " << model.getTexture().getTextureID() << ", Bound texture: " << currentTexture << std::endl;
-        textureLogged = true;
+    // Debug: Check texture binding, once since reading GL state back can stall the pipeline
+    if (LOG_ONCE(ANDROID_LOG_DEBUG)) {
+        GLint currentTexture;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &currentTexture);
+        LOG_DEBUG("DEBUG: Texture ID: %u, Bound texture: %d", model.getTexture().getTextureID(), currentTexture);
     }
 
     // Draw as indexed triangles
     glDrawElements(GL_TRIANGLES, model.getIndexCount(), GL_UNSIGNED_SHORT, model.getIndexData());
 
+    if (isSkinned()) {
+        glDisableVertexAttribArray(weights_);
+        glDisableVertexAttribArray(joints_);
+    }
     glDisableVertexAttribArray(uv_);
     glDisableVertexAttribArray(position_);
 }
 
-void Shader::setMVPMatrix(float *mvpMatrix) const {
+void Shader::setMVPMatrix(const float *mvpMatrix) const {
     glUniformMatrix4fv(mvpMatrix_, 1, false, mvpMatrix);
+}
+
+void Shader::setJointMatrices(const float *jointMatrices, size_t jointCount) const {
+    if (!isSkinned()) {
+        return;
+    }
+
+    jointCount = std::min(jointCount, size_t(kMaxJoints));
+    glBindBuffer(GL_UNIFORM_BUFFER, jointBuffer_);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, jointCount * 16 * sizeof(float), jointMatrices);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, kJointBlockBinding, jointBuffer_);
 }
\ No newline at end of file
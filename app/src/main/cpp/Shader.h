@@ -11,9 +11,19 @@ class Model;
  * input attributes are a position (as a Vector3) and a uv (as a Vector2). It takes a single
  * combined MVP matrix uniform for 3D transformations. The shader expects a single texture for 
  * fragment shading.
+ *
+ * A skinned shader (see @a loadSkinnedShader) additionally reads each vertex's joints and weights
+ * and a palette of joint matrices from a uniform block, so a posed model is drawn from its rest
+ * pose vertices with a single palette upload per frame.
  */
 class Shader {
 public:
+    /*!
+     * The most joints a skinned shader's palette holds. The uniform block in the vertex program
+     * must declare an array of exactly this many mat4.
+     */
+    static constexpr int kMaxJoints = 64;
+
     /*!
      * Loads a shader given the full sourcecode and names for necessary attributes and uniforms to
      * link to. Returns a valid shader on success or null on failure. Shader resources are
@@ -33,7 +43,36 @@ public:
             const std::string &uvAttributeName,
             const std::string &mvpMatrixUniformName);
 
+    /*!
+     * Loads a shader for linear blend skinning. In addition to everything @a loadShader needs, the
+     * vertex program takes a uvec4 of joint indices, a vec4 of weights, and a std140 uniform
+     * block holding kMaxJoints joint matrices.
+     *
+     * @param vertexSource The full source code for your vertex program
+     * @param fragmentSource The full source code of your fragment program
+     * @param positionAttributeName The name of the position attribute in your vertex program
+     * @param uvAttributeName The name of the uv coordinate attribute in your vertex program
+     * @param jointsAttributeName The name of the joint indices attribute in your vertex program
+     * @param weightsAttributeName The name of the joint weights attribute in your vertex program
+     * @param mvpMatrixUniformName The name of your combined MVP matrix uniform
+     * @param jointBlockName The name of the uniform block holding the joint matrices
+     * @return a valid Shader on success, otherwise null.
+     */
+    static Shader *loadSkinnedShader(
+            const std::string &vertexSource,
+            const std::string &fragmentSource,
+            const std::string &positionAttributeName,
+            const std::string &uvAttributeName,
+            const std::string &jointsAttributeName,
+            const std::string &weightsAttributeName,
+            const std::string &mvpMatrixUniformName,
+            const std::string &jointBlockName);
+
     inline ~Shader() {
+        if (jointBuffer_) {
+            glDeleteBuffers(1, &jointBuffer_);
+            jointBuffer_ = 0;
+        }
         if (program_) {
             glDeleteProgram(program_);
             program_ = 0;
@@ -56,11 +95,32 @@ public:
      */
     void drawModel(const Model &model) const;
 
+    /*!
+     * Renders a model with its vertices taken from a buffer instead of the model, such as one the
+     * CPU skinned. The indices and texture still come from the model.
+     * @param model a model to render
+     * @param vertexBuffer a GL_ARRAY_BUFFER holding the model's vertex count of Vertex
+     */
+    void drawModel(const Model &model, GLuint vertexBuffer) const;
+
     /*!
      * Sets the combined MVP matrix in the shader.
      * @param mvpMatrix sixteen floats, column major, defining a combined model-view-projection matrix.
      */
-    void setMVPMatrix(float *mvpMatrix) const;
+    void setMVPMatrix(const float *mvpMatrix) const;
+
+    /*!
+     * Uploads the joint palette of a skinned shader. Call after @a activate, once per frame.
+     * @param jointMatrices sixteen floats per joint, column major, as computed by
+     *     Skeleton::computeSkinMatrices
+     * @param jointCount the number of joints, anything past kMaxJoints is ignored
+     */
+    void setJointMatrices(const float *jointMatrices, size_t jointCount) const;
+
+    /*!
+     * @return true if this shader was loaded with @a loadSkinnedShader
+     */
+    inline bool isSkinned() const { return jointBuffer_ != 0; }
     
     GLuint getProgram() const { return program_; }
 
@@ -73,6 +133,13 @@ private:
      */
     static GLuint loadShader(GLenum shaderType, const std::string &shaderSource);
 
+    /*!
+     * Sets up the attributes and draws
+     * @param model the model to draw
+     * @param vertexData the model's vertices, or an offset into the bound vertex buffer
+     */
+    void drawVertices(const Model &model, const uint8_t *vertexData) const;
+
     /*!
      * Constructs a new instance of a shader. Use @a loadShader
      * @param program the GL program id of the shader
@@ -88,12 +155,23 @@ private:
             : program_(program),
               position_(position),
               uv_(uv),
-              mvpMatrix_(mvpMatrix) {}
+              mvpMatrix_(mvpMatrix),
+              joints_(-1),
+              weights_(-1),
+              jointBuffer_(0) {}
+
+    // The uniform buffer binding point of the joint palette
+    static constexpr GLuint kJointBlockBinding = 0;
 
     GLuint program_;
     GLint position_;
     GLint uv_;
     GLint mvpMatrix_;
+
+    // Only used by skinned shaders
+    GLint joints_;
+    GLint weights_;
+    GLuint jointBuffer_;
 };
 
 #endif //ANDROIDGLINVESTIGATIONS_SHADER_H
\ No newline at end of file
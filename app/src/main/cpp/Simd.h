@@ -0,0 +1,100 @@
+#ifndef HOLOPERSONA_SIMD_H
+#define HOLOPERSONA_SIMD_H
+
+/*
+ * Picks the vector instruction set for the target. arm64-v8a and armeabi-v7a builds get NEON,
+ * x86 and x86_64 builds (the emulator and desktop hosts) get SSE2. Anything else, or a build with
+ * HOLOPERSONA_NO_SIMD defined, falls back to the scalar reference paths.
+ */
+#if !defined(HOLOPERSONA_NO_SIMD) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define HOLOPERSONA_SIMD_NEON 1
+#include <arm_neon.h>
+#elif !defined(HOLOPERSONA_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+#define HOLOPERSONA_SIMD_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(HOLOPERSONA_SIMD_NEON) || defined(HOLOPERSONA_SIMD_SSE2)
+#define HOLOPERSONA_SIMD 1
+
+/*!
+ * Four floats in one vector register, with the handful of operations the kernels share. Keeps
+ * the NEON and SSE variants of float code identical above this header.
+ */
+struct Float4 {
+#if defined(HOLOPERSONA_SIMD_NEON)
+    float32x4_t v;
+#else
+    __m128 v;
+#endif
+};
+
+#if defined(HOLOPERSONA_SIMD_NEON)
+
+inline Float4 load4(const float *p) { return {vld1q_f32(p)}; }
+
+inline void store4(float *p, Float4 a) { vst1q_f32(p, a.v); }
+
+inline Float4 splat4(float s) { return {vdupq_n_f32(s)}; }
+
+inline Float4 set4(float a, float b, float c, float d) {
+    const float lanes[4] = {a, b, c, d};
+    return {vld1q_f32(lanes)};
+}
+
+inline Float4 add4(Float4 a, Float4 b) { return {vaddq_f32(a.v, b.v)}; }
+
+inline Float4 sub4(Float4 a, Float4 b) { return {vsubq_f32(a.v, b.v)}; }
+
+inline Float4 mul4(Float4 a, Float4 b) { return {vmulq_f32(a.v, b.v)}; }
+
+//! a + b * c
+inline Float4 madd4(Float4 a, Float4 b, Float4 c) { return {vmlaq_f32(a.v, b.v, c.v)}; }
+
+inline Float4 min4(Float4 a, Float4 b) { return {vminq_f32(a.v, b.v)}; }
+
+inline Float4 max4(Float4 a, Float4 b) { return {vmaxq_f32(a.v, b.v)}; }
+
+//! Transposes the 4x4 matrix whose rows are a, b, c and d
+inline void transpose4(Float4 &a, Float4 &b, Float4 &c, Float4 &d) {
+    float32x4x2_t ab = vtrnq_f32(a.v, b.v);
+    float32x4x2_t cd = vtrnq_f32(c.v, d.v);
+    a.v = vcombine_f32(vget_low_f32(ab.val[0]), vget_low_f32(cd.val[0]));
+    b.v = vcombine_f32(vget_low_f32(ab.val[1]), vget_low_f32(cd.val[1]));
+    c.v = vcombine_f32(vget_high_f32(ab.val[0]), vget_high_f32(cd.val[0]));
+    d.v = vcombine_f32(vget_high_f32(ab.val[1]), vget_high_f32(cd.val[1]));
+}
+
+#else
+
+inline Float4 load4(const float *p) { return {_mm_loadu_ps(p)}; }
+
+inline void store4(float *p, Float4 a) { _mm_storeu_ps(p, a.v); }
+
+inline Float4 splat4(float s) { return {_mm_set1_ps(s)}; }
+
+inline Float4 set4(float a, float b, float c, float d) { return {_mm_setr_ps(a, b, c, d)}; }
+
+inline Float4 add4(Float4 a, Float4 b) { return {_mm_add_ps(a.v, b.v)}; }
+
+inline Float4 sub4(Float4 a, Float4 b) { return {_mm_sub_ps(a.v, b.v)}; }
+
+inline Float4 mul4(Float4 a, Float4 b) { return {_mm_mul_ps(a.v, b.v)}; }
+
+//! a + b * c
+inline Float4 madd4(Float4 a, Float4 b, Float4 c) { return {_mm_add_ps(a.v, _mm_mul_ps(b.v, c.v))}; }
+
+inline Float4 min4(Float4 a, Float4 b) { return {_mm_min_ps(a.v, b.v)}; }
+
+inline Float4 max4(Float4 a, Float4 b) { return {_mm_max_ps(a.v, b.v)}; }
+
+//! Transposes the 4x4 matrix whose rows are a, b, c and d
+inline void transpose4(Float4 &a, Float4 &b, Float4 &c, Float4 &d) {
+    _MM_TRANSPOSE4_PS(a.v, b.v, c.v, d.v);
+}
+
+#endif
+
+#endif // HOLOPERSONA_SIMD
+
+#endif //HOLOPERSONA_SIMD_H
@@ -0,0 +1,53 @@
+#include "SimulationThread.h"
+
+#include <pthread.h>
+
+SimulationThread::SimulationThread(std::function<void()> step)
+        : step_(std::move(step)),
+          thread_(&SimulationThread::run, this) {}
+
+SimulationThread::~SimulationThread() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    thread_.join();
+}
+
+void SimulationThread::kick() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        kicked_ = true;
+    }
+    wake_.notify_one();
+}
+
+void SimulationThread::waitIdle() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this]() { return !kicked_ && !running_; });
+}
+
+void SimulationThread::run() {
+    pthread_setname_np(pthread_self(), "Simulation");
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [this]() { return kicked_ || stopping_; });
+        if (stopping_) {
+            break;
+        }
+        kicked_ = false;
+        running_ = true;
+
+        lock.unlock();
+        step_();
+        lock.lock();
+
+        running_ = false;
+        if (!kicked_) {
+            idle_.notify_all();
+        }
+    }
+    running_ = false;
+    idle_.notify_all();
+}
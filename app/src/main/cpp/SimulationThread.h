@@ -0,0 +1,54 @@
+#ifndef HOLOPERSONA_SIMULATIONTHREAD_H
+#define HOLOPERSONA_SIMULATIONTHREAD_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/*!
+ * A thread that runs one step of the simulation each time it's kicked, so the next frame can be
+ * simulated while the render thread submits the current one. Kicks that arrive while a step is
+ * running are folded into a single follow-up step.
+ */
+class SimulationThread {
+public:
+    /*!
+     * @param step what to run on each kick, called on the simulation thread only
+     */
+    explicit SimulationThread(std::function<void()> step);
+
+    /*!
+     * Finishes the current step and stops the thread
+     */
+    ~SimulationThread();
+
+    SimulationThread(const SimulationThread &) = delete;
+
+    SimulationThread &operator=(const SimulationThread &) = delete;
+
+    /*!
+     * Asks for a step. Returns straight away.
+     */
+    void kick();
+
+    /*!
+     * Waits until no step is running or asked for, after which nothing the step touches is in use
+     * until the next @a kick
+     */
+    void waitIdle();
+
+private:
+    void run();
+
+    std::function<void()> step_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable idle_;
+    bool kicked_ = false;
+    bool running_ = false;
+    bool stopping_ = false;
+    std::thread thread_;
+};
+
+#endif //HOLOPERSONA_SIMULATIONTHREAD_H
@@ -0,0 +1,90 @@
+#include "Skeleton.h"
+
+#include "AndroidOut.h"
+
+void JointTransform::toMatrix(float *outMatrix) const {
+    const Quaternion &q = rotation;
+    float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+    // column 1
+    outMatrix[0] = (1.f - 2.f * (yy + zz)) * scale.x;
+    outMatrix[1] = 2.f * (xy + wz) * scale.x;
+    outMatrix[2] = 2.f * (xz - wy) * scale.x;
+    outMatrix[3] = 0.f;
+
+    // column 2
+    outMatrix[4] = 2.f * (xy - wz) * scale.y;
+    outMatrix[5] = (1.f - 2.f * (xx + zz)) * scale.y;
+    outMatrix[6] = 2.f * (yz + wx) * scale.y;
+    outMatrix[7] = 0.f;
+
+    // column 3
+    outMatrix[8] = 2.f * (xz + wy) * scale.z;
+    outMatrix[9] = 2.f * (yz - wx) * scale.z;
+    outMatrix[10] = (1.f - 2.f * (xx + yy)) * scale.z;
+    outMatrix[11] = 0.f;
+
+    // column 4 (translation)
+    outMatrix[12] = translation.x;
+    outMatrix[13] = translation.y;
+    outMatrix[14] = translation.z;
+    outMatrix[15] = 1.f;
+}
+
+int Skeleton::addJoint(const std::string &name, int parent, const JointTransform &bindPose) {
+    if (parent < kNoParent || parent >= int(getJointCount())) {
+        aout << "Skeleton: joint " << name << " has no parent " << parent << std::endl;
+        return -1;
+    }
+
+    size_t joint = getJointCount();
+    names_.push_back(name);
+    parents_.push_back(parent);
+    bindPose_.push_back(bindPose);
+    bindModelMatrices_.resize((joint + 1) * 16);
+    inverseBindMatrices_.resize((joint + 1) * 16);
+
+    float *bindModel = &bindModelMatrices_[joint * 16];
+    if (parent == kNoParent) {
+        bindPose.toMatrix(bindModel);
+    } else {
+        float local[16];
+        bindPose.toMatrix(local);
+        VectorMath::multiply(bindModel, &bindModelMatrices_[parent * 16], local);
+    }
+    VectorMath::inverseAffine(&inverseBindMatrices_[joint * 16], bindModel);
+
+    return int(joint);
+}
+
+int Skeleton::findJoint(const std::string &name) const {
+    for (size_t i = 0; i < names_.size(); i++) {
+        if (names_[i] == name) {
+            return int(i);
+        }
+    }
+    return -1;
+}
+
+void Skeleton::computeModelMatrices(const JointTransform *localPose,
+                                    float *outModelMatrices) const {
+    // Parents come first, so theirs are always ready by the time a child needs them
+    for (size_t joint = 0; joint < getJointCount(); joint++) {
+        float *model = outModelMatrices + joint * 16;
+        int parent = parents_[joint];
+        if (parent == kNoParent) {
+            localPose[joint].toMatrix(model);
+        } else {
+            float local[16];
+            localPose[joint].toMatrix(local);
+            VectorMath::multiply(model, outModelMatrices + parent * 16, local);
+        }
+    }
+}
+
+void Skeleton::computeSkinMatrices(const float *modelMatrices, float *outSkinMatrices) const {
+    VectorMath::multiplyBatch(outSkinMatrices, modelMatrices, inverseBindMatrices_.data(),
+                              getJointCount());
+}
@@ -0,0 +1,104 @@
+#ifndef HOLOPERSONA_SKELETON_H
+#define HOLOPERSONA_SKELETON_H
+
+#include <string>
+#include <vector>
+
+#include "Model.h"
+#include "VectorMath.h"
+
+/*!
+ * A joint's transform relative to its parent: scale, then rotate, then translate
+ */
+struct JointTransform {
+    Vector3 translation{0.f, 0.f, 0.f};
+    Quaternion rotation = Quaternion::identity();
+    Vector3 scale{1.f, 1.f, 1.f};
+
+    /*!
+     * Writes the transform as a column major 4x4 matrix
+     * @param outMatrix sixteen floats to write into
+     */
+    void toMatrix(float *outMatrix) const;
+};
+
+/*!
+ * A joint hierarchy for skinning. Joints are stored flat and in parent order, so a parent always
+ * comes before its children and a single forward pass resolves the whole hierarchy.
+ *
+ * The skeleton only holds the rest pose. A pose is a separate array of local transforms, one per
+ * joint, so any number of characters can share a skeleton and posing one is a matrix update
+ * rather than a mesh rebuild:
+ *
+ *  std::vector<JointTransform> pose = skeleton.getBindPose();
+ *  pose[elbow].rotation = Quaternion::fromAxisAngle({0.f, 0.f, 1.f}, 0.5f);
+ *  skeleton.computeModelMatrices(pose.data(), modelMatrices.data());
+ *  skeleton.computeSkinMatrices(modelMatrices.data(), skinMatrices.data());
+ *
+ * Matrices are column major 4x4, sixteen floats per joint.
+ */
+class Skeleton {
+public:
+    //! The parent index of a root joint
+    static constexpr int kNoParent = -1;
+
+    /*!
+     * Appends a joint. Its inverse bind matrix is derived from the bind pose of the joint and its
+     * ancestors.
+     * @param name a name to look the joint up by
+     * @param parent the index of an existing joint, or kNoParent for a root
+     * @param bindPose the rest transform relative to the parent
+     * @return the index of the new joint, or -1 if @a parent isn't an existing joint
+     */
+    int addJoint(const std::string &name, int parent, const JointTransform &bindPose);
+
+    inline size_t getJointCount() const { return parents_.size(); }
+
+    inline const std::string &getJointName(size_t joint) const { return names_[joint]; }
+
+    inline int getParent(size_t joint) const { return parents_[joint]; }
+
+    /*!
+     * @return the index of the joint called @a name, or -1 if there isn't one
+     */
+    int findJoint(const std::string &name) const;
+
+    /*!
+     * @return the local rest transforms, a starting point for posing
+     */
+    inline const std::vector<JointTransform> &getBindPose() const { return bindPose_; }
+
+    /*!
+     * @return sixteen floats that take a point from model space into the joint's rest space
+     */
+    inline const float *getInverseBindMatrix(size_t joint) const {
+        return &inverseBindMatrices_[joint * 16];
+    }
+
+    /*!
+     * Resolves a pose into model space
+     * @param localPose one local transform per joint
+     * @param outModelMatrices receives sixteen floats per joint
+     */
+    void computeModelMatrices(const JointTransform *localPose, float *outModelMatrices) const;
+
+    /*!
+     * Turns model space joint matrices into the matrices skinning multiplies vertices by, the
+     * model matrix times the inverse bind matrix. A vertex bound in the rest pose is unchanged by
+     * the rest pose's skin matrices.
+     * @param modelMatrices the output of @a computeModelMatrices
+     * @param outSkinMatrices receives sixteen floats per joint
+     */
+    void computeSkinMatrices(const float *modelMatrices, float *outSkinMatrices) const;
+
+private:
+    std::vector<std::string> names_;
+    std::vector<int> parents_;
+    std::vector<JointTransform> bindPose_;
+
+    // Sixteen floats per joint
+    std::vector<float> bindModelMatrices_;
+    std::vector<float> inverseBindMatrices_;
+};
+
+#endif //HOLOPERSONA_SKELETON_H
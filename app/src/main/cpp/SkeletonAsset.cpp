@@ -1,207 +1,351 @@
 #include "SkeletonAsset.h"
 
+#include "AndroidOut.h"
+
+#include <algorithm>
+#include <cmath>
+
+static const char *const kJointNames[SkeletonAsset::HUMANOID_JOINT_COUNT] = {
+        "pelvis", "chest", "neck", "head",
+        "leftUpperArm", "leftForearm", "leftHand",
+        "rightUpperArm", "rightForearm", "rightHand",
+        "leftThigh", "leftShin", "leftFoot",
+        "rightThigh", "rightShin", "rightFoot"};
+
+static const int kJointParents[SkeletonAsset::HUMANOID_JOINT_COUNT] = {
+        Skeleton::kNoParent, SkeletonAsset::PELVIS, SkeletonAsset::CHEST, SkeletonAsset::NECK,
+        SkeletonAsset::CHEST, SkeletonAsset::LEFT_UPPER_ARM, SkeletonAsset::LEFT_FOREARM,
+        SkeletonAsset::CHEST, SkeletonAsset::RIGHT_UPPER_ARM, SkeletonAsset::RIGHT_FOREARM,
+        SkeletonAsset::PELVIS, SkeletonAsset::LEFT_THIGH, SkeletonAsset::LEFT_SHIN,
+        SkeletonAsset::PELVIS, SkeletonAsset::RIGHT_THIGH, SkeletonAsset::RIGHT_SHIN};
+
+const SkeletonAsset::Preset &SkeletonAsset::getPreset(SkeletonType type) {
+    // Simple humanoid with basic proportions. Each arm and leg is a single box, the joints below
+    // them still exist so every type can play the same animations.
+    static const BoxPart kBasicParts[] = {
+            {HEAD,            {0.0f, 7.0f, 0.0f},   {1.0f, 1.0f, 1.0f}},
+            {CHEST,           {0.0f, 4.0f, 0.0f},   {1.5f, 2.5f, 0.8f}},
+            {LEFT_UPPER_ARM,  {-2.0f, 4.5f, 0.0f},  {1.0f, 0.3f, 0.3f}},
+            {RIGHT_UPPER_ARM, {2.0f, 4.5f, 0.0f},   {1.0f, 0.3f, 0.3f}},
+            {LEFT_THIGH,      {-0.4f, 0.0f, 0.0f},  {0.4f, 4.0f, 0.4f}},
+            {RIGHT_THIGH,     {0.4f, 0.0f, 0.0f},   {0.4f, 4.0f, 0.4f}},
+    };
+    static const Preset kBasic = {
+            {{0.0f, 0.0f, 0.0f}, {0.0f, 2.75f, 0.0f}, {0.0f, 5.25f, 0.0f}, {0.0f, 6.5f, 0.0f},
+             {-1.5f, 4.5f, 0.0f}, {-2.0f, 4.5f, 0.0f}, {-2.5f, 4.5f, 0.0f},
+             {1.5f, 4.5f, 0.0f}, {2.0f, 4.5f, 0.0f}, {2.5f, 4.5f, 0.0f},
+             {-0.4f, 2.0f, 0.0f}, {-0.4f, 0.0f, 0.0f}, {-0.4f, -2.0f, 0.0f},
+             {0.4f, 2.0f, 0.0f}, {0.4f, 0.0f, 0.0f}, {0.4f, -2.0f, 0.0f}},
+            kBasicParts, sizeof(kBasicParts) / sizeof(kBasicParts[0])};
+
+    // Detailed humanoid with proper anatomy
+    static const BoxPart kDetailedParts[] = {
+            {HEAD,            {0.0f, 7.5f, 0.0f},   {1.2f, 1.2f, 1.0f}},
+            {NECK,            {0.0f, 6.0f, 0.0f},   {0.5f, 1.0f, 0.5f}},
+            {CHEST,           {0.0f, 4.0f, 0.0f},   {2.0f, 3.0f, 1.0f}},
+            {PELVIS,          {0.0f, 0.0f, 0.0f},   {1.8f, 1.0f, 1.0f}},
+            {LEFT_UPPER_ARM,  {-2.5f, 4.5f, 0.0f},  {1.5f, 0.4f, 0.4f}},
+            {LEFT_FOREARM,    {-4.5f, 4.5f, 0.0f},  {1.5f, 0.3f, 0.3f}},
+            {LEFT_HAND,       {-6.0f, 4.5f, 0.0f},  {0.8f, 0.3f, 0.2f}},
+            {RIGHT_UPPER_ARM, {2.5f, 4.5f, 0.0f},   {1.5f, 0.4f, 0.4f}},
+            {RIGHT_FOREARM,   {4.5f, 4.5f, 0.0f},   {1.5f, 0.3f, 0.3f}},
+            {RIGHT_HAND,      {6.0f, 4.5f, 0.0f},   {0.8f, 0.3f, 0.2f}},
+            {LEFT_THIGH,      {-0.6f, -2.5f, 0.0f}, {0.6f, 3.0f, 0.6f}},
+            {LEFT_SHIN,       {-0.6f, -6.5f, 0.0f}, {0.5f, 3.0f, 0.5f}},
+            {LEFT_FOOT,       {-0.6f, -8.5f, 0.8f}, {0.4f, 0.4f, 1.5f}},
+            {RIGHT_THIGH,     {0.6f, -2.5f, 0.0f},  {0.6f, 3.0f, 0.6f}},
+            {RIGHT_SHIN,      {0.6f, -6.5f, 0.0f},  {0.5f, 3.0f, 0.5f}},
+            {RIGHT_FOOT,      {0.6f, -8.5f, 0.8f},  {0.4f, 0.4f, 1.5f}},
+    };
+    static const Preset kDetailed = {
+            {{0.0f, 0.0f, 0.0f}, {0.0f, 2.5f, 0.0f}, {0.0f, 5.5f, 0.0f}, {0.0f, 6.5f, 0.0f},
+             {-1.75f, 4.5f, 0.0f}, {-3.75f, 4.5f, 0.0f}, {-5.6f, 4.5f, 0.0f},
+             {1.75f, 4.5f, 0.0f}, {3.75f, 4.5f, 0.0f}, {5.6f, 4.5f, 0.0f},
+             {-0.6f, -1.0f, 0.0f}, {-0.6f, -5.0f, 0.0f}, {-0.6f, -8.0f, 0.0f},
+             {0.6f, -1.0f, 0.0f}, {0.6f, -5.0f, 0.0f}, {0.6f, -8.0f, 0.0f}},
+            kDetailedParts, sizeof(kDetailedParts) / sizeof(kDetailedParts[0])};
+
+    // Athletic build with broader shoulders, chest and limbs
+    static const BoxPart kAthleticParts[] = {
+            {HEAD,            {0.0f, 7.5f, 0.0f},   {1.3f, 1.3f, 1.1f}},
+            {NECK,            {0.0f, 6.0f, 0.0f},   {0.6f, 1.0f, 0.6f}},
+            {CHEST,           {0.0f, 4.0f, 0.0f},   {2.4f, 3.2f, 1.2f}},
+            {PELVIS,          {0.0f, 0.0f, 0.0f},   {1.8f, 1.0f, 1.0f}},
+            {LEFT_UPPER_ARM,  {-2.7f, 4.5f, 0.0f},  {1.8f, 0.5f, 0.5f}},
+            {LEFT_FOREARM,    {-4.8f, 4.5f, 0.0f},  {1.6f, 0.4f, 0.4f}},
+            {LEFT_HAND,       {-6.2f, 4.5f, 0.0f},  {0.9f, 0.4f, 0.3f}},
+            {RIGHT_UPPER_ARM, {2.7f, 4.5f, 0.0f},   {1.8f, 0.5f, 0.5f}},
+            {RIGHT_FOREARM,   {4.8f, 4.5f, 0.0f},   {1.6f, 0.4f, 0.4f}},
+            {RIGHT_HAND,      {6.2f, 4.5f, 0.0f},   {0.9f, 0.4f, 0.3f}},
+            {LEFT_THIGH,      {-0.7f, -2.5f, 0.0f}, {0.8f, 3.2f, 0.8f}},
+            {LEFT_SHIN,       {-0.7f, -6.5f, 0.0f}, {0.6f, 3.0f, 0.6f}},
+            {LEFT_FOOT,       {-0.7f, -8.5f, 0.8f}, {0.5f, 0.5f, 1.6f}},
+            {RIGHT_THIGH,     {0.7f, -2.5f, 0.0f},  {0.8f, 3.2f, 0.8f}},
+            {RIGHT_SHIN,      {0.7f, -6.5f, 0.0f},  {0.6f, 3.0f, 0.6f}},
+            {RIGHT_FOOT,      {0.7f, -8.5f, 0.8f},  {0.5f, 0.5f, 1.6f}},
+    };
+    static const Preset kAthletic = {
+            {{0.0f, 0.0f, 0.0f}, {0.0f, 2.4f, 0.0f}, {0.0f, 5.5f, 0.0f}, {0.0f, 6.5f, 0.0f},
+             {-1.8f, 4.5f, 0.0f}, {-4.0f, 4.5f, 0.0f}, {-5.75f, 4.5f, 0.0f},
+             {1.8f, 4.5f, 0.0f}, {4.0f, 4.5f, 0.0f}, {5.75f, 4.5f, 0.0f},
+             {-0.7f, -0.9f, 0.0f}, {-0.7f, -5.0f, 0.0f}, {-0.7f, -8.0f, 0.0f},
+             {0.7f, -0.9f, 0.0f}, {0.7f, -5.0f, 0.0f}, {0.7f, -8.0f, 0.0f}},
+            kAthleticParts, sizeof(kAthleticParts) / sizeof(kAthleticParts[0])};
+
+    // Slim build with narrower proportions
+    static const BoxPart kSlimParts[] = {
+            {HEAD,            {0.0f, 7.5f, 0.0f},   {1.0f, 1.0f, 0.9f}},
+            {NECK,            {0.0f, 6.0f, 0.0f},   {0.4f, 1.0f, 0.4f}},
+            {CHEST,           {0.0f, 4.0f, 0.0f},   {1.6f, 2.8f, 0.8f}},
+            {PELVIS,          {0.0f, 0.0f, 0.0f},   {1.4f, 0.8f, 0.8f}},
+            {LEFT_UPPER_ARM,  {-2.3f, 4.5f, 0.0f},  {1.2f, 0.3f, 0.3f}},
+            {LEFT_FOREARM,    {-4.2f, 4.5f, 0.0f},  {1.2f, 0.25f, 0.25f}},
+            {LEFT_HAND,       {-5.6f, 4.5f, 0.0f},  {0.7f, 0.25f, 0.15f}},
+            {RIGHT_UPPER_ARM, {2.3f, 4.5f, 0.0f},   {1.2f, 0.3f, 0.3f}},
+            {RIGHT_FOREARM,   {4.2f, 4.5f, 0.0f},   {1.2f, 0.25f, 0.25f}},
+            {RIGHT_HAND,      {5.6f, 4.5f, 0.0f},   {0.7f, 0.25f, 0.15f}},
+            {LEFT_THIGH,      {-0.5f, -2.5f, 0.0f}, {0.5f, 2.8f, 0.5f}},
+            {LEFT_SHIN,       {-0.5f, -6.5f, 0.0f}, {0.4f, 2.8f, 0.4f}},
+            {LEFT_FOOT,       {-0.5f, -8.5f, 0.7f}, {0.35f, 0.35f, 1.3f}},
+            {RIGHT_THIGH,     {0.5f, -2.5f, 0.0f},  {0.5f, 2.8f, 0.5f}},
+            {RIGHT_SHIN,      {0.5f, -6.5f, 0.0f},  {0.4f, 2.8f, 0.4f}},
+            {RIGHT_FOOT,      {0.5f, -8.5f, 0.7f},  {0.35f, 0.35f, 1.3f}},
+    };
+    static const Preset kSlim = {
+            {{0.0f, 0.0f, 0.0f}, {0.0f, 2.6f, 0.0f}, {0.0f, 5.5f, 0.0f}, {0.0f, 6.5f, 0.0f},
+             {-1.7f, 4.5f, 0.0f}, {-3.6f, 4.5f, 0.0f}, {-5.25f, 4.5f, 0.0f},
+             {1.7f, 4.5f, 0.0f}, {3.6f, 4.5f, 0.0f}, {5.25f, 4.5f, 0.0f},
+             {-0.5f, -1.1f, 0.0f}, {-0.5f, -5.1f, 0.0f}, {-0.5f, -7.9f, 0.0f},
+             {0.5f, -1.1f, 0.0f}, {0.5f, -5.1f, 0.0f}, {0.5f, -7.9f, 0.0f}},
+            kSlimParts, sizeof(kSlimParts) / sizeof(kSlimParts[0])};
+
+    switch (type) {
+        case SkeletonType::BASIC_HUMANOID:
+            return kBasic;
+        case SkeletonType::ATHLETIC_HUMANOID:
+            return kAthletic;
+        case SkeletonType::SLIM_HUMANOID:
+            return kSlim;
+        case SkeletonType::DETAILED_HUMANOID:
+        default:
+            return kDetailed;
+    }
+}
+
 void SkeletonAsset::createSkeleton(SkeletonType type, 
                                   std::vector<Vertex>& vertices, 
                                   std::vector<Index>& indices) {
+    Skeleton skeleton;
+    createSkeleton(type, vertices, indices, skeleton);
+}
+
+void SkeletonAsset::createSkeleton(SkeletonType type,
+                                  std::vector<Vertex>& vertices,
+                                  std::vector<Index>& indices,
+                                  Skeleton& skeleton) {
+    if (skeleton.getJointCount() != 0) {
+        aout << "SkeletonAsset: the skeleton to fill already has joints" << std::endl;
+        return;
+    }
+
+    const PresetMesh &mesh = getPresetMesh(type);
+    vertices.insert(vertices.end(), mesh.vertices.begin(), mesh.vertices.end());
+    indices.insert(indices.end(), mesh.indices.begin(), mesh.indices.end());
+    skeleton = mesh.skeleton;
+}
+
+bool SkeletonAsset::createBodyShapes(SkeletonType type,
+                                     const std::vector<Vertex>& vertices,
+                                     MorphTargetSet& targets) {
+    if (type != SkeletonType::DETAILED_HUMANOID) {
+        return false;
+    }
+
+    static const struct {
+        const char *name;
+        SkeletonType type;
+    } kShapes[BODY_SHAPE_COUNT] = {
+            {"athletic", SkeletonType::ATHLETIC_HUMANOID},
+            {"slim",     SkeletonType::SLIM_HUMANOID},
+    };
+
+    for (const auto &entry: kShapes) {
+        MorphTarget target = MorphTarget::fromShapes(entry.name, vertices,
+                                                     getPresetMesh(entry.type).vertices);
+        if (target.getDeltaCount() == 0) {
+            aout << "SkeletonAsset: the " << entry.name << " build doesn't fit the mesh" << std::endl;
+            return false;
+        }
+        targets.addTarget(std::move(target), vertices);
+    }
+    return true;
+}
+
+const SkeletonAsset::PresetMesh &SkeletonAsset::getPresetMesh(SkeletonType type) {
+    // Built together on first use, which also makes the first use thread safe
+    static const PresetMesh kMeshes[] = {
+            buildPresetMesh(getPreset(SkeletonType::BASIC_HUMANOID)),
+            buildPresetMesh(getPreset(SkeletonType::DETAILED_HUMANOID)),
+            buildPresetMesh(getPreset(SkeletonType::ATHLETIC_HUMANOID)),
+            buildPresetMesh(getPreset(SkeletonType::SLIM_HUMANOID)),
+    };
+
     switch (type) {
         case SkeletonType::BASIC_HUMANOID:
-            createBasicHumanoid(vertices, indices);
-            break;
-        case SkeletonType::DETAILED_HUMANOID:
-            createDetailedHumanoid(vertices, indices);
-            break;
+            return kMeshes[0];
         case SkeletonType::ATHLETIC_HUMANOID:
-            createAthleticHumanoid(vertices, indices);
-            break;
+            return kMeshes[2];
         case SkeletonType::SLIM_HUMANOID:
-            createSlimHumanoid(vertices, indices);
-            break;
+            return kMeshes[3];
+        case SkeletonType::DETAILED_HUMANOID:
+        default:
+            return kMeshes[1];
     }
 }
 
-void SkeletonAsset::createBasicHumanoid(std::vector<Vertex>& vertices, 
-                                       std::vector<Index>& indices) {
-    // Simple humanoid with basic proportions
-    // HEAD
-    addBox(vertices, indices, 0.0f, 7.0f, 0.0f, 1.0f, 1.0f, 1.0f);
-    
-    // TORSO
-    addBox(vertices, indices, 0.0f, 4.0f, 0.0f, 1.5f, 2.5f, 0.8f);
-    
-    // ARMS
-    addBox(vertices, indices, -2.0f, 4.5f, 0.0f, 1.0f, 0.3f, 0.3f);
-    addBox(vertices, indices, 2.0f, 4.5f, 0.0f, 1.0f, 0.3f, 0.3f);
-    
-    // LEGS
-    addBox(vertices, indices, -0.4f, 0.0f, 0.0f, 0.4f, 4.0f, 0.4f);
-    addBox(vertices, indices, 0.4f, 0.0f, 0.0f, 0.4f, 4.0f, 0.4f);
-}
+SkeletonAsset::PresetMesh SkeletonAsset::buildPresetMesh(const Preset &preset) {
+    PresetMesh mesh;
 
-void SkeletonAsset::createDetailedHumanoid(std::vector<Vertex>& vertices, 
-                                          std::vector<Index>& indices) {
-    // Detailed humanoid with proper anatomy (current implementation)
-    // HEAD
-    addBox(vertices, indices, 0.0f, 7.5f, 0.0f, 1.2f, 1.2f, 1.0f);
-    
-    // NECK
-    addBox(vertices, indices, 0.0f, 6.0f, 0.0f, 0.5f, 1.0f, 0.5f);
-    
-    // TORSO (chest/ribcage)
-    addBox(vertices, indices, 0.0f, 4.0f, 0.0f, 2.0f, 3.0f, 1.0f);
-    
-    // PELVIS (at origin - center of character)
-    addBox(vertices, indices, 0.0f, 0.0f, 0.0f, 1.8f, 1.0f, 1.0f);
-    
-    // LEFT ARM
-    addBox(vertices, indices, -2.5f, 4.5f, 0.0f, 1.5f, 0.4f, 0.4f); // Upper arm
-    addBox(vertices, indices, -4.5f, 4.5f, 0.0f, 1.5f, 0.3f, 0.3f); // Forearm
-    addBox(vertices, indices, -6.0f, 4.5f, 0.0f, 0.8f, 0.3f, 0.2f); // Hand
-    
-    // RIGHT ARM
-    addBox(vertices, indices, 2.5f, 4.5f, 0.0f, 1.5f, 0.4f, 0.4f);  // Upper arm
-    addBox(vertices, indices, 4.5f, 4.5f, 0.0f, 1.5f, 0.3f, 0.3f);  // Forearm
-    addBox(vertices, indices, 6.0f, 4.5f, 0.0f, 0.8f, 0.3f, 0.2f);  // Hand
-    
-    // LEFT LEG
-    addBox(vertices, indices, -0.6f, -2.5f, 0.0f, 0.6f, 3.0f, 0.6f); // Thigh
-    addBox(vertices, indices, -0.6f, -6.5f, 0.0f, 0.5f, 3.0f, 0.5f); // Shin
-    addBox(vertices, indices, -0.6f, -8.5f, 0.8f, 0.4f, 0.4f, 1.5f); // Foot
-    
-    // RIGHT LEG
-    addBox(vertices, indices, 0.6f, -2.5f, 0.0f, 0.6f, 3.0f, 0.6f);  // Thigh
-    addBox(vertices, indices, 0.6f, -6.5f, 0.0f, 0.5f, 3.0f, 0.5f);  // Shin
-    addBox(vertices, indices, 0.6f, -8.5f, 0.8f, 0.4f, 0.4f, 1.5f);  // Foot
-}
+    // The rest pose has no rotation, so each joint sits at its model space position minus its
+    // parent's
+    for (int joint = 0; joint < HUMANOID_JOINT_COUNT; joint++) {
+        int parent = kJointParents[joint];
+        const Vector3 &position = preset.jointPositions[joint];
+        JointTransform bindPose;
+        bindPose.translation = position;
+        if (parent != Skeleton::kNoParent) {
+            const Vector3 &parentPosition = preset.jointPositions[parent];
+            bindPose.translation = {position.x - parentPosition.x,
+                                    position.y - parentPosition.y,
+                                    position.z - parentPosition.z};
+        }
+        mesh.skeleton.addJoint(kJointNames[joint], parent, bindPose);
+    }
 
-void SkeletonAsset::createAthleticHumanoid(std::vector<Vertex>& vertices, 
-                                          std::vector<Index>& indices) {
-    // Athletic build with broader shoulders and chest
-    // HEAD
-    addBox(vertices, indices, 0.0f, 7.5f, 0.0f, 1.3f, 1.3f, 1.1f);
-    
-    // NECK (slightly thicker)
-    addBox(vertices, indices, 0.0f, 6.0f, 0.0f, 0.6f, 1.0f, 0.6f);
-    
-    // TORSO (broader chest)
-    addBox(vertices, indices, 0.0f, 4.0f, 0.0f, 2.4f, 3.2f, 1.2f);
-    
-    // PELVIS
-    addBox(vertices, indices, 0.0f, 0.0f, 0.0f, 1.8f, 1.0f, 1.0f);
-    
-    // LEFT ARM (more muscular)
-    addBox(vertices, indices, -2.7f, 4.5f, 0.0f, 1.8f, 0.5f, 0.5f); // Upper arm
-    addBox(vertices, indices, -4.8f, 4.5f, 0.0f, 1.6f, 0.4f, 0.4f); // Forearm
-    addBox(vertices, indices, -6.2f, 4.5f, 0.0f, 0.9f, 0.4f, 0.3f); // Hand
-    
-    // RIGHT ARM (more muscular)
-    addBox(vertices, indices, 2.7f, 4.5f, 0.0f, 1.8f, 0.5f, 0.5f);  // Upper arm
-    addBox(vertices, indices, 4.8f, 4.5f, 0.0f, 1.6f, 0.4f, 0.4f);  // Forearm
-    addBox(vertices, indices, 6.2f, 4.5f, 0.0f, 0.9f, 0.4f, 0.3f);  // Hand
-    
-    // LEFT LEG (more muscular)
-    addBox(vertices, indices, -0.7f, -2.5f, 0.0f, 0.8f, 3.2f, 0.8f); // Thigh
-    addBox(vertices, indices, -0.7f, -6.5f, 0.0f, 0.6f, 3.0f, 0.6f); // Shin
-    addBox(vertices, indices, -0.7f, -8.5f, 0.8f, 0.5f, 0.5f, 1.6f); // Foot
-    
-    // RIGHT LEG (more muscular)
-    addBox(vertices, indices, 0.7f, -2.5f, 0.0f, 0.8f, 3.2f, 0.8f);  // Thigh
-    addBox(vertices, indices, 0.7f, -6.5f, 0.0f, 0.6f, 3.0f, 0.6f);  // Shin
-    addBox(vertices, indices, 0.7f, -8.5f, 0.8f, 0.5f, 0.5f, 1.6f);  // Foot
+    mesh.vertices.reserve(preset.partCount * kBoxVertexCount);
+    mesh.indices.reserve(preset.partCount * kBoxIndexCount);
+    for (size_t i = 0; i < preset.partCount; i++) {
+        const BoxPart &part = preset.parts[i];
+        addBox(mesh.vertices, mesh.indices, part.center, part.size,
+               static_cast<uint8_t>(part.joint));
+    }
+    return mesh;
 }
 
-void SkeletonAsset::createSlimHumanoid(std::vector<Vertex>& vertices, 
-                                      std::vector<Index>& indices) {
-    // Slim build with narrower proportions
-    // HEAD (slightly smaller)
-    addBox(vertices, indices, 0.0f, 7.5f, 0.0f, 1.0f, 1.0f, 0.9f);
-    
-    // NECK (thinner)
-    addBox(vertices, indices, 0.0f, 6.0f, 0.0f, 0.4f, 1.0f, 0.4f);
-    
-    // TORSO (narrower)
-    addBox(vertices, indices, 0.0f, 4.0f, 0.0f, 1.6f, 2.8f, 0.8f);
-    
-    // PELVIS (narrower)
-    addBox(vertices, indices, 0.0f, 0.0f, 0.0f, 1.4f, 0.8f, 0.8f);
-    
-    // LEFT ARM (slimmer)
-    addBox(vertices, indices, -2.3f, 4.5f, 0.0f, 1.2f, 0.3f, 0.3f); // Upper arm
-    addBox(vertices, indices, -4.2f, 4.5f, 0.0f, 1.2f, 0.25f, 0.25f); // Forearm
-    addBox(vertices, indices, -5.6f, 4.5f, 0.0f, 0.7f, 0.25f, 0.15f); // Hand
-    
-    // RIGHT ARM (slimmer)
-    addBox(vertices, indices, 2.3f, 4.5f, 0.0f, 1.2f, 0.3f, 0.3f);  // Upper arm
-    addBox(vertices, indices, 4.2f, 4.5f, 0.0f, 1.2f, 0.25f, 0.25f);  // Forearm
-    addBox(vertices, indices, 5.6f, 4.5f, 0.0f, 0.7f, 0.25f, 0.15f);  // Hand
-    
-    // LEFT LEG (slimmer)
-    addBox(vertices, indices, -0.5f, -2.5f, 0.0f, 0.5f, 2.8f, 0.5f); // Thigh
-    addBox(vertices, indices, -0.5f, -6.5f, 0.0f, 0.4f, 2.8f, 0.4f); // Shin
-    addBox(vertices, indices, -0.5f, -8.5f, 0.7f, 0.35f, 0.35f, 1.3f); // Foot
-    
-    // RIGHT LEG (slimmer)
-    addBox(vertices, indices, 0.5f, -2.5f, 0.0f, 0.5f, 2.8f, 0.5f);  // Thigh
-    addBox(vertices, indices, 0.5f, -6.5f, 0.0f, 0.4f, 2.8f, 0.4f);  // Shin
-    addBox(vertices, indices, 0.5f, -8.5f, 0.7f, 0.35f, 0.35f, 1.3f);  // Foot
+std::shared_ptr<AnimationClip> SkeletonAsset::createClip(ClipType type, const Skeleton& skeleton) {
+    if (skeleton.getJointCount() != HUMANOID_JOINT_COUNT) {
+        aout << "SkeletonAsset: can't animate a skeleton with " << skeleton.getJointCount()
+             << " joints" << std::endl;
+        return nullptr;
+    }
+
+    constexpr float kSampleRate = 30.f;
+    constexpr float kTwoPi = 2.f * float(M_PI);
+    const Vector3 kAxisX{1.f, 0.f, 0.f};
+    const Vector3 kAxisY{0.f, 1.f, 0.f};
+    const Vector3 kAxisZ{0.f, 0.f, 1.f};
+
+    float duration = type == ClipType::WALK ? 1.f : 4.f;
+    int frameCount = int(duration * kSampleRate) + 1;
+    const auto &bindPose = skeleton.getBindPose();
+    std::vector<JointTransform> frames;
+    frames.reserve(frameCount * HUMANOID_JOINT_COUNT);
+
+    for (int frame = 0; frame < frameCount; frame++) {
+        // The last frame lands back on the first so the clip loops seamlessly
+        float phase = kTwoPi * float(frame) / float(frameCount - 1);
+        std::vector<JointTransform> pose = bindPose;
+
+        if (type == ClipType::WALK) {
+            // The character faces +Z. Rotating a leg about +X swings it back, the arms swing
+            // forward and back about Y opposite their leg.
+            float swing = sinf(phase);
+            pose[PELVIS].translation.y += 0.08f * cosf(2.f * phase);
+            pose[CHEST].rotation = Quaternion::fromAxisAngle(kAxisY, 0.08f * swing);
+            pose[LEFT_THIGH].rotation = Quaternion::fromAxisAngle(kAxisX, 0.45f * swing);
+            pose[RIGHT_THIGH].rotation = Quaternion::fromAxisAngle(kAxisX, -0.45f * swing);
+            pose[LEFT_SHIN].rotation = Quaternion::fromAxisAngle(kAxisX, 0.6f * std::max(0.f, swing));
+            pose[RIGHT_SHIN].rotation = Quaternion::fromAxisAngle(kAxisX, 0.6f * std::max(0.f, -swing));
+            pose[LEFT_UPPER_ARM].rotation = Quaternion::fromAxisAngle(kAxisY, 0.3f * swing);
+            pose[RIGHT_UPPER_ARM].rotation = Quaternion::fromAxisAngle(kAxisY, 0.3f * swing);
+            pose[LEFT_FOREARM].rotation = Quaternion::fromAxisAngle(kAxisY, 0.15f * swing + 0.15f);
+            pose[RIGHT_FOREARM].rotation = Quaternion::fromAxisAngle(kAxisY, 0.15f * swing - 0.15f);
+        } else {
+            // Breathing on the chest, a slow look around, arms settling a little below level
+            float breath = sinf(2.f * phase);
+            pose[CHEST].rotation = Quaternion::fromAxisAngle(kAxisX, -0.03f * breath);
+            pose[CHEST].scale = {1.f + 0.02f * breath, 1.f, 1.f + 0.02f * breath};
+            pose[HEAD].rotation = Quaternion::fromAxisAngle(kAxisY, 0.25f * sinf(phase));
+            pose[LEFT_UPPER_ARM].rotation = Quaternion::fromAxisAngle(kAxisZ, 0.1f + 0.03f * breath);
+            pose[RIGHT_UPPER_ARM].rotation = Quaternion::fromAxisAngle(kAxisZ, -0.1f - 0.03f * breath);
+        }
+
+        frames.insert(frames.end(), pose.begin(), pose.end());
+    }
+
+    return AnimationClip::compress(type == ClipType::WALK ? "walk" : "idle",
+                                   HUMANOID_JOINT_COUNT, kSampleRate, frames);
 }
 
-void SkeletonAsset::addBox(std::vector<Vertex>& vertices, 
-                          std::vector<Index>& indices,
-                          float centerX, float centerY, float centerZ,
-                          float width, float height, float depth) {
+void SkeletonAsset::addBox(std::vector<Vertex>& vertices,
+                           std::vector<Index>& indices,
+                           const Vector3& center,
+                           const Vector3& size,
+                           uint8_t joint) {
+    // A unit cube around the origin, front, back, right, left, top then bottom
+    static constexpr struct {
+        Vector3 position;
+        Vector2 uv;
+    } kUnitCube[kBoxVertexCount] = {
+            {{-0.5f, 0.5f, 0.5f},   {0.0f, 0.0f}},
+            {{0.5f, 0.5f, 0.5f},    {1.0f, 0.0f}},
+            {{0.5f, -0.5f, 0.5f},   {1.0f, 1.0f}},
+            {{-0.5f, -0.5f, 0.5f},  {0.0f, 1.0f}},
+
+            {{-0.5f, 0.5f, -0.5f},  {1.0f, 0.0f}},
+            {{0.5f, 0.5f, -0.5f},   {0.0f, 0.0f}},
+            {{0.5f, -0.5f, -0.5f},  {0.0f, 1.0f}},
+            {{-0.5f, -0.5f, -0.5f}, {1.0f, 1.0f}},
+
+            {{0.5f, 0.5f, 0.5f},    {0.0f, 0.0f}},
+            {{0.5f, 0.5f, -0.5f},   {1.0f, 0.0f}},
+            {{0.5f, -0.5f, -0.5f},  {1.0f, 1.0f}},
+            {{0.5f, -0.5f, 0.5f},   {0.0f, 1.0f}},
+
+            {{-0.5f, 0.5f, -0.5f},  {0.0f, 0.0f}},
+            {{-0.5f, 0.5f, 0.5f},   {1.0f, 0.0f}},
+            {{-0.5f, -0.5f, 0.5f},  {1.0f, 1.0f}},
+            {{-0.5f, -0.5f, -0.5f}, {0.0f, 1.0f}},
+
+            {{-0.5f, 0.5f, -0.5f},  {0.0f, 0.0f}},
+            {{0.5f, 0.5f, -0.5f},   {1.0f, 0.0f}},
+            {{0.5f, 0.5f, 0.5f},    {1.0f, 1.0f}},
+            {{-0.5f, 0.5f, 0.5f},   {0.0f, 1.0f}},
+
+            {{-0.5f, -0.5f, 0.5f},  {0.0f, 0.0f}},
+            {{0.5f, -0.5f, 0.5f},   {1.0f, 0.0f}},
+            {{0.5f, -0.5f, -0.5f},  {1.0f, 1.0f}},
+            {{-0.5f, -0.5f, -0.5f}, {0.0f, 1.0f}},
+    };
+
+    // Two triangles per face
+    static constexpr Index kUnitCubeIndices[kBoxIndexCount] = {
+            0, 1, 2, 0, 2, 3,
+            4, 5, 6, 4, 6, 7,
+            8, 9, 10, 8, 10, 11,
+            12, 13, 14, 12, 14, 15,
+            16, 17, 18, 16, 18, 19,
+            20, 21, 22, 20, 22, 23,
+    };
+
     Index baseIndex = vertices.size();
-    
-    float halfW = width * 0.5f;
-    float halfH = height * 0.5f;
-    float halfD = depth * 0.5f;
-    
-    // Add 24 vertices (4 per face) for this box
-    // Front face
-    vertices.emplace_back(Vector3{centerX - halfW, centerY + halfH, centerZ + halfD}, Vector2{0.0f, 0.0f});
-    vertices.emplace_back(Vector3{centerX + halfW, centerY + halfH, centerZ + halfD}, Vector2{1.0f, 0.0f});
-    vertices.emplace_back(Vector3{centerX + halfW, centerY - halfH, centerZ + halfD}, Vector2{1.0f, 1.0f});
-    vertices.emplace_back(Vector3{centerX - halfW, centerY - halfH, centerZ + halfD}, Vector2{0.0f, 1.0f});
-    
-    // Back face
-    vertices.emplace_back(Vector3{centerX - halfW, centerY + halfH, centerZ - halfD}, Vector2{1.0f, 0.0f});
-    vertices.emplace_back(Vector3{centerX + halfW, centerY + halfH, centerZ - halfD}, Vector2{0.0f, 0.0f});
-    vertices.emplace_back(Vector3{centerX + halfW, centerY - halfH, centerZ - halfD}, Vector2{0.0f, 1.0f});
-    vertices.emplace_back(Vector3{centerX - halfW, centerY - halfH, centerZ - halfD}, Vector2{1.0f, 1.0f});
-    
-    // Right face
-    vertices.emplace_back(Vector3{centerX + halfW, centerY + halfH, centerZ + halfD}, Vector2{0.0f, 0.0f});
-    vertices.emplace_back(Vector3{centerX + halfW, centerY + halfH, centerZ - halfD}, Vector2{1.0f, 0.0f});
-    vertices.emplace_back(Vector3{centerX + halfW, centerY - halfH, centerZ - halfD}, Vector2{1.0f, 1.0f});
-    vertices.emplace_back(Vector3{centerX + halfW, centerY - halfH, centerZ + halfD}, Vector2{0.0f, 1.0f});
-    
-    // Left face
-    vertices.emplace_back(Vector3{centerX - halfW, centerY + halfH, centerZ - halfD}, Vector2{0.0f, 0.0f});
-    vertices.emplace_back(Vector3{centerX - halfW, centerY + halfH, centerZ + halfD}, Vector2{1.0f, 0.0f});
-    vertices.emplace_back(Vector3{centerX - halfW, centerY - halfH, centerZ + halfD}, Vector2{1.0f, 1.0f});
-    vertices.emplace_back(Vector3{centerX - halfW, centerY - halfH, centerZ - halfD}, Vector2{0.0f, 1.0f});
-    
-    // Top face
-    vertices.emplace_back(Vector3{centerX - halfW, centerY + halfH, centerZ - halfD}, Vector2{0.0f, 0.0f});
-    vertices.emplace_back(Vector3{centerX + halfW, centerY + halfH, centerZ - halfD}, Vector2{1.0f, 0.0f});
-    vertices.emplace_back(Vector3{centerX + halfW, centerY + halfH, centerZ + halfD}, Vector2{1.0f, 1.0f});
-    vertices.emplace_back(Vector3{centerX - halfW, centerY + halfH, centerZ + halfD}, Vector2{0.0f, 1.0f});
-    
-    // Bottom face
-    vertices.emplace_back(Vector3{centerX - halfW, centerY - halfH, centerZ + halfD}, Vector2{0.0f, 0.0f});
-    vertices.emplace_back(Vector3{centerX + halfW, centerY - halfH, centerZ + halfD}, Vector2{1.0f, 0.0f});
-    vertices.emplace_back(Vector3{centerX + halfW, centerY - halfH, centerZ - halfD}, Vector2{1.0f, 1.0f});
-    vertices.emplace_back(Vector3{centerX - halfW, centerY - halfH, centerZ - halfD}, Vector2{0.0f, 1.0f});
-    
-    // Add indices for this box (12 triangles, 2 per face)
-    for (int face = 0; face < 6; face++) {
-        Index faceBase = baseIndex + face * 4;
-        // Triangle 1
-        indices.push_back(faceBase + 0);
-        indices.push_back(faceBase + 1);
-        indices.push_back(faceBase + 2);
-        // Triangle 2
-        indices.push_back(faceBase + 0);
-        indices.push_back(faceBase + 2);
-        indices.push_back(faceBase + 3);
+    for (const auto &corner: kUnitCube) {
+        vertices.emplace_back(Vector3{center.x + corner.position.x * size.x,
+                                      center.y + corner.position.y * size.y,
+                                      center.z + corner.position.z * size.z},
+                              corner.uv, joint);
+    }
+    for (Index index: kUnitCubeIndices) {
+        indices.push_back(baseIndex + index);
     }
-} 
\ No newline at end of file
+}
@@ -1,13 +1,25 @@
 #ifndef HOLOPERSONA_SKELETONASSET_H
 #define HOLOPERSONA_SKELETONASSET_H
 
+#include "AnimationClip.h"
 #include "Model.h"
+#include "MorphTarget.h"
+#include "Skeleton.h"
 #include <vector>
 #include <memory>
 
 /*!
  * A class for creating and managing skeletal mesh assets for 3D characters.
  * Provides predefined skeleton types and utilities for creating humanoid figures.
+ *
+ * Every type shares the same joint hierarchy (see @a HumanoidJoint) and differs only in where
+ * the joints sit and in the boxes bound to them. Each box is rigidly bound to one joint.
+ *
+ * The detailed, athletic and slim types are built from the same boxes in the same order, so the
+ * athletic and slim builds double as morph targets of the detailed one (see @a createBodyShapes).
+ *
+ * Each type's mesh and skeleton are built once, the first time any type is asked for, and
+ * copied out from then on, so switching types costs a copy of a few hundred vertices.
  */
 class SkeletonAsset {
 public:
@@ -18,56 +30,158 @@ public:
         SLIM_HUMANOID      // Slim build with narrower proportions
     };
 
+    enum class ClipType {
+        IDLE,   // Breathing and a slow look around, 4 seconds
+        WALK    // A walk cycle in place, 1 second
+    };
+
     /*!
-     * Creates a skeletal mesh of the specified type
+     * The morph targets @a createBodyShapes adds, in order
+     */
+    enum BodyShape {
+        ATHLETIC_SHAPE,
+        SLIM_SHAPE,
+        BODY_SHAPE_COUNT
+    };
+
+    /*!
+     * The joints of every humanoid, in parent order. The values are the joint indices in the
+     * skeleton @a createSkeleton builds.
+     */
+    enum HumanoidJoint {
+        PELVIS,
+        CHEST,
+        NECK,
+        HEAD,
+        LEFT_UPPER_ARM,
+        LEFT_FOREARM,
+        LEFT_HAND,
+        RIGHT_UPPER_ARM,
+        RIGHT_FOREARM,
+        RIGHT_HAND,
+        LEFT_THIGH,
+        LEFT_SHIN,
+        LEFT_FOOT,
+        RIGHT_THIGH,
+        RIGHT_SHIN,
+        RIGHT_FOOT,
+        HUMANOID_JOINT_COUNT
+    };
+
+    /*!
+     * The faces of every box, in the order their vertices are written. The character faces +Z.
+     */
+    enum BoxFace {
+        BOX_FRONT,
+        BOX_BACK,
+        BOX_RIGHT,
+        BOX_LEFT,
+        BOX_TOP,
+        BOX_BOTTOM,
+        BOX_FACE_COUNT
+    };
+
+    // Every box has 4 vertices per face so each face gets the whole texture
+    static constexpr size_t kBoxFaceVertexCount = 4;
+    static constexpr size_t kBoxVertexCount = BOX_FACE_COUNT * kBoxFaceVertexCount;
+    static constexpr size_t kBoxIndexCount = 36;
+
+    /*!
+     * Creates a skeletal mesh of the specified type, in its rest pose
      * @param type The type of skeleton to create
      * @param vertices Output vector for vertex data
      * @param indices Output vector for index data
      */
-    static void createSkeleton(SkeletonType type, 
-                              std::vector<Vertex>& vertices, 
+    static void createSkeleton(SkeletonType type,
+                              std::vector<Vertex>& vertices,
                               std::vector<Index>& indices);
 
     /*!
-     * Creates a basic humanoid skeleton with standard proportions
+     * Creates a skeletal mesh of the specified type along with the joints it's skinned to
+     * @param type The type of skeleton to create
+     * @param vertices Output vector for vertex data, in the rest pose
+     * @param indices Output vector for index data
+     * @param skeleton Receives the joint hierarchy, must be empty
      */
-    static void createBasicHumanoid(std::vector<Vertex>& vertices, 
-                                   std::vector<Index>& indices);
+    static void createSkeleton(SkeletonType type,
+                              std::vector<Vertex>& vertices,
+                              std::vector<Index>& indices,
+                              Skeleton& skeleton);
 
     /*!
-     * Creates a detailed humanoid skeleton with proper anatomy
+     * Creates a procedural, looping animation for a skeleton made by @a createSkeleton. The same
+     * clip plays on every skeleton type, only the rest pose it's built on differs.
+     * @param type The animation to create
+     * @param skeleton The skeleton to animate
+     * @return the compressed clip, or null if the skeleton isn't a humanoid
      */
-    static void createDetailedHumanoid(std::vector<Vertex>& vertices, 
-                                      std::vector<Index>& indices);
+    static std::shared_ptr<AnimationClip> createClip(ClipType type, const Skeleton& skeleton);
 
     /*!
-     * Creates an athletic humanoid skeleton with broader build
+     * Adds the athletic and slim builds as morph targets of a detailed humanoid, so its body can
+     * be blended between builds without rebuilding the mesh. The joints keep their detailed
+     * positions.
+     * @param type The type @a vertices was created as
+     * @param vertices The mesh made by @a createSkeleton
+     * @param targets Receives one target per @a BodyShape
+     * @return false if @a type isn't DETAILED_HUMANOID, the only type the others can morph from
      */
-    static void createAthleticHumanoid(std::vector<Vertex>& vertices, 
-                                      std::vector<Index>& indices);
+    static bool createBodyShapes(SkeletonType type,
+                                 const std::vector<Vertex>& vertices,
+                                 MorphTargetSet& targets);
 
+private:
     /*!
-     * Creates a slim humanoid skeleton with narrower proportions
+     * A box bound to a joint, in rest pose model space
      */
-    static void createSlimHumanoid(std::vector<Vertex>& vertices, 
-                                  std::vector<Index>& indices);
+    struct BoxPart {
+        HumanoidJoint joint;
+        Vector3 center;
+        Vector3 size;
+    };
+
+    /*!
+     * Everything that differs between skeleton types
+     */
+    struct Preset {
+        // Rest position of each joint in model space
+        Vector3 jointPositions[HUMANOID_JOINT_COUNT];
+        const BoxPart *parts;
+        size_t partCount;
+    };
+
+    static const Preset &getPreset(SkeletonType type);
+
+    /*!
+     * The built mesh and skeleton of a type
+     */
+    struct PresetMesh {
+        std::vector<Vertex> vertices;
+        std::vector<Index> indices;
+        Skeleton skeleton;
+    };
+
+    /*!
+     * @return the cached mesh and skeleton of a type
+     */
+    static const PresetMesh &getPresetMesh(SkeletonType type);
+
+    static PresetMesh buildPresetMesh(const Preset &preset);
 
-private:
     /*!
-     * Helper function to add a box primitive to the mesh
+     * Helper function to add a box primitive to the mesh. Copies a unit cube scaled and moved
+     * into place, so reserve room for @a kBoxVertexCount and @a kBoxIndexCount more first.
      * @param vertices Vertex array to append to
      * @param indices Index array to append to
-     * @param centerX X position of box center
-     * @param centerY Y position of box center
-     * @param centerZ Z position of box center
-     * @param width Box width
-     * @param height Box height
-     * @param depth Box depth
+     * @param center The center of the box
+     * @param size The width, height and depth of the box
+     * @param joint The joint every vertex of the box is bound to
      */
-    static void addBox(std::vector<Vertex>& vertices, 
-                      std::vector<Index>& indices,
-                      float centerX, float centerY, float centerZ,
-                      float width, float height, float depth);
+    static void addBox(std::vector<Vertex>& vertices,
+                       std::vector<Index>& indices,
+                       const Vector3& center,
+                       const Vector3& size,
+                       uint8_t joint = 0);
 };
 
-#endif //HOLOPERSONA_SKELETONASSET_H 
\ No newline at end of file
+#endif //HOLOPERSONA_SKELETONASSET_H
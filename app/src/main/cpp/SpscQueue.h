@@ -0,0 +1,75 @@
+#ifndef HOLOPERSONA_SPSCQUEUE_H
+#define HOLOPERSONA_SPSCQUEUE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+/*!
+ * A fixed size, lock-free queue with one producer thread and one consumer thread. Neither side
+ * ever blocks or allocates, so the render thread can drain it every frame at the cost of a couple
+ * of atomic loads.
+ *
+ * Each side keeps its own copy of the other's index and only reloads the shared one when its copy
+ * says the queue is full or empty, so the two cache lines are rarely passed back and forth.
+ *
+ * @tparam T a trivially copyable item
+ * @tparam Capacity the number of items the queue holds, a power of two
+ */
+template<typename T, size_t Capacity>
+class SpscQueue {
+public:
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "The capacity must be a power of two");
+    static_assert(std::is_trivially_copyable<T>::value, "Items are copied in and out");
+
+    /*!
+     * Adds an item. Producer thread only.
+     * @return false if the queue is full, in which case the item is dropped
+     */
+    bool push(const T &item) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - producerHead_ == Capacity) {
+            producerHead_ = head_.load(std::memory_order_acquire);
+            if (tail - producerHead_ == Capacity) {
+                return false;
+            }
+        }
+        slots_[tail & kMask] = item;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /*!
+     * Removes the oldest item. Consumer thread only.
+     * @return false if the queue is empty
+     */
+    bool pop(T &outItem) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == consumerTail_) {
+            consumerTail_ = tail_.load(std::memory_order_acquire);
+            if (head == consumerTail_) {
+                return false;
+            }
+        }
+        outItem = slots_[head & kMask];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    static constexpr size_t kMask = Capacity - 1;
+
+    // Written by the consumer, with the consumer's copy of the tail
+    alignas(64) std::atomic<size_t> head_{0};
+    size_t consumerTail_ = 0;
+
+    // Written by the producer, with the producer's copy of the head
+    alignas(64) std::atomic<size_t> tail_{0};
+    size_t producerHead_ = 0;
+
+    alignas(64) std::array<T, Capacity> slots_;
+};
+
+#endif //HOLOPERSONA_SPSCQUEUE_H
@@ -1,8 +1,13 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "TextureAsset.h"
 #include "AndroidOut.h"
+#include "ImageKernels.h"
+#include "KtxContainer.h"
+#include "Profiler.h"
 #include "Utility.h"
 #include <GLES3/gl3.h>
+#include <algorithm>
+#include <cstring>
 
 // Single header image loading library - works with all Android API levels
 #define STBI_ONLY_PNG
@@ -11,6 +16,7 @@
 
 std::shared_ptr<TextureAsset>
 TextureAsset::loadAsset(AAssetManager *assetManager, const std::string &assetPath) {
+    PROFILE_ZONE("TextureAsset::loadAsset");
     // Get the image from asset manager
     auto pAsset = AAssetManager_open(
             assetManager,
@@ -32,6 +38,22 @@ TextureAsset::loadAsset(AAssetManager *assetManager, const std::string &assetPat
         return nullptr;
     }
 
+    // Compressed textures come in KTX containers with their mip chain already built
+    if (KtxContainer::isKtx(assetData, assetSize)) {
+        KtxContainer container;
+        std::string error;
+        std::shared_ptr<TextureAsset> spTexture;
+        if (KtxContainer::parse(assetData, assetSize, container, &error)) {
+            spTexture = createFromKtx(container, assetPath);
+        } else {
+            aout << "Failed to parse KTX container " << assetPath << ": " << error << std::endl;
+        }
+
+        // The level data points into the asset buffer, so only close it after uploading
+        AAsset_close(pAsset);
+        return spTexture;
+    }
+
     // Use stb_image to decode the image data
     int width, height, channels;
     unsigned char* imageData = stbi_load_from_memory(
@@ -48,6 +70,56 @@ TextureAsset::loadAsset(AAssetManager *assetManager, const std::string &assetPat
         return nullptr;
     }
 
+    auto spTexture = createFromPixels(imageData, width, height);
+
+    // cleanup the image data
+    stbi_image_free(imageData);
+
+    return spTexture;
+}
+
+bool TextureAsset::decodeAsset(AAssetManager *assetManager,
+                               const std::string &assetPath,
+                               std::vector<uint8_t> &outPixels,
+                               int &outWidth,
+                               int &outHeight,
+                               bool premultiplyAlpha) {
+    auto pAsset = AAssetManager_open(assetManager, assetPath.c_str(), AASSET_MODE_BUFFER);
+    if (!pAsset) {
+        aout << "Failed to open asset: " << assetPath << std::endl;
+        return false;
+    }
+
+    const void *assetData = AAsset_getBuffer(pAsset);
+    if (!assetData) {
+        aout << "Failed to get asset buffer: " << assetPath << std::endl;
+        AAsset_close(pAsset);
+        return false;
+    }
+
+    int channels;
+    unsigned char *imageData = stbi_load_from_memory(
+            static_cast<const stbi_uc *>(assetData),
+            static_cast<int>(AAsset_getLength(pAsset)),
+            &outWidth, &outHeight, &channels, 4);
+    AAsset_close(pAsset);
+
+    if (!imageData) {
+        aout << "Failed to decode image: " << assetPath << std::endl;
+        return false;
+    }
+
+    outPixels.assign(imageData, imageData + size_t(outWidth) * outHeight * 4);
+    stbi_image_free(imageData);
+
+    if (premultiplyAlpha) {
+        ImageKernels::premultiplyAlpha(outPixels.data(), size_t(outWidth) * outHeight);
+    }
+    return true;
+}
+
+std::shared_ptr<TextureAsset>
+TextureAsset::createFromPixels(const uint8_t *pixels, int width, int height) {
     // Get an opengl texture
     GLuint textureId;
     glGenTextures(1, &textureId);
@@ -70,17 +142,107 @@ TextureAsset::loadAsset(AAssetManager *assetManager, const std::string &assetPat
             0, // border (always 0)
             GL_RGBA, // format
             GL_UNSIGNED_BYTE, // type
-            imageData // Data to upload
+            pixels // Data to upload
     );
 
     // generate mip levels. Not really needed for 2D, but good to do
     glGenerateMipmap(GL_TEXTURE_2D);
 
-    // cleanup the image data
-    stbi_image_free(imageData);
+    // A full mip chain adds a third on top of the base level
+    size_t byteSize = size_t(width) * height * 4 * 4 / 3;
 
     // Create a shared pointer so it can be cleaned up easily/automatically
-    return std::shared_ptr<TextureAsset>(new TextureAsset(textureId));
+    return std::shared_ptr<TextureAsset>(new TextureAsset(textureId, byteSize));
+}
+
+std::shared_ptr<TextureAsset>
+TextureAsset::loadCompressedAsset(AAssetManager *assetManager,
+                                  const std::string &basePath,
+                                  bool streaming) {
+    auto load = streaming ? loadStreamingAsset : loadAsset;
+    std::shared_ptr<TextureAsset> spTexture;
+    if (isAstcSupported()) {
+        spTexture = load(assetManager, basePath + ".astc.ktx2");
+    }
+    if (!spTexture) {
+        spTexture = load(assetManager, basePath + ".etc2.ktx2");
+    }
+    if (!spTexture) {
+        spTexture = load(assetManager, basePath + ".png");
+    }
+    return spTexture;
+}
+
+bool TextureAsset::isAstcSupported() {
+    // Extensions don't change for the lifetime of the process, only query them once
+    static const bool astcSupported = []() {
+        GLint extensionCount = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+        for (GLint i = 0; i < extensionCount; i++) {
+            auto extension = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, i));
+            if (extension && strcmp(extension, "GL_KHR_texture_compression_astc_ldr") == 0) {
+                return true;
+            }
+        }
+        return false;
+    }();
+    return astcSupported;
+}
+
+std::shared_ptr<TextureAsset>
+TextureAsset::createFromKtx(const KtxContainer &container, const std::string &assetPath) {
+    if (container.isAstc() && !isAstcSupported()) {
+        aout << "ASTC is not supported on this device, can't load " << assetPath << std::endl;
+        return nullptr;
+    }
+
+    GLuint textureId;
+    glGenTextures(1, &textureId);
+    glBindTexture(GL_TEXTURE_2D, textureId);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    // Only sample the levels the container actually has so a partial chain is still complete
+    GLint levelCount = static_cast<GLint>(container.getLevelCount());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                    levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    for (GLint level = 0; level < levelCount; level++) {
+        const auto &mip = container.getLevel(level);
+        if (container.isCompressed()) {
+            glCompressedTexImage2D(
+                    GL_TEXTURE_2D,
+                    level,
+                    container.getGlInternalFormat(),
+                    mip.width,
+                    mip.height,
+                    0,
+                    static_cast<GLsizei>(mip.size),
+                    mip.data);
+        } else {
+            glTexImage2D(
+                    GL_TEXTURE_2D,
+                    level,
+                    container.getGlInternalFormat(),
+                    mip.width,
+                    mip.height,
+                    0,
+                    container.getGlFormat(),
+                    container.getGlType(),
+                    mip.data);
+        }
+    }
+
+    if (!Utility::checkAndLogGlError()) {
+        aout << "Failed to upload KTX texture " << assetPath << std::endl;
+        glDeleteTextures(1, &textureId);
+        return nullptr;
+    }
+
+    return std::shared_ptr<TextureAsset>(new TextureAsset(textureId, container.getTotalSize()));
 }
 
 std::shared_ptr<TextureAsset> TextureAsset::createSimpleTexture() {
@@ -106,7 +268,208 @@ std::shared_ptr<TextureAsset> TextureAsset::createSimpleTexture() {
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 2, 2, 0, GL_RGBA, GL_UNSIGNED_BYTE, textureData);
     
     // Create a shared pointer using the private constructor
-    return std::shared_ptr<TextureAsset>(new TextureAsset(textureId));
+    return std::shared_ptr<TextureAsset>(new TextureAsset(textureId, sizeof(textureData)));
+}
+
+std::shared_ptr<TextureAsset>
+TextureAsset::loadStreamingAsset(AAssetManager *assetManager, const std::string &assetPath) {
+    auto pAsset = AAssetManager_open(assetManager, assetPath.c_str(), AASSET_MODE_BUFFER);
+    if (!pAsset) {
+        aout << "Failed to open asset: " << assetPath << std::endl;
+        return nullptr;
+    }
+
+    off_t assetSize = AAsset_getLength(pAsset);
+    const void *assetData = AAsset_getBuffer(pAsset);
+    if (!assetData) {
+        aout << "Failed to get asset buffer: " << assetPath << std::endl;
+        AAsset_close(pAsset);
+        return nullptr;
+    }
+
+    if (KtxContainer::isKtx(assetData, assetSize)) {
+        KtxContainer container;
+        std::string error;
+        if (!KtxContainer::parse(assetData, assetSize, container, &error)) {
+            aout << "Failed to parse KTX container " << assetPath << ": " << error << std::endl;
+            AAsset_close(pAsset);
+            return nullptr;
+        }
+        if (container.isAstc() && !isAstcSupported()) {
+            aout << "ASTC is not supported on this device, can't load " << assetPath << std::endl;
+            AAsset_close(pAsset);
+            return nullptr;
+        }
+
+        auto streaming = std::make_unique<StreamingState>();
+        streaming->internalFormat = container.getGlInternalFormat();
+        streaming->format = container.getGlFormat();
+        streaming->type = container.getGlType();
+        streaming->compressed = container.isCompressed();
+        for (size_t i = 0; i < container.getLevelCount(); i++) {
+            const auto &level = container.getLevel(i);
+            streaming->levels.push_back(
+                    {level.width, level.height, {level.data, level.data + level.size}});
+        }
+        AAsset_close(pAsset);
+        return createStreaming(std::move(streaming), assetPath);
+    }
+
+    int width, height, channels;
+    unsigned char *imageData = stbi_load_from_memory(
+            static_cast<const stbi_uc *>(assetData),
+            static_cast<int>(assetSize),
+            &width, &height, &channels, 4);
+    AAsset_close(pAsset);
+    if (!imageData) {
+        aout << "Failed to decode image: " << assetPath << std::endl;
+        return nullptr;
+    }
+
+    auto spTexture = createStreamingFromPixels(imageData, width, height);
+    stbi_image_free(imageData);
+    return spTexture;
+}
+
+std::shared_ptr<TextureAsset>
+TextureAsset::createStreamingFromPixels(const uint8_t *pixels, int width, int height) {
+    auto streaming = std::make_unique<StreamingState>();
+    streaming->internalFormat = GL_RGBA8;
+    streaming->format = GL_RGBA;
+    streaming->type = GL_UNSIGNED_BYTE;
+    streaming->compressed = false;
+    streaming->levels.push_back({uint32_t(width), uint32_t(height),
+                                 {pixels, pixels + size_t(width) * height * 4}});
+
+    // Build the rest of the chain on the CPU since we can't read levels back from GL
+    while (streaming->levels.back().width > 1 || streaming->levels.back().height > 1) {
+        const auto &src = streaming->levels.back();
+        StreamingState::Level dst{ImageKernels::mipDimension(src.width),
+                                  ImageKernels::mipDimension(src.height),
+                                  {}};
+        dst.data.resize(size_t(dst.width) * dst.height * 4);
+        ImageKernels::downsample(src.data.data(), src.width, src.height, dst.data.data());
+        streaming->levels.push_back(std::move(dst));
+    }
+
+    return createStreaming(std::move(streaming), "pixels");
+}
+
+std::shared_ptr<TextureAsset>
+TextureAsset::createStreaming(std::unique_ptr<StreamingState> streaming,
+                              const std::string &assetPath) {
+    // Start from the first level small enough to be cheap to upload
+    size_t lastLevel = streaming->levels.size() - 1;
+    size_t initialLevel = 0;
+    while (initialLevel < lastLevel
+           && std::max(streaming->levels[initialLevel].width,
+                       streaming->levels[initialLevel].height) > kInitialStreamSize) {
+        initialLevel++;
+    }
+    streaming->initialLevel = initialLevel;
+    streaming->residentLevel = lastLevel + 1;
+    streaming->requestedLevel = lastLevel;
+    streaming->lastRequestedLevel = lastLevel;
+
+    auto spTexture = std::shared_ptr<TextureAsset>(new TextureAsset(0, 0));
+    spTexture->streaming_ = std::move(streaming);
+    if (!spTexture->makeResident(initialLevel)) {
+        aout << "Failed to upload streaming texture " << assetPath << std::endl;
+        return nullptr;
+    }
+    return spTexture;
+}
+
+void TextureAsset::requestScreenSize(float pixels) {
+    if (!streaming_) {
+        return;
+    }
+
+    // Find the coarsest level that still has at least one texel per pixel
+    const auto &levels = streaming_->levels;
+    size_t level = 0;
+    while (level + 1 < levels.size()
+           && float(std::max(levels[level + 1].width, levels[level + 1].height)) >= pixels) {
+        level++;
+    }
+    streaming_->requestedLevel = std::min(streaming_->requestedLevel, level);
+}
+
+bool TextureAsset::updateResidency(bool allowGrowth) {
+    if (!streaming_) {
+        return false;
+    }
+
+    // Only one level per frame so a large texture doesn't upload its whole chain in one hitch
+    bool changed = false;
+    if (allowGrowth && streaming_->requestedLevel < streaming_->residentLevel) {
+        changed = makeResident(streaming_->residentLevel - 1);
+    }
+
+    streaming_->lastRequestedLevel = streaming_->requestedLevel;
+    streaming_->requestedLevel = streaming_->levels.size() - 1;
+    return changed;
+}
+
+bool TextureAsset::dropUnusedLevels() {
+    if (!streaming_) {
+        return false;
+    }
+
+    size_t target = std::min(streaming_->lastRequestedLevel, streaming_->initialLevel);
+    return target > streaming_->residentLevel && makeResident(target);
+}
+
+bool TextureAsset::dropToInitialLevels() {
+    if (!streaming_) {
+        return false;
+    }
+    return streaming_->initialLevel > streaming_->residentLevel
+           && makeResident(streaming_->initialLevel);
+}
+
+bool TextureAsset::makeResident(size_t level) {
+    const auto &levels = streaming_->levels;
+
+    // Immutable storage can't grow new levels, so build a fresh texture with the new chain
+    GLuint textureId;
+    glGenTextures(1, &textureId);
+    glBindTexture(GL_TEXTURE_2D, textureId);
+
+    GLint levelCount = static_cast<GLint>(levels.size() - level);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                    levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexStorage2D(GL_TEXTURE_2D, levelCount, streaming_->internalFormat,
+                   levels[level].width, levels[level].height);
+
+    size_t byteSize = 0;
+    for (GLint i = 0; i < levelCount; i++) {
+        const auto &mip = levels[level + i];
+        if (streaming_->compressed) {
+            glCompressedTexSubImage2D(GL_TEXTURE_2D, i, 0, 0, mip.width, mip.height,
+                                      streaming_->internalFormat,
+                                      static_cast<GLsizei>(mip.data.size()), mip.data.data());
+        } else {
+            glTexSubImage2D(GL_TEXTURE_2D, i, 0, 0, mip.width, mip.height,
+                            streaming_->format, streaming_->type, mip.data.data());
+        }
+        byteSize += mip.data.size();
+    }
+
+    if (!Utility::checkAndLogGlError()) {
+        glDeleteTextures(1, &textureId);
+        return false;
+    }
+
+    glDeleteTextures(1, &textureID_);
+    textureID_ = textureId;
+    byteSize_ = byteSize;
+    streaming_->residentLevel = level;
+    return true;
 }
 
 TextureAsset::~TextureAsset() {
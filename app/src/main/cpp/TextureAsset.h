@@ -7,10 +7,14 @@
 #include <string>
 #include <vector>
 
+class KtxContainer;
+
 class TextureAsset {
 public:
     /*!
-     * Loads a texture asset from the assets/ directory
+     * Loads a texture asset from the assets/ directory. PNG and JPEG images are decoded and
+     * uploaded as RGBA8 with generated mips. KTX and KTX2 containers are uploaded as-is using the
+     * mip chain they carry, which is how ETC2 and ASTC compressed textures are loaded.
      * @param assetManager Asset manager to use
      * @param assetPath The path to the asset
      * @return a shared pointer to a texture asset, resources will be reclaimed when it's cleaned up
@@ -18,23 +22,188 @@ public:
     static std::shared_ptr<TextureAsset>
     loadAsset(AAssetManager *assetManager, const std::string &assetPath);
 
+    /*!
+     * Loads the best available compressed variant of a texture. Tries @a basePath + ".astc.ktx2"
+     * when the device supports ASTC, then @a basePath + ".etc2.ktx2", which every GLES 3 device
+     * can sample, and finally @a basePath + ".png".
+     * @param assetManager Asset manager to use
+     * @param basePath The path to the asset without its extension
+     * @param streaming true to load the variant with @a loadStreamingAsset
+     * @return a shared pointer to a texture asset, or null if no variant could be loaded
+     */
+    static std::shared_ptr<TextureAsset>
+    loadCompressedAsset(AAssetManager *assetManager,
+                        const std::string &basePath,
+                        bool streaming = false);
+
+    /*!
+     * @return true if the current context can sample ASTC LDR textures
+     */
+    static bool isAstcSupported();
+
+    /*!
+     * Creates a texture from tightly packed RGBA8 pixels and generates its mips
+     * @param pixels width * height * 4 bytes of pixel data
+     * @param width the width of the image in pixels
+     * @param height the height of the image in pixels
+     * @return a shared pointer to a texture asset
+     */
+    static std::shared_ptr<TextureAsset>
+    createFromPixels(const uint8_t *pixels, int width, int height);
+
+    /*!
+     * Decodes a PNG or JPEG asset to RGBA8 pixels without creating a texture, for CPU side
+     * processing such as atlas packing
+     * @param assetManager Asset manager to use
+     * @param assetPath The path to the asset
+     * @param outPixels receives width * height * 4 bytes of pixel data
+     * @param outWidth receives the width of the image
+     * @param outHeight receives the height of the image
+     * @param premultiplyAlpha multiplies the color channels by alpha after decoding
+     * @return true if successful, false otherwise
+     */
+    static bool decodeAsset(AAssetManager *assetManager,
+                            const std::string &assetPath,
+                            std::vector<uint8_t> &outPixels,
+                            int &outWidth,
+                            int &outHeight,
+                            bool premultiplyAlpha = false);
+
     /*!
      * Creates a simple colored texture
      * @return a shared pointer to a texture asset with a simple pattern
      */
     static std::shared_ptr<TextureAsset> createSimpleTexture();
 
+    /*!
+     * Loads a texture that streams its mip levels in. Only the levels no larger than
+     * @a kInitialStreamSize are uploaded up front; finer levels are uploaded one at a time by
+     * @a updateResidency as @a requestScreenSize asks for them. A CPU copy of the whole mip chain
+     * is kept so levels can be dropped and brought back without touching the asset again.
+     *
+     * Accepts the same PNG, JPEG, KTX and KTX2 files as @a loadAsset.
+     * @param assetManager Asset manager to use
+     * @param assetPath The path to the asset
+     * @return a shared pointer to a texture asset, or null on failure
+     */
+    static std::shared_ptr<TextureAsset>
+    loadStreamingAsset(AAssetManager *assetManager, const std::string &assetPath);
+
+    /*!
+     * Like @a createFromPixels but streams the mip levels in as @a loadStreamingAsset does. The
+     * mip chain is built on the CPU and kept.
+     * @param pixels width * height * 4 bytes of pixel data
+     * @param width the width of the image in pixels
+     * @param height the height of the image in pixels
+     * @return a shared pointer to a texture asset, or null on failure
+     */
+    static std::shared_ptr<TextureAsset>
+    createStreamingFromPixels(const uint8_t *pixels, int width, int height);
+
     ~TextureAsset();
 
+    /*!
+     * @return true if this texture was created by @a loadStreamingAsset or
+     *     @a createStreamingFromPixels
+     */
+    inline bool isStreaming() const { return streaming_ != nullptr; }
+
+    /*!
+     * Tells a streaming texture how large something using it appears on screen this frame. Call
+     * once per visible model; the largest request since the last @a updateResidency wins.
+     * Does nothing for textures that aren't streaming.
+     * @param pixels the on-screen size in pixels of the surface the texture is mapped onto
+     */
+    void requestScreenSize(float pixels);
+
+    /*!
+     * Uploads the next finer mip level if the requested screen size needs it, then starts
+     * collecting requests for the next frame.
+     * @param allowGrowth false to only collect requests, eg when over a memory budget
+     * @return true if the texture changed and its byte size needs re-counting
+     */
+    bool updateResidency(bool allowGrowth);
+
+    /*!
+     * Releases mip levels finer than the ones requested during the last frame
+     * @return true if anything was released
+     */
+    bool dropUnusedLevels();
+
+    /*!
+     * Releases every mip level larger than @a kInitialStreamSize
+     * @return true if anything was released
+     */
+    bool dropToInitialLevels();
+
     /*!
      * @return the texture id for use with OpenGL
      */
     constexpr GLuint getTextureID() const { return textureID_; }
 
+    /*!
+     * @return the estimated VRAM used by the texture including its mips, in bytes
+     */
+    constexpr size_t getByteSize() const { return byteSize_; }
+
+    //! Streaming textures start with levels no larger than this many pixels across
+    static constexpr uint32_t kInitialStreamSize = 64;
+
 private:
-    inline TextureAsset(GLuint textureId) : textureID_(textureId) {}
+    /*!
+     * Uploads every level of a parsed KTX container to a new texture
+     * @param container the parsed container, its payload must still be in memory
+     * @param assetPath the path the container was loaded from, for logging
+     * @return a shared pointer to a texture asset, or null if the format can't be used here
+     */
+    static std::shared_ptr<TextureAsset>
+    createFromKtx(const KtxContainer &container, const std::string &assetPath);
+
+    /*!
+     * The CPU side copy of a streaming texture's mip chain
+     */
+    struct StreamingState {
+        struct Level {
+            uint32_t width;
+            uint32_t height;
+            std::vector<uint8_t> data;
+        };
+
+        GLenum internalFormat;
+        GLenum format;
+        GLenum type;
+        bool compressed;
+        std::vector<Level> levels;
+
+        // The level streaming starts from and falls back to under memory pressure
+        size_t initialLevel;
+        // The finest level currently in VRAM, 0 being full resolution
+        size_t residentLevel;
+        // The finest level needed by requests collected so far this frame
+        size_t requestedLevel;
+        // The finest level that was needed during the previous frame
+        size_t lastRequestedLevel;
+    };
+
+    /*!
+     * Takes ownership of a CPU mip chain and uploads its initial levels
+     */
+    static std::shared_ptr<TextureAsset>
+    createStreaming(std::unique_ptr<StreamingState> streaming, const std::string &assetPath);
+
+    /*!
+     * Replaces the GL texture with one holding levels @a level and coarser
+     * @return true on success, on failure the previous texture is kept
+     */
+    bool makeResident(size_t level);
+
+    inline TextureAsset(GLuint textureId, size_t byteSize)
+            : textureID_(textureId),
+              byteSize_(byteSize) {}
 
     GLuint textureID_;
+    size_t byteSize_;
+    std::unique_ptr<StreamingState> streaming_;
 };
 
 #endif //ANDROIDGLINVESTIGATIONS_TEXTUREASSET_H
\ No newline at end of file
@@ -0,0 +1,165 @@
+#include "TextureAtlas.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "AndroidOut.h"
+
+TextureAtlas::TextureAtlas(uint32_t maxSize, uint32_t padding)
+        : maxSize_(maxSize),
+          padding_(padding),
+          width_(0),
+          height_(0) {}
+
+int TextureAtlas::addImage(const uint8_t *pixels, uint32_t width, uint32_t height) {
+    if (!pixels || width == 0 || height == 0
+        || width + 2 * padding_ > maxSize_ || height + 2 * padding_ > maxSize_) {
+        aout << "TextureAtlas: can't add " << width << "x" << height << " image" << std::endl;
+        return -1;
+    }
+
+    Image image{width, height, {}, 0, 0};
+    image.pixels.assign(pixels, pixels + size_t(width) * height * 4);
+    images_.push_back(std::move(image));
+    return static_cast<int>(images_.size() - 1);
+}
+
+int TextureAtlas::addAsset(AAssetManager *assetManager, const std::string &assetPath) {
+    std::vector<uint8_t> pixels;
+    int width, height;
+    if (!TextureAsset::decodeAsset(assetManager, assetPath, pixels, width, height)) {
+        return -1;
+    }
+    return addImage(pixels.data(), width, height);
+}
+
+bool TextureAtlas::pack() {
+    regions_.clear();
+    pixels_.clear();
+    width_ = 0;
+    height_ = 0;
+
+    if (images_.empty()) {
+        return false;
+    }
+
+    // Shelf packing wastes the least space when the tallest images go first
+    std::vector<size_t> order(images_.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+        return images_[a].height > images_[b].height;
+    });
+
+    // Start from the smallest power of two that could hold the total area
+    size_t totalArea = 0;
+    for (const auto &image: images_) {
+        totalArea += size_t(image.width + 2 * padding_) * (image.height + 2 * padding_);
+    }
+    uint32_t size = 64;
+    while (size < maxSize_ && size_t(size) * size < totalArea) {
+        size *= 2;
+    }
+
+    for (; size <= maxSize_; size *= 2) {
+        if (layout(size, order)) {
+            break;
+        }
+    }
+    if (size > maxSize_) {
+        aout << "TextureAtlas: " << images_.size() << " images don't fit in " << maxSize_ << "x"
+             << maxSize_ << std::endl;
+        return false;
+    }
+
+    width_ = size;
+    height_ = size;
+    pixels_.assign(size_t(width_) * height_ * 4, 0);
+    regions_.resize(images_.size());
+    for (size_t i = 0; i < images_.size(); i++) {
+        const auto &image = images_[i];
+        blit(image);
+        regions_[i] = {
+                float(image.x) / width_,
+                float(image.y) / height_,
+                float(image.x + image.width) / width_,
+                float(image.y + image.height) / height_
+        };
+    }
+
+    aout << "TextureAtlas: packed " << images_.size() << " images into " << width_ << "x"
+         << height_ << std::endl;
+    return true;
+}
+
+bool TextureAtlas::layout(uint32_t size, const std::vector<size_t> &order) {
+    uint32_t shelfX = 0;
+    uint32_t shelfY = 0;
+    uint32_t shelfHeight = 0;
+
+    for (size_t index: order) {
+        auto &image = images_[index];
+        uint32_t paddedWidth = image.width + 2 * padding_;
+        uint32_t paddedHeight = image.height + 2 * padding_;
+
+        // Start a new shelf when this one is full
+        if (shelfX + paddedWidth > size) {
+            shelfY += shelfHeight;
+            shelfX = 0;
+            shelfHeight = 0;
+        }
+        if (paddedWidth > size || shelfY + paddedHeight > size) {
+            return false;
+        }
+
+        image.x = shelfX + padding_;
+        image.y = shelfY + padding_;
+        shelfX += paddedWidth;
+        shelfHeight = std::max(shelfHeight, paddedHeight);
+    }
+    return true;
+}
+
+void TextureAtlas::blit(const Image &image) {
+    const size_t rowBytes = size_t(image.width) * 4;
+
+    // Copy each row and stretch its first and last pixel out across the horizontal padding
+    for (uint32_t row = 0; row < image.height; row++) {
+        const uint8_t *src = image.pixels.data() + row * rowBytes;
+        uint8_t *dst = pixels_.data() + (size_t(image.y + row) * width_ + image.x) * 4;
+        memcpy(dst, src, rowBytes);
+        for (uint32_t p = 1; p <= padding_; p++) {
+            memcpy(dst - p * 4, src, 4);
+            memcpy(dst + rowBytes + (p - 1) * 4, src + rowBytes - 4, 4);
+        }
+    }
+
+    // Then repeat the first and last padded rows vertically
+    const size_t paddedRowBytes = rowBytes + 2 * padding_ * 4;
+    uint8_t *firstRow = pixels_.data() + (size_t(image.y) * width_ + image.x - padding_) * 4;
+    uint8_t *lastRow = firstRow + size_t(image.height - 1) * width_ * 4;
+    for (uint32_t p = 1; p <= padding_; p++) {
+        memcpy(firstRow - size_t(p) * width_ * 4, firstRow, paddedRowBytes);
+        memcpy(lastRow + size_t(p) * width_ * 4, lastRow, paddedRowBytes);
+    }
+}
+
+std::shared_ptr<TextureAsset> TextureAtlas::createTexture(bool streaming) const {
+    if (pixels_.empty()) {
+        aout << "TextureAtlas: createTexture called before pack" << std::endl;
+        return nullptr;
+    }
+    return streaming ? TextureAsset::createStreamingFromPixels(pixels_.data(), width_, height_)
+                     : TextureAsset::createFromPixels(pixels_.data(), width_, height_);
+}
+
+void TextureAtlas::remapUVs(Vertex *vertices, size_t count, const Region &region) {
+    const float scaleU = region.u1 - region.u0;
+    const float scaleV = region.v1 - region.v0;
+    for (size_t i = 0; i < count; i++) {
+        auto &uv = vertices[i].uv;
+        uv.u = region.u0 + std::clamp(uv.u, 0.f, 1.f) * scaleU;
+        uv.v = region.v0 + std::clamp(uv.v, 0.f, 1.f) * scaleV;
+    }
+}
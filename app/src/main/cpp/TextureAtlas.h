@@ -0,0 +1,130 @@
+#ifndef HOLOPERSONA_TEXTUREATLAS_H
+#define HOLOPERSONA_TEXTUREATLAS_H
+
+#include <android/asset_manager.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Model.h"
+#include "TextureAsset.h"
+
+/*!
+ * Packs several small material textures (skin, hair, eyes, suit, ...) into a single atlas at load
+ * time so a whole character can be drawn with one texture binding.
+ *
+ * Add every image, call @a pack, then remap the UVs of each material's vertices into its region
+ * with @a remapUVs and upload the atlas with @a createTexture.
+ *
+ * ex:
+ *  TextureAtlas atlas;
+ *  int skin = atlas.addAsset(assetManager, "skin.png");
+ *  int suit = atlas.addAsset(assetManager, "suit.png");
+ *  if (atlas.pack()) {
+ *      TextureAtlas::remapUVs(skinVertices, skinVertexCount, atlas.getRegion(skin));
+ *      TextureAtlas::remapUVs(suitVertices, suitVertexCount, atlas.getRegion(suit));
+ *      auto spTexture = atlas.createTexture();
+ *  }
+ */
+class TextureAtlas {
+public:
+    /*!
+     * The normalized rectangle an image occupies in the atlas
+     */
+    struct Region {
+        float u0, v0;
+        float u1, v1;
+    };
+
+    /*!
+     * @param maxSize the largest width and height the atlas may grow to
+     * @param padding pixels of edge extrusion around every image, stops bilinear filtering and
+     *     lower mips from bleeding neighbouring images into each other
+     */
+    explicit TextureAtlas(uint32_t maxSize = 2048, uint32_t padding = 4);
+
+    /*!
+     * Adds a copy of an RGBA8 image to the atlas
+     * @param pixels width * height * 4 bytes of pixel data
+     * @param width the width of the image
+     * @param height the height of the image
+     * @return the image index to pass to @a getRegion, or -1 if the image can never fit
+     */
+    int addImage(const uint8_t *pixels, uint32_t width, uint32_t height);
+
+    /*!
+     * Decodes a PNG or JPEG asset and adds it to the atlas
+     * @return the image index to pass to @a getRegion, or -1 on failure
+     */
+    int addAsset(AAssetManager *assetManager, const std::string &assetPath);
+
+    /*!
+     * Lays out all added images and composes the atlas pixels. Images are placed tallest first on
+     * shelves, growing the atlas in powers of two until everything fits.
+     * @return true if every image fits within maxSize x maxSize
+     */
+    bool pack();
+
+    /*!
+     * @param image an index returned by @a addImage or @a addAsset
+     * @return the region of the image, only valid after a successful @a pack
+     */
+    inline const Region &getRegion(int image) const { return regions_[image]; }
+
+    inline uint32_t getWidth() const { return width_; }
+
+    inline uint32_t getHeight() const { return height_; }
+
+    /*!
+     * @return the composed RGBA8 atlas, only valid after a successful @a pack
+     */
+    inline const std::vector<uint8_t> &getPixels() const { return pixels_; }
+
+    /*!
+     * Uploads the packed atlas to a new texture
+     * @param streaming true to stream the finer mip levels in, see
+     *     @a TextureAsset::createStreamingFromPixels
+     * @return a shared pointer to a texture asset, or null if the atlas hasn't been packed
+     */
+    std::shared_ptr<TextureAsset> createTexture(bool streaming = false) const;
+
+    /*!
+     * Moves UVs from an image's own 0..1 space into its atlas region. Coordinates outside 0..1 are
+     * clamped since wrapping can't be expressed inside an atlas.
+     * @param vertices the vertices of the material that used the image
+     * @param count the number of vertices
+     * @param region the region returned by @a getRegion
+     */
+    static void remapUVs(Vertex *vertices, size_t count, const Region &region);
+
+private:
+    struct Image {
+        uint32_t width;
+        uint32_t height;
+        std::vector<uint8_t> pixels;
+        uint32_t x;
+        uint32_t y;
+    };
+
+    /*!
+     * Tries to place every image into a size x size atlas
+     * @return true if all images fit
+     */
+    bool layout(uint32_t size, const std::vector<size_t> &order);
+
+    /*!
+     * Copies an image into the atlas pixels and extrudes its border into the padding
+     */
+    void blit(const Image &image);
+
+    uint32_t maxSize_;
+    uint32_t padding_;
+    uint32_t width_;
+    uint32_t height_;
+    std::vector<Image> images_;
+    std::vector<Region> regions_;
+    std::vector<uint8_t> pixels_;
+};
+
+#endif //HOLOPERSONA_TEXTUREATLAS_H
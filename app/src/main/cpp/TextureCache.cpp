@@ -0,0 +1,142 @@
+#include "TextureCache.h"
+
+#include "AndroidOut.h"
+#include "Log.h"
+
+// Values of ComponentCallbacks2.TRIM_MEMORY_*
+static constexpr int kTrimMemoryRunningModerate = 5;
+static constexpr int kTrimMemoryUiHidden = 20;
+
+TextureCache::TextureCache(size_t budgetBytes)
+        : budgetBytes_(budgetBytes),
+          residentBytes_(0) {}
+
+std::shared_ptr<TextureAsset>
+TextureCache::load(AAssetManager *assetManager, const std::string &assetPath) {
+    return getOrCreate(assetPath, [assetManager, &assetPath]() {
+        return TextureAsset::loadAsset(assetManager, assetPath);
+    });
+}
+
+std::shared_ptr<TextureAsset>
+TextureCache::loadStreaming(AAssetManager *assetManager, const std::string &assetPath) {
+    return getOrCreate(assetPath, [assetManager, &assetPath]() {
+        return TextureAsset::loadStreamingAsset(assetManager, assetPath);
+    });
+}
+
+std::shared_ptr<TextureAsset> TextureCache::getOrCreate(
+        const std::string &key,
+        const std::function<std::shared_ptr<TextureAsset>()> &create) {
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+        touch(it->second);
+        return it->second.spTexture;
+    }
+
+    auto spTexture = create();
+    if (!spTexture) {
+        return nullptr;
+    }
+
+    insert(key, spTexture);
+    if (residentBytes_ > budgetBytes_) {
+        evict(budgetBytes_);
+    }
+    return spTexture;
+}
+
+void TextureCache::setBudget(size_t budgetBytes) {
+    budgetBytes_ = budgetBytes;
+    if (residentBytes_ > budgetBytes_) {
+        evict(budgetBytes_);
+    }
+}
+
+bool TextureCache::updateResidency(size_t maxUploads) {
+    bool allowGrowth = residentBytes_ < budgetBytes_;
+    bool changed = false;
+
+    // Every texture still has to be visited so it starts collecting the next frame's requests
+    for (auto &entry: entries_) {
+        bool canGrow = allowGrowth && maxUploads > 0;
+        if (entry.second.spTexture->updateResidency(canGrow)) {
+            changed = true;
+            maxUploads--;
+        }
+    }
+
+    if (changed) {
+        recountResidentBytes();
+    }
+    return changed;
+}
+
+void TextureCache::trim() {
+    evict(0);
+}
+
+void TextureCache::onTrimMemory(int level) {
+    if (level < kTrimMemoryRunningModerate) {
+        return;
+    }
+
+    trim();
+
+    bool hidden = level >= kTrimMemoryUiHidden;
+    for (auto &entry: entries_) {
+        if (hidden) {
+            entry.second.spTexture->dropToInitialLevels();
+        } else {
+            entry.second.spTexture->dropUnusedLevels();
+        }
+    }
+    recountResidentBytes();
+
+    aout << "TextureCache: trimmed for level " << level << ", " << residentBytes_
+         << " bytes resident in " << entries_.size() << " textures" << std::endl;
+}
+
+void TextureCache::recountResidentBytes() {
+    residentBytes_ = 0;
+    for (const auto &entry: entries_) {
+        residentBytes_ += entry.second.spTexture->getByteSize();
+    }
+}
+
+void TextureCache::clear() {
+    entries_.clear();
+    lru_.clear();
+    residentBytes_ = 0;
+}
+
+void TextureCache::insert(const std::string &key, std::shared_ptr<TextureAsset> spTexture) {
+    residentBytes_ += spTexture->getByteSize();
+    lru_.push_front(key);
+    entries_[key] = {std::move(spTexture), lru_.begin()};
+}
+
+void TextureCache::touch(Entry &entry) {
+    lru_.splice(lru_.begin(), lru_, entry.lruPosition);
+}
+
+void TextureCache::evict(size_t targetBytes) {
+    // Walk from the least recently used end, skipping anything a model still holds on to
+    auto it = lru_.end();
+    while (residentBytes_ > targetBytes && it != lru_.begin()) {
+        --it;
+        auto entry = entries_.find(*it);
+        if (entry->second.spTexture.use_count() > 1) {
+            continue;
+        }
+
+        residentBytes_ -= entry->second.spTexture->getByteSize();
+        entries_.erase(entry);
+        it = lru_.erase(it);
+    }
+
+    if (residentBytes_ > targetBytes && targetBytes == budgetBytes_) {
+        LOG_WARN("TextureCache: %zu bytes in use, over the %zu byte budget", residentBytes_,
+                 budgetBytes_);
+    }
+}
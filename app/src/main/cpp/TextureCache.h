@@ -0,0 +1,131 @@
+#ifndef HOLOPERSONA_TEXTURECACHE_H
+#define HOLOPERSONA_TEXTURECACHE_H
+
+#include <android/asset_manager.h>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "TextureAsset.h"
+
+/*!
+ * A path keyed cache of textures. Asking for the same texture twice returns the same
+ * @a TextureAsset instead of creating a new GL texture, so rebuilding models is free as far as
+ * textures are concerned.
+ *
+ * The cache tracks the estimated VRAM of every texture. When the total goes over the budget the
+ * least recently used textures that nothing else references any more are released. Textures that
+ * are still referenced by a model are never released, so the budget can be exceeded while they're
+ * in use.
+ *
+ * Must only be used on the thread that owns the GL context.
+ */
+class TextureCache {
+public:
+    static constexpr size_t kDefaultBudgetBytes = 64 * 1024 * 1024;
+
+    /*!
+     * @param budgetBytes the estimated VRAM to keep cached textures under
+     */
+    explicit TextureCache(size_t budgetBytes = kDefaultBudgetBytes);
+
+    /*!
+     * Returns the cached texture for an asset, loading it with @a TextureAsset::loadAsset on the
+     * first request
+     * @param assetManager Asset manager to use
+     * @param assetPath The path to the asset, also used as the cache key
+     * @return a shared pointer to a texture asset, or null if the asset failed to load
+     */
+    std::shared_ptr<TextureAsset> load(AAssetManager *assetManager, const std::string &assetPath);
+
+    /*!
+     * Like @a load but creates the texture with @a TextureAsset::loadStreamingAsset so its finer
+     * mip levels are streamed in by @a updateResidency
+     */
+    std::shared_ptr<TextureAsset>
+    loadStreaming(AAssetManager *assetManager, const std::string &assetPath);
+
+    /*!
+     * Returns the cached texture for @a key, calling @a create to make it on the first request.
+     * Use this for procedural textures.
+     * @param key a unique name for the texture
+     * @param create makes the texture when it isn't cached
+     * @return a shared pointer to a texture asset, or null if @a create failed
+     */
+    std::shared_ptr<TextureAsset> getOrCreate(
+            const std::string &key,
+            const std::function<std::shared_ptr<TextureAsset>()> &create);
+
+    /*!
+     * Changes the budget, evicting unused textures straight away if the cache is now over it
+     */
+    void setBudget(size_t budgetBytes);
+
+    inline size_t getBudget() const { return budgetBytes_; }
+
+    /*!
+     * @return the estimated VRAM of every cached texture, in bytes
+     */
+    inline size_t getResidentBytes() const { return residentBytes_; }
+
+    inline size_t getTextureCount() const { return entries_.size(); }
+
+    /*!
+     * Lets every streaming texture upload the next mip level its on-screen size asks for. Call
+     * once per frame after the visible models have called @a TextureAsset::requestScreenSize.
+     * Growth stops while the cache is over its budget.
+     * @param maxUploads the most levels to upload this frame, spreads the cost of streaming
+     * @return true if a texture changed, in which case the next frame may bring in more
+     */
+    bool updateResidency(size_t maxUploads = 1);
+
+    /*!
+     * Releases every texture that nothing else references, regardless of the budget
+     */
+    void trim();
+
+    /*!
+     * Responds to ComponentCallbacks2.onTrimMemory. While running, unreferenced textures and mip
+     * levels nobody asked for last frame are released. Once the UI is hidden, streaming textures
+     * also fall back to their initial levels.
+     * @param level the level passed to onTrimMemory
+     */
+    void onTrimMemory(int level);
+
+    /*!
+     * Forgets every texture. Call this when the GL context is lost, since the cached texture ids
+     * are no longer valid.
+     */
+    void clear();
+
+private:
+    struct Entry {
+        std::shared_ptr<TextureAsset> spTexture;
+        std::list<std::string>::iterator lruPosition;
+    };
+
+    void insert(const std::string &key, std::shared_ptr<TextureAsset> spTexture);
+
+    void touch(Entry &entry);
+
+    /*!
+     * Releases unreferenced textures, least recently used first, until @a targetBytes is reached
+     */
+    void evict(size_t targetBytes);
+
+    /*!
+     * Re-counts @a residentBytes_ after streaming textures changed size
+     */
+    void recountResidentBytes();
+
+    size_t budgetBytes_;
+    size_t residentBytes_;
+    std::unordered_map<std::string, Entry> entries_;
+
+    // Cache keys with the most recently used at the front
+    std::list<std::string> lru_;
+};
+
+#endif //HOLOPERSONA_TEXTURECACHE_H
@@ -0,0 +1,79 @@
+#include "TouchInput.h"
+
+#include <algorithm>
+
+float TouchInput::consume(const TouchSample *samples, size_t count) {
+    float deltaX = 0.f;
+    for (size_t i = 0; i < count; i++) {
+        const TouchSample &sample = samples[i];
+        switch (sample.action) {
+            case ACTION_DOWN:
+                active_ = true;
+                lastX_ = sample.x;
+                historyCount_ = 0;
+                addHistory(sample);
+                break;
+
+            case ACTION_MOVE:
+                if (active_) {
+                    deltaX += sample.x - lastX_;
+                    lastX_ = sample.x;
+                    addHistory(sample);
+                }
+                break;
+
+            default:
+                active_ = false;
+                historyCount_ = 0;
+                break;
+        }
+    }
+    return deltaX;
+}
+
+float TouchInput::predictDeltaX(int64_t displayTimeNanos) const {
+    if (!active_ || historyCount_ < 2) {
+        return 0.f;
+    }
+
+    size_t newest = (historyNext_ + kHistorySize - 1) % kHistorySize;
+    int64_t newestTime = historyTimes_[newest];
+    if (displayTimeNanos - newestTime > kMaxSampleAgeNanos) {
+        return 0.f;
+    }
+
+    // Least squares slope of x over time, with times relative to the newest sample in seconds so
+    // the sums stay small enough for floats
+    float sumT = 0.f, sumX = 0.f, sumTT = 0.f, sumTX = 0.f;
+    int used = 0;
+    for (size_t n = 0; n < historyCount_; n++) {
+        size_t index = (newest + kHistorySize - n) % kHistorySize;
+        int64_t age = newestTime - historyTimes_[index];
+        if (age > kVelocityWindowNanos) {
+            break;
+        }
+        float t = float(-age) * 1e-9f;
+        float x = historyXs_[index];
+        sumT += t;
+        sumX += x;
+        sumTT += t * t;
+        sumTX += t * x;
+        used++;
+    }
+    float denominator = float(used) * sumTT - sumT * sumT;
+    if (used < 2 || denominator <= 0.f) {
+        return 0.f;
+    }
+    float velocity = (float(used) * sumTX - sumT * sumX) / denominator;
+
+    // Extrapolate from the newest sample, which is where the drag has actually got to
+    int64_t horizon = std::clamp(displayTimeNanos - newestTime, int64_t(0), kMaxPredictionNanos);
+    return velocity * float(horizon) * 1e-9f;
+}
+
+void TouchInput::addHistory(const TouchSample &sample) {
+    historyTimes_[historyNext_] = sample.timeNanos;
+    historyXs_[historyNext_] = sample.x;
+    historyNext_ = (historyNext_ + 1) % kHistorySize;
+    historyCount_ = std::min(historyCount_ + 1, kHistorySize);
+}
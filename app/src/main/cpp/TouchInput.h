@@ -0,0 +1,78 @@
+#ifndef HOLOPERSONA_TOUCHINPUT_H
+#define HOLOPERSONA_TOUCHINPUT_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*!
+ * One touch sample as the view writes it into the shared touch buffer, in native byte order
+ */
+struct TouchSample {
+    //! A MotionEvent action, see @a TouchInput::Action
+    int32_t action;
+    float x;
+    float y;
+    int32_t reserved;
+    //! The event time in nanoseconds on the monotonic clock, the one SystemClock.uptimeMillis uses
+    int64_t timeNanos;
+};
+
+static_assert(sizeof(TouchSample) == 24, "Must match the layout written by the view");
+
+/*!
+ * Turns a frame's worth of batched touch samples into a horizontal drag, and predicts where the
+ * finger will be when the frame reaches the display. The prediction fits a line through the most
+ * recent moves, so it also smooths out the jitter between individual samples.
+ */
+class TouchInput {
+public:
+    //! The MotionEvent actions the view sends, anything else ends the drag
+    enum Action : int32_t {
+        ACTION_DOWN = 0,
+        ACTION_UP = 1,
+        ACTION_MOVE = 2,
+    };
+
+    /*!
+     * Applies a batch of samples in the order they happened
+     * @return how far the drag moved horizontally over the batch, in pixels
+     */
+    float consume(const TouchSample *samples, size_t count);
+
+    inline bool isActive() const { return active_; }
+
+    /*!
+     * @param displayTimeNanos when the frame being drawn is expected on screen, on the same clock
+     *     as the samples
+     * @return how much further the drag will have moved horizontally by then, in pixels. 0 when
+     *     the finger is up or hasn't moved lately.
+     */
+    float predictDeltaX(int64_t displayTimeNanos) const;
+
+private:
+    // Moves the velocity is fitted through, enough for 40ms at 240Hz
+    static constexpr size_t kHistorySize = 10;
+
+    // Samples older than this, relative to the newest, are left out of the fit
+    static constexpr int64_t kVelocityWindowNanos = 40'000'000;
+
+    // Don't extrapolate further than this. Past about two frames a prediction overshoots more
+    // than it saves.
+    static constexpr int64_t kMaxPredictionNanos = 30'000'000;
+
+    // A finger that hasn't reported in this long is treated as resting
+    static constexpr int64_t kMaxSampleAgeNanos = 50'000'000;
+
+    void addHistory(const TouchSample &sample);
+
+    bool active_ = false;
+    float lastX_ = 0.f;
+
+    // A ring of the latest moves of the current drag
+    int64_t historyTimes_[kHistorySize] = {};
+    float historyXs_[kHistorySize] = {};
+    size_t historyCount_ = 0;
+    size_t historyNext_ = 0;
+};
+
+#endif //HOLOPERSONA_TOUCHINPUT_H
@@ -0,0 +1,62 @@
+#ifndef HOLOPERSONA_TRIPLEBUFFER_H
+#define HOLOPERSONA_TRIPLEBUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+/*!
+ * A mailbox between one writer thread and one reader thread. The writer fills its own slot and
+ * publishes it, the reader picks up the newest published slot. Neither side waits for the other:
+ * a writer that gets ahead replaces a state the reader never saw, and a reader that gets ahead
+ * keeps the state it has.
+ *
+ * Three slots are all that takes. One belongs to the writer, one to the reader, and the third
+ * holds the newest published state. Publishing and acquiring each swap a slot with the middle one
+ * in a single atomic exchange.
+ */
+template<typename T>
+class TripleBuffer {
+public:
+    /*!
+     * @return the slot to fill. Writer only. Holds whatever state was last written to it, so
+     *     containers can be refilled without reallocating.
+     */
+    inline T &getWriteBuffer() { return slots_[write_]; }
+
+    /*!
+     * Makes the write slot the newest state and hands the writer another slot. Writer only.
+     */
+    void publish() {
+        write_ = middle_.exchange(uint8_t(write_ | kFresh), std::memory_order_acq_rel) & kIndexMask;
+    }
+
+    /*!
+     * Takes the newest state if one was published since the last call. Reader only.
+     * @return true if @a getReadBuffer changed
+     */
+    bool acquire() {
+        if (!(middle_.load(std::memory_order_relaxed) & kFresh)) {
+            return false;
+        }
+        read_ = middle_.exchange(read_, std::memory_order_acq_rel) & kIndexMask;
+        return true;
+    }
+
+    /*!
+     * @return the state taken by the last @a acquire, default constructed before the first one.
+     *     Reader only.
+     */
+    inline const T &getReadBuffer() const { return slots_[read_]; }
+
+private:
+    static constexpr uint8_t kIndexMask = 3;
+    // Set in the middle index while it holds a state the reader hasn't taken
+    static constexpr uint8_t kFresh = 4;
+
+    T slots_[3];
+    uint8_t write_ = 0;
+    std::atomic<uint8_t> middle_{1};
+    uint8_t read_ = 2;
+};
+
+#endif //HOLOPERSONA_TRIPLEBUFFER_H
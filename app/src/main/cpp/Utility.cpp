@@ -1,5 +1,6 @@
 #include "Utility.h"
 #include "AndroidOut.h"
+#include "VectorMath.h"
 
 #include <GLES3/gl3.h>
 #include <cmath>
@@ -87,58 +88,8 @@ Utility::buildViewMatrix(float *outMatrix,
                         float eyeX, float eyeY, float eyeZ,
                         float centerX, float centerY, float centerZ,
                         float upX, float upY, float upZ) {
-    // Calculate forward vector (from eye to center)
-    float forwardX = centerX - eyeX;
-    float forwardY = centerY - eyeY;
-    float forwardZ = centerZ - eyeZ;
-    
-    // Normalize forward vector
-    float forwardLength = sqrtf(forwardX * forwardX + forwardY * forwardY + forwardZ * forwardZ);
-    forwardX /= forwardLength;
-    forwardY /= forwardLength;
-    forwardZ /= forwardLength;
-    
-    // Calculate right vector (cross product of forward and up)
-    float rightX = forwardY * upZ - forwardZ * upY;
-    float rightY = forwardZ * upX - forwardX * upZ;
-    float rightZ = forwardX * upY - forwardY * upX;
-    
-    // Normalize right vector
-    float rightLength = sqrtf(rightX * rightX + rightY * rightY + rightZ * rightZ);
-    rightX /= rightLength;
-    rightY /= rightLength;
-    rightZ /= rightLength;
-    
-    // Calculate actual up vector (cross product of right and forward)
-    float newUpX = rightY * forwardZ - rightZ * forwardY;
-    float newUpY = rightZ * forwardX - rightX * forwardZ;
-    float newUpZ = rightX * forwardY - rightY * forwardX;
-    
-    // Build view matrix
-    // column 1
-    outMatrix[0] = rightX;
-    outMatrix[1] = newUpX;
-    outMatrix[2] = -forwardX;
-    outMatrix[3] = 0.0f;
-    
-    // column 2
-    outMatrix[4] = rightY;
-    outMatrix[5] = newUpY;
-    outMatrix[6] = -forwardY;
-    outMatrix[7] = 0.0f;
-    
-    // column 3
-    outMatrix[8] = rightZ;
-    outMatrix[9] = newUpZ;
-    outMatrix[10] = -forwardZ;
-    outMatrix[11] = 0.0f;
-    
-    // column 4 (translation)
-    outMatrix[12] = -(rightX * eyeX + rightY * eyeY + rightZ * eyeZ);
-    outMatrix[13] = -(newUpX * eyeX + newUpY * eyeY + newUpZ * eyeZ);
-    outMatrix[14] = forwardX * eyeX + forwardY * eyeY + forwardZ * eyeZ;
-    outMatrix[15] = 1.0f;
-    
+    VectorMath::lookAt(outMatrix, {eyeX, eyeY, eyeZ}, {centerX, centerY, centerZ},
+                       {upX, upY, upZ});
     return outMatrix;
 }
 
@@ -178,16 +129,7 @@ Utility::buildModelMatrix(float *outMatrix, float rotationY,
 
 float *
 Utility::multiplyMatrices(float *result, const float *matA, const float *matB) {
-    // Fixed for column-major matrices used by OpenGL
-    for (int i = 0; i < 4; i++) {
-        for (int j = 0; j < 4; j++) {
-            result[i * 4 + j] = 
-                matA[0 * 4 + j] * matB[i * 4 + 0] +
-                matA[1 * 4 + j] * matB[i * 4 + 1] +
-                matA[2 * 4 + j] * matB[i * 4 + 2] +
-                matA[3 * 4 + j] * matB[i * 4 + 3];
-        }
-    }
+    VectorMath::multiply(result, matA, matB);
     return result;
 }
 
@@ -217,4 +159,4 @@ float *Utility::buildIdentityMatrix(float *outMatrix) {
     outMatrix[15] = 1.f;
 
     return outMatrix;
-}
\ No newline at end of file
+}
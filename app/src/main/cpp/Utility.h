@@ -2,6 +2,10 @@
 #define ANDROIDGLINVESTIGATIONS_UTILITY_H
 
 #include <cassert>
+#include <cstddef>
+
+#include "Bounds.h"
+#include "VectorMath.h"
 
 class Utility {
 public:
@@ -84,7 +88,8 @@ public:
             float scale);
 
     /**
-     * Multiplies two 4x4 matrices: result = matA * matB
+     * Multiplies two 4x4 matrices: result = matA * matB. Uses VectorMath, so result may be
+     * either input.
      *
      * @param result output matrix
      * @param matA first matrix
@@ -97,6 +102,38 @@ public:
             const float *matB);
 
     static float *buildIdentityMatrix(float *outMatrix);
+
+    /**
+     * Forwards to Bounds::transformPoints, which holds the kernel so it builds without GL
+     */
+    static inline void transformPoints(
+            const float *matrix,
+            const float *xs, const float *ys, const float *zs,
+            float *outXs, float *outYs, float *outZs,
+            size_t count) {
+        Bounds::transformPoints(matrix, xs, ys, zs, outXs, outYs, outZs, count);
+    }
+
+    /**
+     * Forwards to Bounds::transformBoundingBoxes
+     */
+    static inline void transformBoundingBoxes(
+            const float *matrix,
+            const BoundingBox *boxes,
+            BoundingBox *outBoxes,
+            size_t count) {
+        Bounds::transformBoundingBoxes(matrix, boxes, outBoxes, count);
+    }
+
+    /**
+     * Forwards to Bounds::computeBoundingBox
+     */
+    static inline BoundingBox computeBoundingBox(
+            const float *matrix,
+            const Vertex *vertices,
+            size_t count) {
+        return Bounds::computeBoundingBox(matrix, vertices, count);
+    }
 };
 
 #endif //ANDROIDGLINVESTIGATIONS_UTILITY_H
\ No newline at end of file
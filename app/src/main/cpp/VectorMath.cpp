@@ -0,0 +1,293 @@
+#include "VectorMath.h"
+
+#include <cmath>
+
+#include "Simd.h"
+
+Mat4 Mat4::identity() {
+    return {{1.f, 0.f, 0.f, 0.f,
+             0.f, 1.f, 0.f, 0.f,
+             0.f, 0.f, 1.f, 0.f,
+             0.f, 0.f, 0.f, 1.f}};
+}
+
+Quaternion Quaternion::fromAxisAngle(const Vector3 &axis, float angle) {
+    float s = sinf(angle * 0.5f);
+    return {axis.x * s, axis.y * s, axis.z * s, cosf(angle * 0.5f)};
+}
+
+Quaternion Quaternion::operator*(const Quaternion &o) const {
+    return {
+            w * o.x + x * o.w + y * o.z - z * o.y,
+            w * o.y - x * o.z + y * o.w + z * o.x,
+            w * o.z + x * o.y - y * o.x + z * o.w,
+            w * o.w - x * o.x - y * o.y - z * o.z};
+}
+
+// Scalar and vector arithmetic under the same names, so the inverse below is written once and
+// both paths evaluate it in the same order
+static inline float sub(float a, float b) { return a - b; }
+
+static inline float mul(float a, float b) { return a * b; }
+
+static inline float madd(float a, float b, float c) { return a + b * c; }
+
+static inline float msub(float a, float b, float c) { return a - b * c; }
+
+#if defined(HOLOPERSONA_SIMD)
+
+static inline Float4 sub(Float4 a, Float4 b) { return sub4(a, b); }
+
+static inline Float4 mul(Float4 a, Float4 b) { return mul4(a, b); }
+
+static inline Float4 madd(Float4 a, Float4 b, Float4 c) { return madd4(a, b, c); }
+
+static inline Float4 msub(Float4 a, Float4 b, Float4 c) { return sub4(a, mul4(b, c)); }
+
+#endif
+
+/*!
+ * The adjugate and determinant of a 4x4 matrix, from the 2x2 determinants of its top and bottom
+ * halves. The adjugate divided by the determinant is the inverse.
+ */
+template<typename T>
+static inline void adjugate(const T *m, T *adj, T &det) {
+    T s0 = msub(mul(m[0], m[5]), m[4], m[1]);
+    T s1 = msub(mul(m[0], m[6]), m[4], m[2]);
+    T s2 = msub(mul(m[0], m[7]), m[4], m[3]);
+    T s3 = msub(mul(m[1], m[6]), m[5], m[2]);
+    T s4 = msub(mul(m[1], m[7]), m[5], m[3]);
+    T s5 = msub(mul(m[2], m[7]), m[6], m[3]);
+
+    T c5 = msub(mul(m[10], m[15]), m[14], m[11]);
+    T c4 = msub(mul(m[9], m[15]), m[13], m[11]);
+    T c3 = msub(mul(m[9], m[14]), m[13], m[10]);
+    T c2 = msub(mul(m[8], m[15]), m[12], m[11]);
+    T c1 = msub(mul(m[8], m[14]), m[12], m[10]);
+    T c0 = msub(mul(m[8], m[13]), m[12], m[9]);
+
+    det = madd(msub(madd(madd(msub(mul(s0, c5), s1, c4), s2, c3), s3, c2), s4, c1), s5, c0);
+
+    adj[0] = madd(msub(mul(m[5], c5), m[6], c4), m[7], c3);
+    adj[1] = msub(msub(mul(m[2], c4), m[1], c5), m[3], c3);
+    adj[2] = madd(msub(mul(m[13], s5), m[14], s4), m[15], s3);
+    adj[3] = msub(msub(mul(m[10], s4), m[9], s5), m[11], s3);
+    adj[4] = msub(msub(mul(m[6], c2), m[4], c5), m[7], c1);
+    adj[5] = madd(msub(mul(m[0], c5), m[2], c2), m[3], c1);
+    adj[6] = msub(msub(mul(m[14], s2), m[12], s5), m[15], s1);
+    adj[7] = madd(msub(mul(m[8], s5), m[10], s2), m[11], s1);
+    adj[8] = madd(msub(mul(m[4], c4), m[5], c2), m[7], c0);
+    adj[9] = msub(msub(mul(m[1], c2), m[0], c4), m[3], c0);
+    adj[10] = madd(msub(mul(m[12], s4), m[13], s2), m[15], s0);
+    adj[11] = msub(msub(mul(m[9], s2), m[8], s4), m[11], s0);
+    adj[12] = msub(msub(mul(m[5], c1), m[4], c3), m[6], c0);
+    adj[13] = madd(msub(mul(m[0], c3), m[1], c1), m[2], c0);
+    adj[14] = msub(msub(mul(m[13], s1), m[12], s3), m[14], s0);
+    adj[15] = madd(msub(mul(m[8], s3), m[9], s1), m[10], s0);
+}
+
+static inline float reciprocalOrZero(float det) { return det != 0.f ? 1.f / det : 0.f; }
+
+void VectorMath::multiply(float *out, const float *a, const float *b) {
+#if defined(HOLOPERSONA_SIMD)
+    // Each column of the product is the columns of a weighted by a column of b. All four are
+    // computed before any is stored so out can alias either input.
+    Float4 a0 = load4(a), a1 = load4(a + 4), a2 = load4(a + 8), a3 = load4(a + 12);
+    Float4 columns[4];
+    for (int i = 0; i < 4; i++) {
+        const float *bi = b + i * 4;
+        Float4 column = mul4(a0, splat4(bi[0]));
+        column = madd4(column, a1, splat4(bi[1]));
+        column = madd4(column, a2, splat4(bi[2]));
+        columns[i] = madd4(column, a3, splat4(bi[3]));
+    }
+    for (int i = 0; i < 4; i++) {
+        store4(out + i * 4, columns[i]);
+    }
+#else
+    multiplyReference(out, a, b);
+#endif
+}
+
+void VectorMath::multiplyReference(float *out, const float *a, const float *b) {
+    float result[16];
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            result[i * 4 + j] =
+                    a[0 * 4 + j] * b[i * 4 + 0] +
+                    a[1 * 4 + j] * b[i * 4 + 1] +
+                    a[2 * 4 + j] * b[i * 4 + 2] +
+                    a[3 * 4 + j] * b[i * 4 + 3];
+        }
+    }
+    for (int i = 0; i < 16; i++) {
+        out[i] = result[i];
+    }
+}
+
+void VectorMath::multiplyBatch(float *out, const float *a, const float *b, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        multiply(out + i * 16, a + i * 16, b + i * 16);
+    }
+}
+
+bool VectorMath::inverse(float *out, const float *m) {
+    float adj[16];
+    float det;
+    adjugate(m, adj, det);
+    float invDet = reciprocalOrZero(det);
+    for (int i = 0; i < 16; i++) {
+        out[i] = adj[i] * invDet;
+    }
+    return det != 0.f;
+}
+
+void VectorMath::inverseBatch(float *out, const float *m, size_t count) {
+    size_t i = 0;
+
+#if defined(HOLOPERSONA_SIMD)
+    // One matrix per lane. Transposing each group of four columns puts the same element of the
+    // four matrices in one vector, then the scalar formula runs unchanged on vectors.
+    for (; i + 4 <= count; i += 4) {
+        const float *src = m + i * 16;
+        Float4 elements[16];
+        for (int group = 0; group < 4; group++) {
+            Float4 *e = elements + group * 4;
+            for (int matrix = 0; matrix < 4; matrix++) {
+                e[matrix] = load4(src + matrix * 16 + group * 4);
+            }
+            transpose4(e[0], e[1], e[2], e[3]);
+        }
+
+        Float4 adj[16];
+        Float4 det;
+        adjugate(elements, adj, det);
+
+        // Four divides are cheaper than a reciprocal estimate refined to full precision
+        float dets[4];
+        store4(dets, det);
+        Float4 invDet = set4(reciprocalOrZero(dets[0]), reciprocalOrZero(dets[1]),
+                             reciprocalOrZero(dets[2]), reciprocalOrZero(dets[3]));
+
+        float *dst = out + i * 16;
+        for (int group = 0; group < 4; group++) {
+            Float4 *e = adj + group * 4;
+            for (int k = 0; k < 4; k++) {
+                e[k] = mul4(e[k], invDet);
+            }
+            transpose4(e[0], e[1], e[2], e[3]);
+            for (int matrix = 0; matrix < 4; matrix++) {
+                store4(dst + matrix * 16 + group * 4, e[matrix]);
+            }
+        }
+    }
+#endif
+
+    for (; i < count; i++) {
+        inverse(out + i * 16, m + i * 16);
+    }
+}
+
+void VectorMath::inverseAffine(float *out, const float *m) {
+    // Inverse of the upper 3x3 through its cofactors
+    float c00 = m[5] * m[10] - m[9] * m[6];
+    float c01 = m[8] * m[6] - m[4] * m[10];
+    float c02 = m[4] * m[9] - m[8] * m[5];
+    float det = m[0] * c00 + m[1] * c01 + m[2] * c02;
+    float invDet = reciprocalOrZero(det);
+
+    float r[16];
+    r[0] = c00 * invDet;
+    r[1] = (m[9] * m[2] - m[1] * m[10]) * invDet;
+    r[2] = (m[1] * m[6] - m[5] * m[2]) * invDet;
+    r[3] = 0.f;
+    r[4] = c01 * invDet;
+    r[5] = (m[0] * m[10] - m[8] * m[2]) * invDet;
+    r[6] = (m[4] * m[2] - m[0] * m[6]) * invDet;
+    r[7] = 0.f;
+    r[8] = c02 * invDet;
+    r[9] = (m[8] * m[1] - m[0] * m[9]) * invDet;
+    r[10] = (m[0] * m[5] - m[4] * m[1]) * invDet;
+    r[11] = 0.f;
+
+    // Then the translation is undone in the inverted basis
+    r[12] = -(r[0] * m[12] + r[4] * m[13] + r[8] * m[14]);
+    r[13] = -(r[1] * m[12] + r[5] * m[13] + r[9] * m[14]);
+    r[14] = -(r[2] * m[12] + r[6] * m[13] + r[10] * m[14]);
+    r[15] = 1.f;
+
+    for (int i = 0; i < 16; i++) {
+        out[i] = r[i];
+    }
+}
+
+void VectorMath::transformBatch(const float *matrix, const Vec4 *in, Vec4 *out, size_t count) {
+#if defined(HOLOPERSONA_SIMD)
+    Float4 c0 = load4(matrix), c1 = load4(matrix + 4);
+    Float4 c2 = load4(matrix + 8), c3 = load4(matrix + 12);
+    for (size_t i = 0; i < count; i++) {
+        const Vec4 v = in[i];
+        Float4 result = mul4(c0, splat4(v.x));
+        result = madd4(result, c1, splat4(v.y));
+        result = madd4(result, c2, splat4(v.z));
+        result = madd4(result, c3, splat4(v.w));
+        store4(&out[i].x, result);
+    }
+#else
+    transformBatchReference(matrix, in, out, count);
+#endif
+}
+
+void VectorMath::transformBatchReference(const float *matrix, const Vec4 *in, Vec4 *out,
+                                         size_t count) {
+    const float *m = matrix;
+    for (size_t i = 0; i < count; i++) {
+        const Vec4 v = in[i];
+        out[i] = {m[0] * v.x + m[4] * v.y + m[8] * v.z + m[12] * v.w,
+                  m[1] * v.x + m[5] * v.y + m[9] * v.z + m[13] * v.w,
+                  m[2] * v.x + m[6] * v.y + m[10] * v.z + m[14] * v.w,
+                  m[3] * v.x + m[7] * v.y + m[11] * v.z + m[15] * v.w};
+    }
+}
+
+void VectorMath::lookAt(float *out, const Vector3 &eye, const Vector3 &center,
+                        const Vector3 &up) {
+    // Forward from the eye to the center
+    float fx = center.x - eye.x, fy = center.y - eye.y, fz = center.z - eye.z;
+    float forwardLength = sqrtf(fx * fx + fy * fy + fz * fz);
+    fx /= forwardLength;
+    fy /= forwardLength;
+    fz /= forwardLength;
+
+    // Right is forward cross up
+    float rx = fy * up.z - fz * up.y;
+    float ry = fz * up.x - fx * up.z;
+    float rz = fx * up.y - fy * up.x;
+    float rightLength = sqrtf(rx * rx + ry * ry + rz * rz);
+    rx /= rightLength;
+    ry /= rightLength;
+    rz /= rightLength;
+
+    // The true up is right cross forward
+    float ux = ry * fz - rz * fy;
+    float uy = rz * fx - rx * fz;
+    float uz = rx * fy - ry * fx;
+
+    // The rows are the camera axes, the camera looks down -Z
+    out[0] = rx;
+    out[1] = ux;
+    out[2] = -fx;
+    out[3] = 0.f;
+    out[4] = ry;
+    out[5] = uy;
+    out[6] = -fy;
+    out[7] = 0.f;
+    out[8] = rz;
+    out[9] = uz;
+    out[10] = -fz;
+    out[11] = 0.f;
+    out[12] = -(rx * eye.x + ry * eye.y + rz * eye.z);
+    out[13] = -(ux * eye.x + uy * eye.y + uz * eye.z);
+    out[14] = fx * eye.x + fy * eye.y + fz * eye.z;
+    out[15] = 1.f;
+}
@@ -0,0 +1,125 @@
+#ifndef HOLOPERSONA_VECTORMATH_H
+#define HOLOPERSONA_VECTORMATH_H
+
+#include <cstddef>
+
+#include "Model.h"
+
+/*!
+ * A four component vector, aligned for vector loads
+ */
+struct alignas(16) Vec4 {
+    float x, y, z, w;
+};
+
+/*!
+ * A column major 4x4 matrix, the layout GL and the Utility helpers use. Element (row, column)
+ * is m[column * 4 + row].
+ */
+struct alignas(16) Mat4 {
+    float m[16];
+
+    static Mat4 identity();
+
+    inline float *data() { return m; }
+
+    inline const float *data() const { return m; }
+};
+
+/*!
+ * An axis aligned bounding box
+ */
+struct BoundingBox {
+    Vector3 min;
+    Vector3 max;
+};
+
+/*!
+ * A rotation, stored as a unit quaternion
+ */
+struct Quaternion {
+    float x, y, z, w;
+
+    static constexpr Quaternion identity() { return {0.f, 0.f, 0.f, 1.f}; }
+
+    /*!
+     * @param axis the axis to rotate around, must be normalized
+     * @param angle the angle in radians
+     */
+    static Quaternion fromAxisAngle(const Vector3 &axis, float angle);
+
+    /*!
+     * @return the rotation that applies @a other first, then this one
+     */
+    Quaternion operator*(const Quaternion &other) const;
+};
+
+/*!
+ * Matrix math for transforms. Everything works on raw column major float arrays so it can run
+ * over joint palettes and vertex buffers in place, with @a Mat4 overloads for single matrices.
+ *
+ * Products and batch transforms use NEON or SSE2 (see Simd.h), one matrix column per vector.
+ * Inverses are vectorized across matrices instead, four per batch with one matrix per lane.
+ * Every vector path has a scalar reference that adds in the same order, so the two agree to
+ * the last bit unless the compiler fuses multiply-adds. Pointers need no particular alignment.
+ */
+class VectorMath {
+public:
+    /*!
+     * out = a * b. @a out may be either input.
+     */
+    static void multiply(float *out, const float *a, const float *b);
+
+    static void multiplyReference(float *out, const float *a, const float *b);
+
+    /*!
+     * Multiplies pairs of matrices, out[i] = a[i] * b[i]
+     * @param count the number of matrices in each array, sixteen floats each
+     */
+    static void multiplyBatch(float *out, const float *a, const float *b, size_t count);
+
+    /*!
+     * Inverts a general matrix
+     * @return false if the matrix is singular, in which case @a out is all zeros
+     */
+    static bool inverse(float *out, const float *m);
+
+    /*!
+     * Inverts matrices four at a time. Singular matrices come back all zeros.
+     * @param count the number of matrices, sixteen floats each. @a out must not overlap @a m.
+     */
+    static void inverseBatch(float *out, const float *m, size_t count);
+
+    /*!
+     * Inverts a matrix whose last row is 0, 0, 0, 1, such as any joint or model matrix. Cheaper
+     * than @a inverse. A singular upper 3x3 comes back as zeros.
+     */
+    static void inverseAffine(float *out, const float *m);
+
+    /*!
+     * out[i] = matrix * in[i]. @a out may be @a in.
+     */
+    static void transformBatch(const float *matrix, const Vec4 *in, Vec4 *out, size_t count);
+
+    static void transformBatchReference(const float *matrix, const Vec4 *in, Vec4 *out,
+                                        size_t count);
+
+    /*!
+     * Writes a right handed view matrix looking from @a eye at @a center
+     */
+    static void lookAt(float *out, const Vector3 &eye, const Vector3 &center, const Vector3 &up);
+
+    static inline Mat4 multiply(const Mat4 &a, const Mat4 &b) {
+        Mat4 out;
+        multiply(out.m, a.m, b.m);
+        return out;
+    }
+
+    static inline Vec4 transform(const Mat4 &matrix, const Vec4 &v) {
+        Vec4 out;
+        transformBatch(matrix.m, &v, &out, 1);
+        return out;
+    }
+};
+
+#endif //HOLOPERSONA_VECTORMATH_H
@@ -0,0 +1,37 @@
+package org.lightscout.holopersona
+
+/**
+ * What the native renderer spent on recent frames, averaged over the last half second or so.
+ *
+ * @property gpuMs null when the GPU can't be timed on this device or no result has come back yet
+ * @property simulationMs the step drawn, which ran on the simulation thread rather than in cpuMs
+ */
+data class FrameStats(
+        val cpuMs: Float,
+        val gpuMs: Float?,
+        val draws: Float,
+        val triangles: Float,
+        val stateChanges: Float,
+        val inputMs: Float,
+        val waitMs: Float,
+        val simulationMs: Float,
+        val renderMs: Float
+) {
+    companion object {
+        /** Floats nativeGetFrameStats writes, laid out as FrameStatsSnapshot in FrameStats.h. */
+        const val FIELD_COUNT = 9
+
+        fun fromArray(fields: FloatArray) =
+                FrameStats(
+                        cpuMs = fields[0],
+                        gpuMs = fields[1].takeIf { it >= 0f },
+                        draws = fields[2],
+                        triangles = fields[3],
+                        stateChanges = fields[4],
+                        inputMs = fields[5],
+                        waitMs = fields[6],
+                        simulationMs = fields[7],
+                        renderMs = fields[8]
+                )
+    }
+}
@@ -1,9 +1,14 @@
 package org.lightscout.holopersona
 
+import android.content.ComponentCallbacks2
 import android.content.Context
+import android.content.res.Configuration
 import android.opengl.GLSurfaceView
 import android.util.AttributeSet
 import android.view.MotionEvent
+import java.io.File
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
 import javax.microedition.khronos.egl.EGLConfig
 import javax.microedition.khronos.opengles.GL10
 
@@ -13,6 +18,23 @@ constructor(context: Context, attrs: AttributeSet? = null) : GLSurfaceView(conte
 
     private val renderer: HoloPersonaRenderer
 
+    // Forwards memory pressure to native code so textures can drop mip levels nobody is using
+    private val trimMemoryCallbacks =
+            object : ComponentCallbacks2 {
+                override fun onTrimMemory(level: Int) {
+                    queueEvent { renderer.onTrimMemory(level) }
+                }
+
+                override fun onConfigurationChanged(newConfig: Configuration) {}
+
+                @Deprecated("Deprecated in Java")
+                override fun onLowMemory() {
+                    queueEvent {
+                        renderer.onTrimMemory(ComponentCallbacks2.TRIM_MEMORY_RUNNING_CRITICAL)
+                    }
+                }
+            }
+
     init {
         // Create an OpenGL ES 3.0 context
         setEGLContextClientVersion(3)
@@ -21,47 +43,141 @@ constructor(context: Context, attrs: AttributeSet? = null) : GLSurfaceView(conte
         renderer = HoloPersonaRenderer(context)
         setRenderer(renderer)
 
-        // Render the view only when there is a change in the drawing data
-        renderMode = RENDERMODE_CONTINUOUSLY
+        // Render the view only when there is a change in the drawing data. While the scene is
+        // moving, native code asks for a frame on every vsync.
+        renderMode = RENDERMODE_WHEN_DIRTY
+    }
+
+    override fun onAttachedToWindow() {
+        super.onAttachedToWindow()
+        context.registerComponentCallbacks(trimMemoryCallbacks)
+        if (!renderer.startFramePacing(this)) {
+            renderMode = RENDERMODE_CONTINUOUSLY
+        }
+    }
+
+    override fun onDetachedFromWindow() {
+        renderer.stopFramePacing()
+        context.unregisterComponentCallbacks(trimMemoryCallbacks)
+        super.onDetachedFromWindow()
     }
 
     override fun onTouchEvent(e: MotionEvent): Boolean {
-        // Handle touch events for camera control
-        when (e.action) {
-            MotionEvent.ACTION_DOWN -> {
-                renderer.onTouchDown(e.x, e.y)
-            }
-            MotionEvent.ACTION_MOVE -> {
-                renderer.onTouchMove(e.x, e.y)
+        // Handle touch events for camera control. Samples are only batched here, native code
+        // picks them up once per frame.
+        renderer.touchBatch.add(e)
+        requestRender()
+        return true
+    }
+
+    /**
+     * Touch samples waiting for the next frame, written straight into direct buffers that native
+     * code reads without copying. The UI thread fills one buffer while the render thread reads the
+     * other, and [swap] trades them once per frame.
+     *
+     * Each sample is the action, x, y, a reserved int and the event time in nanoseconds, in native
+     * byte order. The layout must match TouchSample in TouchInput.h.
+     */
+    private class TouchBatch {
+        val buffers: Array<ByteBuffer> =
+                Array(2) {
+                    ByteBuffer.allocateDirect(MAX_SAMPLES * SAMPLE_SIZE)
+                            .order(ByteOrder.nativeOrder())
+                }
+
+        private var writeBuffer = 0
+        private var count = 0
+
+        /** Adds an event, including the moves the system batched into it since the last one. */
+        @Synchronized
+        fun add(e: MotionEvent) {
+            when (e.actionMasked) {
+                MotionEvent.ACTION_MOVE -> {
+                    for (i in 0 until e.historySize) {
+                        put(
+                                MotionEvent.ACTION_MOVE,
+                                e.getHistoricalX(i),
+                                e.getHistoricalY(i),
+                                e.getHistoricalEventTime(i)
+                        )
+                    }
+                    put(MotionEvent.ACTION_MOVE, e.x, e.y, e.eventTime)
+                }
+                MotionEvent.ACTION_DOWN, MotionEvent.ACTION_UP, MotionEvent.ACTION_CANCEL ->
+                        put(e.actionMasked, e.x, e.y, e.eventTime)
             }
-            MotionEvent.ACTION_UP -> {
-                renderer.onTouchUp()
+        }
+
+        /**
+         * Hands the samples added since the last call to the render thread.
+         *
+         * @return the index of the buffer holding them shifted up 16 bits, or'd with the sample
+         *   count. Packed rather than a pair so a frame allocates nothing.
+         */
+        @Synchronized
+        fun swap(): Int {
+            val filled = (writeBuffer shl 16) or count
+            writeBuffer = writeBuffer xor 1
+            count = 0
+            return filled
+        }
+
+        private fun put(action: Int, x: Float, y: Float, eventTimeMillis: Long) {
+            val buffer = buffers[writeBuffer]
+
+            // A full batch means the render thread has stalled. Moves are coalesced into the last
+            // one so a down or up is never lost.
+            var index = count
+            if (index == MAX_SAMPLES) {
+                val last = (index - 1) * SAMPLE_SIZE
+                if (action != MotionEvent.ACTION_MOVE ||
+                                buffer.getInt(last) != MotionEvent.ACTION_MOVE
+                ) {
+                    return
+                }
+                index--
             }
+
+            val offset = index * SAMPLE_SIZE
+            buffer.putInt(offset, action)
+            buffer.putFloat(offset + 4, x)
+            buffer.putFloat(offset + 8, y)
+            buffer.putInt(offset + 12, 0)
+            buffer.putLong(offset + 16, eventTimeMillis * 1_000_000L)
+            count = index + 1
+        }
+
+        companion object {
+            const val MAX_SAMPLES = 64
+            const val SAMPLE_SIZE = 24
         }
-        return true
     }
 
     private class HoloPersonaRenderer(private val context: Context) : GLSurfaceView.Renderer {
 
         private var surfaceWidth: Int = 0
         private var surfaceHeight: Int = 0
-        private var lastTouchX: Float = 0f
-        private var lastTouchY: Float = 0f
-        private var touchDown: Boolean = false
+        val touchBatch = TouchBatch()
 
         external fun nativeOnSurfaceCreated()
         external fun nativeOnSurfaceChanged(width: Int, height: Int)
-        external fun nativeOnDrawFrame()
-        external fun nativeOnTouchDown(x: Float, y: Float)
-        external fun nativeOnTouchMove(x: Float, y: Float)
-        external fun nativeOnTouchUp()
+        external fun nativeOnDrawFrame(touchBuffer: Int, touchCount: Int)
+        external fun nativeSetTouchBuffers(first: ByteBuffer, second: ByteBuffer)
+        external fun nativeStartFramePacing(view: GLSurfaceView): Boolean
+        external fun nativeStopFramePacing()
         external fun nativeSetSkeletonType(skeletonType: Int)
+        external fun nativeSetBodyShape(bodyShape: Float)
+        external fun nativeSetAnimating(animating: Boolean)
         external fun nativeSetAssetManager(assetManager: android.content.res.AssetManager)
         external fun nativeSetUseObjLoader(useObjLoader: Boolean)
+        external fun nativeOnTrimMemory(level: Int)
+        external fun nativeWriteTrace(path: String): Boolean
+        external fun nativeGetFrameStats(stats: FloatArray)
 
         override fun onSurfaceCreated(gl: GL10?, config: EGLConfig?) {
             // Initialize AssetManager in native code
             nativeSetAssetManager(context.assets)
+            nativeSetTouchBuffers(touchBatch.buffers[0], touchBatch.buffers[1])
             nativeOnSurfaceCreated()
         }
 
@@ -72,46 +188,92 @@ constructor(context: Context, attrs: AttributeSet? = null) : GLSurfaceView(conte
         }
 
         override fun onDrawFrame(gl: GL10?) {
-            nativeOnDrawFrame()
-        }
-
-        fun onTouchDown(x: Float, y: Float) {
-            lastTouchX = x
-            lastTouchY = y
-            touchDown = true
-            nativeOnTouchDown(x, y)
+            // One JNI call per frame however many touch samples arrived
+            val touches = touchBatch.swap()
+            nativeOnDrawFrame(touches ushr 16, touches and 0xFFFF)
         }
 
-        fun onTouchMove(x: Float, y: Float) {
-            if (touchDown) {
-                nativeOnTouchMove(x, y)
-                lastTouchX = x
-                lastTouchY = y
-            }
-        }
+        fun startFramePacing(view: GLSurfaceView): Boolean = nativeStartFramePacing(view)
 
-        fun onTouchUp() {
-            touchDown = false
-            nativeOnTouchUp()
+        fun stopFramePacing() {
+            nativeStopFramePacing()
         }
 
         fun setSkeletonType(skeletonType: Int) {
             nativeSetSkeletonType(skeletonType)
         }
 
+        fun setBodyShape(bodyShape: Float) {
+            nativeSetBodyShape(bodyShape)
+        }
+
         fun setUseObjLoader(useObjLoader: Boolean) {
             nativeSetUseObjLoader(useObjLoader)
         }
+
+        fun setAnimating(animating: Boolean) {
+            nativeSetAnimating(animating)
+        }
+
+        fun onTrimMemory(level: Int) {
+            nativeOnTrimMemory(level)
+        }
+
+        fun writeTrace(path: String): Boolean = nativeWriteTrace(path)
+
+        private val frameStats = FloatArray(FrameStats.FIELD_COUNT)
+
+        @Synchronized
+        fun getFrameStats(): FrameStats {
+            nativeGetFrameStats(frameStats)
+            return FrameStats.fromArray(frameStats)
+        }
     }
 
+    // Settings ask native code for a frame themselves, paced to vsync
+
     fun setSkeletonType(skeletonType: Int) {
         renderer.setSkeletonType(skeletonType)
     }
 
+    /**
+     * Blends the detailed body between builds, -1 for slim through 0 to 1 for athletic. Only the
+     * detailed skeleton type can be reshaped.
+     */
+    fun setBodyShape(bodyShape: Float) {
+        renderer.setBodyShape(bodyShape)
+    }
+
     fun setUseObjLoader(useObjLoader: Boolean) {
         renderer.setUseObjLoader(useObjLoader)
     }
 
+    /**
+     * Plays or pauses the persona's animation. While paused and untouched the view draws
+     * nothing.
+     */
+    fun setAnimating(animating: Boolean) {
+        renderer.setAnimating(animating)
+    }
+
+    /**
+     * Writes what the native profiler recorded over the last few seconds to trace.json in the
+     * app's external files, to pull with adb and open in Perfetto or chrome://tracing. It's
+     * written on a background thread and [onWritten] is called back on the UI thread with the
+     * file, or null if it couldn't be written.
+     */
+    fun writeTrace(onWritten: (File?) -> Unit) {
+        val file = File(context.getExternalFilesDir(null) ?: context.filesDir, "trace.json")
+        Thread {
+                    val written = renderer.writeTrace(file.path)
+                    post { onWritten(if (written) file else null) }
+                }
+                .start()
+    }
+
+    /** What recent frames cost, cheap enough to poll from the UI a few times a second. */
+    fun getFrameStats(): FrameStats = renderer.getFrameStats()
+
     companion object {
         init {
             System.loadLibrary("holopersona")
@@ -1,6 +1,7 @@
 package org.lightscout.holopersona
 
 import android.os.Bundle
+import android.widget.Toast
 import androidx.activity.ComponentActivity
 import androidx.activity.compose.setContent
 import androidx.activity.enableEdgeToEdge
@@ -11,11 +12,14 @@ import androidx.compose.material3.*
 import androidx.compose.runtime.*
 import androidx.compose.ui.Alignment
 import androidx.compose.ui.Modifier
+import androidx.compose.ui.graphics.Color
+import androidx.compose.ui.platform.LocalContext
 import androidx.compose.ui.unit.dp
 import androidx.compose.ui.viewinterop.AndroidView
 import androidx.core.view.WindowCompat
 import androidx.core.view.WindowInsetsCompat
 import androidx.core.view.WindowInsetsControllerCompat
+import kotlinx.coroutines.delay
 import org.lightscout.holopersona.ui.theme.HoloPersonaTheme
 
 class MainActivity : ComponentActivity() {
@@ -54,6 +58,12 @@ fun HoloPersonaApp() {
     var selectedSkeletonType by remember { mutableIntStateOf(1) } // DETAILED_HUMANOID
     var showControls by remember { mutableStateOf(true) }
     var useObjLoader by remember { mutableStateOf(false) }
+    var bodyShape by remember { mutableFloatStateOf(0f) } // -1 slim to 1 athletic
+    var animating by remember { mutableStateOf(true) }
+    var glView by remember { mutableStateOf<HoloPersonaGLSurfaceView?>(null) }
+    var showStats by remember { mutableStateOf(false) }
+    var frameStats by remember { mutableStateOf<FrameStats?>(null) }
+    val context = LocalContext.current
 
     Box(modifier = Modifier.fillMaxSize()) {
         // 3D Background View
@@ -62,12 +72,17 @@ fun HoloPersonaApp() {
                     HoloPersonaGLSurfaceView(context).apply {
                         setSkeletonType(selectedSkeletonType)
                         setUseObjLoader(useObjLoader)
+                        setBodyShape(bodyShape)
+                        setAnimating(animating)
+                        glView = this
                     }
                 },
                 modifier = Modifier.fillMaxSize(),
                 update = { view ->
                     view.setSkeletonType(selectedSkeletonType)
                     view.setUseObjLoader(useObjLoader)
+                    view.setBodyShape(bodyShape)
+                    view.setAnimating(animating)
                 }
         )
 
@@ -151,6 +166,33 @@ fun HoloPersonaApp() {
 
                         Spacer(modifier = Modifier.height(16.dp))
 
+                        // Body Shape Slider, morphs the detailed skeleton between builds
+                        val canReshape = selectedSkeletonType == 1 && !useObjLoader
+                        Row(
+                                modifier = Modifier.fillMaxWidth(),
+                                verticalAlignment = Alignment.CenterVertically
+                        ) {
+                            Text(
+                                    text = "Slim",
+                                    style = MaterialTheme.typography.bodyMedium,
+                                    color = MaterialTheme.colorScheme.onSurface
+                            )
+                            Slider(
+                                    value = bodyShape,
+                                    onValueChange = { bodyShape = it },
+                                    valueRange = -1f..1f,
+                                    enabled = canReshape,
+                                    modifier = Modifier.weight(1f).padding(horizontal = 8.dp)
+                            )
+                            Text(
+                                    text = "Athletic",
+                                    style = MaterialTheme.typography.bodyMedium,
+                                    color = MaterialTheme.colorScheme.onSurface
+                            )
+                        }
+
+                        Spacer(modifier = Modifier.height(16.dp))
+
                         // OBJ Loader Toggle
                         Row(
                                 modifier = Modifier.fillMaxWidth(),
@@ -167,6 +209,53 @@ fun HoloPersonaApp() {
 
                         Spacer(modifier = Modifier.height(16.dp))
 
+                        // Animation Toggle, a paused persona costs nothing to show
+                        Row(
+                                modifier = Modifier.fillMaxWidth(),
+                                verticalAlignment = Alignment.CenterVertically
+                        ) {
+                            Text(
+                                    text = "Animate",
+                                    modifier = Modifier.weight(1f),
+                                    style = MaterialTheme.typography.bodyMedium,
+                                    color = MaterialTheme.colorScheme.onSurface
+                            )
+                            Switch(checked = animating, onCheckedChange = { animating = it })
+                        }
+
+                        Spacer(modifier = Modifier.height(16.dp))
+
+                        // Frame Stats Toggle
+                        Row(
+                                modifier = Modifier.fillMaxWidth(),
+                                verticalAlignment = Alignment.CenterVertically
+                        ) {
+                            Text(
+                                    text = "Show Frame Stats",
+                                    modifier = Modifier.weight(1f),
+                                    style = MaterialTheme.typography.bodyMedium,
+                                    color = MaterialTheme.colorScheme.onSurface
+                            )
+                            Switch(checked = showStats, onCheckedChange = { showStats = it })
+                        }
+
+                        Spacer(modifier = Modifier.height(16.dp))
+
+                        // Saves the native profiler's recent zones for Perfetto
+                        OutlinedButton(
+                                onClick = {
+                                    glView?.writeTrace { file ->
+                                        val message =
+                                                file?.let { "Trace saved to ${it.path}" }
+                                                        ?: "Couldn't save the trace"
+                                        Toast.makeText(context, message, Toast.LENGTH_LONG).show()
+                                    }
+                                },
+                                modifier = Modifier.fillMaxWidth()
+                        ) { Text("Save Trace") }
+
+                        Spacer(modifier = Modifier.height(8.dp))
+
                         // Hide/Show Controls Button
                         Button(
                                 onClick = { showControls = false },
@@ -177,6 +266,45 @@ fun HoloPersonaApp() {
             }
         }
 
+        // Frame Stats Overlay, polled a couple of times a second while it's shown
+        if (showStats) {
+            LaunchedEffect(glView) {
+                while (true) {
+                    frameStats = glView?.getFrameStats()
+                    delay(500)
+                }
+            }
+            frameStats?.let { stats ->
+                Surface(
+                        modifier = Modifier.align(Alignment.TopEnd).padding(24.dp),
+                        color = Color.Black.copy(alpha = 0.6f),
+                        shape = MaterialTheme.shapes.small
+                ) {
+                    Text(
+                            text =
+                                    ("CPU %.2f ms\n  input %.2f, wait %.2f, render %.2f\n" +
+                                                    "Simulation %.2f ms\nGPU %s\n" +
+                                                    "%.0f draws, %.0f triangles\n%.0f state changes")
+                                            .format(
+                                                    stats.cpuMs,
+                                                    stats.inputMs,
+                                                    stats.waitMs,
+                                                    stats.renderMs,
+                                                    stats.simulationMs,
+                                                    stats.gpuMs?.let { "%.2f ms".format(it) }
+                                                            ?: "n/a",
+                                                    stats.draws,
+                                                    stats.triangles,
+                                                    stats.stateChanges
+                                            ),
+                            modifier = Modifier.padding(8.dp),
+                            style = MaterialTheme.typography.bodySmall,
+                            color = Color.White
+                    )
+                }
+            }
+        }
+
         // Show Controls Button (when hidden)
         if (!showControls) {
             FloatingActionButton(
@@ -0,0 +1,173 @@
+#include "HostTest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "AnimationClip.h"
+
+namespace {
+
+const float kSampleRate = 30.f;
+
+/*!
+ * The angle between two rotations, from the chord between them. An acos of their dot can't
+ * tell angles under a milliradian or so apart.
+ */
+float rotationError(const Quaternion &a, const Quaternion &b) {
+    float sign = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w < 0.f ? -1.f : 1.f;
+    float dx = a.x - b.x * sign, dy = a.y - b.y * sign;
+    float dz = a.z - b.z * sign, dw = a.w - b.w * sign;
+    return 4.f * asinf(std::min(1.f, 0.5f * sqrtf(dx * dx + dy * dy + dz * dz + dw * dw)));
+}
+
+float vectorError(const Vector3 &a, const Vector3 &b) {
+    return std::max({fabsf(a.x - b.x), fabsf(a.y - b.y), fabsf(a.z - b.z)});
+}
+
+Quaternion normalized(float x, float y, float z, float w) {
+    float length = sqrtf(x * x + y * y + z * z + w * w);
+    return {x / length, y / length, z / length, w / length};
+}
+
+/*!
+ * Compresses a clip that holds @a rotation still on one joint, then samples it back, which is
+ * the rotation packed and unpacked
+ */
+Quaternion roundTrip(const Quaternion &rotation) {
+    JointTransform transform;
+    transform.rotation = rotation;
+    auto spClip = AnimationClip::compress("still", 1, kSampleRate, {transform, transform});
+    AnimationSampler sampler(spClip);
+    JointTransform sampled;
+    sampler.sample(0.f, false, &sampled);
+    return sampled.rotation;
+}
+
+} // namespace
+
+TEST(packedRotationsRoundTripForEveryDroppedComponent) {
+    const float tolerance = AnimationClip::Tolerance().rotation;
+    std::vector<Quaternion> rotations;
+
+    // Each component the largest in turn, with either sign, and the others of both signs
+    for (int largest = 0; largest < 4; largest++) {
+        for (float sign: {1.f, -1.f}) {
+            for (float small: {0.1f, -0.3f, 0.7f}) {
+                float c[4] = {small, -small * 0.5f, small * 0.25f, small};
+                c[largest] = sign;
+                rotations.push_back(normalized(c[0], c[1], c[2], c[3]));
+            }
+        }
+    }
+    // Two components tied for largest, which puts the others at the edge of the quantized range
+    rotations.push_back(normalized(1.f, 1.f, 0.f, 0.f));
+    rotations.push_back(normalized(0.f, 0.f, -1.f, 1.f));
+    rotations.push_back(Quaternion::identity());
+
+    std::mt19937 random(1);
+    std::normal_distribution<float> distribution;
+    for (int i = 0; i < 1000; i++) {
+        rotations.push_back(normalized(distribution(random), distribution(random),
+                                       distribution(random), distribution(random)));
+    }
+
+    float worst = 0.f;
+    for (const Quaternion &rotation: rotations) {
+        worst = std::max(worst, rotationError(roundTrip(rotation), rotation));
+    }
+    if (worst > tolerance) {
+        std::cerr << "    worst round trip " << worst << std::endl;
+    }
+    CHECK(worst <= tolerance);
+}
+
+TEST(compressedClipSamplesWithinTolerance) {
+    const size_t kJointCount = 3;
+    const size_t kFrameCount = 121;
+    const AnimationClip::Tolerance tolerance;
+
+    // A still joint, a swinging one, and one tumbling through every axis so the dropped
+    // component changes from frame to frame
+    std::vector<JointTransform> frames(kFrameCount * kJointCount);
+    for (size_t frame = 0; frame < kFrameCount; frame++) {
+        float t = float(frame) / kSampleRate;
+        JointTransform *pose = &frames[frame * kJointCount];
+        pose[0].translation = {0.f, 1.f, 0.f};
+        pose[1].rotation = Quaternion::fromAxisAngle({0.f, 0.f, 1.f}, 0.8f * sinf(t * 3.f));
+        pose[1].translation = {0.2f * sinf(t * 2.f), 0.5f, 0.f};
+        pose[2].rotation = normalized(sinf(t * 1.3f), cosf(t * 2.1f), sinf(t * 0.7f + 1.f),
+                                      cosf(t * 1.7f));
+        pose[2].scale = {1.f + 0.1f * sinf(t), 1.f, 1.f};
+    }
+
+    auto spClip = AnimationClip::compress("test", kJointCount, kSampleRate, frames, tolerance);
+    CHECK(spClip != nullptr);
+    if (!spClip) {
+        return;
+    }
+    CHECK_NEAR(spClip->getDuration(), float(kFrameCount - 1) / kSampleRate, 1e-6);
+    // Something was dropped, and the still joint keeps one key a track
+    CHECK(spClip->getKeyCount() < kFrameCount * kJointCount * 3);
+
+    AnimationSampler sampler(spClip);
+    std::vector<JointTransform> pose(kJointCount);
+    float worstRotation = 0.f, worstTranslation = 0.f, worstScale = 0.f;
+    for (size_t frame = 0; frame < kFrameCount; frame++) {
+        sampler.sample(float(frame) / kSampleRate, false, pose.data());
+        for (size_t joint = 0; joint < kJointCount; joint++) {
+            const JointTransform &source = frames[frame * kJointCount + joint];
+            worstRotation = std::max(worstRotation,
+                                     rotationError(pose[joint].rotation, source.rotation));
+            worstTranslation = std::max(worstTranslation,
+                                        vectorError(pose[joint].translation, source.translation));
+            worstScale = std::max(worstScale, vectorError(pose[joint].scale, source.scale));
+        }
+    }
+    if (worstRotation > tolerance.rotation) {
+        std::cerr << "    worst rotation error " << worstRotation << std::endl;
+    }
+    CHECK(worstRotation <= tolerance.rotation);
+    CHECK(worstTranslation <= tolerance.translation + 1e-6f);
+    CHECK(worstScale <= tolerance.scale + 1e-6f);
+}
+
+TEST(constantTracksKeepOneKey) {
+    const size_t kJointCount = 4;
+    const size_t kFrameCount = 60;
+    std::vector<JointTransform> frames(kFrameCount * kJointCount);
+    for (size_t frame = 0; frame < kFrameCount; frame++) {
+        for (size_t joint = 0; joint < kJointCount; joint++) {
+            JointTransform &transform = frames[frame * kJointCount + joint];
+            transform.rotation = Quaternion::fromAxisAngle({0.f, 1.f, 0.f}, float(joint));
+            transform.translation = {float(joint), 0.f, -1.f};
+            transform.scale = {2.f, 2.f, 2.f};
+        }
+    }
+    // Noise well inside the tolerance doesn't count as movement
+    frames[31 * kJointCount + 2].translation.x += 0.0005f;
+
+    auto spClip = AnimationClip::compress("still", kJointCount, kSampleRate, frames);
+    CHECK(spClip != nullptr);
+    if (!spClip) {
+        return;
+    }
+    CHECK_EQ(spClip->getKeyCount(), kJointCount * 3);
+
+    // A single key holds for the whole clip
+    AnimationSampler sampler(spClip);
+    std::vector<JointTransform> pose(kJointCount);
+    sampler.sample(1.5f, false, pose.data());
+    for (size_t joint = 0; joint < kJointCount; joint++) {
+        CHECK_EQ(pose[joint].translation.x, float(joint));
+        CHECK_EQ(pose[joint].scale.y, 2.f);
+    }
+}
+
+TEST(rejectsFramesThatDontFit) {
+    std::vector<JointTransform> frames(5);
+    CHECK(AnimationClip::compress("odd", 2, kSampleRate, frames) == nullptr);
+    CHECK(AnimationClip::compress("short", 5, kSampleRate, frames) == nullptr);
+    CHECK(AnimationClip::compress("rate", 1, 0.f, frames) == nullptr);
+}
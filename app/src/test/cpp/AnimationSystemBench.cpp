@@ -0,0 +1,64 @@
+// Time per character of AnimationSystem::update for crowds of 1 to 1000 detailed humanoids
+// playing the idle and walk clips, on JobSystems of 1 to 7 workers plus the calling thread.
+// Small crowds show what the job overhead costs, large ones how well the batches spread.
+
+#include <cstdio>
+#include <memory>
+#include <thread>
+
+#include "AnimationSystem.h"
+#include "HostBench.h"
+#include "SkeletonAsset.h"
+
+int main(int argc, char **argv) {
+    const bool quick = HostBench::isQuick(argc, argv);
+    const size_t repeats = quick ? 1 : 20;
+    const size_t kFrameUpdates = quick ? 1 : 10;
+    const float kFrameTime = 1.0f / 60.0f;
+
+    std::vector<Vertex> vertices;
+    std::vector<Index> indices;
+    auto spSkeleton = std::make_shared<Skeleton>();
+    SkeletonAsset::createSkeleton(SkeletonAsset::SkeletonType::DETAILED_HUMANOID, vertices,
+                                  indices, *spSkeleton);
+    std::shared_ptr<const AnimationClip> spIdle =
+            SkeletonAsset::createClip(SkeletonAsset::ClipType::IDLE, *spSkeleton);
+    std::shared_ptr<const AnimationClip> spWalk =
+            SkeletonAsset::createClip(SkeletonAsset::ClipType::WALK, *spSkeleton);
+    if (!spIdle || !spWalk) {
+        fprintf(stderr, "couldn't create the clips\n");
+        return 1;
+    }
+
+    printf("%zu joints, best of %zu runs of %zu updates, %u hardware threads\n",
+           spSkeleton->getJointCount(), repeats, kFrameUpdates,
+           std::thread::hardware_concurrency());
+    printf("%-10s %8s %16s %12s\n", "characters", "workers", "us/character", "us/update");
+
+    for (size_t workers: {1, 2, 4, 7}) {
+        if (quick && workers > 2) {
+            break;
+        }
+        JobSystem jobSystem(workers);
+        for (size_t characters: {1, 10, 100, 1000}) {
+            if (quick && characters > 10) {
+                break;
+            }
+            AnimationSystem animation(jobSystem);
+            for (size_t i = 0; i < characters; i++) {
+                animation.addCharacter(std::make_unique<AnimatedCharacter>(
+                        spSkeleton, spIdle, spWalk, float(i) * 0.37f));
+            }
+
+            double nanos = HostBench::fastestNanos(repeats, [&]() {
+                for (size_t frame = 0; frame < kFrameUpdates; frame++) {
+                    animation.update(kFrameTime);
+                }
+                HostBench::keep(animation.getCharacter(0).getSkinMatrices());
+            }) / double(kFrameUpdates);
+            printf("%-10zu %8zu %16.2f %12.1f\n", characters, workers,
+                   nanos / 1000.0 / double(characters), nanos / 1000.0);
+        }
+    }
+    return 0;
+}
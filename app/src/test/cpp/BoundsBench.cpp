@@ -0,0 +1,112 @@
+// Nanoseconds per point, box or vertex of the Bounds kernels against the obvious scalar loops:
+// points and bounds over the MakeHuman mesh (test_model.obj), boxes against transforming all
+// eight corners.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "Bounds.h"
+#include "HostAssets.h"
+#include "HostBench.h"
+
+int main(int argc, char **argv) {
+    const bool quick = HostBench::isQuick(argc, argv);
+    const size_t repeats = quick ? 1 : 100;
+    const size_t kBoxCount = 4096;
+
+    std::vector<Vertex> vertices;
+    std::vector<Index> indices;
+    if (!HostAssets::loadObj("test_model.obj", vertices, indices)) {
+        fprintf(stderr, "couldn't load test_model.obj\n");
+        return 1;
+    }
+    const size_t count = vertices.size();
+    std::vector<float> xs(count), ys(count), zs(count), outXs(count), outYs(count), outZs(count);
+    for (size_t i = 0; i < count; i++) {
+        xs[i] = vertices[i].position.x;
+        ys[i] = vertices[i].position.y;
+        zs[i] = vertices[i].position.z;
+    }
+
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> distribution(-4.0f, 4.0f);
+    float m[16];
+    for (float &value: m) {
+        value = distribution(random);
+    }
+    m[3] = m[7] = m[11] = 0.f;
+    m[15] = 1.f;
+    std::vector<BoundingBox> boxes(kBoxCount), outBoxes(kBoxCount);
+    for (auto &box: boxes) {
+        float x = distribution(random), y = distribution(random), z = distribution(random);
+        box = {{x, y, z}, {x + 1.f, y + 2.f, z + 0.5f}};
+    }
+
+    printf("%zu vertices, %zu boxes, best of %zu\n%-24s %12s %10s\n", count, kBoxCount, repeats,
+           "operation", "ns/each", "speedup");
+    auto report = [](const char *operation, double nanos, double referenceNanos) {
+        printf("%-24s %12.2f %9.2fx\n", operation, nanos, referenceNanos / nanos);
+    };
+
+    double reference = HostBench::fastestNanos(repeats, [&]() {
+        for (size_t i = 0; i < count; i++) {
+            outXs[i] = m[0] * xs[i] + m[4] * ys[i] + m[8] * zs[i] + m[12];
+            outYs[i] = m[1] * xs[i] + m[5] * ys[i] + m[9] * zs[i] + m[13];
+            outZs[i] = m[2] * xs[i] + m[6] * ys[i] + m[10] * zs[i] + m[14];
+        }
+        HostBench::keep(outXs.data());
+    }) / double(count);
+    report("points scalar", reference, reference);
+    report("transformPoints", HostBench::fastestNanos(repeats, [&]() {
+        Bounds::transformPoints(m, xs.data(), ys.data(), zs.data(),
+                                outXs.data(), outYs.data(), outZs.data(), count);
+        HostBench::keep(outXs.data());
+    }) / double(count), reference);
+
+    reference = HostBench::fastestNanos(repeats, [&]() {
+        for (size_t i = 0; i < kBoxCount; i++) {
+            BoundingBox result = {{INFINITY, INFINITY, INFINITY},
+                                  {-INFINITY, -INFINITY, -INFINITY}};
+            for (int corner = 0; corner < 8; corner++) {
+                float x = corner & 1 ? boxes[i].max.x : boxes[i].min.x;
+                float y = corner & 2 ? boxes[i].max.y : boxes[i].min.y;
+                float z = corner & 4 ? boxes[i].max.z : boxes[i].min.z;
+                for (int row = 0; row < 3; row++) {
+                    float world = m[row] * x + m[4 + row] * y + m[8 + row] * z + m[12 + row];
+                    result.min.idx[row] = std::min(result.min.idx[row], world);
+                    result.max.idx[row] = std::max(result.max.idx[row], world);
+                }
+            }
+            outBoxes[i] = result;
+        }
+        HostBench::keep(outBoxes.data());
+    }) / double(kBoxCount);
+    report("boxes by corners", reference, reference);
+    report("transformBoundingBoxes", HostBench::fastestNanos(repeats, [&]() {
+        Bounds::transformBoundingBoxes(m, boxes.data(), outBoxes.data(), kBoxCount);
+        HostBench::keep(outBoxes.data());
+    }) / double(kBoxCount), reference);
+
+    BoundingBox bounds;
+    reference = HostBench::fastestNanos(repeats, [&]() {
+        bounds = {{INFINITY, INFINITY, INFINITY}, {-INFINITY, -INFINITY, -INFINITY}};
+        for (size_t i = 0; i < count; i++) {
+            const Vector3 &p = vertices[i].position;
+            for (int row = 0; row < 3; row++) {
+                float world = m[row] * p.x + m[4 + row] * p.y + m[8 + row] * p.z + m[12 + row];
+                bounds.min.idx[row] = std::min(bounds.min.idx[row], world);
+                bounds.max.idx[row] = std::max(bounds.max.idx[row], world);
+            }
+        }
+        HostBench::keep(bounds);
+    }) / double(count);
+    report("bounds scalar", reference, reference);
+    report("computeBoundingBox", HostBench::fastestNanos(repeats, [&]() {
+        bounds = Bounds::computeBoundingBox(m, vertices.data(), count);
+        HostBench::keep(bounds);
+    }) / double(count), reference);
+    return 0;
+}
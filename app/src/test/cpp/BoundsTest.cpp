@@ -0,0 +1,179 @@
+#include "HostTest.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "Bounds.h"
+#include "HostRandom.h"
+
+namespace {
+
+using HostRandom::randomFloats;
+
+std::vector<float> randomAffineMatrix(uint32_t seed) {
+    std::vector<float> m = randomFloats(16, seed);
+    m[3] = m[7] = m[11] = 0.f;
+    m[15] = 1.f;
+    return m;
+}
+
+std::vector<BoundingBox> randomBoxes(size_t count, uint32_t seed) {
+    std::vector<float> floats = randomFloats(count * 6, seed);
+    std::vector<BoundingBox> boxes(count);
+    for (size_t i = 0; i < count; i++) {
+        const float *f = &floats[i * 6];
+        boxes[i] = {{std::min(f[0], f[3]), std::min(f[1], f[4]), std::min(f[2], f[5])},
+                    {std::max(f[0], f[3]), std::max(f[1], f[4]), std::max(f[2], f[5])}};
+    }
+    return boxes;
+}
+
+Vec4 transformPoint(const float *matrix, float x, float y, float z) {
+    Vec4 in = {x, y, z, 1.f}, out;
+    VectorMath::transformBatchReference(matrix, &in, &out, 1);
+    return out;
+}
+
+/*!
+ * The bounds of a box's eight corners, each transformed on its own
+ */
+BoundingBox transformCorners(const float *matrix, const BoundingBox &box) {
+    BoundingBox result = {{INFINITY, INFINITY, INFINITY}, {-INFINITY, -INFINITY, -INFINITY}};
+    for (int corner = 0; corner < 8; corner++) {
+        Vec4 p = transformPoint(matrix,
+                                corner & 1 ? box.max.x : box.min.x,
+                                corner & 2 ? box.max.y : box.min.y,
+                                corner & 4 ? box.max.z : box.min.z);
+        const float world[3] = {p.x, p.y, p.z};
+        for (int axis = 0; axis < 3; axis++) {
+            result.min.idx[axis] = std::min(result.min.idx[axis], world[axis]);
+            result.max.idx[axis] = std::max(result.max.idx[axis], world[axis]);
+        }
+    }
+    return result;
+}
+
+void checkBoxNear(const BoundingBox &actual, const BoundingBox &expected) {
+    for (int axis = 0; axis < 3; axis++) {
+        CHECK_NEAR(actual.min.idx[axis], expected.min.idx[axis], 1e-4);
+        CHECK_NEAR(actual.max.idx[axis], expected.max.idx[axis], 1e-4);
+    }
+}
+
+bool sameBox(const BoundingBox &a, const BoundingBox &b) {
+    for (int axis = 0; axis < 3; axis++) {
+        if (a.min.idx[axis] != b.min.idx[axis] || a.max.idx[axis] != b.max.idx[axis]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+TEST(transformPointsMatchesPointByPoint) {
+    std::vector<float> matrix = randomAffineMatrix(1);
+    for (size_t count: HostRandom::kBatchCounts) {
+        std::vector<float> xs = randomFloats(count, uint32_t(count));
+        std::vector<float> ys = randomFloats(count, uint32_t(count + 1));
+        std::vector<float> zs = randomFloats(count, uint32_t(count + 2));
+        std::vector<float> outXs(count), outYs(count), outZs(count);
+        Bounds::transformPoints(matrix.data(), xs.data(), ys.data(), zs.data(),
+                                outXs.data(), outYs.data(), outZs.data(), count);
+        for (size_t i = 0; i < count; i++) {
+            Vec4 expected = transformPoint(matrix.data(), xs[i], ys[i], zs[i]);
+            CHECK_NEAR(outXs[i], expected.x, 1e-5);
+            CHECK_NEAR(outYs[i], expected.y, 1e-5);
+            CHECK_NEAR(outZs[i], expected.z, 1e-5);
+        }
+
+        // In place gives the same bits
+        Bounds::transformPoints(matrix.data(), xs.data(), ys.data(), zs.data(),
+                                xs.data(), ys.data(), zs.data(), count);
+        CHECK(xs == outXs);
+        CHECK(ys == outYs);
+        CHECK(zs == outZs);
+    }
+}
+
+TEST(transformBoundingBoxesMatchesCorners) {
+    std::vector<BoundingBox> boxes = randomBoxes(200, 2);
+    for (uint32_t seed = 0; seed < 5; seed++) {
+        std::vector<float> matrix = randomAffineMatrix(seed);
+        std::vector<BoundingBox> transformed(boxes.size());
+        Bounds::transformBoundingBoxes(matrix.data(), boxes.data(), transformed.data(),
+                                       boxes.size());
+        for (size_t i = 0; i < boxes.size(); i++) {
+            checkBoxNear(transformed[i], transformCorners(matrix.data(), boxes[i]));
+        }
+
+        std::vector<BoundingBox> inPlace = boxes;
+        Bounds::transformBoundingBoxes(matrix.data(), inPlace.data(), inPlace.data(),
+                                       inPlace.size());
+        for (size_t i = 0; i < boxes.size(); i++) {
+            CHECK(sameBox(inPlace[i], transformed[i]));
+        }
+    }
+}
+
+TEST(transformBoundingBoxesKeepsFlatBoxes) {
+    // A box flat in y, as a floor quad's is, stays a single transformed plane
+    BoundingBox box = {{-1.f, 0.f, -1.f}, {1.f, 0.f, 1.f}};
+    const float translate[16] = {1.f, 0.f, 0.f, 0.f,
+                                 0.f, 1.f, 0.f, 0.f,
+                                 0.f, 0.f, 1.f, 0.f,
+                                 2.f, 3.f, 4.f, 1.f};
+    BoundingBox result;
+    Bounds::transformBoundingBoxes(translate, &box, &result, 1);
+    CHECK_EQ(result.min.y, 3.f);
+    CHECK_EQ(result.max.y, 3.f);
+    checkBoxNear(result, {{1.f, 3.f, 3.f}, {3.f, 3.f, 5.f}});
+}
+
+TEST(computeBoundingBoxMatchesVertices) {
+    std::vector<float> positions = randomFloats(1001 * 3, 3);
+    std::vector<Vertex> vertices;
+    for (size_t i = 0; i < 1001; i++) {
+        vertices.emplace_back(Vector3{positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2]},
+                              Vector2{0.f, 0.f});
+    }
+    std::vector<float> matrix = randomAffineMatrix(4);
+
+    for (size_t count: HostRandom::kBatchCounts) {
+        if (count == 0) {
+            continue;
+        }
+        BoundingBox local = {{INFINITY, INFINITY, INFINITY}, {-INFINITY, -INFINITY, -INFINITY}};
+        BoundingBox world = local;
+        for (size_t i = 0; i < count; i++) {
+            const Vector3 &p = vertices[i].position;
+            Vec4 w = transformPoint(matrix.data(), p.x, p.y, p.z);
+            const float worlds[3] = {w.x, w.y, w.z};
+            for (int axis = 0; axis < 3; axis++) {
+                local.min.idx[axis] = std::min(local.min.idx[axis], p.idx[axis]);
+                local.max.idx[axis] = std::max(local.max.idx[axis], p.idx[axis]);
+                world.min.idx[axis] = std::min(world.min.idx[axis], worlds[axis]);
+                world.max.idx[axis] = std::max(world.max.idx[axis], worlds[axis]);
+            }
+        }
+
+        // Without a matrix the bounds are the positions themselves, exactly
+        CHECK(sameBox(Bounds::computeBoundingBox(nullptr, vertices.data(), count), local));
+        checkBoxNear(Bounds::computeBoundingBox(matrix.data(), vertices.data(), count), world);
+
+        // And the transformed local bounds hold the tighter world bounds
+        BoundingBox loose;
+        Bounds::transformBoundingBoxes(matrix.data(), &local, &loose, 1);
+        for (int axis = 0; axis < 3; axis++) {
+            CHECK(loose.min.idx[axis] <= world.min.idx[axis] + 1e-4f);
+            CHECK(loose.max.idx[axis] >= world.max.idx[axis] - 1e-4f);
+        }
+    }
+}
+
+TEST(computeBoundingBoxOfNothingIsZero) {
+    std::vector<float> matrix = randomAffineMatrix(5);
+    BoundingBox zero = {{0.f, 0.f, 0.f}, {0.f, 0.f, 0.f}};
+    CHECK(sameBox(Bounds::computeBoundingBox(matrix.data(), nullptr, 0), zero));
+    CHECK(sameBox(Bounds::computeBoundingBox(nullptr, nullptr, 0), zero));
+}
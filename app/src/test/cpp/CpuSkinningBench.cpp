@@ -0,0 +1,66 @@
+// Vertices skinned per second on the MakeHuman mesh (test_model.obj), by the scalar reference
+// and by CpuSkinning with 1 to 8 threads. One thread is CpuSkinning::skin on the calling thread,
+// n threads are skinParallel on a JobSystem of n - 1 workers plus the caller. Runs once with
+// neighbouring vertices sharing joints, as in a real rig, and once with them mixed, which makes
+// the vector path gather every matrix element.
+
+#include <cstdio>
+#include <vector>
+
+#include "CpuSkinning.h"
+#include "HostAssets.h"
+#include "HostBench.h"
+#include "JobSystem.h"
+
+int main(int argc, char **argv) {
+    const bool quick = HostBench::isQuick(argc, argv);
+    const size_t repeats = quick ? 1 : 50;
+    const size_t kJointCount = 16;
+
+    std::vector<Vertex> rest;
+    std::vector<Index> indices;
+    if (!HostAssets::loadObj("test_model.obj", rest, indices)) {
+        fprintf(stderr, "couldn't load test_model.obj\n");
+        return 1;
+    }
+    std::vector<Vertex> skinned = rest;
+    std::vector<float> matrices = HostAssets::randomSkinMatrices(kJointCount, 1);
+    SkinPalette palette;
+    palette.setMatrices(matrices.data(), kJointCount);
+
+    printf("%zu vertices, 4 influences each, best of %zu, %u hardware threads\n", rest.size(),
+           repeats, std::thread::hardware_concurrency());
+
+    for (bool mixed: {false, true}) {
+        HostAssets::bindToJoints(rest, kJointCount, mixed);
+        printf("\n%s joints\n%-12s %14s %10s\n", mixed ? "mixed" : "shared", "path",
+               "Mverts/s", "speedup");
+
+        double referenceNanos = HostBench::fastestNanos(repeats, [&]() {
+            CpuSkinning::skinReference(rest.data(), skinned.data(), rest.size(), matrices.data());
+            HostBench::keep(skinned.data());
+        });
+        auto report = [&](const char *path, double nanos) {
+            printf("%-12s %14.1f %9.2fx\n", path, double(rest.size()) / nanos * 1000.0,
+                   referenceNanos / nanos);
+        };
+        report("reference", referenceNanos);
+
+        report("1 thread", HostBench::fastestNanos(repeats, [&]() {
+            CpuSkinning::skin(rest.data(), skinned.data(), rest.size(), palette);
+            HostBench::keep(skinned.data());
+        }));
+
+        for (size_t threads = 2; threads <= (quick ? 2 : 8); threads++) {
+            JobSystem jobSystem(threads - 1);
+            char path[32];
+            snprintf(path, sizeof(path), "%zu threads", threads);
+            report(path, HostBench::fastestNanos(repeats, [&]() {
+                CpuSkinning::skinParallel(rest.data(), skinned.data(), rest.size(), palette,
+                                          jobSystem);
+                HostBench::keep(skinned.data());
+            }));
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include "HostTest.h"
+
+#include <cstring>
+#include <vector>
+
+#include "CpuSkinning.h"
+#include "HostAssets.h"
+#include "JobSystem.h"
+
+namespace {
+
+constexpr size_t kJointCount = 16;
+
+/*!
+ * @return the largest distance between the positions of two vertex arrays, relative to how far
+ *     the first one's positions are from the origin
+ */
+float largestRelativeError(const std::vector<Vertex> &a, const std::vector<Vertex> &b) {
+    float largest = 0.f;
+    for (size_t i = 0; i < a.size(); i++) {
+        const Vector3 &p = a[i].position;
+        const Vector3 &q = b[i].position;
+        float scale = std::max(1.f, std::fabs(p.x) + std::fabs(p.y) + std::fabs(p.z));
+        float error = (std::fabs(p.x - q.x) + std::fabs(p.y - q.y) + std::fabs(p.z - q.z)) / scale;
+        largest = std::max(largest, error);
+    }
+    return largest;
+}
+
+bool sameVertices(const std::vector<Vertex> &a, const std::vector<Vertex> &b) {
+    return a.size() == b.size() && memcmp(a.data(), b.data(), a.size() * sizeof(Vertex)) == 0;
+}
+
+/*!
+ * Skins @a rest every way there is and checks them against the reference
+ */
+void checkAgainstReference(const std::vector<Vertex> &rest) {
+    std::vector<float> matrices = HostAssets::randomSkinMatrices(kJointCount, 7);
+    SkinPalette palette;
+    palette.setMatrices(matrices.data(), kJointCount);
+
+    std::vector<Vertex> reference(rest.size(), rest.empty() ? Vertex({}, {}) : rest[0]);
+    CpuSkinning::skinReference(rest.data(), reference.data(), rest.size(), matrices.data());
+
+    std::vector<Vertex> skinned = reference;
+    CpuSkinning::skin(rest.data(), skinned.data(), rest.size(), palette);
+    // The vector path adds in a different order to the reference, so only rounding may differ
+    CHECK(largestRelativeError(reference, skinned) < 1e-5f);
+
+    // Everything but the position is copied as is
+    bool copied = true;
+    for (size_t i = 0; i < rest.size(); i++) {
+        copied = copied && skinned[i].uv.u == rest[i].uv.u && skinned[i].uv.v == rest[i].uv.v
+                 && memcmp(skinned[i].joints, rest[i].joints, sizeof(rest[i].joints)) == 0
+                 && memcmp(skinned[i].weights, rest[i].weights, sizeof(rest[i].weights)) == 0;
+    }
+    CHECK(copied);
+
+    // Splitting the mesh into jobs runs the same kernel on each range, so it's bit exact
+    for (size_t workers: {1, 3, 7}) {
+        JobSystem jobSystem(workers);
+        std::vector<Vertex> parallel(rest.size(), reference.empty() ? Vertex({}, {}) : reference[0]);
+        CpuSkinning::skinParallel(rest.data(), parallel.data(), rest.size(), palette, jobSystem);
+        CHECK(sameVertices(skinned, parallel));
+    }
+}
+
+} // namespace
+
+TEST(skinsTestModelLikeReference) {
+    std::vector<Vertex> vertices;
+    std::vector<Index> indices;
+    CHECK(HostAssets::loadObj("test_model.obj", vertices, indices));
+    CHECK(vertices.size() > 10000);
+    HostAssets::bindToJoints(vertices, kJointCount);
+    checkAgainstReference(vertices);
+
+    // Neighbours that don't share joints take the gathering path
+    HostAssets::bindToJoints(vertices, kJointCount, true);
+    checkAgainstReference(vertices);
+}
+
+TEST(skinsOddCountsLikeReference) {
+    // Counts that leave a scalar tail after the batches of four, and that split unevenly
+    std::vector<Vertex> vertices;
+    std::vector<Index> indices;
+    CHECK(HostAssets::loadObj("test_model.obj", vertices, indices));
+    HostAssets::bindToJoints(vertices, kJointCount);
+    for (size_t count: {0, 1, 3, 5, 4097, 8191}) {
+        checkAgainstReference({vertices.begin(), vertices.begin() + count});
+    }
+}
+
+TEST(skipsZeroWeights) {
+    // A vertex fully bound to joint 3 ignores every other joint's matrix
+    Vertex vertex(Vector3{1.f, 2.f, 3.f}, Vector2{0.f, 0.f}, 3);
+    std::vector<float> matrices = HostAssets::randomSkinMatrices(kJointCount, 9);
+    SkinPalette palette;
+    palette.setMatrices(matrices.data(), kJointCount);
+
+    std::vector<Vertex> rest(5, vertex), skinned(5, vertex);
+    CpuSkinning::skin(rest.data(), skinned.data(), rest.size(), palette);
+    const float *m = &matrices[3 * 16];
+    for (const auto &v: skinned) {
+        CHECK_NEAR(v.position.x, m[0] * 1.f + m[4] * 2.f + m[8] * 3.f + m[12], 1e-5);
+        CHECK_NEAR(v.position.y, m[1] * 1.f + m[5] * 2.f + m[9] * 3.f + m[13], 1e-5);
+        CHECK_NEAR(v.position.z, m[2] * 1.f + m[6] * 2.f + m[10] * 3.f + m[14], 1e-5);
+    }
+}
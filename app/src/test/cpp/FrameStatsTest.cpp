@@ -0,0 +1,256 @@
+#include "HostTest.h"
+
+#include <map>
+
+#include "FrameStats.h"
+#include "GpuTimer.h"
+
+namespace {
+
+/*!
+ * Queries whose results come back a fixed number of frames after they end, each timing what the
+ * test says the next scope takes
+ */
+class FakeQueryBackend : public GpuQueryBackend {
+public:
+    bool supported = true;
+    bool disjoint = false;
+    // Frames from a query ending to its result being available
+    int latency = 2;
+    // What the next query to end timed
+    uint32_t scopeNanos = 1'000'000;
+
+    int queriesBegun = 0;
+    bool nested = false;
+
+    //! Moves the GPU on a frame
+    void advance() { frame_++; }
+
+    bool isSupported() override { return supported; }
+
+    void createQueries(uint32_t *outQueries, size_t count) override {
+        for (size_t i = 0; i < count; i++) {
+            outQueries[i] = ++lastQuery_;
+        }
+    }
+
+    bool checkDisjoint() override {
+        bool wasDisjoint = disjoint;
+        disjoint = false;
+        return wasDisjoint;
+    }
+
+    void beginQuery(uint32_t query) override {
+        nested |= open_ != 0;
+        open_ = query;
+        queriesBegun++;
+    }
+
+    void endQuery() override {
+        results_[open_] = {frame_ + latency, scopeNanos};
+        open_ = 0;
+    }
+
+    bool isResultAvailable(uint32_t query) override {
+        auto result = results_.find(query);
+        return result != results_.end() && result->second.availableFrame <= frame_;
+    }
+
+    uint32_t getResultNanos(uint32_t query) override { return results_[query].nanos; }
+
+private:
+    struct Result {
+        int availableFrame;
+        uint32_t nanos;
+    };
+
+    int frame_ = 0;
+    uint32_t lastQuery_ = 0;
+    uint32_t open_ = 0;
+    std::map<uint32_t, Result> results_;
+};
+
+/*!
+ * Times a frame of @a scopes scopes on @a timer
+ * @return what beginFrame returned
+ */
+float timeFrame(GpuTimer &timer, FakeQueryBackend &backend, int scopes = 1) {
+    float gpuMs = timer.beginFrame();
+    for (int i = 0; i < scopes; i++) {
+        GpuScope scope(timer);
+    }
+    timer.endFrame();
+    backend.advance();
+    return gpuMs;
+}
+
+} // namespace
+
+TEST(frameStatsAveragesTheWindow) {
+    FrameStats stats;
+    FrameStatsSnapshot empty = stats.getSnapshot();
+    CHECK_EQ(empty.cpuMs, 0.0f);
+    CHECK_EQ(empty.draws, 0.0f);
+    CHECK_EQ(empty.renderMs, 0.0f);
+    CHECK(empty.gpuMs < 0.0f);
+
+    stats.addFrame({2.0f, 10, 1000, 4, 0.5f, 0.0f, 1.0f, 1.5f});
+    stats.addFrame({4.0f, 20, 3000, 6, 0.5f, 1.0f, 3.0f, 2.5f});
+    FrameStatsSnapshot snapshot = stats.getSnapshot();
+    CHECK_NEAR(snapshot.cpuMs, 3.0, 1e-6);
+    CHECK_NEAR(snapshot.draws, 15.0, 1e-6);
+    CHECK_NEAR(snapshot.triangles, 2000.0, 1e-6);
+    CHECK_NEAR(snapshot.stateChanges, 5.0, 1e-6);
+    CHECK_NEAR(snapshot.inputMs, 0.5, 1e-6);
+    CHECK_NEAR(snapshot.waitMs, 0.5, 1e-6);
+    CHECK_NEAR(snapshot.simulationMs, 2.0, 1e-6);
+    CHECK_NEAR(snapshot.renderMs, 2.0, 1e-6);
+    // Frames alone say nothing about the GPU
+    CHECK(snapshot.gpuMs < 0.0f);
+
+    stats.addGpuTime(1.0f);
+    stats.addGpuTime(2.0f);
+    CHECK_NEAR(stats.getSnapshot().gpuMs, 1.5, 1e-6);
+}
+
+TEST(frameStatsKeepsTheNewestFrames) {
+    FrameStats stats;
+    const size_t kFrames = FrameStats::kWindowSize + 10;
+    for (size_t i = 0; i < kFrames; i++) {
+        stats.addFrame({float(i), uint32_t(i), 0, 0, 0.0f, 0.0f, 0.0f, 0.0f});
+        stats.addGpuTime(float(i) * 2.0f);
+    }
+
+    // Only frames 10 to 39 are left, which average 24.5
+    double newestAverage = (10.0 + double(kFrames - 1)) / 2.0;
+    FrameStatsSnapshot snapshot = stats.getSnapshot();
+    CHECK_NEAR(snapshot.cpuMs, newestAverage, 1e-4);
+    CHECK_NEAR(snapshot.draws, newestAverage, 1e-4);
+    CHECK_NEAR(snapshot.gpuMs, newestAverage * 2.0, 1e-4);
+
+    stats.clear();
+    snapshot = stats.getSnapshot();
+    CHECK_EQ(snapshot.cpuMs, 0.0f);
+    CHECK(snapshot.gpuMs < 0.0f);
+}
+
+TEST(gpuTimerWithoutBackendNeverHasAResult) {
+    GpuTimer timer;
+    CHECK(!timer.init());
+    CHECK(!timer.isSupported());
+    for (int i = 0; i < 10; i++) {
+        CHECK(timer.beginFrame() < 0.0f);
+        timer.beginScope();
+        timer.endScope();
+        timer.endFrame();
+    }
+}
+
+TEST(gpuTimerWithUnsupportedBackendMakesNoQueries) {
+    FakeQueryBackend backend;
+    backend.supported = false;
+    GpuTimer timer(backend);
+    CHECK(!timer.init());
+    for (int i = 0; i < 10; i++) {
+        CHECK(timeFrame(timer, backend) < 0.0f);
+    }
+    CHECK_EQ(backend.queriesBegun, 0);
+}
+
+TEST(gpuTimerIsNegativeUntilAResultArrives) {
+    FakeQueryBackend backend;
+    backend.latency = 3;
+    GpuTimer timer(backend);
+    CHECK(timer.init());
+
+    // The first frame's result is available three frames after it ended, which the fourth
+    // frame's beginFrame collects
+    for (int frame = 0; frame < 3; frame++) {
+        CHECK(timeFrame(timer, backend) < 0.0f);
+    }
+    CHECK_NEAR(timeFrame(timer, backend), 1.0, 1e-6);
+    CHECK_NEAR(timeFrame(timer, backend), 1.0, 1e-6);
+    CHECK(!backend.nested);
+}
+
+TEST(gpuTimerAddsAFramesScopes) {
+    FakeQueryBackend backend;
+    backend.latency = 1;
+    backend.scopeNanos = 250'000;
+    GpuTimer timer(backend);
+    timer.init();
+
+    CHECK(timeFrame(timer, backend, 3) < 0.0f);
+    CHECK_NEAR(timeFrame(timer, backend, 3), 0.75, 1e-6);
+    CHECK_EQ(backend.queriesBegun, 6);
+
+    // A scope inside another is part of it, not a query of its own
+    timer.beginFrame();
+    {
+        GpuScope outer(timer);
+        GpuScope inner(timer);
+    }
+    timer.endFrame();
+    CHECK_EQ(backend.queriesBegun, 7);
+    CHECK(!backend.nested);
+}
+
+TEST(gpuTimerSkipsFramesWhenTheGpuFallsBehind) {
+    FakeQueryBackend backend;
+    backend.latency = 100;
+    GpuTimer timer(backend);
+    timer.init();
+
+    // Every frame in flight is waiting, so the rest go untimed rather than reuse their queries
+    for (size_t frame = 0; frame < GpuTimer::kFramesInFlight * 3; frame++) {
+        CHECK(timeFrame(timer, backend) < 0.0f);
+    }
+    CHECK_EQ(backend.queriesBegun, int(GpuTimer::kFramesInFlight));
+}
+
+TEST(gpuTimerDropsResultsAfterADisjoint) {
+    FakeQueryBackend backend;
+    backend.latency = 2;
+    GpuTimer timer(backend);
+    timer.init();
+
+    timeFrame(timer, backend);
+    timeFrame(timer, backend);
+    backend.disjoint = true;
+    // The two frames in flight are dropped, so the next result is the third frame's
+    CHECK(timeFrame(timer, backend) < 0.0f);
+    CHECK(timeFrame(timer, backend) < 0.0f);
+    CHECK_NEAR(timeFrame(timer, backend), 1.0, 1e-6);
+}
+
+TEST(frameStatsAverageGpuTimesAsTheyArrive) {
+    // The renderer's loop, with the GPU taking 1 ms more each frame
+    FakeQueryBackend backend;
+    backend.latency = 2;
+    GpuTimer timer(backend);
+    timer.init();
+    FrameStats stats;
+
+    const size_t kFrames = FrameStats::kWindowSize + 12;
+    for (size_t frame = 0; frame < kFrames; frame++) {
+        backend.scopeNanos = uint32_t(frame + 1) * 1'000'000;
+        float gpuMs = timeFrame(timer, backend);
+        if (gpuMs >= 0.0f) {
+            stats.addGpuTime(gpuMs);
+        }
+        stats.addFrame({1.0f, 1, 1, 1, 0.25f, 0.0f, 0.5f, 0.75f});
+
+        FrameStatsSnapshot snapshot = stats.getSnapshot();
+        if (frame < 2) {
+            // Frame 0's result is only collected by frame 2
+            CHECK(snapshot.gpuMs < 0.0f);
+        } else {
+            // Frames 0 to frame - 2 have come back, and the window holds the newest of them
+            size_t arrived = frame - 1;
+            size_t first = arrived > FrameStats::kWindowSize ? arrived - FrameStats::kWindowSize
+                                                             : 0;
+            double expected = (double(first + 1) + double(arrived)) / 2.0;
+            CHECK_NEAR(snapshot.gpuMs, expected, 1e-4);
+        }
+    }
+}
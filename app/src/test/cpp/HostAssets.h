@@ -0,0 +1,95 @@
+#ifndef HOLOPERSONA_HOSTASSETS_H
+#define HOLOPERSONA_HOSTASSETS_H
+
+#include <android/asset_manager.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "Model.h"
+#include "ObjLoader.h"
+
+/*!
+ * Meshes and poses shared by the host tests and benchmarks, loaded from the app's own assets
+ */
+namespace HostAssets {
+
+/*!
+ * Loads an OBJ from the app's assets the way the app does
+ * @return false if it couldn't be loaded
+ */
+inline bool loadObj(const char *assetPath, std::vector<Vertex> &vertices,
+                    std::vector<Index> &indices) {
+    AAssetManager *assetManager = hostAssetManagerCreate(HOLOPERSONA_ASSETS_DIR);
+    bool loaded = ObjLoader::loadFromAssets(assetManager, assetPath, vertices, indices);
+    hostAssetManagerDestroy(assetManager);
+    return loaded;
+}
+
+/*!
+ * The OBJ files aren't rigged, so this binds every vertex to four joints of a chain running up
+ * the mesh, weighted by height. Every influence is used, the most work skinning can have.
+ * @param mixed false to bind a vertex to the joints around its height, so neighbouring vertices
+ *     mostly share joints as they do in a real rig, true to give the last two influences to
+ *     joints that differ from one vertex to the next
+ */
+inline void bindToJoints(std::vector<Vertex> &vertices, size_t jointCount, bool mixed = false) {
+    float bottom = vertices.empty() ? 0.f : vertices[0].position.y;
+    float top = bottom;
+    for (const auto &vertex: vertices) {
+        bottom = std::min(bottom, vertex.position.y);
+        top = std::max(top, vertex.position.y);
+    }
+
+    for (size_t i = 0; i < vertices.size(); i++) {
+        Vertex &vertex = vertices[i];
+        float along = (vertex.position.y - bottom) / std::max(top - bottom, 1e-6f)
+                      * float(jointCount - 1);
+        size_t joint = std::min(size_t(along), jointCount - 1);
+        float blend = along - float(joint);
+        const uint8_t weights[4] = {uint8_t(150 - 100 * blend), uint8_t(50 + 100 * blend), 35, 20};
+        for (int k = 0; k < Vertex::kMaxInfluences; k++) {
+            size_t offset = mixed && k > 1 ? i % 3 : 0;
+            vertex.joints[k] = uint8_t((joint + k + offset) % jointCount);
+            vertex.weights[k] = weights[k];
+        }
+    }
+}
+
+/*!
+ * Fills sixteen floats per joint with column major rigid transforms, rotated about random axes
+ * and moved by up to a unit
+ */
+inline std::vector<float> randomSkinMatrices(size_t jointCount, uint32_t seed) {
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> unit(-1.f, 1.f);
+    std::vector<float> matrices(jointCount * 16, 0.f);
+    for (size_t joint = 0; joint < jointCount; joint++) {
+        float axis[3] = {unit(random), unit(random), unit(random)};
+        float length = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+        float x = axis[0] / length, y = axis[1] / length, z = axis[2] / length;
+        float angle = unit(random) * 3.f;
+        float c = std::cos(angle), s = std::sin(angle), t = 1.f - c;
+
+        float *m = &matrices[joint * 16];
+        m[0] = t * x * x + c;
+        m[1] = t * x * y + s * z;
+        m[2] = t * x * z - s * y;
+        m[4] = t * x * y - s * z;
+        m[5] = t * y * y + c;
+        m[6] = t * y * z + s * x;
+        m[8] = t * x * z + s * y;
+        m[9] = t * y * z - s * x;
+        m[10] = t * z * z + c;
+        m[12] = unit(random);
+        m[13] = unit(random);
+        m[14] = unit(random);
+        m[15] = 1.f;
+    }
+    return matrices;
+}
+
+} // namespace HostAssets
+
+#endif //HOLOPERSONA_HOSTASSETS_H
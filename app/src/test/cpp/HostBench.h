@@ -0,0 +1,56 @@
+#ifndef HOLOPERSONA_HOSTBENCH_H
+#define HOLOPERSONA_HOSTBENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+
+/*!
+ * Helpers for the host benchmarks. They're timed on whatever machine runs them, so compare numbers
+ * from one run against each other rather than against a phone. ctest runs each with --quick,
+ * which only checks they still work.
+ */
+namespace HostBench {
+
+/*!
+ * @return true if the benchmark was asked to only do a token amount of work
+ */
+inline bool isQuick(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quick") == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*!
+ * Runs @a function @a repeats times and keeps the fastest, which is the one least disturbed by
+ * the rest of the machine
+ * @return the fastest run in nanoseconds
+ */
+template<typename Function>
+double fastestNanos(size_t repeats, Function &&function) {
+    double best = 0.0;
+    for (size_t i = 0; i < repeats; i++) {
+        auto begin = std::chrono::steady_clock::now();
+        function();
+        auto end = std::chrono::steady_clock::now();
+        double nanos = std::chrono::duration<double, std::nano>(end - begin).count();
+        best = i == 0 ? nanos : std::min(best, nanos);
+    }
+    return best;
+}
+
+/*!
+ * Keeps the optimizer from discarding a result nothing else reads
+ */
+template<typename T>
+inline void keep(const T &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+} // namespace HostBench
+
+#endif //HOLOPERSONA_HOSTBENCH_H
@@ -0,0 +1,34 @@
+#ifndef HOLOPERSONA_HOSTRANDOM_H
+#define HOLOPERSONA_HOSTRANDOM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+/*!
+ * Inputs shared by the tests of the batched math, which works on four at a time
+ */
+namespace HostRandom {
+
+/*!
+ * Batch sizes around the four the batched math takes at a time, and its scalar tail
+ */
+inline constexpr size_t kBatchCounts[] = {0, 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 1000, 1001};
+
+/*!
+ * @return @a count floats spread over [-4, 4), the same for the same @a seed
+ */
+inline std::vector<float> randomFloats(size_t count, uint32_t seed) {
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> distribution(-4.0f, 4.0f);
+    std::vector<float> floats(count);
+    for (auto &value: floats) {
+        value = distribution(random);
+    }
+    return floats;
+}
+
+} // namespace HostRandom
+
+#endif //HOLOPERSONA_HOSTRANDOM_H
@@ -0,0 +1,90 @@
+// Stands in for the Android libraries the GL-free native sources call, so they can be built and
+// run on a desktop host
+
+#include <android/asset_manager.h>
+#include <android/log.h>
+#include <android/trace.h>
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+struct AAssetManager {
+    std::string directory;
+};
+
+struct AAsset {
+    std::vector<char> data;
+    size_t position = 0;
+};
+
+extern "C" {
+
+int __android_log_write(int prio, const char *tag, const char *text) {
+    // Debug chatter would drown the test output, warnings and errors are worth seeing
+    if (prio < ANDROID_LOG_WARN) {
+        return 0;
+    }
+    return fprintf(stderr, "%s: %s\n", tag, text);
+}
+
+int __android_log_print(int prio, const char *tag, const char *fmt, ...) {
+    char line[1024];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(line, sizeof(line), fmt, args);
+    va_end(args);
+    return __android_log_write(prio, tag, line);
+}
+
+bool ATrace_isEnabled() {
+    return false;
+}
+
+void ATrace_beginSection(const char *) {}
+
+void ATrace_endSection() {}
+
+AAssetManager *hostAssetManagerCreate(const char *directory) {
+    return new AAssetManager{directory};
+}
+
+void hostAssetManagerDestroy(AAssetManager *mgr) {
+    delete mgr;
+}
+
+AAsset *AAssetManager_open(AAssetManager *mgr, const char *filename, int) {
+    std::ifstream file(mgr->directory + "/" + filename, std::ios::binary);
+    if (!file) {
+        return nullptr;
+    }
+    auto asset = new AAsset;
+    asset->data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return asset;
+}
+
+const void *AAsset_getBuffer(AAsset *asset) {
+    return asset->data.data();
+}
+
+off_t AAsset_getLength(AAsset *asset) {
+    return static_cast<off_t>(asset->data.size());
+}
+
+int AAsset_read(AAsset *asset, void *buf, size_t count) {
+    size_t read = std::min(count, asset->data.size() - asset->position);
+    memcpy(buf, asset->data.data() + asset->position, read);
+    asset->position += read;
+    return static_cast<int>(read);
+}
+
+void AAsset_close(AAsset *asset) {
+    delete asset;
+}
+
+} // extern "C"
@@ -0,0 +1,44 @@
+#include "HostTest.h"
+
+#include <vector>
+
+namespace {
+
+struct Test {
+    const char *name;
+    HostTest::TestFunction function;
+};
+
+std::vector<Test> &getTests() {
+    static std::vector<Test> tests;
+    return tests;
+}
+
+size_t gFailures = 0;
+
+} // namespace
+
+HostTest::Registration::Registration(const char *name, TestFunction function) {
+    getTests().push_back({name, function});
+}
+
+void HostTest::fail(const char *file, int line, const char *message) {
+    std::cerr << "    " << file << ":" << line << ": CHECK(" << message << ") failed" << std::endl;
+    gFailures++;
+}
+
+int main() {
+    size_t failedTests = 0;
+    for (const auto &test: getTests()) {
+        size_t failuresBefore = gFailures;
+        test.function();
+        bool passed = gFailures == failuresBefore;
+        std::cout << (passed ? "[ pass ] " : "[ FAIL ] ") << test.name << std::endl;
+        if (!passed) {
+            failedTests++;
+        }
+    }
+    std::cout << getTests().size() - failedTests << "/" << getTests().size() << " passed"
+              << std::endl;
+    return failedTests == 0 ? 0 : 1;
+}
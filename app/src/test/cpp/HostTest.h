@@ -0,0 +1,68 @@
+#ifndef HOLOPERSONA_HOSTTEST_H
+#define HOLOPERSONA_HOSTTEST_H
+
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+
+/*!
+ * A minimal test runner for the host tests, each test executable links HostTest.cpp for its main.
+ * A failed CHECK reports itself and fails the test but lets the rest of the test run, so one
+ * mismatch doesn't hide the others.
+ *
+ * ex:
+ *  TEST(parsesEmptyFile) {
+ *      CHECK(!KtxContainer::isKtx(nullptr, 0));
+ *      CHECK_EQ(container.getLevelCount(), size_t(1));
+ *  }
+ */
+namespace HostTest {
+
+using TestFunction = void (*)();
+
+struct Registration {
+    Registration(const char *name, TestFunction function);
+};
+
+/*!
+ * Records a failed check against the running test
+ */
+void fail(const char *file, int line, const char *message);
+
+} // namespace HostTest
+
+#define TEST(name) \
+    static void name(); \
+    static HostTest::Registration name##Registration(#name, name); \
+    static void name()
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            HostTest::fail(__FILE__, __LINE__, #condition); \
+        } \
+    } while (0)
+
+#define CHECK_EQ(actual, expected) \
+    do { \
+        auto &&checkActual = (actual); \
+        auto &&checkExpected = (expected); \
+        if (!(checkActual == checkExpected)) { \
+            std::cerr << "    " #actual " = " << checkActual << ", expected " << checkExpected \
+                      << std::endl; \
+            HostTest::fail(__FILE__, __LINE__, #actual " == " #expected); \
+        } \
+    } while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance) \
+    do { \
+        double checkActual = (actual); \
+        double checkExpected = (expected); \
+        if (!(std::fabs(checkActual - checkExpected) <= (tolerance))) { \
+            std::cerr << "    " #actual " = " << checkActual << ", expected " << checkExpected \
+                      << std::endl; \
+            HostTest::fail(__FILE__, __LINE__, #actual " ~= " #expected); \
+        } \
+    } while (0)
+
+#endif //HOLOPERSONA_HOSTTEST_H
@@ -0,0 +1,75 @@
+// Throughput of each image kernel on its scalar reference and its vector path, in megapixels per
+// second of input
+
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include "HostBench.h"
+#include "ImageKernels.h"
+
+int main(int argc, char **argv) {
+    const bool quick = HostBench::isQuick(argc, argv);
+    const uint32_t size = quick ? 64 : 2048;
+    const size_t repeats = quick ? 1 : 10;
+    const size_t pixelCount = size_t(size) * size;
+
+    std::mt19937 random(1);
+    std::vector<uint8_t> pixels(pixelCount * 4);
+    for (auto &byte: pixels) {
+        byte = uint8_t(random());
+    }
+    std::vector<uint8_t> work(pixels.size());
+    std::vector<uint16_t> packed(pixelCount);
+    std::vector<uint8_t> half(size_t(size / 2) * (size / 2) * 4);
+
+    struct Kernel {
+        const char *name;
+        std::function<void()> run;
+    };
+    const Kernel kernels[] = {
+            {"premultiplyAlpha", [&]() {
+                work = pixels;
+                ImageKernels::premultiplyAlpha(work.data(), pixelCount);
+            }},
+            {"RGBA8 to RGB565", [&]() {
+                ImageKernels::convertRGBA8ToRGB565(pixels.data(), packed.data(), pixelCount);
+            }},
+            {"RGB565 to RGBA8", [&]() {
+                ImageKernels::convertRGB565ToRGBA8(packed.data(), work.data(), pixelCount);
+            }},
+            {"RGBA8 to RGBA4444", [&]() {
+                ImageKernels::convertRGBA8ToRGBA4444(pixels.data(), packed.data(), pixelCount);
+            }},
+            {"RGBA4444 to RGBA8", [&]() {
+                ImageKernels::convertRGBA4444ToRGBA8(packed.data(), work.data(), pixelCount);
+            }},
+            {"downsample box", [&]() {
+                ImageKernels::downsample(pixels.data(), size, size, half.data());
+            }},
+            {"downsample sRGB", [&]() {
+                ImageKernels::downsample(pixels.data(), size, size, half.data(),
+                                         ImageKernels::MipFilter::BOX_SRGB);
+            }},
+            {"downsample Kaiser", [&]() {
+                ImageKernels::downsample(pixels.data(), size, size, half.data(),
+                                         ImageKernels::MipFilter::KAISER);
+            }},
+    };
+
+    printf("%ux%u RGBA8, best of %zu, megapixels per second\n", size, size, repeats);
+    printf("%-20s %10s %10s %8s\n", "kernel", "scalar", "simd", "speedup");
+    for (const auto &kernel: kernels) {
+        double nanos[2];
+        for (int simd = 0; simd < 2; simd++) {
+            ImageKernels::setSimdEnabled(simd);
+            nanos[simd] = HostBench::fastestNanos(repeats, kernel.run);
+            HostBench::keep(work.data());
+        }
+        printf("%-20s %10.1f %10.1f %7.2fx\n", kernel.name,
+               double(pixelCount) / nanos[0] * 1000.0, double(pixelCount) / nanos[1] * 1000.0,
+               nanos[0] / nanos[1]);
+    }
+    return 0;
+}
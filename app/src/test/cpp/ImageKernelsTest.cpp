@@ -0,0 +1,236 @@
+#include "HostTest.h"
+
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "ImageKernels.h"
+
+namespace {
+
+// Pixel counts around every vector width the kernels use (4, 8 and 16 pixels) and their tails
+const size_t kPixelCounts[] = {0, 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 23, 31, 32, 33, 63, 64, 65,
+                               1000, 1001, 1023};
+
+std::vector<uint8_t> randomBytes(size_t count, uint32_t seed) {
+    std::mt19937 random(seed);
+    std::vector<uint8_t> bytes(count);
+    for (auto &byte: bytes) {
+        byte = uint8_t(random());
+    }
+    return bytes;
+}
+
+std::vector<uint16_t> randomShorts(size_t count, uint32_t seed) {
+    std::mt19937 random(seed);
+    std::vector<uint16_t> shorts(count);
+    for (auto &value: shorts) {
+        value = uint16_t(random());
+    }
+    return shorts;
+}
+
+/*!
+ * Runs a kernel through the scalar reference and through the vector path
+ * @return the scalar result in @a scalar and the vector one in @a simd
+ */
+template<typename Output, typename Kernel>
+void runBothPaths(std::vector<Output> &scalar, std::vector<Output> &simd, Kernel &&kernel) {
+    ImageKernels::setSimdEnabled(false);
+    kernel(scalar);
+    ImageKernels::setSimdEnabled(true);
+    kernel(simd);
+}
+
+/*!
+ * @return the largest difference between two images, and the first index that differs at all
+ */
+int largestDifference(const std::vector<uint8_t> &a, const std::vector<uint8_t> &b,
+                      size_t &firstDifference) {
+    int largest = 0;
+    firstDifference = a.size();
+    for (size_t i = 0; i < a.size(); i++) {
+        int difference = std::abs(int(a[i]) - int(b[i]));
+        if (difference && firstDifference == a.size()) {
+            firstDifference = i;
+        }
+        largest = std::max(largest, difference);
+    }
+    return largest;
+}
+
+void checkDownsampleMatches(ImageKernels::MipFilter filter, int tolerance) {
+    for (uint32_t height = 1; height <= 9; height++) {
+        for (uint32_t width = 1; width <= 37; width++) {
+            std::vector<uint8_t> src = randomBytes(size_t(width) * height * 4, width * 100 + height);
+            size_t dstSize = size_t(ImageKernels::mipDimension(width))
+                             * ImageKernels::mipDimension(height) * 4;
+            std::vector<uint8_t> scalar(dstSize), simd(dstSize);
+            runBothPaths(scalar, simd, [&](std::vector<uint8_t> &dst) {
+                ImageKernels::downsample(src.data(), width, height, dst.data(), filter);
+            });
+
+            size_t first;
+            int difference = largestDifference(scalar, simd, first);
+            if (difference > tolerance) {
+                std::cerr << "    " << width << "x" << height << " differs by " << difference
+                          << " at byte " << first << std::endl;
+            }
+            CHECK(difference <= tolerance);
+        }
+    }
+}
+
+} // namespace
+
+TEST(simdIsAvailableOnHost) {
+    // x86_64 always has SSE2, an ARM host has NEON. Without either every check here compares the
+    // scalar path with itself.
+    CHECK(ImageKernels::isSimdAvailable());
+}
+
+TEST(premultiplyMatchesScalar) {
+    for (size_t count: kPixelCounts) {
+        std::vector<uint8_t> src = randomBytes(count * 4, uint32_t(count));
+        std::vector<uint8_t> scalar = src, simd = src;
+        runBothPaths(scalar, simd, [&](std::vector<uint8_t> &pixels) {
+            ImageKernels::premultiplyAlpha(pixels.data(), count);
+        });
+        CHECK(scalar == simd);
+    }
+}
+
+TEST(premultiplyRoundsEveryPair) {
+    // Every color and alpha pair, 16 pixels per alpha so the vector path sees them all
+    std::vector<uint8_t> pixels(256 * 256 * 4);
+    for (int alpha = 0; alpha < 256; alpha++) {
+        for (int color = 0; color < 256; color++) {
+            uint8_t *pixel = &pixels[(alpha * 256 + color) * 4];
+            pixel[0] = pixel[1] = pixel[2] = uint8_t(color);
+            pixel[3] = uint8_t(alpha);
+        }
+    }
+    for (bool simd: {false, true}) {
+        std::vector<uint8_t> result = pixels;
+        ImageKernels::setSimdEnabled(simd);
+        ImageKernels::premultiplyAlpha(result.data(), 256 * 256);
+        size_t wrong = 0;
+        for (int alpha = 0; alpha < 256; alpha++) {
+            for (int color = 0; color < 256; color++) {
+                const uint8_t *pixel = &result[(alpha * 256 + color) * 4];
+                int expected = (color * alpha * 2 + 255) / 510;
+                wrong += pixel[0] != expected || pixel[1] != expected || pixel[2] != expected
+                         || pixel[3] != alpha;
+            }
+        }
+        CHECK_EQ(wrong, size_t(0));
+    }
+    ImageKernels::setSimdEnabled(true);
+}
+
+TEST(rgb565MatchesScalar) {
+    for (size_t count: kPixelCounts) {
+        std::vector<uint8_t> src = randomBytes(count * 4, uint32_t(count) + 1);
+        std::vector<uint16_t> scalar(count), simd(count);
+        runBothPaths(scalar, simd, [&](std::vector<uint16_t> &dst) {
+            ImageKernels::convertRGBA8ToRGB565(src.data(), dst.data(), count);
+        });
+        CHECK(scalar == simd);
+
+        std::vector<uint16_t> packed = randomShorts(count, uint32_t(count) + 2);
+        std::vector<uint8_t> scalarPixels(count * 4), simdPixels(count * 4);
+        runBothPaths(scalarPixels, simdPixels, [&](std::vector<uint8_t> &dst) {
+            ImageKernels::convertRGB565ToRGBA8(packed.data(), dst.data(), count);
+        });
+        CHECK(scalarPixels == simdPixels);
+    }
+}
+
+TEST(rgb565RoundTrips) {
+    // Expanding and packing again gives back every 16 bit value
+    std::vector<uint16_t> packed(65536);
+    for (size_t i = 0; i < packed.size(); i++) {
+        packed[i] = uint16_t(i);
+    }
+    std::vector<uint8_t> pixels(packed.size() * 4);
+    std::vector<uint16_t> repacked(packed.size());
+    ImageKernels::convertRGB565ToRGBA8(packed.data(), pixels.data(), packed.size());
+    ImageKernels::convertRGBA8ToRGB565(pixels.data(), repacked.data(), packed.size());
+    CHECK(repacked == packed);
+    CHECK_EQ(int(pixels[0xFFFF * 4]), 255);
+    CHECK_EQ(int(pixels[0xFFFF * 4 + 3]), 255);
+}
+
+TEST(rgba4444MatchesScalar) {
+    for (size_t count: kPixelCounts) {
+        std::vector<uint8_t> src = randomBytes(count * 4, uint32_t(count) + 3);
+        std::vector<uint16_t> scalar(count), simd(count);
+        runBothPaths(scalar, simd, [&](std::vector<uint16_t> &dst) {
+            ImageKernels::convertRGBA8ToRGBA4444(src.data(), dst.data(), count);
+        });
+        CHECK(scalar == simd);
+
+        std::vector<uint16_t> packed = randomShorts(count, uint32_t(count) + 4);
+        std::vector<uint8_t> scalarPixels(count * 4), simdPixels(count * 4);
+        runBothPaths(scalarPixels, simdPixels, [&](std::vector<uint8_t> &dst) {
+            ImageKernels::convertRGBA4444ToRGBA8(packed.data(), dst.data(), count);
+        });
+        CHECK(scalarPixels == simdPixels);
+    }
+}
+
+TEST(rgba4444RoundTrips) {
+    std::vector<uint16_t> packed(65536);
+    for (size_t i = 0; i < packed.size(); i++) {
+        packed[i] = uint16_t(i);
+    }
+    std::vector<uint8_t> pixels(packed.size() * 4);
+    std::vector<uint16_t> repacked(packed.size());
+    ImageKernels::convertRGBA4444ToRGBA8(packed.data(), pixels.data(), packed.size());
+    ImageKernels::convertRGBA8ToRGBA4444(pixels.data(), repacked.data(), packed.size());
+    CHECK(repacked == packed);
+}
+
+TEST(boxDownsampleMatchesScalar) {
+    checkDownsampleMatches(ImageKernels::MipFilter::BOX, 0);
+}
+
+TEST(srgbDownsampleMatchesScalar) {
+    checkDownsampleMatches(ImageKernels::MipFilter::BOX_SRGB, 0);
+}
+
+TEST(kaiserDownsampleWithinOneLsb) {
+    checkDownsampleMatches(ImageKernels::MipFilter::KAISER, 1);
+}
+
+TEST(boxDownsampleDropsOddEdges) {
+    // A 3x3 image halves to 1x1 from its top left 2x2, the last row and column don't count
+    const uint8_t src[3 * 3 * 4] = {
+            10, 10, 10, 10, 20, 20, 20, 20, 255, 255, 255, 255,
+            30, 30, 30, 30, 40, 40, 40, 40, 255, 255, 255, 255,
+            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    };
+    for (bool simd: {false, true}) {
+        ImageKernels::setSimdEnabled(simd);
+        uint8_t dst[4];
+        ImageKernels::downsample(src, 3, 3, dst);
+        CHECK_EQ(int(dst[0]), 25);
+        CHECK_EQ(int(dst[3]), 25);
+
+        // A side of 1 pixel is kept, the other still halves
+        const uint8_t column[3 * 4] = {10, 0, 0, 0, 30, 0, 0, 0, 255, 0, 0, 0};
+        ImageKernels::downsample(column, 1, 3, dst);
+        CHECK_EQ(int(dst[0]), 20);
+    }
+    ImageKernels::setSimdEnabled(true);
+}
+
+TEST(mipChainEndsAtOnePixel) {
+    std::vector<uint8_t> src = randomBytes(37 * 6 * 4, 5);
+    auto levels = ImageKernels::buildMipChain(src.data(), 37, 6);
+    // 37x6, 18x3, 9x1, 4x1, 2x1, 1x1
+    CHECK_EQ(levels.size(), size_t(6));
+    CHECK(levels[0] == src);
+    CHECK_EQ(levels[1].size(), size_t(18 * 3 * 4));
+    CHECK_EQ(levels.back().size(), size_t(4));
+}
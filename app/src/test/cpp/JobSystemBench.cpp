@@ -0,0 +1,60 @@
+// Nanoseconds per job of the JobSystem's two paths: a worker spawning jobs onto its own queue
+// and running them itself, and another thread stealing them off that queue while the worker is
+// busy. Both jobs are empty, so this is the queueing cost alone.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+#include "HostBench.h"
+#include "JobSystem.h"
+
+int main(int argc, char **argv) {
+    const bool quick = HostBench::isQuick(argc, argv);
+    const size_t repeats = quick ? 1 : 20;
+    const int kJobCount = quick ? 1000 : 100000;
+
+    JobSystem jobSystem(1);
+    printf("%d jobs, best of %zu, %u hardware threads\n%-8s %12s\n", kJobCount, repeats,
+           std::thread::hardware_concurrency(), "path", "ns/job");
+
+    // The worker queues onto its own queue and waits, which runs them newest first from there
+    double spawnNanos = HostBench::fastestNanos(repeats, [&]() {
+        JobCounter outer;
+        jobSystem.run(outer, [&]() {
+            JobCounter inner;
+            for (int i = 0; i < kJobCount; i++) {
+                jobSystem.run(inner, []() {});
+            }
+            jobSystem.wait(inner);
+        });
+        jobSystem.wait(outer);
+    });
+    printf("%-8s %12.1f\n", "spawn", spawnNanos / kJobCount);
+
+    // The worker queues the jobs and then only watches, so the calling thread's wait has to
+    // steal every one of them from the front of the worker's queue. Only the stealing is timed.
+    double stealNanos = 0.0;
+    for (size_t repeat = 0; repeat < repeats; repeat++) {
+        JobCounter outer, inner;
+        std::atomic<bool> queued{false};
+        jobSystem.run(outer, [&]() {
+            for (int i = 0; i < kJobCount; i++) {
+                jobSystem.run(inner, []() {});
+            }
+            queued = true;
+            while (!inner.isDone()) {
+                std::this_thread::yield();
+            }
+        });
+        while (!queued) {
+            std::this_thread::yield();
+        }
+        double nanos = HostBench::fastestNanos(1, [&]() { jobSystem.wait(inner); });
+        stealNanos = repeat == 0 ? nanos : std::min(stealNanos, nanos);
+        jobSystem.wait(outer);
+    }
+    printf("%-8s %12.1f\n", "steal", stealNanos / kJobCount);
+    return 0;
+}
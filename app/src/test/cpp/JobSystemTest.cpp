@@ -0,0 +1,172 @@
+#include "HostTest.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#include "JobSystem.h"
+
+namespace {
+
+// Worker counts to run each test on. One worker leaves the caller and that worker to share the
+// jobs, more have the workers stealing from each other.
+const size_t kWorkerCounts[] = {1, 2, 4};
+
+} // namespace
+
+TEST(runsEveryJobBeforeWaitReturns) {
+    for (size_t workers: kWorkerCounts) {
+        JobSystem jobSystem(workers);
+        CHECK_EQ(jobSystem.getWorkerCount(), workers);
+
+        JobCounter counter;
+        CHECK(counter.isDone());
+        std::atomic<int> ran{0};
+        for (int i = 0; i < 1000; i++) {
+            jobSystem.run(counter, [&ran]() { ran.fetch_add(1, std::memory_order_relaxed); });
+        }
+        jobSystem.wait(counter);
+        CHECK(counter.isDone());
+        CHECK_EQ(ran.load(), 1000);
+
+        // A counter can be reused once its jobs are done
+        jobSystem.run(counter, [&ran]() { ran.fetch_add(1, std::memory_order_relaxed); });
+        jobSystem.wait(counter);
+        CHECK_EQ(ran.load(), 1001);
+    }
+}
+
+TEST(runAfterWaitsForItsDependency) {
+    for (size_t workers: kWorkerCounts) {
+        JobSystem jobSystem(workers);
+        JobCounter first, second, third;
+        std::atomic<int> firstRan{0};
+        std::atomic<bool> secondSawFirst{false}, thirdSawSecond{false};
+        std::atomic<bool> secondRan{false};
+
+        for (int i = 0; i < 100; i++) {
+            jobSystem.run(first, [&firstRan]() {
+                std::this_thread::sleep_for(std::chrono::microseconds(10));
+                firstRan.fetch_add(1);
+            });
+        }
+        jobSystem.runAfter(first, second, [&]() {
+            secondSawFirst = firstRan.load() == 100;
+            secondRan = true;
+        });
+        // The second step is counted from the moment it's queued, so this can't start early
+        jobSystem.runAfter(second, third, [&]() {
+            thirdSawSecond = secondRan.load();
+        });
+
+        jobSystem.wait(third);
+        CHECK(first.isDone());
+        CHECK(second.isDone());
+        CHECK(secondSawFirst.load());
+        CHECK(thirdSawSecond.load());
+    }
+}
+
+TEST(runAfterOnFinishedDependencyRunsStraightAway) {
+    JobSystem jobSystem(1);
+    JobCounter done, counter;
+    bool ran = false;
+    jobSystem.runAfter(done, counter, [&ran]() { ran = true; });
+    jobSystem.wait(counter);
+    CHECK(ran);
+}
+
+TEST(jobsCanWaitOnJobsTheyQueue) {
+    // With one worker the outer job would deadlock if waiting blocked instead of running jobs
+    for (size_t workers: kWorkerCounts) {
+        JobSystem jobSystem(workers);
+        JobCounter outer;
+        std::atomic<int> innerRan{0};
+        std::atomic<int> outerSawAll{0};
+        for (int i = 0; i < 8; i++) {
+            jobSystem.run(outer, [&]() {
+                JobCounter inner;
+                for (int j = 0; j < 50; j++) {
+                    jobSystem.run(inner, [&innerRan]() { innerRan.fetch_add(1); });
+                }
+                jobSystem.wait(inner);
+                if (inner.isDone()) {
+                    outerSawAll.fetch_add(1);
+                }
+            });
+        }
+        jobSystem.wait(outer);
+        CHECK_EQ(innerRan.load(), 8 * 50);
+        CHECK_EQ(outerSawAll.load(), 8);
+    }
+}
+
+TEST(parallelForCoversEveryIndexOnce) {
+    const size_t kMinBatchSize = 16;
+    // Around a single batch, and around the point count / (threads * 4) overtakes the minimum
+    const size_t kCounts[] = {0, 1, 15, 16, 17, 31, 32, 33, 63, 64, 65, 127, 128, 129, 255, 256,
+                              257, 1000, 4099};
+    for (size_t workers: kWorkerCounts) {
+        JobSystem jobSystem(workers);
+        for (size_t count: kCounts) {
+            std::vector<std::atomic<int>> visits(count);
+            std::atomic<bool> batchTooSmall{false};
+            jobSystem.parallelFor(count, kMinBatchSize, [&](size_t begin, size_t end) {
+                // Only the last batch may be short
+                if (end - begin < kMinBatchSize && end != count) {
+                    batchTooSmall = true;
+                }
+                for (size_t i = begin; i < end; i++) {
+                    visits[i].fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+
+            size_t wrong = 0;
+            for (auto &visit: visits) {
+                wrong += visit.load() != 1;
+            }
+            if (wrong) {
+                std::cerr << "    " << count << " items on " << workers << " workers, " << wrong
+                          << " not visited exactly once" << std::endl;
+            }
+            CHECK_EQ(wrong, size_t(0));
+            CHECK(!batchTooSmall.load());
+        }
+    }
+}
+
+TEST(destructorFinishesQueuedJobs) {
+    for (size_t workers: kWorkerCounts) {
+        // The counter has to outlive the pool's jobs, which it does by being declared first
+        JobCounter counter;
+        std::atomic<int> ran{0};
+        {
+            JobSystem jobSystem(workers);
+            for (int i = 0; i < 200; i++) {
+                jobSystem.run(counter, [&ran]() {
+                    std::this_thread::sleep_for(std::chrono::microseconds(20));
+                    ran.fetch_add(1);
+                });
+            }
+        }
+        CHECK_EQ(ran.load(), 200);
+        CHECK(counter.isDone());
+    }
+}
+
+TEST(destructorRunsContinuationsOfQueuedJobs) {
+    JobCounter first, second;
+    std::atomic<bool> continued{false};
+    {
+        JobSystem jobSystem(2);
+        for (int i = 0; i < 20; i++) {
+            jobSystem.run(first, []() {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            });
+        }
+        jobSystem.runAfter(first, second, [&continued]() { continued = true; });
+    }
+    CHECK(continued.load());
+    CHECK(second.isDone());
+}
@@ -0,0 +1,485 @@
+#include "HostTest.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "EtcCodec.h"
+#include "KtxContainer.h"
+#include "KtxWriter.h"
+
+namespace {
+
+constexpr uint32_t kGlUnsignedByte = 0x1401;
+constexpr uint32_t kGlRgba = 0x1908;
+constexpr uint32_t kGlRgba8 = 0x8058;
+constexpr uint32_t kGlCompressedRgb8Etc2 = 0x9274;
+constexpr uint32_t kGlCompressedRgba8Etc2Eac = 0x9278;
+constexpr uint32_t kGlCompressedRgbaAstc4x4 = 0x93B0;
+constexpr uint32_t kGlCompressedRgbaAstc6x6 = 0x93B4;
+constexpr uint32_t kGlCompressedSrgb8Alpha8Astc6x6 = 0x93D4;
+
+constexpr uint32_t kVkFormatR8G8B8A8Unorm = 37;
+constexpr uint32_t kVkFormatEtc2R8G8B8Unorm = 147;
+constexpr uint32_t kVkFormatEtc2R8G8B8A8Unorm = 151;
+constexpr uint32_t kVkFormatAstc6x6Unorm = 165;
+constexpr uint32_t kVkFormatAstc6x6Srgb = 166;
+
+void appendU32(std::vector<uint8_t> &out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out.push_back(uint8_t(value >> (i * 8)));
+    }
+}
+
+void appendU64(std::vector<uint8_t> &out, uint64_t value) {
+    appendU32(out, uint32_t(value));
+    appendU32(out, uint32_t(value >> 32));
+}
+
+void writeU32(std::vector<uint8_t> &out, size_t offset, uint32_t value) {
+    memcpy(out.data() + offset, &value, sizeof(value));
+}
+
+/*!
+ * What goes in a hand-built file, with the level sizes overridable to build broken ones
+ */
+struct KtxDescription {
+    uint32_t format;        // glInternalFormat for KTX 1, vkFormat for KTX 2
+    uint32_t glFormat;
+    uint32_t glType;
+    uint32_t width;
+    uint32_t height;
+    std::vector<size_t> levelSizes;
+};
+
+/*!
+ * Builds a KTX 1.1 file whose level payloads are filled with the level number, with a few bytes
+ * of key/value data to skip
+ */
+std::vector<uint8_t> buildKtx1(const KtxDescription &description) {
+    const uint8_t identifier[12] = {
+            0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+    };
+    std::vector<uint8_t> file(identifier, identifier + sizeof(identifier));
+    appendU32(file, 0x04030201);
+    appendU32(file, description.glType);
+    appendU32(file, description.glType ? 1 : 0);    // glTypeSize
+    appendU32(file, description.glFormat);
+    appendU32(file, description.format);
+    appendU32(file, description.glFormat);          // glBaseInternalFormat
+    appendU32(file, description.width);
+    appendU32(file, description.height);
+    appendU32(file, 0);                             // pixelDepth
+    appendU32(file, 0);                             // numberOfArrayElements
+    appendU32(file, 1);                             // numberOfFaces
+    appendU32(file, uint32_t(description.levelSizes.size()));
+    appendU32(file, 8);                             // bytesOfKeyValueData
+    appendU64(file, 0);
+
+    for (size_t level = 0; level < description.levelSizes.size(); level++) {
+        size_t size = description.levelSizes[level];
+        appendU32(file, uint32_t(size));
+        file.insert(file.end(), size, uint8_t(level + 1));
+        file.resize((file.size() + 3) & ~size_t(3));
+    }
+    return file;
+}
+
+/*!
+ * Builds a KTX 2.0 file with its levels stored smallest first, as the specification asks
+ */
+std::vector<uint8_t> buildKtx2(const KtxDescription &description) {
+    const uint8_t identifier[12] = {
+            0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+    };
+    size_t levelCount = description.levelSizes.size();
+    std::vector<uint8_t> file(identifier, identifier + sizeof(identifier));
+    appendU32(file, description.format);
+    appendU32(file, 1);                 // typeSize
+    appendU32(file, description.width);
+    appendU32(file, description.height);
+    appendU32(file, 0);                 // pixelDepth
+    appendU32(file, 0);                 // layerCount
+    appendU32(file, 1);                 // faceCount
+    appendU32(file, uint32_t(levelCount));
+    appendU32(file, 0);                 // supercompressionScheme
+    file.resize(80 + levelCount * 24);  // No data format descriptor, key/value or global data
+
+    for (size_t level = levelCount; level-- > 0;) {
+        file.resize((file.size() + 7) & ~size_t(7));
+        size_t size = description.levelSizes[level];
+        uint64_t entry[3] = {file.size(), size, size};
+        memcpy(file.data() + 80 + level * 24, entry, sizeof(entry));
+        file.insert(file.end(), size, uint8_t(level + 1));
+    }
+    return file;
+}
+
+bool parse(const std::vector<uint8_t> &file, KtxContainer &container, std::string &error) {
+    return KtxContainer::parse(file.data(), file.size(), container, &error);
+}
+
+/*!
+ * Checks a container holds the levels a description asked for, filled as the builders fill them
+ */
+void checkLevels(const KtxContainer &container, const KtxDescription &description) {
+    CHECK_EQ(container.getLevelCount(), description.levelSizes.size());
+    CHECK_EQ(container.getWidth(), description.width);
+    CHECK_EQ(container.getHeight(), description.height);
+    size_t total = 0;
+    for (size_t i = 0; i < container.getLevelCount(); i++) {
+        const auto &level = container.getLevel(i);
+        uint32_t width = description.width >> i;
+        uint32_t height = description.height >> i;
+        CHECK_EQ(level.width, width ? width : 1u);
+        CHECK_EQ(level.height, height ? height : 1u);
+        CHECK_EQ(level.size, description.levelSizes[i]);
+        CHECK(level.data[0] == i + 1 && level.data[level.size - 1] == i + 1);
+        total += level.size;
+    }
+    CHECK_EQ(container.getTotalSize(), total);
+}
+
+// An 8x4 RGBA8 image with its mips: 128, 32 and 8 bytes
+const KtxDescription kRgba8Ktx1 = {kGlRgba8, kGlRgba, kGlUnsignedByte, 8, 4, {128, 32, 8, 4}};
+
+// A 10x6 ETC2 RGB8 image, 3x2 blocks of 8 bytes then 2x1 and a block for each smaller level
+const KtxDescription kEtc2Ktx1 = {kGlCompressedRgb8Etc2, 0, 0, 10, 6, {48, 16, 8, 8}};
+
+} // namespace
+
+TEST(detectsIdentifiers) {
+    std::vector<uint8_t> ktx1 = buildKtx1(kRgba8Ktx1);
+    std::vector<uint8_t> ktx2 = buildKtx2({kVkFormatR8G8B8A8Unorm, 0, 0, 1, 1, {4}});
+    CHECK(KtxContainer::isKtx(ktx1.data(), ktx1.size()));
+    CHECK(KtxContainer::isKtx(ktx2.data(), ktx2.size()));
+    CHECK(!KtxContainer::isKtx(ktx1.data(), 11));
+    CHECK(!KtxContainer::isKtx(nullptr, 0));
+
+    const char png[] = "\x89PNG\r\n\x1a\n\0\0\0\0";
+    CHECK(!KtxContainer::isKtx(png, sizeof(png)));
+    KtxContainer container;
+    std::string error;
+    CHECK(!KtxContainer::parse(png, sizeof(png), container, &error));
+    CHECK_EQ(error, std::string("missing KTX identifier"));
+}
+
+TEST(parsesKtx1Rgba8) {
+    std::vector<uint8_t> file = buildKtx1(kRgba8Ktx1);
+    KtxContainer container;
+    std::string error;
+    CHECK(parse(file, container, error));
+    CHECK_EQ(container.getGlInternalFormat(), kGlRgba8);
+    CHECK_EQ(container.getGlFormat(), kGlRgba);
+    CHECK_EQ(container.getGlType(), kGlUnsignedByte);
+    CHECK(!container.isCompressed());
+    CHECK(!container.isAstc());
+    checkLevels(container, kRgba8Ktx1);
+
+    // Levels point into the caller's buffer rather than a copy
+    const uint8_t *level0 = container.getLevel(0).data;
+    CHECK(level0 >= file.data() && level0 < file.data() + file.size());
+}
+
+TEST(parsesKtx1Etc2WithPadding) {
+    KtxContainer container;
+    std::string error;
+    CHECK(parse(buildKtx1(kEtc2Ktx1), container, error));
+    CHECK(container.isCompressed());
+    CHECK_EQ(container.getGlInternalFormat(), kGlCompressedRgb8Etc2);
+    checkLevels(container, kEtc2Ktx1);
+
+    // The 4x4 ETC2 RGBA blocks are twice the size
+    KtxDescription rgba = {kGlCompressedRgba8Etc2Eac, 0, 0, 4, 4, {16}};
+    CHECK(parse(buildKtx1(rgba), container, error));
+    checkLevels(container, rgba);
+
+    // An RGBA8 level of 1x3 pixels is 12 bytes, the 4 byte padding must not be counted
+    KtxDescription odd = {kGlRgba8, kGlRgba, kGlUnsignedByte, 1, 3, {12, 4}};
+    CHECK(parse(buildKtx1(odd), container, error));
+    checkLevels(container, odd);
+}
+
+TEST(parsesKtx1Astc) {
+    // 6x6 blocks: a 13x7 image is 3x2 blocks, every smaller level fits in one
+    KtxDescription astc = {kGlCompressedRgbaAstc6x6, 0, 0, 13, 7, {96, 16, 16, 16}};
+    KtxContainer container;
+    std::string error;
+    CHECK(parse(buildKtx1(astc), container, error));
+    CHECK(container.isAstc());
+    checkLevels(container, astc);
+
+    astc.format = kGlCompressedSrgb8Alpha8Astc6x6;
+    CHECK(parse(buildKtx1(astc), container, error));
+    CHECK(container.isAstc());
+    CHECK_EQ(container.getGlInternalFormat(), kGlCompressedSrgb8Alpha8Astc6x6);
+}
+
+TEST(ktx1ZeroLevelsMeansOne) {
+    std::vector<uint8_t> file = buildKtx1({kGlRgba8, kGlRgba, kGlUnsignedByte, 2, 2, {16}});
+    writeU32(file, 12 + 44, 0);
+    KtxContainer container;
+    std::string error;
+    CHECK(parse(file, container, error));
+    CHECK_EQ(container.getLevelCount(), size_t(1));
+}
+
+TEST(rejectsTruncatedKtx1) {
+    std::vector<uint8_t> file = buildKtx1(kEtc2Ktx1);
+    KtxContainer container;
+    std::string error;
+
+    CHECK(!KtxContainer::parse(file.data(), 63, container, &error));
+    CHECK_EQ(error, std::string("truncated KTX header"));
+
+    // Cut inside the last level's size field, then inside its payload
+    size_t lastLevel = file.size() - 8 - 4;
+    CHECK(!KtxContainer::parse(file.data(), lastLevel + 2, container, &error));
+    CHECK_EQ(error, std::string("truncated mip level 3"));
+    CHECK(!KtxContainer::parse(file.data(), file.size() - 1, container, &error));
+    CHECK_EQ(error, std::string("bad size for mip level 3"));
+
+    // A failed parse leaves the container empty
+    CHECK_EQ(container.getLevelCount(), size_t(0));
+    CHECK_EQ(container.getWidth(), 0u);
+}
+
+TEST(rejectsMisSizedKtx1Levels) {
+    KtxContainer container;
+    std::string error;
+
+    // Level 1 of the ETC2 image claims a block too many
+    KtxDescription tooBig = kEtc2Ktx1;
+    tooBig.levelSizes[1] += 8;
+    CHECK(!parse(buildKtx1(tooBig), container, error));
+    CHECK_EQ(error, std::string("bad size for mip level 1"));
+
+    // An RGBA8 level sized as if it were 3 bytes per pixel
+    KtxDescription rgb = {kGlRgba8, kGlRgba, kGlUnsignedByte, 4, 4, {48}};
+    CHECK(!parse(buildKtx1(rgb), container, error));
+    CHECK_EQ(error, std::string("bad size for mip level 0"));
+
+    // A size field larger than the file
+    std::vector<uint8_t> file = buildKtx1({kGlRgba8, kGlRgba, kGlUnsignedByte, 1, 1, {4}});
+    writeU32(file, 64 + 8, 0xFFFFFFF0);
+    CHECK(!parse(file, container, error));
+    CHECK_EQ(error, std::string("bad size for mip level 0"));
+}
+
+TEST(rejectsUnsupportedKtx1) {
+    KtxContainer container;
+    std::string error;
+
+    std::vector<uint8_t> file = buildKtx1(kRgba8Ktx1);
+    writeU32(file, 12, 0x01020304);
+    CHECK(!parse(file, container, error));
+    CHECK_EQ(error, std::string("big endian KTX files are not supported"));
+
+    file = buildKtx1(kRgba8Ktx1);
+    writeU32(file, 12 + 40, 6);
+    CHECK(!parse(file, container, error));
+    CHECK_EQ(error, std::string("only single 2D images are supported"));
+
+    file = buildKtx1(kRgba8Ktx1);
+    writeU32(file, 12 + 36, 4);
+    CHECK(!parse(file, container, error));
+    CHECK_EQ(error, std::string("only single 2D images are supported"));
+
+    // RGBA8 pixels described as GL_RGB
+    file = buildKtx1(kRgba8Ktx1);
+    writeU32(file, 12 + 12, 0x1907);
+    CHECK(!parse(file, container, error));
+    CHECK(error.find("unsupported GL internal format") == 0);
+
+    file = buildKtx1({0x83F0 /* S3TC DXT1 */, 0, 0, 4, 4, {8}});
+    CHECK(!parse(file, container, error));
+    CHECK(error.find("unsupported GL internal format") == 0);
+
+    file = buildKtx1(kRgba8Ktx1);
+    writeU32(file, 12 + 44, 33);
+    CHECK(!parse(file, container, error));
+    CHECK_EQ(error, std::string("invalid mip level count"));
+}
+
+TEST(parsesKtx2) {
+    KtxContainer container;
+    std::string error;
+
+    KtxDescription rgba = {kVkFormatR8G8B8A8Unorm, 0, 0, 8, 4, {128, 32, 8, 4}};
+    CHECK(parse(buildKtx2(rgba), container, error));
+    CHECK_EQ(container.getGlInternalFormat(), kGlRgba8);
+    CHECK(!container.isCompressed());
+    checkLevels(container, rgba);
+
+    KtxDescription etc2 = {kVkFormatEtc2R8G8B8Unorm, 0, 0, 10, 6, {48, 16, 8, 8}};
+    CHECK(parse(buildKtx2(etc2), container, error));
+    CHECK_EQ(container.getGlInternalFormat(), kGlCompressedRgb8Etc2);
+    checkLevels(container, etc2);
+
+    // Vulkan orders ETC2 before EAC, GL the other way round
+    KtxDescription etc2Rgba = {kVkFormatEtc2R8G8B8A8Unorm, 0, 0, 4, 4, {16, 16, 16}};
+    CHECK(parse(buildKtx2(etc2Rgba), container, error));
+    CHECK_EQ(container.getGlInternalFormat(), kGlCompressedRgba8Etc2Eac);
+
+    // Vulkan interleaves UNORM and SRGB ASTC
+    KtxDescription astc = {kVkFormatAstc6x6Unorm, 0, 0, 13, 7, {96, 16, 16, 16}};
+    CHECK(parse(buildKtx2(astc), container, error));
+    CHECK(container.isAstc());
+    CHECK_EQ(container.getGlInternalFormat(), kGlCompressedRgbaAstc6x6);
+    checkLevels(container, astc);
+    astc.format = kVkFormatAstc6x6Srgb;
+    CHECK(parse(buildKtx2(astc), container, error));
+    CHECK_EQ(container.getGlInternalFormat(), kGlCompressedSrgb8Alpha8Astc6x6);
+
+    KtxDescription astc4x4 = {157, 0, 0, 4, 4, {16}};
+    CHECK(parse(buildKtx2(astc4x4), container, error));
+    CHECK_EQ(container.getGlInternalFormat(), kGlCompressedRgbaAstc4x4);
+}
+
+TEST(rejectsTruncatedKtx2) {
+    KtxDescription etc2 = {kVkFormatEtc2R8G8B8Unorm, 0, 0, 16, 16, {128, 32, 8, 8, 8}};
+    std::vector<uint8_t> file = buildKtx2(etc2);
+    KtxContainer container;
+    std::string error;
+
+    CHECK(!KtxContainer::parse(file.data(), 79, container, &error));
+    CHECK_EQ(error, std::string("truncated KTX2 header"));
+
+    // Cut inside the level index
+    CHECK(!KtxContainer::parse(file.data(), 80 + 2 * 24, container, &error));
+    CHECK_EQ(error, std::string("invalid mip level index"));
+
+    // Level 0 is stored last, so losing the final byte breaks it
+    CHECK(!KtxContainer::parse(file.data(), file.size() - 1, container, &error));
+    CHECK_EQ(error, std::string("bad size for mip level 0"));
+    CHECK_EQ(container.getLevelCount(), size_t(0));
+}
+
+TEST(rejectsMisSizedKtx2Levels) {
+    KtxDescription etc2 = {kVkFormatEtc2R8G8B8Unorm, 0, 0, 16, 16, {128, 32, 8, 8, 8}};
+    KtxContainer container;
+    std::string error;
+
+    KtxDescription misSized = etc2;
+    misSized.levelSizes[2] = 16;
+    CHECK(!parse(buildKtx2(misSized), container, error));
+    CHECK_EQ(error, std::string("bad size for mip level 2"));
+
+    // An offset past the end, and one whose length would wrap around
+    std::vector<uint8_t> file = buildKtx2(etc2);
+    uint64_t offset = file.size() + 8;
+    memcpy(file.data() + 80 + 24, &offset, sizeof(offset));
+    CHECK(!parse(file, container, error));
+    CHECK_EQ(error, std::string("bad size for mip level 1"));
+
+    file = buildKtx2(etc2);
+    offset = ~uint64_t(0) - 16;
+    memcpy(file.data() + 80 + 24, &offset, sizeof(offset));
+    CHECK(!parse(file, container, error));
+    CHECK_EQ(error, std::string("bad size for mip level 1"));
+}
+
+TEST(rejectsUnsupportedKtx2) {
+    KtxDescription rgba = {kVkFormatR8G8B8A8Unorm, 0, 0, 2, 2, {16, 4}};
+    KtxContainer container;
+    std::string error;
+
+    std::vector<uint8_t> file = buildKtx2(rgba);
+    writeU32(file, 12 + 32, 1);     // BasisLZ
+    CHECK(!parse(file, container, error));
+    CHECK_EQ(error, std::string("supercompressed KTX2 files are not supported"));
+
+    file = buildKtx2(rgba);
+    writeU32(file, 12 + 24, 6);
+    CHECK(!parse(file, container, error));
+    CHECK_EQ(error, std::string("only single 2D images are supported"));
+
+    file = buildKtx2(rgba);
+    writeU32(file, 12 + 16, 2);
+    CHECK(!parse(file, container, error));
+    CHECK_EQ(error, std::string("only single 2D images are supported"));
+
+    file = buildKtx2({131 /* BC1 */, 0, 0, 4, 4, {8}});
+    CHECK(!parse(file, container, error));
+    CHECK_EQ(error, std::string("unsupported Vulkan format 131"));
+}
+
+TEST(writerRoundTripsThroughDecoder) {
+    // A gradient with a hard edge, at a size that leaves partial blocks on every level
+    const uint32_t width = 37;
+    const uint32_t height = 22;
+    std::vector<uint8_t> pixels(size_t(width) * height * 4);
+    for (uint32_t y = 0; y < height; y++) {
+        for (uint32_t x = 0; x < width; x++) {
+            uint8_t *pixel = &pixels[(size_t(y) * width + x) * 4];
+            pixel[0] = uint8_t(x * 255 / (width - 1));
+            pixel[1] = uint8_t(y * 255 / (height - 1));
+            pixel[2] = x < width / 2 ? 40 : 220;
+            pixel[3] = 255;
+        }
+    }
+
+    std::vector<uint8_t> file = KtxWriter::writeKtx2(pixels.data(), width, height,
+                                                     KtxWriter::Format::ETC2_RGB8);
+    KtxContainer container;
+    std::string error;
+    CHECK(parse(file, container, error));
+    CHECK_EQ(container.getGlInternalFormat(), kGlCompressedRgb8Etc2);
+    CHECK_EQ(container.getLevelCount(), size_t(6));
+    CHECK_EQ(container.getLevel(5).width, 1u);
+    CHECK_EQ(container.getLevel(5).height, 1u);
+
+    // Level 0 decodes back close to the source, ETC2 keeps about 5 bits per channel
+    std::vector<uint8_t> decoded(pixels.size());
+    CHECK(EtcCodec::decode(container.getLevel(0).data, width, height, decoded.data()));
+    double squaredError = 0.0;
+    for (size_t i = 0; i < pixels.size(); i++) {
+        double difference = double(decoded[i]) - double(pixels[i]);
+        squaredError += difference * difference;
+    }
+    double rootMeanSquare = std::sqrt(squaredError / double(pixels.size()));
+    CHECK(rootMeanSquare < 6.0);
+
+    // Every level decodes without running into a mode the codec doesn't write
+    for (size_t i = 1; i < container.getLevelCount(); i++) {
+        const auto &level = container.getLevel(i);
+        std::vector<uint8_t> levelPixels(size_t(level.width) * level.height * 4);
+        CHECK(EtcCodec::decode(level.data, level.width, level.height, levelPixels.data()));
+    }
+
+    // Uncompressed output keeps the pixels as they were
+    file = KtxWriter::writeKtx2(pixels.data(), width, height, KtxWriter::Format::RGBA8,
+                                ImageKernels::MipFilter::BOX, false);
+    CHECK(parse(file, container, error));
+    CHECK_EQ(container.getLevelCount(), size_t(1));
+    CHECK(memcmp(container.getLevel(0).data, pixels.data(), pixels.size()) == 0);
+}
+
+TEST(decoderRejectsEtc2OnlyModes) {
+    // Differential mode with red 31 + 3 overflows, which ETC2 reads as T mode
+    const uint8_t block[8] = {0xFB, 0x00, 0x00, 0x02, 0, 0, 0, 0};
+    uint8_t pixels[16 * 4];
+    CHECK(!EtcCodec::decode(block, 4, 4, pixels));
+}
+
+TEST(shippedSkinParses) {
+    FILE *file = fopen(HOLOPERSONA_ASSETS_DIR "/textures/skin.etc2.ktx2", "rb");
+    CHECK(file != nullptr);
+    if (!file) {
+        return;
+    }
+    std::vector<uint8_t> data;
+    uint8_t buffer[4096];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        data.insert(data.end(), buffer, buffer + read);
+    }
+    fclose(file);
+
+    KtxContainer container;
+    std::string error;
+    CHECK(parse(data, container, error));
+    CHECK_EQ(container.getGlInternalFormat(), kGlCompressedRgb8Etc2);
+    CHECK(container.getLevelCount() > 1);
+}
@@ -0,0 +1,76 @@
+// Nanoseconds per matrix, or per vector for transforms, of the VectorMath batch operations over
+// a few thousand joint-like matrices, against their scalar references.
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "HostBench.h"
+#include "VectorMath.h"
+
+int main(int argc, char **argv) {
+    const bool quick = HostBench::isQuick(argc, argv);
+    const size_t repeats = quick ? 1 : 200;
+    const size_t kCount = 4096;
+
+    // Affine, as joint and model matrices are, so inverseAffine times the same input
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> distribution(-4.0f, 4.0f);
+    std::vector<float> a(kCount * 16), b(kCount * 16), out(kCount * 16);
+    for (size_t i = 0; i < kCount * 16; i++) {
+        bool lastRow = i % 4 == 3;
+        a[i] = lastRow ? (i % 16 == 15 ? 1.f : 0.f) : distribution(random);
+        b[i] = lastRow ? (i % 16 == 15 ? 1.f : 0.f) : distribution(random);
+    }
+    std::vector<Vec4> vectors(kCount), transformed(kCount);
+    for (auto &v: vectors) {
+        v = {distribution(random), distribution(random), distribution(random), 1.f};
+    }
+
+    printf("%zu matrices, best of %zu\n%-26s %12s %10s\n", kCount, repeats, "operation", "ns/each",
+           "speedup");
+    auto time = [&](auto &&function) {
+        return HostBench::fastestNanos(repeats, [&]() {
+            function();
+            HostBench::keep(out.data());
+            HostBench::keep(transformed.data());
+        }) / double(kCount);
+    };
+    auto report = [](const char *operation, double nanos, double referenceNanos) {
+        printf("%-26s %12.2f %9.2fx\n", operation, nanos, referenceNanos / nanos);
+    };
+
+    double reference = time([&]() {
+        for (size_t i = 0; i < kCount; i++) {
+            VectorMath::multiplyReference(&out[i * 16], &a[i * 16], &b[i * 16]);
+        }
+    });
+    report("multiplyReference", reference, reference);
+    report("multiplyBatch", time([&]() {
+        VectorMath::multiplyBatch(out.data(), a.data(), b.data(), kCount);
+    }), reference);
+
+    reference = time([&]() {
+        for (size_t i = 0; i < kCount; i++) {
+            VectorMath::inverse(&out[i * 16], &a[i * 16]);
+        }
+    });
+    report("inverse", reference, reference);
+    report("inverseBatch", time([&]() {
+        VectorMath::inverseBatch(out.data(), a.data(), kCount);
+    }), reference);
+    report("inverseAffine", time([&]() {
+        for (size_t i = 0; i < kCount; i++) {
+            VectorMath::inverseAffine(&out[i * 16], &a[i * 16]);
+        }
+    }), reference);
+
+    reference = time([&]() {
+        VectorMath::transformBatchReference(a.data(), vectors.data(), transformed.data(), kCount);
+    });
+    report("transformBatchReference", reference, reference);
+    report("transformBatch", time([&]() {
+        VectorMath::transformBatch(a.data(), vectors.data(), transformed.data(), kCount);
+    }), reference);
+    return 0;
+}
@@ -0,0 +1,168 @@
+#include "HostTest.h"
+
+#include <cstring>
+#include <vector>
+
+#include "HostRandom.h"
+#include "VectorMath.h"
+
+namespace {
+
+using HostRandom::randomFloats;
+
+/*!
+ * Random matrices whose last row is 0, 0, 0, 1, with every seventh one's z axis zeroed so it
+ * can't be inverted
+ */
+std::vector<float> randomAffineMatrices(size_t count, uint32_t seed) {
+    std::vector<float> matrices = randomFloats(count * 16, seed);
+    for (size_t i = 0; i < count; i++) {
+        float *m = &matrices[i * 16];
+        m[3] = m[7] = m[11] = 0.f;
+        m[15] = 1.f;
+        if (i % 7 == 6) {
+            m[8] = m[9] = m[10] = 0.f;
+        }
+    }
+    return matrices;
+}
+
+bool sameBits(const float *a, const float *b, size_t count) {
+    return count == 0 || memcmp(a, b, count * sizeof(float)) == 0;
+}
+
+bool sameBits(const std::vector<Vec4> &a, const std::vector<Vec4> &b) {
+    return a.size() == b.size() && (a.empty() || sameBits(&a[0].x, &b[0].x, a.size() * 4));
+}
+
+} // namespace
+
+TEST(multiplyMatchesReference) {
+    std::vector<float> a = randomFloats(16 * 100, 1);
+    std::vector<float> b = randomFloats(16 * 100, 2);
+    for (size_t i = 0; i < 100; i++) {
+        const float *ai = &a[i * 16];
+        const float *bi = &b[i * 16];
+        float expected[16], actual[16];
+        VectorMath::multiplyReference(expected, ai, bi);
+        VectorMath::multiply(actual, ai, bi);
+        CHECK(sameBits(actual, expected, 16));
+    }
+}
+
+TEST(multiplyAllowsAliasing) {
+    std::vector<float> a = randomFloats(16, 3);
+    std::vector<float> b = randomFloats(16, 4);
+    float expected[16];
+    VectorMath::multiplyReference(expected, a.data(), b.data());
+
+    float intoA[16], intoB[16];
+    memcpy(intoA, a.data(), sizeof(intoA));
+    memcpy(intoB, b.data(), sizeof(intoB));
+    VectorMath::multiply(intoA, intoA, b.data());
+    VectorMath::multiply(intoB, a.data(), intoB);
+    CHECK(sameBits(intoA, expected, 16));
+    CHECK(sameBits(intoB, expected, 16));
+
+}
+
+TEST(multiplyBatchMatchesMultiply) {
+    for (size_t count: HostRandom::kBatchCounts) {
+        std::vector<float> a = randomFloats(count * 16, uint32_t(count));
+        std::vector<float> b = randomFloats(count * 16, uint32_t(count + 1));
+        std::vector<float> expected(count * 16), actual(count * 16);
+        for (size_t i = 0; i < count; i++) {
+            VectorMath::multiplyReference(&expected[i * 16], &a[i * 16], &b[i * 16]);
+        }
+        VectorMath::multiplyBatch(actual.data(), a.data(), b.data(), count);
+        CHECK(sameBits(actual.data(), expected.data(), count * 16));
+    }
+}
+
+TEST(inverseBatchMatchesInverse) {
+    for (size_t count: HostRandom::kBatchCounts) {
+        // Affine matrices include singular ones, which must come back as zeros in any lane
+        std::vector<float> matrices = count % 2 ? randomAffineMatrices(count, uint32_t(count))
+                                                : randomFloats(count * 16, uint32_t(count));
+        std::vector<float> expected(count * 16), actual(count * 16);
+        for (size_t i = 0; i < count; i++) {
+            VectorMath::inverse(&expected[i * 16], &matrices[i * 16]);
+        }
+        VectorMath::inverseBatch(actual.data(), matrices.data(), count);
+        CHECK(sameBits(actual.data(), expected.data(), count * 16));
+    }
+}
+
+TEST(inverseUndoesMatrix) {
+    std::vector<float> matrices = randomAffineMatrices(50, 5);
+    for (size_t i = 0; i < 50; i++) {
+        const float *m = &matrices[i * 16];
+        float inverse[16], product[16];
+        bool invertible = VectorMath::inverse(inverse, m);
+        CHECK_EQ(invertible, i % 7 != 6);
+        if (!invertible) {
+            for (float value: inverse) {
+                CHECK_EQ(value, 0.f);
+            }
+            continue;
+        }
+        VectorMath::multiply(product, m, inverse);
+        for (int j = 0; j < 16; j++) {
+            CHECK_NEAR(product[j], j % 5 == 0 ? 1.0 : 0.0, 1e-3);
+        }
+    }
+}
+
+TEST(inverseAffineMatchesInverse) {
+    std::vector<float> matrices = randomAffineMatrices(200, 6);
+    for (size_t i = 0; i < 200; i++) {
+        const float *m = &matrices[i * 16];
+        float expected[16], actual[16];
+        VectorMath::inverse(expected, m);
+        VectorMath::inverseAffine(actual, m);
+
+        // A different formula, so only close, but the last row is exact
+        CHECK_EQ(actual[3], 0.f);
+        CHECK_EQ(actual[7], 0.f);
+        CHECK_EQ(actual[11], 0.f);
+        CHECK_EQ(actual[15], 1.f);
+        if (i % 7 == 6) {
+            for (int j = 0; j < 12; j++) {
+                CHECK_EQ(actual[j], 0.f);
+            }
+            continue;
+        }
+        for (int j = 0; j < 16; j++) {
+            CHECK_NEAR(actual[j], expected[j], 1e-4 * (1.0 + std::fabs(expected[j])));
+        }
+    }
+}
+
+TEST(transformBatchMatchesReference) {
+    std::vector<float> matrix = randomFloats(16, 8);
+    for (size_t count: HostRandom::kBatchCounts) {
+        std::vector<float> floats = randomFloats(count * 4, uint32_t(count));
+        std::vector<Vec4> in(count), expected(count), actual(count);
+        for (size_t i = 0; i < count; i++) {
+            in[i] = {floats[i * 4], floats[i * 4 + 1], floats[i * 4 + 2], floats[i * 4 + 3]};
+        }
+        VectorMath::transformBatchReference(matrix.data(), in.data(), expected.data(), count);
+        VectorMath::transformBatch(matrix.data(), in.data(), actual.data(), count);
+        CHECK(sameBits(actual, expected));
+
+        // In place
+        VectorMath::transformBatch(matrix.data(), in.data(), in.data(), count);
+        CHECK(sameBits(in, expected));
+    }
+}
+
+TEST(transformMatchesTransformBatch) {
+    Mat4 matrix;
+    std::vector<float> floats = randomFloats(16, 9);
+    memcpy(matrix.m, floats.data(), sizeof(matrix.m));
+    Vec4 v = {1.5f, -2.0f, 0.25f, 1.0f};
+    Vec4 expected;
+    VectorMath::transformBatchReference(matrix.m, &v, &expected, 1);
+    Vec4 actual = VectorMath::transform(matrix, v);
+    CHECK(sameBits(&actual.x, &expected.x, 4));
+}
@@ -0,0 +1,23 @@
+#ifndef HOLOPERSONA_HOST_GLES3_GL3_H
+#define HOLOPERSONA_HOST_GLES3_GL3_H
+
+#include <cstddef>
+#include <cstdint>
+
+// The GL types only, so host code can include headers such as Model.h that mention them. There
+// are no GL functions, calling one from a host build is a compile error rather than a crash.
+
+typedef unsigned int GLenum;
+typedef unsigned char GLboolean;
+typedef unsigned int GLbitfield;
+typedef int GLint;
+typedef int GLsizei;
+typedef unsigned int GLuint;
+typedef float GLfloat;
+typedef char GLchar;
+typedef uint64_t GLuint64;
+typedef int64_t GLint64;
+typedef ptrdiff_t GLsizeiptr;
+typedef ptrdiff_t GLintptr;
+
+#endif //HOLOPERSONA_HOST_GLES3_GL3_H
@@ -0,0 +1,46 @@
+#ifndef HOLOPERSONA_HOST_ANDROID_ASSET_MANAGER_H
+#define HOLOPERSONA_HOST_ANDROID_ASSET_MANAGER_H
+
+#include <sys/types.h>
+
+// <android/asset_manager.h> for desktop hosts. HostStubs.cpp reads assets as files below the
+// directory an AAssetManager is created for with hostAssetManagerCreate.
+
+struct AAssetManager;
+struct AAsset;
+typedef struct AAssetManager AAssetManager;
+typedef struct AAsset AAsset;
+
+enum {
+    AASSET_MODE_UNKNOWN = 0,
+    AASSET_MODE_RANDOM = 1,
+    AASSET_MODE_STREAMING = 2,
+    AASSET_MODE_BUFFER = 3
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+AAsset *AAssetManager_open(AAssetManager *mgr, const char *filename, int mode);
+
+const void *AAsset_getBuffer(AAsset *asset);
+
+off_t AAsset_getLength(AAsset *asset);
+
+int AAsset_read(AAsset *asset, void *buf, size_t count);
+
+void AAsset_close(AAsset *asset);
+
+/*!
+ * Host only: an asset manager reading from @a directory, free it with hostAssetManagerDestroy
+ */
+AAssetManager *hostAssetManagerCreate(const char *directory);
+
+void hostAssetManagerDestroy(AAssetManager *mgr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //HOLOPERSONA_HOST_ANDROID_ASSET_MANAGER_H
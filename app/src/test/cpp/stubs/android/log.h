@@ -0,0 +1,32 @@
+#ifndef HOLOPERSONA_HOST_ANDROID_LOG_H
+#define HOLOPERSONA_HOST_ANDROID_LOG_H
+
+// The part of the NDK's <android/log.h> the native sources use, for building them on a desktop
+// host. HostStubs.cpp writes the lines to stderr.
+
+typedef enum android_LogPriority {
+    ANDROID_LOG_UNKNOWN = 0,
+    ANDROID_LOG_DEFAULT,
+    ANDROID_LOG_VERBOSE,
+    ANDROID_LOG_DEBUG,
+    ANDROID_LOG_INFO,
+    ANDROID_LOG_WARN,
+    ANDROID_LOG_ERROR,
+    ANDROID_LOG_FATAL,
+    ANDROID_LOG_SILENT,
+} android_LogPriority;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int __android_log_write(int prio, const char *tag, const char *text);
+
+int __android_log_print(int prio, const char *tag, const char *fmt, ...)
+        __attribute__((__format__(printf, 3, 4)));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //HOLOPERSONA_HOST_ANDROID_LOG_H
@@ -0,0 +1,20 @@
+#ifndef HOLOPERSONA_HOST_ANDROID_TRACE_H
+#define HOLOPERSONA_HOST_ANDROID_TRACE_H
+
+// <android/trace.h> for desktop hosts, tracing is never enabled there
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool ATrace_isEnabled();
+
+void ATrace_beginSection(const char *sectionName);
+
+void ATrace_endSection();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //HOLOPERSONA_HOST_ANDROID_TRACE_H
@@ -0,0 +1,262 @@
+#include "EtcCodec.h"
+
+#include <algorithm>
+#include <climits>
+
+namespace {
+
+// Intensity modifiers for pixel indices 0 to 3 of each table, from the ETC1 specification
+constexpr int kModifiers[8][4] = {
+        {2, 8, -2, -8},
+        {5, 17, -5, -17},
+        {9, 29, -9, -29},
+        {13, 42, -13, -42},
+        {18, 60, -18, -60},
+        {24, 80, -24, -80},
+        {33, 106, -33, -106},
+        {47, 183, -47, -183}
+};
+
+struct Texel {
+    int r, g, b;
+};
+
+inline int clampByte(int value) {
+    return std::min(255, std::max(0, value));
+}
+
+inline int expand4(int value) {
+    return (value << 4) | value;
+}
+
+inline int expand5(int value) {
+    return (value << 3) | (value >> 2);
+}
+
+/*!
+ * @return which subblock texel (x, y) of a block is in
+ */
+inline int subblockOf(int x, int y, bool flip) {
+    return flip ? (y >= 2) : (x >= 2);
+}
+
+/*!
+ * A subblock encoded with one base color and table
+ */
+struct SubblockFit {
+    int table;
+    int indices[16];    // Per texel of the block, only this subblock's are set
+    long error;
+};
+
+SubblockFit fitSubblock(const Texel texels[16], int subblock, bool flip, const int base[3]) {
+    SubblockFit best = {0, {}, LONG_MAX};
+    for (int table = 0; table < 8; table++) {
+        SubblockFit fit = {table, {}, 0};
+        for (int i = 0; i < 16; i++) {
+            int x = i / 4;
+            int y = i % 4;
+            if (subblockOf(x, y, flip) != subblock) {
+                continue;
+            }
+            long bestTexelError = LONG_MAX;
+            for (int index = 0; index < 4; index++) {
+                int modifier = kModifiers[table][index];
+                int dr = clampByte(base[0] + modifier) - texels[i].r;
+                int dg = clampByte(base[1] + modifier) - texels[i].g;
+                int db = clampByte(base[2] + modifier) - texels[i].b;
+                long texelError = long(dr) * dr + long(dg) * dg + long(db) * db;
+                if (texelError < bestTexelError) {
+                    bestTexelError = texelError;
+                    fit.indices[i] = index;
+                }
+            }
+            fit.error += bestTexelError;
+        }
+        if (fit.error < best.error) {
+            best = fit;
+        }
+    }
+    return best;
+}
+
+/*!
+ * Writes the fields every mode shares: tables, flip and the pixel indices
+ */
+uint64_t packCommon(const SubblockFit fits[2], bool flip, bool differential) {
+    uint64_t bits = 0;
+    bits |= uint64_t(fits[0].table) << 37;
+    bits |= uint64_t(fits[1].table) << 34;
+    bits |= uint64_t(differential) << 33;
+    bits |= uint64_t(flip) << 32;
+    for (int i = 0; i < 16; i++) {
+        int x = i / 4;
+        int y = i % 4;
+        int index = fits[subblockOf(x, y, flip)].indices[i];
+        bits |= uint64_t(index >> 1) << (16 + i);
+        bits |= uint64_t(index & 1) << i;
+    }
+    return bits;
+}
+
+void encodeBlock(const Texel texels[16], uint8_t *out) {
+    uint64_t bestBits = 0;
+    long bestError = LONG_MAX;
+
+    for (int flip = 0; flip < 2; flip++) {
+        // Average each subblock to pick its base color
+        int sums[2][3] = {};
+        for (int i = 0; i < 16; i++) {
+            int subblock = subblockOf(i / 4, i % 4, flip);
+            sums[subblock][0] += texels[i].r;
+            sums[subblock][1] += texels[i].g;
+            sums[subblock][2] += texels[i].b;
+        }
+
+        // Individual mode, a 4 bit color per subblock
+        {
+            int colors[2][3];
+            int bases[2][3];
+            for (int s = 0; s < 2; s++) {
+                for (int c = 0; c < 3; c++) {
+                    colors[s][c] = std::min(15, (sums[s][c] / 8 * 15 + 127) / 255);
+                    bases[s][c] = expand4(colors[s][c]);
+                }
+            }
+            SubblockFit fits[2] = {fitSubblock(texels, 0, flip, bases[0]),
+                                   fitSubblock(texels, 1, flip, bases[1])};
+            long error = fits[0].error + fits[1].error;
+            if (error < bestError) {
+                uint64_t bits = packCommon(fits, flip, false);
+                for (int c = 0; c < 3; c++) {
+                    bits |= uint64_t(colors[0][c]) << (60 - c * 8);
+                    bits |= uint64_t(colors[1][c]) << (56 - c * 8);
+                }
+                bestBits = bits;
+                bestError = error;
+            }
+        }
+
+        // Differential mode, a 5 bit color and a 3 bit signed offset to the second, only when
+        // the offset fits since anything else reads as one of the ETC2 modes
+        {
+            int colors[2][3];
+            int bases[2][3];
+            bool fits3Bits = true;
+            for (int s = 0; s < 2; s++) {
+                for (int c = 0; c < 3; c++) {
+                    colors[s][c] = std::min(31, (sums[s][c] / 8 * 31 + 127) / 255);
+                    bases[s][c] = expand5(colors[s][c]);
+                }
+            }
+            for (int c = 0; c < 3; c++) {
+                int delta = colors[1][c] - colors[0][c];
+                fits3Bits = fits3Bits && delta >= -4 && delta <= 3;
+            }
+            if (fits3Bits) {
+                SubblockFit fits[2] = {fitSubblock(texels, 0, flip, bases[0]),
+                                       fitSubblock(texels, 1, flip, bases[1])};
+                long error = fits[0].error + fits[1].error;
+                if (error < bestError) {
+                    uint64_t bits = packCommon(fits, flip, true);
+                    for (int c = 0; c < 3; c++) {
+                        int delta = colors[1][c] - colors[0][c];
+                        bits |= uint64_t(colors[0][c]) << (59 - c * 8);
+                        bits |= uint64_t(delta & 7) << (56 - c * 8);
+                    }
+                    bestBits = bits;
+                    bestError = error;
+                }
+            }
+        }
+    }
+
+    // Blocks are stored big endian
+    for (int i = 0; i < 8; i++) {
+        out[i] = uint8_t(bestBits >> (56 - i * 8));
+    }
+}
+
+bool decodeBlock(const uint8_t *in, Texel texels[16]) {
+    uint64_t bits = 0;
+    for (int i = 0; i < 8; i++) {
+        bits = (bits << 8) | in[i];
+    }
+
+    bool differential = (bits >> 33) & 1;
+    bool flip = (bits >> 32) & 1;
+    int tables[2] = {int(bits >> 37) & 7, int(bits >> 34) & 7};
+    int bases[2][3];
+    for (int c = 0; c < 3; c++) {
+        if (differential) {
+            int color = int(bits >> (59 - c * 8)) & 31;
+            int delta = int(bits >> (56 - c * 8)) & 7;
+            delta = delta >= 4 ? delta - 8 : delta;
+            if (color + delta < 0 || color + delta > 31) {
+                // T, H or planar mode
+                return false;
+            }
+            bases[0][c] = expand5(color);
+            bases[1][c] = expand5(color + delta);
+        } else {
+            bases[0][c] = expand4(int(bits >> (60 - c * 8)) & 15);
+            bases[1][c] = expand4(int(bits >> (56 - c * 8)) & 15);
+        }
+    }
+
+    for (int i = 0; i < 16; i++) {
+        int subblock = subblockOf(i / 4, i % 4, flip);
+        int index = int((bits >> (16 + i)) & 1) << 1 | int((bits >> i) & 1);
+        int modifier = kModifiers[tables[subblock]][index];
+        texels[i] = {clampByte(bases[subblock][0] + modifier),
+                     clampByte(bases[subblock][1] + modifier),
+                     clampByte(bases[subblock][2] + modifier)};
+    }
+    return true;
+}
+
+} // namespace
+
+std::vector<uint8_t> EtcCodec::encode(const uint8_t *rgba, uint32_t width, uint32_t height) {
+    std::vector<uint8_t> blocks(encodedSize(width, height));
+    uint8_t *out = blocks.data();
+    for (uint32_t blockY = 0; blockY < height; blockY += 4) {
+        for (uint32_t blockX = 0; blockX < width; blockX += 4) {
+            // Texels are numbered down each column, the order the pixel indices are stored in
+            Texel texels[16];
+            for (int i = 0; i < 16; i++) {
+                uint32_t x = std::min(blockX + i / 4, width - 1);
+                uint32_t y = std::min(blockY + i % 4, height - 1);
+                const uint8_t *pixel = rgba + (size_t(y) * width + x) * 4;
+                texels[i] = {pixel[0], pixel[1], pixel[2]};
+            }
+            encodeBlock(texels, out);
+            out += kBlockSize;
+        }
+    }
+    return blocks;
+}
+
+bool EtcCodec::decode(const uint8_t *blocks, uint32_t width, uint32_t height, uint8_t *outRgba) {
+    for (uint32_t blockY = 0; blockY < height; blockY += 4) {
+        for (uint32_t blockX = 0; blockX < width; blockX += 4) {
+            Texel texels[16];
+            if (!decodeBlock(blocks, texels)) {
+                return false;
+            }
+            blocks += kBlockSize;
+            for (int i = 0; i < 16; i++) {
+                uint32_t x = blockX + i / 4;
+                uint32_t y = blockY + i % 4;
+                if (x < width && y < height) {
+                    uint8_t *pixel = outRgba + (size_t(y) * width + x) * 4;
+                    pixel[0] = uint8_t(texels[i].r);
+                    pixel[1] = uint8_t(texels[i].g);
+                    pixel[2] = uint8_t(texels[i].b);
+                    pixel[3] = 255;
+                }
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,42 @@
+#ifndef HOLOPERSONA_ETCCODEC_H
+#define HOLOPERSONA_ETCCODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*!
+ * A small ETC2 RGB8 codec for the host tools. The encoder only emits the individual and
+ * differential modes ETC2 inherits from ETC1, choosing between them, the two subblock flips and
+ * the eight intensity tables by brute force. That's slower and a little worse than a production
+ * encoder but every block it writes decodes the same on any ETC2 decoder.
+ *
+ * The decoder handles the same subset and stands in for the GPU on hosts without one, so a
+ * converted file can be checked against its source. Blocks are 8 bytes for 4x4 texels, images
+ * whose sides aren't a multiple of 4 repeat their last row and column to fill the edge blocks.
+ */
+namespace EtcCodec {
+
+static constexpr size_t kBlockSize = 8;
+
+/*!
+ * @return the bytes an ETC2 RGB8 image of the given size takes
+ */
+constexpr size_t encodedSize(uint32_t width, uint32_t height) {
+    return size_t((width + 3) / 4) * ((height + 3) / 4) * kBlockSize;
+}
+
+/*!
+ * Encodes tightly packed RGBA8 pixels, alpha is dropped
+ */
+std::vector<uint8_t> encode(const uint8_t *rgba, uint32_t width, uint32_t height);
+
+/*!
+ * Decodes an image written by @a encode to RGBA8 with alpha 255
+ * @return false if a block uses an ETC2 mode outside the subset this codec writes
+ */
+bool decode(const uint8_t *blocks, uint32_t width, uint32_t height, uint8_t *outRgba);
+
+} // namespace EtcCodec
+
+#endif //HOLOPERSONA_ETCCODEC_H
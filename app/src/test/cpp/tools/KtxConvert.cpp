@@ -0,0 +1,61 @@
+// Converts a PNG or JPEG to the KTX 2.0 files TextureAsset::loadCompressedAsset looks for.
+//
+// usage: KtxConvert [--rgba8] [--linear] [--no-mips] <input image> <output.ktx2>
+//
+// The output is ETC2 RGB8 unless --rgba8 is given. Mips are averaged in linear light, as color
+// textures want, unless --linear says the image holds data rather than color.
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "KtxWriter.h"
+
+int main(int argc, char **argv) {
+    KtxWriter::Format format = KtxWriter::Format::ETC2_RGB8;
+    ImageKernels::MipFilter mipFilter = ImageKernels::MipFilter::BOX_SRGB;
+    bool withMips = true;
+    const char *paths[2] = {};
+    int pathCount = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--rgba8") == 0) {
+            format = KtxWriter::Format::RGBA8;
+        } else if (strcmp(argv[i], "--linear") == 0) {
+            mipFilter = ImageKernels::MipFilter::BOX;
+        } else if (strcmp(argv[i], "--no-mips") == 0) {
+            withMips = false;
+        } else if (pathCount < 2 && argv[i][0] != '-') {
+            paths[pathCount++] = argv[i];
+        } else {
+            pathCount = -1;
+            break;
+        }
+    }
+    if (pathCount != 2) {
+        fprintf(stderr, "usage: %s [--rgba8] [--linear] [--no-mips] <input image> <output.ktx2>\n",
+                argv[0]);
+        return 2;
+    }
+
+    int width, height, channels;
+    unsigned char *pixels = stbi_load(paths[0], &width, &height, &channels, 4);
+    if (!pixels) {
+        fprintf(stderr, "couldn't decode %s: %s\n", paths[0], stbi_failure_reason());
+        return 1;
+    }
+    std::vector<uint8_t> file = KtxWriter::writeKtx2(pixels, uint32_t(width), uint32_t(height),
+                                                     format, mipFilter, withMips);
+    stbi_image_free(pixels);
+
+    FILE *out = fopen(paths[1], "wb");
+    if (!out || fwrite(file.data(), 1, file.size(), out) != file.size() || fclose(out) != 0) {
+        fprintf(stderr, "couldn't write %s\n", paths[1]);
+        return 1;
+    }
+    printf("wrote %s, %dx%d, %zu bytes\n", paths[1], width, height, file.size());
+    return 0;
+}
@@ -0,0 +1,129 @@
+#include "KtxWriter.h"
+
+#include <cstring>
+
+#include "EtcCodec.h"
+
+namespace {
+
+constexpr uint8_t kKtx2Identifier[12] = {
+        0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+};
+constexpr size_t kHeaderSize = 80;
+constexpr size_t kLevelIndexEntrySize = 24;
+
+constexpr uint32_t kVkFormatR8G8B8A8Unorm = 37;
+constexpr uint32_t kVkFormatEtc2R8G8B8Unorm = 147;
+
+// Data format descriptor values from the Khronos Data Format specification
+constexpr uint32_t kDfdModelRgbsda = 1;
+constexpr uint32_t kDfdModelEtc2 = 161;
+constexpr uint32_t kDfdPrimariesBt709 = 1;
+constexpr uint32_t kDfdTransferLinear = 1;
+constexpr uint32_t kDfdChannelEtc2Color = 2;
+constexpr uint32_t kDfdChannelAlpha = 15;
+
+void appendU32(std::vector<uint8_t> &out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out.push_back(uint8_t(value >> (i * 8)));
+    }
+}
+
+void writeU64(uint8_t *out, uint64_t value) {
+    memcpy(out, &value, sizeof(value));
+}
+
+/*!
+ * Builds the basic data format descriptor block, which KTX 2.0 readers other than ours need to
+ * interpret the payload
+ */
+std::vector<uint8_t> buildDfd(KtxWriter::Format format) {
+    bool etc2 = format == KtxWriter::Format::ETC2_RGB8;
+    uint32_t sampleCount = etc2 ? 1 : 4;
+    uint32_t blockSize = 24 + 16 * sampleCount;
+
+    std::vector<uint8_t> dfd;
+    appendU32(dfd, 4 + blockSize);  // dfdTotalSize
+    appendU32(dfd, 0);              // vendorId and descriptorType, both Khronos basic
+    appendU32(dfd, 2 | (blockSize << 16));  // versionNumber and descriptorBlockSize
+    appendU32(dfd, (etc2 ? kDfdModelEtc2 : kDfdModelRgbsda)
+                   | (kDfdPrimariesBt709 << 8) | (kDfdTransferLinear << 16));
+    appendU32(dfd, etc2 ? 0x00000303 : 0);  // texelBlockDimension, each one less than the size
+    appendU32(dfd, etc2 ? 8 : 4);   // bytesPlane0
+    appendU32(dfd, 0);              // bytesPlane4 to 7
+
+    if (etc2) {
+        appendU32(dfd, 0 | (63 << 16) | (kDfdChannelEtc2Color << 24));
+        appendU32(dfd, 0);
+        appendU32(dfd, 0);
+        appendU32(dfd, 0xFFFFFFFF);
+    } else {
+        const uint32_t channels[4] = {0, 1, 2, kDfdChannelAlpha};
+        for (uint32_t i = 0; i < 4; i++) {
+            appendU32(dfd, (i * 8) | (7 << 16) | (channels[i] << 24));
+            appendU32(dfd, 0);
+            appendU32(dfd, 0);
+            appendU32(dfd, 255);
+        }
+    }
+    return dfd;
+}
+
+} // namespace
+
+std::vector<uint8_t> KtxWriter::writeKtx2(const uint8_t *rgba,
+                                          uint32_t width,
+                                          uint32_t height,
+                                          Format format,
+                                          ImageKernels::MipFilter mipFilter,
+                                          bool withMips) {
+    std::vector<std::vector<uint8_t>> levels;
+    if (withMips) {
+        levels = ImageKernels::buildMipChain(rgba, width, height, mipFilter);
+    } else {
+        levels.emplace_back(rgba, rgba + size_t(width) * height * 4);
+    }
+    if (format == Format::ETC2_RGB8) {
+        uint32_t levelWidth = width;
+        uint32_t levelHeight = height;
+        for (auto &level: levels) {
+            level = EtcCodec::encode(level.data(), levelWidth, levelHeight);
+            levelWidth = ImageKernels::mipDimension(levelWidth);
+            levelHeight = ImageKernels::mipDimension(levelHeight);
+        }
+    }
+
+    std::vector<uint8_t> dfd = buildDfd(format);
+    std::vector<uint8_t> file(kHeaderSize + levels.size() * kLevelIndexEntrySize);
+
+    uint8_t *header = file.data();
+    memcpy(header, kKtx2Identifier, sizeof(kKtx2Identifier));
+    uint32_t fields[9] = {
+            format == Format::ETC2_RGB8 ? kVkFormatEtc2R8G8B8Unorm : kVkFormatR8G8B8A8Unorm,
+            1,      // typeSize
+            width,
+            height,
+            0,      // pixelDepth
+            0,      // layerCount
+            1,      // faceCount
+            uint32_t(levels.size()),
+            0       // supercompressionScheme
+    };
+    memcpy(header + 12, fields, sizeof(fields));
+    uint32_t dfdOffset = uint32_t(file.size());
+    uint32_t dfdIndex[4] = {dfdOffset, uint32_t(dfd.size()), 0, 0};
+    memcpy(header + 48, dfdIndex, sizeof(dfdIndex));
+    file.insert(file.end(), dfd.begin(), dfd.end());
+
+    // Levels go smallest first, each aligned to both its block size and 4 bytes
+    size_t alignment = format == Format::ETC2_RGB8 ? EtcCodec::kBlockSize : 4;
+    for (size_t i = levels.size(); i-- > 0;) {
+        file.resize((file.size() + alignment - 1) / alignment * alignment);
+        uint8_t *entry = file.data() + kHeaderSize + i * kLevelIndexEntrySize;
+        writeU64(entry, file.size());
+        writeU64(entry + 8, levels[i].size());
+        writeU64(entry + 16, levels[i].size());
+        file.insert(file.end(), levels[i].begin(), levels[i].end());
+    }
+    return file;
+}
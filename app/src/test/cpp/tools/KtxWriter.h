@@ -0,0 +1,40 @@
+#ifndef HOLOPERSONA_KTXWRITER_H
+#define HOLOPERSONA_KTXWRITER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "ImageKernels.h"
+
+/*!
+ * Writes single image KTX 2.0 files for the app's texture pipeline to load, the counterpart of
+ * @a KtxContainer. Only what the app uses is supported: uncompressed RGBA8 and ETC2 RGB8, which
+ * every GLES 3 device can sample, without supercompression.
+ */
+namespace KtxWriter {
+
+enum class Format {
+    RGBA8,      // VK_FORMAT_R8G8B8A8_UNORM
+    ETC2_RGB8   // VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK, alpha is dropped
+};
+
+/*!
+ * Encodes an image and, if asked, its mip chain down to 1x1
+ * @param rgba tightly packed RGBA8 pixels
+ * @param width the width of the image in pixels
+ * @param height the height of the image in pixels
+ * @param format the format to store the levels in
+ * @param mipFilter how to build the mip chain
+ * @param withMips false to only store the full resolution level
+ * @return the file contents
+ */
+std::vector<uint8_t> writeKtx2(const uint8_t *rgba,
+                               uint32_t width,
+                               uint32_t height,
+                               Format format,
+                               ImageKernels::MipFilter mipFilter = ImageKernels::MipFilter::BOX,
+                               bool withMips = true);
+
+} // namespace KtxWriter
+
+#endif //HOLOPERSONA_KTXWRITER_H